@@ -0,0 +1,546 @@
+// Headless asset loading benchmark for every file in Project/data.
+//
+// Runs the CPU side of each loader the game uses, with no Direct3D device:
+//   obj parse    ObjLoaderClass on the obj file, split across every core
+//   mesh cook    MeshLoaderClass with no .mesh next to the obj: optimize, build the detail levels and meshlets,
+//                write the cache
+//   mesh cache   MeshLoaderClass again, mapping the .mesh it just wrote
+//   stale cache  the smallest obj copied next to the JSON file and cooked, then edited with its .mesh still
+//                there: the stale .mesh must be rejected and replaced, and the next load must map it
+//   texture read mapping a dds, checking its header and reading every byte of its surfaces, all the
+//                loading thread does before the texture is created from memory
+//   font parse   FontLoaderClass on the font spacing file
+// and finally loads every mesh from its cache at once on AssetLoaderClass, the way GraphicsClass does.
+//
+// Each stage reports its median wall time over the iterations, throughput in MB/s of the input file, the
+// bytes it allocated and the most it held at once, and the peak resident set size of the process after it.
+// The mesh stages also report the high water mark of the load arena MeshLoaderClass keeps its temporary
+// arrays in.
+// The table goes to stdout and the same numbers are written as JSON.
+//
+// The mesh cook stage deletes the .mesh next to each obj first, so it rebuilds the cache the game would use.
+//
+// Usage: assetbench [data directory] [iterations] [json file]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <dirent.h>
+#include <sys/resource.h>
+#endif
+
+#include "../Project/objloaderclass.h"
+#include "../Project/meshloaderclass.h"
+#include "../Project/fontloaderclass.h"
+#include "../Project/ddsfileclass.h"
+#include "../Project/assetloaderclass.h"
+#include "../Project/hashclass.h"
+
+using namespace std;
+
+// Same processing GraphicsClass asks for, so the cooked files are the ones the game maps.
+static const bool OPTIMIZE_MESHES = true;
+static const int MESH_LOD_COUNT = 4;
+
+struct StageType
+{
+	string file;
+	string stage;
+	size_t inputBytes;
+	double milliseconds;
+	double megabytesPerSecond;
+	unsigned long long bytesAllocated;
+	unsigned long long peakHeapBytes;
+	unsigned long long peakRssBytes;
+	unsigned long long transientPeakBytes;
+	bool result;
+};
+
+// Every allocation made through operator new is counted, including those on the loader threads. The size is
+// kept in front of the block so delete can take it off the live total.
+static atomic<unsigned long long> s_bytesAllocated(0);
+static atomic<unsigned long long> s_liveBytes(0);
+static atomic<unsigned long long> s_peakLiveBytes(0);
+
+static const size_t ALLOCATION_HEADER = 16;
+
+// Largest load arena of the meshes loaded in the current run of a stage.
+static atomic<unsigned long long> s_transientPeakBytes(0);
+
+void* operator new(size_t size)
+{
+	unsigned long long live, peak;
+	char* block;
+
+	block = (char*)malloc(size + ALLOCATION_HEADER);
+	if (!block)
+	{
+		throw bad_alloc();
+	}
+	*(size_t*)block = size;
+
+	s_bytesAllocated += size;
+	live = (s_liveBytes += size);
+	peak = s_peakLiveBytes.load();
+	while (live > peak && !s_peakLiveBytes.compare_exchange_weak(peak, live))
+	{
+	}
+
+	return block + ALLOCATION_HEADER;
+}
+
+void* operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	char* block;
+
+	if (!pointer)
+	{
+		return;
+	}
+
+	block = (char*)pointer - ALLOCATION_HEADER;
+	s_liveBytes -= *(size_t*)block;
+	free(block);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	operator delete(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	operator delete(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	operator delete(pointer);
+}
+
+static unsigned long long GetPeakRss()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+	{
+		return 0;
+	}
+	return counters.PeakWorkingSetSize;
+#else
+	struct rusage usage;
+
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+	{
+		return 0;
+	}
+#ifdef __APPLE__
+	return (unsigned long long)usage.ru_maxrss;
+#else
+	return (unsigned long long)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+static vector<string> ListDirectory(const string& directory)
+{
+	vector<string> names;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	HANDLE find;
+
+	find = FindFirstFileA((directory + "/*").c_str(), &data);
+	if (find != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
+			{
+				names.push_back(data.cFileName);
+			}
+		} while (FindNextFileA(find, &data));
+		FindClose(find);
+	}
+#else
+	DIR* dir;
+	struct dirent* entry;
+
+	dir = opendir(directory.c_str());
+	if (dir)
+	{
+		while ((entry = readdir(dir)) != 0)
+		{
+			if (entry->d_name[0] != '.')
+			{
+				names.push_back(entry->d_name);
+			}
+		}
+		closedir(dir);
+	}
+#endif
+
+	sort(names.begin(), names.end());
+	return names;
+}
+
+static bool HasExtension(const string& name, const char* extension)
+{
+	size_t length;
+
+	length = strlen(extension);
+	return name.size() >= length && name.compare(name.size() - length, length, extension) == 0;
+}
+
+static size_t GetFileSize(const string& filename)
+{
+	MappedFileClass file;
+	size_t size;
+
+	size = file.Initialize(filename.c_str()) ? file.GetSize() : 0;
+	file.Shutdown();
+
+	return size;
+}
+
+static string GetCacheFilename(const string& filename)
+{
+	return filename.substr(0, filename.find_last_of('.')) + ".mesh";
+}
+
+// Runs one stage the given number of times and keeps the median time. Allocation counts come from the last
+// run, they are the same every time.
+template <typename Function>
+static StageType Measure(const string& file, const char* stage, size_t inputBytes, int iterations, Function function)
+{
+	StageType result;
+	vector<double> times;
+	chrono::high_resolution_clock::time_point start;
+	unsigned long long allocatedBefore, liveBefore;
+	int i;
+
+	result.file = file;
+	result.stage = stage;
+	result.inputBytes = inputBytes;
+	result.result = true;
+
+	for (i = 0; i < iterations; i++)
+	{
+		allocatedBefore = s_bytesAllocated;
+		liveBefore = s_liveBytes;
+		s_peakLiveBytes = liveBefore;
+		s_transientPeakBytes = 0;
+
+		start = chrono::high_resolution_clock::now();
+		result.result = function() && result.result;
+		times.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+
+		result.bytesAllocated = s_bytesAllocated - allocatedBefore;
+		result.peakHeapBytes = s_peakLiveBytes - liveBefore;
+		result.transientPeakBytes = s_transientPeakBytes;
+	}
+
+	sort(times.begin(), times.end());
+	result.milliseconds = times[times.size() / 2];
+	result.megabytesPerSecond = (result.milliseconds > 0.0) ? inputBytes / (1024.0 * 1024.0) / (result.milliseconds / 1000.0) : 0.0;
+	result.peakRssBytes = GetPeakRss();
+
+	return result;
+}
+
+static bool ParseObj(const string& filename)
+{
+	ObjLoaderClass loader;
+	bool result;
+
+	result = loader.Initialize(filename.c_str(), 0);
+	loader.Shutdown();
+
+	return result;
+}
+
+static bool LoadMesh(const string& filename, bool expectCache)
+{
+	MeshLoaderClass loader;
+	bool result;
+
+	result = loader.Initialize(filename.c_str(), OPTIMIZE_MESHES, VERTEX_FORMAT_FLOAT, MESH_LOD_COUNT, MESH_RESIDENCY_NONE);
+	result = result && loader.IsFromCache() == expectCache && (expectCache || loader.IsCacheWritten());
+	if (loader.GetTransientPeakBytes() > s_transientPeakBytes)
+	{
+		s_transientPeakBytes = loader.GetTransientPeakBytes();
+	}
+	loader.Shutdown();
+
+	return result;
+}
+
+static bool CookMesh(const string& filename)
+{
+	remove(GetCacheFilename(filename).c_str());
+
+	return LoadMesh(filename, false);
+}
+
+static bool CopyDataFile(const string& source, const string& destination)
+{
+	MappedFileClass file;
+	FILE* output;
+	bool result;
+
+	result = file.Initialize(source.c_str());
+	output = result ? fopen(destination.c_str(), "wb") : 0;
+	result = output && fwrite(file.GetData(), 1, file.GetSize(), output) == file.GetSize();
+	result = output && fclose(output) == 0 && result;
+	file.Shutdown();
+
+	return result;
+}
+
+static bool AppendLine(const string& filename, const char* line)
+{
+	FILE* file;
+	bool result;
+
+	file = fopen(filename.c_str(), "ab");
+	if (!file)
+	{
+		return false;
+	}
+
+	result = fputs(line, file) >= 0;
+	result = fclose(file) == 0 && result;
+
+	return result;
+}
+
+// A source edited after it was cooked, with its old .mesh still next to it, the way an artist saves over a model.
+static bool StaleMesh(const string& filename, const string& scratchFilename)
+{
+	bool result;
+
+	result = CopyDataFile(filename, scratchFilename);
+	remove(GetCacheFilename(scratchFilename).c_str());
+
+	result = result && LoadMesh(scratchFilename, false);
+	result = result && LoadMesh(scratchFilename, true);
+	result = result && AppendLine(scratchFilename, "# edited\n");
+	result = result && LoadMesh(scratchFilename, false);
+	result = result && LoadMesh(scratchFilename, true);
+
+	remove(scratchFilename.c_str());
+	remove(GetCacheFilename(scratchFilename).c_str());
+
+	return result;
+}
+
+static bool ReadTexture(const string& filename)
+{
+	DdsFileClass file;
+	DdsFileClass::SurfaceType surface;
+	bool result;
+
+	// Hashing touches every page, as creating the texture does when it reads the surfaces.
+	result = file.Initialize(filename.c_str());
+	result = result && file.GetSurface(0, 0, surface);
+	if (result)
+	{
+		result = HashClass::HashData(surface.data, file.GetDataSize()) != 0;
+	}
+	file.Shutdown();
+
+	return result;
+}
+
+static bool ParseFont(const string& filename)
+{
+	FontLoaderClass loader;
+	bool result;
+
+	result = loader.Initialize(filename.c_str());
+	loader.Shutdown();
+
+	return result;
+}
+
+static bool LoadAllMeshes(const vector<string>& filenames)
+{
+	AssetLoaderClass pool;
+	vector<future<bool> > loads;
+	bool result;
+	size_t i;
+
+	if (!pool.Initialize(0))
+	{
+		return false;
+	}
+
+	for (i = 0; i < filenames.size(); i++)
+	{
+		string filename = filenames[i];
+		loads.push_back(pool.Submit([filename]() { return LoadMesh(filename, true); }));
+	}
+
+	result = true;
+	for (i = 0; i < loads.size(); i++)
+	{
+		result = loads[i].get() && result;
+	}
+
+	pool.Shutdown();
+
+	return result;
+}
+
+static void WriteString(FILE* file, const string& text)
+{
+	size_t i;
+
+	fputc('"', file);
+	for (i = 0; i < text.size(); i++)
+	{
+		if (text[i] == '"' || text[i] == '\\')
+		{
+			fputc('\\', file);
+		}
+		fputc(text[i], file);
+	}
+	fputc('"', file);
+}
+
+static bool WriteJson(const char* filename, const string& dataDirectory, int iterations, const vector<StageType>& stages)
+{
+	FILE* file;
+	size_t i;
+
+	file = fopen(filename, "w");
+	if (!file)
+	{
+		return false;
+	}
+
+	fprintf(file, "{\n  \"dataDirectory\": ");
+	WriteString(file, dataDirectory);
+	fprintf(file, ",\n  \"iterations\": %d,\n  \"threads\": %u,\n  \"stages\": [\n", iterations, thread::hardware_concurrency());
+	for (i = 0; i < stages.size(); i++)
+	{
+		fprintf(file, "    { \"file\": ");
+		WriteString(file, stages[i].file);
+		fprintf(file, ", \"stage\": ");
+		WriteString(file, stages[i].stage);
+		fprintf(file, ", \"ok\": %s, \"inputBytes\": %llu, \"wallMs\": %.4f, \"mbPerSecond\": %.2f, \"bytesAllocated\": %llu, "
+			"\"peakHeapBytes\": %llu, \"peakRssBytes\": %llu, \"transientPeakBytes\": %llu }%s\n", stages[i].result ? "true" : "false",
+			(unsigned long long)stages[i].inputBytes, stages[i].milliseconds, stages[i].megabytesPerSecond, stages[i].bytesAllocated,
+			stages[i].peakHeapBytes, stages[i].peakRssBytes, stages[i].transientPeakBytes, (i + 1 < stages.size()) ? "," : "");
+	}
+	fprintf(file, "  ]\n}\n");
+
+	return fclose(file) == 0;
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory, filename, smallestMesh, scratchFilename;
+	const char* jsonFilename;
+	vector<string> names, meshes;
+	vector<StageType> stages;
+	size_t i, meshBytes, smallestBytes;
+	int iterations;
+	bool result;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	iterations = (argc > 2) ? atoi(argv[2]) : 5;
+	iterations = (iterations > 0) ? iterations : 5;
+	jsonFilename = (argc > 3) ? argv[3] : "assetbench.json";
+
+	names = ListDirectory(dataDirectory);
+	if (names.empty())
+	{
+		printf("no files in %s\n", dataDirectory.c_str());
+		return 1;
+	}
+
+	meshBytes = 0;
+	smallestBytes = 0;
+	for (i = 0; i < names.size(); i++)
+	{
+		filename = dataDirectory + "/" + names[i];
+
+		if (HasExtension(names[i], ".obj"))
+		{
+			stages.push_back(Measure(names[i], "obj parse", GetFileSize(filename), iterations, [&]() { return ParseObj(filename); }));
+			stages.push_back(Measure(names[i], "mesh cook", GetFileSize(filename), iterations, [&]() { return CookMesh(filename); }));
+			stages.push_back(Measure(names[i], "mesh cache", GetFileSize(GetCacheFilename(filename)), iterations, [&]() { return LoadMesh(filename, true); }));
+
+			meshes.push_back(filename);
+			meshBytes += GetFileSize(GetCacheFilename(filename));
+
+			if (smallestMesh.empty() || GetFileSize(filename) < smallestBytes)
+			{
+				smallestMesh = names[i];
+				smallestBytes = GetFileSize(filename);
+			}
+		}
+		else if (HasExtension(names[i], ".dds"))
+		{
+			stages.push_back(Measure(names[i], "texture read", GetFileSize(filename), iterations, [&]() { return ReadTexture(filename); }));
+		}
+		else if (HasExtension(names[i], "fontdata.txt"))
+		{
+			stages.push_back(Measure(names[i], "font parse", GetFileSize(filename), iterations, [&]() { return ParseFont(filename); }));
+		}
+	}
+
+	if (!meshes.empty())
+	{
+		stages.push_back(Measure("*.mesh", "pool load", meshBytes, iterations, [&]() { return LoadAllMeshes(meshes); }));
+
+		// The edited copy goes next to the JSON file, the data directory is left as it was.
+		filename = dataDirectory + "/" + smallestMesh;
+		scratchFilename = jsonFilename;
+		scratchFilename = scratchFilename.substr(0, scratchFilename.find_last_of("/\\") + 1) + "stale_" + smallestMesh;
+		stages.push_back(Measure(smallestMesh, "stale cache", smallestBytes, iterations, [&]() { return StaleMesh(filename, scratchFilename); }));
+	}
+
+	printf("%-14s %-13s %4s %10s %10s %10s %12s %12s %10s %12s\n", "file", "stage", "ok", "bytes", "ms", "MB/s", "allocated", "peak heap", "peak rss",
+		"arena peak");
+
+	result = true;
+	for (i = 0; i < stages.size(); i++)
+	{
+		printf("%-14s %-13s %4s %10llu %10.3f %10.1f %12llu %12llu %9.1fM %12llu\n", stages[i].file.c_str(), stages[i].stage.c_str(), stages[i].result ? "yes" : "NO",
+			(unsigned long long)stages[i].inputBytes, stages[i].milliseconds, stages[i].megabytesPerSecond, stages[i].bytesAllocated,
+			stages[i].peakHeapBytes, stages[i].peakRssBytes / (1024.0 * 1024.0), stages[i].transientPeakBytes);
+		result = result && stages[i].result;
+	}
+
+	if (!WriteJson(jsonFilename, dataDirectory, iterations, stages))
+	{
+		printf("could not write %s\n", jsonFilename);
+		return 1;
+	}
+
+	return result ? 0 : 1;
+}
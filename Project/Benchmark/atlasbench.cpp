@@ -0,0 +1,269 @@
+// Texture atlas benchmark: how tightly small textures pack, whether their levels stay apart, and the texture
+// binds an atlas saves a frame.
+//
+// The font, seafloor and ground textures in Project/data are packed with SPRITE_COUNT small solid colored
+// sprites, written as RGBA dds files to the output directory, into an RGBA atlas and again into a BC1 one.
+// Every cell must lie in the atlas on the alignment without overlapping another; the first level must hold
+// each source's texels where the table says and repeat its edge texels out to the cell; and every level of a
+// sprite's cell must be its color alone, which it is not if a level filtered in a neighbour's texels. The
+// table read back must match the one cooked, and remapping a source's corners must land on its first and
+// last texels.
+//
+// The frame drawn is FRAME_DRAWS sprites and text in the order a UI draws them, cycling through the sources,
+// bound one after another the way the shaders bind them: without the atlas a bind for each change of texture,
+// with it a single one. Exits with 1 if any check failed.
+//
+// Usage: atlasbench [data directory] [output directory]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Project/ddsfileclass.h"
+#include "../Project/textureatlasclass.h"
+#include "../Project/texturecookerclass.h"
+
+using namespace std;
+
+// Small sprites packed with the textures in Project/data, and the draws of the frame.
+static const int SPRITE_COUNT = 48;
+static const int FRAME_DRAWS = 400;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static bool WriteSprite(const string& filename, int width, int height, const unsigned char* color)
+{
+	vector<char> file;
+	FILE* output;
+	int i;
+	bool result;
+
+	file.resize(DDS_WRITTEN_HEADER_SIZE + (size_t)width * height * 4);
+	DdsFileClass::WriteHeader(DDS_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, false, &file[0]);
+	for (i = 0; i < width * height; i++)
+	{
+		memcpy(&file[DDS_WRITTEN_HEADER_SIZE + (size_t)i * 4], color, 4);
+	}
+
+	output = fopen(filename.c_str(), "wb");
+	if (!output)
+	{
+		return false;
+	}
+
+	result = fwrite(&file[0], 1, file.size(), output) == file.size();
+	result = (fclose(output) == 0) && result;
+
+	return result;
+}
+
+// The first level of a source against its place in the atlas, gutter included.
+static bool CheckFirstLevel(const string& filename, const DdsFileClass::SurfaceType& atlas, const TextureAtlasClass::EntryType& entry)
+{
+	DdsFileClass source;
+	DdsFileClass::SurfaceType surface;
+	vector<unsigned char> texels;
+	int x, y, sourceX, sourceY;
+	bool result;
+
+	result = source.Initialize(filename.c_str()) && source.GetSurface(0, 0, surface) && TextureCookerClass::ConvertToRgba(source.GetFormat(), surface, 0);
+	if (result)
+	{
+		texels.resize((size_t)surface.width * surface.height * 4);
+		TextureCookerClass::ConvertToRgba(source.GetFormat(), surface, &texels[0]);
+	}
+
+	for (y = -ATLAS_GUTTER; result && y < entry.height + ATLAS_GUTTER; y++)
+	{
+		sourceY = (y < 0) ? 0 : ((y >= entry.height) ? entry.height - 1 : y);
+		for (x = -ATLAS_GUTTER; result && x < entry.width + ATLAS_GUTTER; x++)
+		{
+			sourceX = (x < 0) ? 0 : ((x >= entry.width) ? entry.width - 1 : x);
+			result = memcmp(atlas.data + (size_t)(entry.y + y) * atlas.rowPitch + (size_t)(entry.x + x) * 4, &texels[((size_t)sourceY * surface.width + sourceX) * 4], 4) == 0;
+		}
+	}
+	source.Shutdown();
+
+	return result;
+}
+
+// Every texel of a sprite's cell at every level is its color.
+static bool CheckLevels(DdsFileClass& atlas, const TextureAtlasClass::EntryType& entry, const unsigned char* color)
+{
+	DdsFileClass::SurfaceType surface;
+	int mip, cellX, cellY, cellWidth, cellHeight, x, y;
+	bool result;
+
+	cellX = entry.x - ATLAS_GUTTER;
+	cellY = entry.y - ATLAS_GUTTER;
+	cellWidth = (entry.width + 2 * ATLAS_GUTTER + ATLAS_ALIGNMENT - 1) / ATLAS_ALIGNMENT * ATLAS_ALIGNMENT;
+	cellHeight = (entry.height + 2 * ATLAS_GUTTER + ATLAS_ALIGNMENT - 1) / ATLAS_ALIGNMENT * ATLAS_ALIGNMENT;
+
+	result = true;
+	for (mip = 0; result && mip < atlas.GetMipCount(); mip++)
+	{
+		result = atlas.GetSurface(mip, 0, surface);
+		for (y = cellY >> mip; result && y < (cellY + cellHeight) >> mip; y++)
+		{
+			for (x = cellX >> mip; result && x < (cellX + cellWidth) >> mip; x++)
+			{
+				result = memcmp(surface.data + (size_t)y * surface.rowPitch + (size_t)x * 4, color, 4) == 0;
+			}
+		}
+	}
+
+	return result;
+}
+
+int main(int argc, char** argv)
+{
+	static const char* names[] = { "font", "seafloor", "ground" };
+	vector<string> sources;
+	vector<unsigned char> colors;
+	TextureAtlasClass atlas, table;
+	TextureAtlasClass::RemapType remap;
+	DdsFileClass cooked;
+	DdsFileClass::SurfaceType surface;
+	chrono::high_resolution_clock::time_point start;
+	string dataDirectory, outputDirectory, filename;
+	char name[64];
+	double rgbaMilliseconds, bcMilliseconds;
+	unsigned int seed;
+	int threadCount, i, j, width, height, binds, lastBound;
+	bool result, overlap;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	outputDirectory = (argc > 2) ? argv[2] : ".";
+
+	threadCount = (int)thread::hardware_concurrency();
+	threadCount = (threadCount > 0) ? threadCount : 1;
+
+	for (i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+	{
+		sources.push_back(dataDirectory + "/" + names[i] + ".dds");
+	}
+
+	// Sprites of 8 to 71 texels a side, each its own opaque color.
+	seed = 12345;
+	colors.resize(SPRITE_COUNT * 4);
+	for (i = 0; i < SPRITE_COUNT; i++)
+	{
+		seed = seed * 1103515245 + 12345;
+		width = 8 + (int)((seed >> 16) % 64);
+		seed = seed * 1103515245 + 12345;
+		height = 8 + (int)((seed >> 16) % 64);
+		colors[i * 4 + 0] = (unsigned char)(i * 5);
+		colors[i * 4 + 1] = (unsigned char)(255 - i * 3);
+		colors[i * 4 + 2] = (unsigned char)(i * 37);
+		colors[i * 4 + 3] = 255;
+
+		sprintf(name, "/sprite%02d.dds", i);
+		sources.push_back(outputDirectory + name);
+		result = WriteSprite(sources.back(), width, height, &colors[i * 4]);
+		Check(result, "sprites", "could not be written");
+	}
+
+	start = chrono::high_resolution_clock::now();
+	result = atlas.Cook(sources, (outputDirectory + "/atlas.dds").c_str(), (outputDirectory + "/atlas.txt").c_str(), DDS_FORMAT_R8G8B8A8_UNORM, threadCount);
+	rgbaMilliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	Check(result, "atlas", "could not be cooked");
+	if (!result)
+	{
+		printf("\nFAILED, %d check%s failed\n", s_failures, (s_failures == 1) ? "" : "s");
+		return 1;
+	}
+
+	// Cells aligned, in the atlas and apart.
+	for (i = 0; i < atlas.GetEntryCount(); i++)
+	{
+		const TextureAtlasClass::EntryType& entry = atlas.GetEntry(i);
+		Check((entry.x - ATLAS_GUTTER) % ATLAS_ALIGNMENT == 0 && (entry.y - ATLAS_GUTTER) % ATLAS_ALIGNMENT == 0, entry.name.c_str(), "cell not aligned");
+		Check(entry.x >= ATLAS_GUTTER && entry.y >= ATLAS_GUTTER && entry.x + entry.width + ATLAS_GUTTER <= atlas.GetStats().width &&
+			entry.y + entry.height + ATLAS_GUTTER <= atlas.GetStats().height, entry.name.c_str(), "cell outside the atlas");
+
+		overlap = false;
+		for (j = 0; j < i; j++)
+		{
+			const TextureAtlasClass::EntryType& other = atlas.GetEntry(j);
+			overlap = overlap || (entry.x - ATLAS_GUTTER < other.x + other.width + ATLAS_GUTTER && other.x - ATLAS_GUTTER < entry.x + entry.width + ATLAS_GUTTER &&
+				entry.y - ATLAS_GUTTER < other.y + other.height + ATLAS_GUTTER && other.y - ATLAS_GUTTER < entry.y + entry.height + ATLAS_GUTTER);
+		}
+		Check(!overlap, entry.name.c_str(), "cell overlaps another");
+	}
+
+	// Texels and gutters of the first level, and the levels of the sprites.
+	result = cooked.Initialize((outputDirectory + "/atlas.dds").c_str()) && cooked.GetFormat() == DDS_FORMAT_R8G8B8A8_UNORM && cooked.GetSurface(0, 0, surface) &&
+		cooked.GetWidth() == atlas.GetStats().width && cooked.GetHeight() == atlas.GetStats().height && cooked.GetMipCount() == atlas.GetStats().mipCount;
+	Check(result, "atlas", "could not be read back");
+	for (i = 0; result && i < atlas.GetEntryCount(); i++)
+	{
+		Check(CheckFirstLevel(sources[i], surface, atlas.GetEntry(i)), atlas.GetEntry(i).name.c_str(), "texels or gutter differ from the source");
+		if (i >= (int)(sizeof(names) / sizeof(names[0])))
+		{
+			Check(CheckLevels(cooked, atlas.GetEntry(i), &colors[(i - sizeof(names) / sizeof(names[0])) * 4]), atlas.GetEntry(i).name.c_str(), "a level mixes in another cell");
+		}
+	}
+	cooked.Shutdown();
+
+	// The table read back, and the remap of a source's corners onto its first and last texels.
+	result = table.Initialize((outputDirectory + "/atlas.txt").c_str());
+	Check(result && table.GetAtlasName() == "atlas.dds" && table.GetEntryCount() == atlas.GetEntryCount() && table.GetStats().mipCount == atlas.GetStats().mipCount, "table", "not read back");
+	for (i = 0; result && i < table.GetEntryCount(); i++)
+	{
+		const TextureAtlasClass::EntryType& entry = atlas.GetEntry(i);
+		Check(table.GetEntry(i).name == entry.name && table.GetEntry(i).x == entry.x && table.GetEntry(i).y == entry.y &&
+			table.GetEntry(i).width == entry.width && table.GetEntry(i).height == entry.height, entry.name.c_str(), "table entry differs");
+
+		filename = "some/other\\directory/" + entry.name;
+		result = table.GetRemap(filename.c_str(), remap);
+		Check(result, entry.name.c_str(), "not found by file name");
+		Check((int)(remap.uOffset * table.GetStats().width + 0.5f) == entry.x && (int)(remap.vOffset * table.GetStats().height + 0.5f) == entry.y &&
+			(int)((remap.uScale + remap.uOffset) * table.GetStats().width + 0.5f) == entry.x + entry.width &&
+			(int)((remap.vScale + remap.vOffset) * table.GetStats().height + 0.5f) == entry.y + entry.height, entry.name.c_str(), "remap misses the entry");
+	}
+	Check(!table.GetRemap("missing.dds", remap), "table", "found a source never packed");
+
+	start = chrono::high_resolution_clock::now();
+	result = table.Cook(sources, (outputDirectory + "/atlas_bc1.dds").c_str(), (outputDirectory + "/atlas_bc1.txt").c_str(), DDS_FORMAT_BC1_UNORM, threadCount);
+	bcMilliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+	result = result && cooked.Initialize((outputDirectory + "/atlas_bc1.dds").c_str()) && cooked.GetFormat() == DDS_FORMAT_BC1_UNORM && cooked.GetMipCount() == atlas.GetStats().mipCount;
+	cooked.Shutdown();
+	Check(result, "atlas", "BC1 atlas could not be cooked");
+
+	printf("%-14s %8s %11s %6s %8s %10s %10s %10s\n", "atlas", "entries", "size", "levels", "gutter", "occupancy", "cells", "cook ms");
+	printf("%-14s %8d %5dx%-5d %6d %8d %9.1f%% %9.1f%% %10.2f\n", "RGBA", atlas.GetStats().entryCount, atlas.GetStats().width, atlas.GetStats().height,
+		atlas.GetStats().mipCount, ATLAS_GUTTER, atlas.GetStats().occupancy * 100.0f, atlas.GetStats().cellOccupancy * 100.0f, rgbaMilliseconds);
+	printf("%-14s %8d %5dx%-5d %6d %8d %9.1f%% %9.1f%% %10.2f\n", "BC1", table.GetStats().entryCount, table.GetStats().width, table.GetStats().height,
+		table.GetStats().mipCount, ATLAS_GUTTER, table.GetStats().occupancy * 100.0f, table.GetStats().cellOccupancy * 100.0f, bcMilliseconds);
+
+	// The frame, bound draw by draw: every source its own texture, or all of them the atlas.
+	binds = 0;
+	lastBound = -1;
+	for (i = 0; i < FRAME_DRAWS; i++)
+	{
+		j = (i * 7) % (int)sources.size();
+		binds += (j != lastBound) ? 1 : 0;
+		lastBound = j;
+	}
+
+	printf("\n%-14s %8s %10s %10s\n", "frame", "draws", "binds", "saved");
+	printf("%-14s %8d %10d %10d\n", "separate", FRAME_DRAWS, binds, 0);
+	printf("%-14s %8d %10d %10d\n", "atlas", FRAME_DRAWS, 1, binds - 1);
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
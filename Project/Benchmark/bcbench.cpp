@@ -0,0 +1,323 @@
+// Block decoder benchmark, BC1 to BC5 and BC7, on the sizes of the textures in Project/data.
+//
+// The shipped textures are stored uncompressed, so for each of them and each format this builds a DX10
+// dds in memory of the same size with a full mip chain of pseudo-random blocks, which covers every BC1
+// and channel block mode and every BC7 mode and partition. The chain is decoded with each kernel the
+// processor has on one thread, and with the best kernel on every core, and the median rate is reported in
+// megatexels per second. Every kernel's output must match the scalar reference byte for byte. A few
+// hand-made blocks with known colors check the reference itself.
+// Block compressed dds files found in the data directory are decoded and timed the same way.
+//
+// Usage: bcbench [data directory] [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "../Project/ddsfileclass.h"
+#include "../Project/blockdecoderclass.h"
+
+using namespace std;
+
+struct FormatType
+{
+	unsigned int format;
+	const char* name;
+};
+
+static const FormatType s_formats[] =
+{
+	{ DDS_FORMAT_BC1_UNORM, "BC1" },
+	{ DDS_FORMAT_BC2_UNORM, "BC2" },
+	{ DDS_FORMAT_BC3_UNORM, "BC3" },
+	{ DDS_FORMAT_BC4_UNORM, "BC4" },
+	{ DDS_FORMAT_BC5_UNORM, "BC5" },
+	{ DDS_FORMAT_BC7_UNORM, "BC7" },
+};
+
+static const char* s_kernels[] = { "scalar", "sse4", "avx2" };
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static vector<string> ListTextures(const string& dataDirectory)
+{
+	vector<string> names;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE search;
+
+	search = FindFirstFileA((dataDirectory + "/*.dds").c_str(), &found);
+	if (search != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			names.push_back(found.cFileName);
+		} while (FindNextFileA(search, &found));
+		FindClose(search);
+	}
+#else
+	DIR* directory;
+	struct dirent* entry;
+	string name;
+
+	directory = opendir(dataDirectory.c_str());
+	if (directory)
+	{
+		while ((entry = readdir(directory)) != 0)
+		{
+			name = entry->d_name;
+			if (name.size() > 4 && name.compare(name.size() - 4, 4, ".dds") == 0)
+			{
+				names.push_back(name);
+			}
+		}
+		closedir(directory);
+	}
+#endif
+
+	sort(names.begin(), names.end());
+
+	return names;
+}
+
+// A DX10 dds of the given size and format with its whole mip chain filled from a fixed random sequence.
+static void BuildTexture(unsigned int format, int width, int height, vector<char>& data)
+{
+	unsigned int header[31], extended[5], blockBytes, bitsPerPixel, random;
+	size_t size, i;
+	int mipCount, mip;
+
+	DdsFileClass::GetFormatSize(format, blockBytes, bitsPerPixel);
+	for (mipCount = 1; ((width > height ? width : height) >> mipCount) > 0; mipCount++)
+	{
+	}
+
+	size = 0;
+	for (mip = 0; mip < mipCount; mip++)
+	{
+		size += (size_t)((((width >> mip) > 0 ? (width >> mip) : 1) + 3) / 4) * ((((height >> mip) > 0 ? (height >> mip) : 1) + 3) / 4) * blockBytes;
+	}
+
+	memset(header, 0, sizeof(header));
+	header[0] = 124;
+	header[1] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+	header[2] = (unsigned int)height;
+	header[3] = (unsigned int)width;
+	header[6] = (unsigned int)mipCount;
+	header[18] = 32;
+	header[19] = 0x4;
+	memcpy(&header[20], "DX10", 4);
+	header[26] = 0x1000 | 0x8 | 0x400000;
+
+	extended[0] = format;
+	extended[1] = 3;
+	extended[2] = 0;
+	extended[3] = 1;
+	extended[4] = 0;
+
+	data.resize(4 + sizeof(header) + sizeof(extended) + size);
+	memcpy(&data[0], "DDS ", 4);
+	memcpy(&data[4], header, sizeof(header));
+	memcpy(&data[4 + sizeof(header)], extended, sizeof(extended));
+
+	random = 12345;
+	for (i = 4 + sizeof(header) + sizeof(extended); i < data.size(); i++)
+	{
+		random = random * 1664525 + 1013904223;
+		data[i] = (char)(random >> 24);
+	}
+}
+
+static double TimeDecode(DdsFileClass& dds, int kernel, int threadCount, int iterations, vector<unsigned char>& texels)
+{
+	BlockDecoderClass decoder;
+	chrono::high_resolution_clock::time_point start;
+	vector<double> times;
+	int i;
+
+	decoder.Initialize(threadCount, kernel);
+	for (i = 0; i < iterations; i++)
+	{
+		start = chrono::high_resolution_clock::now();
+		decoder.DecodeMipChain(&dds, 0, texels);
+		times.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+	}
+	decoder.Shutdown();
+
+	sort(times.begin(), times.end());
+
+	return times[times.size() / 2];
+}
+
+static void Report(const char* format, const char* texture, DdsFileClass& dds, int iterations)
+{
+	vector<unsigned char> reference, texels;
+	double texelCount, milliseconds;
+	int kernel, threadCount;
+	bool same;
+
+	printf("%-6s %-14s %5d x %-5d", format, texture, dds.GetWidth(), dds.GetHeight());
+
+	milliseconds = TimeDecode(dds, BLOCK_KERNEL_SCALAR, 1, iterations, reference);
+	texelCount = (double)reference.size() / 4;
+	printf(" %9.1f", texelCount / milliseconds / 1000.0);
+
+	same = true;
+	for (kernel = BLOCK_KERNEL_SSE4; kernel <= BLOCK_KERNEL_AVX2; kernel++)
+	{
+		if (kernel > BlockDecoderClass::GetSupportedKernel())
+		{
+			printf(" %9s", "-");
+			continue;
+		}
+
+		milliseconds = TimeDecode(dds, kernel, 1, iterations, texels);
+		printf(" %9.1f", texelCount / milliseconds / 1000.0);
+		same = same && (texels == reference);
+	}
+
+	// The best kernel on every core.
+	threadCount = (int)thread::hardware_concurrency();
+	threadCount = (threadCount > 0) ? threadCount : 1;
+	milliseconds = TimeDecode(dds, BLOCK_KERNEL_AVX2, threadCount, iterations, texels);
+	same = same && (texels == reference);
+	printf(" %9.1f %5s\n", texelCount / milliseconds / 1000.0, same ? "yes" : "NO");
+
+	Check(same, texture, "a kernel differs from the scalar reference");
+}
+
+static void CheckKnownBlocks()
+{
+	unsigned char block[16], texels[64];
+	unsigned long long bits[2];
+	int i, value;
+
+	// BC1 from red to blue, the four texels of the first row one palette entry each.
+	memset(block, 0, sizeof(block));
+	block[0] = 0x00;
+	block[1] = 0xF8;
+	block[2] = 0x1F;
+	block[3] = 0x00;
+	block[4] = 0xE4;
+	BlockDecoderClass::DecodeBlock(DDS_FORMAT_BC1_UNORM, block, texels, 16);
+	Check(texels[0] == 255 && texels[2] == 0 && texels[4] == 0 && texels[6] == 255, "bc1 block", "wrong endpoints");
+	Check(texels[8] == 170 && texels[10] == 85 && texels[12] == 85 && texels[14] == 170 && texels[15] == 255, "bc1 block", "wrong interpolated colors");
+
+	// BC1 with the endpoints swapped is three colors and transparent black.
+	block[0] = 0x1F;
+	block[1] = 0x00;
+	block[2] = 0x00;
+	block[3] = 0xF8;
+	BlockDecoderClass::DecodeBlock(DDS_FORMAT_BC1_UNORM, block, texels, 16);
+	Check(texels[8] == 128 && texels[10] == 128 && texels[12] == 0 && texels[15] == 0, "bc1 block", "wrong three color mode");
+
+	// BC4 from 255 down to 0, texel 1 takes the first interpolated value, (6 * 255 + 3) / 7.
+	memset(block, 0, sizeof(block));
+	block[0] = 255;
+	block[2] = 0x10;
+	BlockDecoderClass::DecodeBlock(DDS_FORMAT_BC4_UNORM, block, texels, 16);
+	Check(texels[0] == 255 && texels[4] == 219 && texels[5] == 0 && texels[7] == 255, "bc4 block", "wrong value");
+
+	// BC7 mode 6 from black to white: texel 0, the anchor, takes 3 bit index 7 (weight 30), the rest 15.
+	// Mode bit 6, the eight 7 bit endpoints alternating 0 and 127, p-bits 0 and 1, then all index bits set.
+	memset(bits, 0, sizeof(bits));
+	for (i = 0; i < 128; i++)
+	{
+		value = (i == 6) || (i >= 64);
+		if (i >= 7 && i < 63)
+		{
+			value = ((i - 7) / 7) % 2;
+		}
+		bits[i / 64] |= (unsigned long long)value << (i % 64);
+	}
+	for (i = 0; i < 16; i++)
+	{
+		block[i] = (unsigned char)(bits[i / 8] >> (8 * (i % 8)));
+	}
+	BlockDecoderClass::DecodeBlock(DDS_FORMAT_BC7_UNORM, block, texels, 16);
+	Check(texels[0] == 120 && texels[1] == 120 && texels[3] == 120, "bc7 block", "wrong anchor texel");
+	Check(texels[4] == 255 && texels[63] == 255, "bc7 block", "wrong texels");
+
+	// A reserved mode decodes to zero.
+	memset(block, 0xFF, sizeof(block));
+	block[0] = 0;
+	BlockDecoderClass::DecodeBlock(DDS_FORMAT_BC7_UNORM, block, texels, 16);
+	Check(texels[0] == 0 && texels[63] == 0, "bc7 block", "reserved mode not zero");
+}
+
+int main(int argc, char** argv)
+{
+	DdsFileClass dds;
+	vector<string> textures;
+	vector<char> data;
+	string dataDirectory, filename;
+	unsigned int i, j;
+	int iterations;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	iterations = (argc > 2) ? atoi(argv[2]) : 9;
+	iterations = (iterations > 0) ? iterations : 9;
+
+	CheckKnownBlocks();
+
+	printf("best kernel: %s, %u threads\n", s_kernels[BlockDecoderClass::GetSupportedKernel()], thread::hardware_concurrency());
+	printf("%-6s %-14s %13s %9s %9s %9s %9s %5s\n", "format", "texture", "size", "scalar", "sse4", "avx2", "threads", "same");
+
+	textures = ListTextures(dataDirectory);
+	for (i = 0; i < textures.size(); i++)
+	{
+		filename = dataDirectory + "/" + textures[i];
+		if (!dds.Initialize(filename.c_str()))
+		{
+			dds.Shutdown();
+			continue;
+		}
+
+		// Block compressed files as they are, the rest as stand-ins of their size in every format.
+		if (BlockDecoderClass::IsSupported(dds.GetFormat()))
+		{
+			Report("file", textures[i].c_str(), dds, iterations);
+			dds.Shutdown();
+			continue;
+		}
+
+		for (j = 0; j < sizeof(s_formats) / sizeof(s_formats[0]); j++)
+		{
+			BuildTexture(s_formats[j].format, dds.GetWidth(), dds.GetHeight(), data);
+
+			DdsFileClass synthetic;
+			synthetic.InitializeFromMemory(&data[0], data.size());
+			Report(s_formats[j].name, textures[i].c_str(), synthetic, iterations);
+			synthetic.Shutdown();
+		}
+		dds.Shutdown();
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
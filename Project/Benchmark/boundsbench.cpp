@@ -0,0 +1,114 @@
+// Bounding volume microbenchmark on one mesh, car.obj by default.
+//
+// Times BoundingVolumeClass::Compute, the SSE (or AVX) min/max reduction MeshLoaderClass uses, against the
+// plain scalar loop over the same vertices, for the 32 byte float vertex and for a 12 byte position only
+// copy like MESH_RESIDENCY_POSITIONS keeps. Prints the median time of a pass, the vertex rate, the speedup
+// and whether both give the same box and sphere.
+//
+// Usage: boundsbench [obj file] [passes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "../Project/objloaderclass.h"
+#include "../Project/boundingvolumeclass.h"
+
+using namespace std;
+
+typedef void (*ComputeFunction)(const void*, int, int, BoundingVolumeClass::BoundsType&);
+
+static double MedianMs(ComputeFunction compute, const void* vertices, int vertexCount, int stride, int passCount, BoundingVolumeClass::BoundsType& bounds)
+{
+	chrono::high_resolution_clock::time_point start;
+	vector<double> times;
+	int i;
+
+	for (i = 0; i < passCount; i++)
+	{
+		start = chrono::high_resolution_clock::now();
+		compute(vertices, vertexCount, stride, bounds);
+		times.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+	}
+
+	sort(times.begin(), times.end());
+
+	return times[times.size() / 2];
+}
+
+static bool SameBounds(const BoundingVolumeClass::BoundsType& first, const BoundingVolumeClass::BoundsType& second)
+{
+	int i;
+
+	for (i = 0; i < 3; i++)
+	{
+		if (first.boundsMin[i] != second.boundsMin[i] || first.boundsMax[i] != second.boundsMax[i])
+		{
+			return false;
+		}
+	}
+
+	return fabsf(first.radius - second.radius) <= 1e-6f * second.radius;
+}
+
+static void Report(const char* name, const void* vertices, int vertexCount, int stride, int passCount)
+{
+	BoundingVolumeClass::BoundsType simdBounds, scalarBounds;
+	double simdMs, scalarMs;
+
+	scalarMs = MedianMs(BoundingVolumeClass::ComputeScalar, vertices, vertexCount, stride, passCount, scalarBounds);
+	simdMs = MedianMs(BoundingVolumeClass::Compute, vertices, vertexCount, stride, passCount, simdBounds);
+
+	printf("%-10s %6d %9.4f %9.4f %10.1f %10.1f %7.2fx %5s\n", name, stride, scalarMs, simdMs, vertexCount / scalarMs / 1000.0, vertexCount / simdMs / 1000.0,
+		scalarMs / simdMs, SameBounds(simdBounds, scalarBounds) ? "yes" : "NO");
+}
+
+int main(int argc, char** argv)
+{
+	ObjLoaderClass loader;
+	BoundingVolumeClass::BoundsType bounds;
+	vector<float> positions;
+	const char* filename;
+	int passCount, i;
+
+	filename = (argc > 1) ? argv[1] : "../Project/data/car.obj";
+	passCount = (argc > 2) ? atoi(argv[2]) : 501;
+	passCount = (passCount > 0) ? passCount : 501;
+
+	if (!loader.Initialize(filename, 0))
+	{
+		printf("%s missing\n", filename);
+		return 1;
+	}
+
+	positions.resize((size_t)loader.GetVertexCount() * 3);
+	for (i = 0; i < loader.GetVertexCount(); i++)
+	{
+		positions[i * 3 + 0] = loader.GetVertices()[i].x;
+		positions[i * 3 + 1] = loader.GetVertices()[i].y;
+		positions[i * 3 + 2] = loader.GetVertices()[i].z;
+	}
+
+	BoundingVolumeClass::Compute(loader.GetVertices(), loader.GetVertexCount(), sizeof(ObjLoaderClass::VertexType), bounds);
+	printf("%s: %d vertices, box (%.3f %.3f %.3f) - (%.3f %.3f %.3f), sphere radius %.3f (box corner %.3f)\n", filename, loader.GetVertexCount(),
+		bounds.boundsMin[0], bounds.boundsMin[1], bounds.boundsMin[2], bounds.boundsMax[0], bounds.boundsMax[1], bounds.boundsMax[2], bounds.radius,
+		sqrtf((bounds.boundsMax[0] - bounds.center[0]) * (bounds.boundsMax[0] - bounds.center[0]) + (bounds.boundsMax[1] - bounds.center[1]) * (bounds.boundsMax[1] - bounds.center[1]) +
+			(bounds.boundsMax[2] - bounds.center[2]) * (bounds.boundsMax[2] - bounds.center[2])));
+
+#if defined(__AVX__)
+	printf("simd path: AVX\n");
+#else
+	printf("simd path: SSE\n");
+#endif
+	printf("%-10s %6s %9s %9s %10s %10s %8s %5s\n", "layout", "stride", "scalar ms", "simd ms", "scalar Mv/s", "simd Mv/s", "speedup", "same");
+
+	Report("vertex", loader.GetVertices(), loader.GetVertexCount(), sizeof(ObjLoaderClass::VertexType), passCount);
+	Report("position", &positions[0], loader.GetVertexCount(), sizeof(float) * 3, passCount);
+
+	loader.Shutdown();
+
+	return 0;
+}
@@ -0,0 +1,275 @@
+// DDS reader check and benchmark for the textures in Project/data.
+//
+// Maps each dds with DdsFileClass and checks what it reports against what the file is known to hold: size,
+// texel format, mip levels, and a first surface that starts right after the header and covers the rest of
+// the file. Then feeds it broken copies (cut short, wrong magic, wrong header size, more mip levels than
+// the size allows) that must all be rejected, and builds a DX10 BC1 cube map with mips in memory to check
+// the surface offsets of the extended header.
+//
+// Last it times mapping and checking the file against reading it into memory with fread, the copy the
+// surfaces no longer need, over the iterations. Exits with 1 if any check failed.
+//
+// Usage: ddsbench [data directory] [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../Project/ddsfileclass.h"
+#include "../Project/hashclass.h"
+
+using namespace std;
+
+struct ExpectedType
+{
+	const char* name;
+	int width, height, mipCount;
+	unsigned int format;
+	const char* formatName;
+};
+
+static const ExpectedType s_textures[] =
+{
+	{ "car.dds", 1024, 1024, 1, DDS_FORMAT_B8G8R8, "B8G8R8" },
+	{ "ground.dds", 253, 256, 1, DDS_FORMAT_B8G8R8X8_UNORM, "B8G8R8X8" },
+	{ "seafloor.dds", 256, 256, 1, DDS_FORMAT_B8G8R8A8_UNORM, "B8G8R8A8" },
+	{ "font.dds", 1024, 16, 1, DDS_FORMAT_R8G8B8X8, "R8G8B8X8" },
+};
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static bool ReadFile(const string& filename, vector<char>& data)
+{
+	FILE* file;
+	long size;
+
+	file = fopen(filename.c_str(), "rb");
+	if (!file)
+	{
+		return false;
+	}
+
+	fseek(file, 0, SEEK_END);
+	size = ftell(file);
+	fseek(file, 0, SEEK_SET);
+
+	data.resize((size_t)size);
+	if (size > 0 && fread(&data[0], 1, (size_t)size, file) != (size_t)size)
+	{
+		fclose(file);
+		return false;
+	}
+
+	fclose(file);
+
+	return true;
+}
+
+static bool Parses(const vector<char>& data, size_t size)
+{
+	DdsFileClass dds;
+	bool result;
+
+	result = dds.InitializeFromMemory(&data[0], size);
+	dds.Shutdown();
+
+	return result;
+}
+
+static void CheckBrokenCopies(const char* name, const vector<char>& data)
+{
+	vector<char> copy;
+	unsigned int value;
+
+	Check(!Parses(data, data.size() - 1), name, "file cut short by a byte was accepted");
+	Check(!Parses(data, 100), name, "file cut inside the header was accepted");
+
+	copy = data;
+	copy[0] = 'X';
+	Check(!Parses(copy, copy.size()), name, "wrong magic number was accepted");
+
+	copy = data;
+	value = 120;
+	memcpy(&copy[4], &value, 4);
+	Check(!Parses(copy, copy.size()), name, "wrong header size was accepted");
+
+	// One level more than the largest side allows.
+	copy = data;
+	value = 12;
+	memcpy(&copy[4 + 24], &value, 4);
+	Check(!Parses(copy, copy.size()), name, "too many mip levels were accepted");
+}
+
+static void CheckTexture(const string& dataDirectory, const ExpectedType& expected)
+{
+	DdsFileClass dds;
+	DdsFileClass::SurfaceType surface;
+	vector<char> data;
+	string filename;
+	bool result;
+
+	filename = dataDirectory + "/" + expected.name;
+	result = dds.Initialize(filename.c_str());
+	Check(result, expected.name, "could not be read");
+	if (!result)
+	{
+		dds.Shutdown();
+		return;
+	}
+
+	Check(dds.GetWidth() == expected.width && dds.GetHeight() == expected.height && dds.GetDepth() == 1, expected.name, "wrong size");
+	Check(dds.GetFormat() == expected.format, expected.name, "wrong format");
+	Check(dds.GetMipCount() == expected.mipCount && dds.GetArraySize() == 1 && dds.GetDimension() == 2 && !dds.IsCubemap(), expected.name, "wrong layout");
+
+	result = dds.GetSurface(0, 0, surface);
+	Check(result && surface.width == (unsigned int)expected.width && surface.height == (unsigned int)expected.height, expected.name, "wrong first surface");
+	Check(result && surface.size == dds.GetDataSize() && surface.slicePitch == surface.rowPitch * surface.rowCount, expected.name, "wrong surface pitch");
+	Check(!dds.GetSurface(1, 0, surface) && !dds.GetSurface(0, 1, surface), expected.name, "surface past the end was returned");
+
+	printf("%-14s %5d x %-5d %-10s %4d %9u %9u %s\n", expected.name, dds.GetWidth(), dds.GetHeight(), expected.formatName, dds.GetMipCount(),
+		(unsigned int)dds.GetDataSize(), result ? surface.rowPitch : 0, DdsFileClass::IsDxgiFormat(dds.GetFormat()) ? "as stored" : "converted");
+
+	dds.Shutdown();
+
+	if (ReadFile(filename, data))
+	{
+		CheckBrokenCopies(expected.name, data);
+	}
+}
+
+static void CheckCubemap()
+{
+	DdsFileClass dds;
+	DdsFileClass::SurfaceType surface;
+	vector<char> data;
+	unsigned int header[31], extended[5];
+	size_t offset;
+	int face, mip;
+	bool result;
+
+	// A 16x16 BC1 cube map with all five levels: 4x4, 2x2, 1x1 and two more 1x1 blocks, 8 bytes each.
+	memset(header, 0, sizeof(header));
+	header[0] = 124;
+	header[1] = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+	header[2] = 16;
+	header[3] = 16;
+	header[6] = 5;
+	header[18] = 32;
+	header[19] = 0x4;
+	memcpy(&header[20], "DX10", 4);
+	header[26] = 0x1000 | 0x8 | 0x400000;
+
+	extended[0] = DDS_FORMAT_BC1_UNORM;
+	extended[1] = 3;
+	extended[2] = 0x4;
+	extended[3] = 1;
+	extended[4] = 0;
+
+	data.resize(4 + sizeof(header) + sizeof(extended) + 6 * (128 + 32 + 8 + 8 + 8));
+	memcpy(&data[0], "DDS ", 4);
+	memcpy(&data[4], header, sizeof(header));
+	memcpy(&data[4 + sizeof(header)], extended, sizeof(extended));
+
+	result = dds.InitializeFromMemory(&data[0], data.size());
+	Check(result, "dx10 cube", "could not be read");
+	Check(result && dds.IsCubemap() && dds.GetArraySize() == 6 && dds.GetMipCount() == 5 && dds.IsBlockCompressed(dds.GetFormat()), "dx10 cube", "wrong layout");
+
+	// Faces one after another, each with its whole mip chain.
+	offset = 4 + sizeof(header) + sizeof(extended);
+	for (face = 0; result && face < 6; face++)
+	{
+		for (mip = 0; mip < 5; mip++)
+		{
+			dds.GetSurface(mip, face, surface);
+			Check(surface.data == &data[offset], "dx10 cube", "wrong surface offset");
+			Check(surface.rowPitch == ((16u >> mip) + 3) / 4 * 8 || (mip >= 3 && surface.rowPitch == 8), "dx10 cube", "wrong block row pitch");
+			offset += surface.size;
+		}
+	}
+	Check(offset == data.size(), "dx10 cube", "surfaces do not cover the data");
+	dds.Shutdown();
+
+	// A cube map missing its last block.
+	Check(!Parses(data, data.size() - 1), "dx10 cube", "file cut short by a byte was accepted");
+}
+
+static void TimeTexture(const string& dataDirectory, const char* name, int iterations)
+{
+	DdsFileClass dds;
+	DdsFileClass::SurfaceType surface;
+	vector<char> data;
+	vector<double> mapTimes, readTimes;
+	chrono::high_resolution_clock::time_point start;
+	string filename;
+	unsigned long long hash;
+	int i;
+
+	filename = dataDirectory + "/" + name;
+	hash = 0;
+	for (i = 0; i < iterations; i++)
+	{
+		// Map, check and touch every byte of the surfaces, which is what the upload reads.
+		start = chrono::high_resolution_clock::now();
+		if (dds.Initialize(filename.c_str()) && dds.GetSurface(0, 0, surface))
+		{
+			hash += HashClass::HashData(surface.data, dds.GetDataSize());
+		}
+		dds.Shutdown();
+		mapTimes.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+
+		// Read into memory first, then touch every byte of the copy.
+		start = chrono::high_resolution_clock::now();
+		if (ReadFile(filename, data))
+		{
+			hash += HashClass::HashData(&data[0], data.size());
+		}
+		readTimes.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+	}
+
+	sort(mapTimes.begin(), mapTimes.end());
+	sort(readTimes.begin(), readTimes.end());
+
+	printf("%-14s %10.3f %10.3f %7.2fx %s\n", name, mapTimes[mapTimes.size() / 2], readTimes[readTimes.size() / 2],
+		readTimes[readTimes.size() / 2] / mapTimes[mapTimes.size() / 2], hash ? "" : "(no data)");
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory;
+	int iterations;
+	unsigned int i;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	iterations = (argc > 2) ? atoi(argv[2]) : 21;
+	iterations = (iterations > 0) ? iterations : 21;
+
+	printf("%-14s %13s %-10s %4s %9s %9s %s\n", "texture", "size", "format", "mips", "bytes", "row pitch", "texels");
+	for (i = 0; i < sizeof(s_textures) / sizeof(s_textures[0]); i++)
+	{
+		CheckTexture(dataDirectory, s_textures[i]);
+	}
+	CheckCubemap();
+
+	printf("\n%-14s %10s %10s %8s\n", "texture", "mapped ms", "fread ms", "speedup");
+	for (i = 0; i < sizeof(s_textures) / sizeof(s_textures[0]); i++)
+	{
+		TimeTexture(dataDirectory, s_textures[i].name, iterations);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,139 @@
+// Level of detail report for the obj meshes in Project/data.
+//
+// Builds the same chain ModelClass builds when a model is cooked: each level simplified by
+// MeshSimplifierClass from the one before it to half of its triangles, under the same error limit, and
+// stopped once a level no longer gets meaningfully smaller. Prints the triangles kept by every level, its
+// error as a fraction of the mesh size (summed along the chain) and the time it took.
+//
+// Every level must hold fewer triangles than the one before it, whole and none of them collapsed to a line,
+// indexing only vertices of the mesh, each within the error limit; and every mesh of more than
+// MIN_SIMPLIFIED_TRIANGLES triangles must get at least one level. Exits with 1 if any check failed.
+//
+// Usage: lodbench [data directory] [error limit]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../Project/objloaderclass.h"
+#include "../Project/meshoptimizerclass.h"
+#include "../Project/meshsimplifierclass.h"
+
+using namespace std;
+
+static const char* s_meshes[] = { "cube.obj", "car.obj", "penguin.obj", "chicken.obj" };
+static const int s_lodCount = 4;
+static const int MIN_SIMPLIFIED_TRIANGLES = 1000;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static bool IsValidLevel(const unsigned int* indices, int indexCount, int vertexCount)
+{
+	int i;
+
+	if (indexCount % 3 != 0)
+	{
+		return false;
+	}
+
+	for (i = 0; i < indexCount; i += 3)
+	{
+		if (indices[i] >= (unsigned int)vertexCount || indices[i + 1] >= (unsigned int)vertexCount || indices[i + 2] >= (unsigned int)vertexCount ||
+			indices[i] == indices[i + 1] || indices[i + 1] == indices[i + 2] || indices[i] == indices[i + 2])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static void Report(const string& dataDirectory, const char* mesh, float errorLimit)
+{
+	ObjLoaderClass loader;
+	MeshOptimizerClass optimizer;
+	MeshSimplifierClass simplifier;
+	chrono::high_resolution_clock::time_point start;
+	vector<unsigned int> source, indices;
+	string filename;
+	int level, vertexCount, count, targetCount;
+	float error, totalError;
+	double time;
+
+	filename = dataDirectory + "/" + mesh;
+	if (!loader.Initialize(filename.c_str(), 0))
+	{
+		loader.Shutdown();
+		Check(false, mesh, "could not be read");
+		return;
+	}
+
+	// Simplify the optimized mesh, as ModelClass does.
+	source.assign(loader.GetIndices(), loader.GetIndices() + loader.GetIndexCount());
+	vertexCount = optimizer.Optimize(loader.GetVertices(), loader.GetVertexCount(), sizeof(ObjLoaderClass::VertexType), &source[0], (int)source.size());
+
+	printf("%-12s %5d %10d %10s %12s %10s\n", mesh, 0, (int)source.size() / 3, "100.0%", "0.000000", "-");
+
+	totalError = 0.0f;
+	for (level = 1; level < s_lodCount; level++)
+	{
+		targetCount = (int)source.size() / 6 * 3;
+		indices.resize(source.size());
+
+		start = chrono::high_resolution_clock::now();
+		count = simplifier.Simplify(&indices[0], &source[0], (int)source.size(), loader.GetVertices(), vertexCount, sizeof(ObjLoaderClass::VertexType),
+									targetCount, errorLimit, error);
+		time = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+		if (count == 0 || count > (int)source.size() * 9 / 10)
+		{
+			printf("%-12s %5d stopped at %d triangles, error %f\n", mesh, level, count / 3, error);
+			Check(level > 1 || loader.GetIndexCount() / 3 <= MIN_SIMPLIFIED_TRIANGLES, mesh, "not simplified at all");
+			break;
+		}
+
+		Check(count < (int)source.size(), mesh, "level not smaller than the one before it");
+		Check(IsValidLevel(&indices[0], count, vertexCount), mesh, "level holds a broken triangle");
+		Check(error <= errorLimit, mesh, "level over the error limit");
+
+		totalError += error;
+		printf("%-12s %5d %10d %9.1f%% %12.6f %10.2f\n", mesh, level, count / 3, count * 100.0 / loader.GetIndexCount(), totalError, time);
+
+		indices.resize(count);
+		source.swap(indices);
+	}
+
+	loader.Shutdown();
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory;
+	float errorLimit;
+	unsigned int i;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	errorLimit = (argc > 2) ? (float)atof(argv[2]) : 0.05f;
+
+	printf("%-12s %5s %10s %10s %12s %10s\n", "mesh", "level", "triangles", "kept", "error", "ms");
+
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		Report(dataDirectory, s_meshes[i], errorLimit);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,376 @@
+// Meshlet report for the obj meshes in Project/data.
+//
+// Splits every mesh into meshlets the way ModelClass does and prints their size, how many have a normal cone
+// narrow enough to ever be culled, and the vertex cache ACMR before and after the triangles were regrouped.
+// Then flies the demo camera (45 degree field of view, 800x600) around each mesh on a ring at 1.5 times its
+// bounding radius, close enough that part of it leaves the view, and reports the fraction of meshlets and
+// triangles the CPU pass rejects by frustum and by normal cone.
+//
+// Every meshlet must hold at most MESHLET_MAX_VERTICES vertices and MESHLET_MAX_TRIANGLES triangles, count the
+// vertices it uses, and bound them with its sphere; together the meshlets must cover every triangle of the mesh
+// exactly once, with the same vertices in the same winding. A meshlet the normal cone rejects must have every
+// triangle facing away from the camera. Exits with 1 if any check failed.
+//
+// Usage: meshletbench [data directory] [camera positions]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "../Project/objloaderclass.h"
+#include "../Project/meshoptimizerclass.h"
+#include "../Project/meshletbuilderclass.h"
+
+using namespace std;
+
+static const char* s_meshes[] = { "cube.obj", "car.obj", "penguin.obj", "chicken.obj" };
+
+struct CameraType
+{
+	float position[3];
+	float right[3], up[3], forward[3];
+	float tanHalfWidth, tanHalfHeight;
+};
+
+// A triangle turned so its smallest index comes first, which keeps its winding.
+struct TriangleType
+{
+	unsigned int index[3];
+};
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static float Dot(const float a[3], const float b[3])
+{
+	return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+static bool CompareTriangles(const TriangleType& a, const TriangleType& b)
+{
+	if (a.index[0] != b.index[0])
+	{
+		return a.index[0] < b.index[0];
+	}
+	if (a.index[1] != b.index[1])
+	{
+		return a.index[1] < b.index[1];
+	}
+
+	return a.index[2] < b.index[2];
+}
+
+static void GetTriangles(const vector<unsigned int>& indices, vector<TriangleType>& triangles)
+{
+	TriangleType triangle;
+	int i, first;
+
+	triangles.clear();
+	for (i = 0; i + 3 <= (int)indices.size(); i += 3)
+	{
+		first = (indices[i] < indices[i + 1]) ? ((indices[i] < indices[i + 2]) ? 0 : 2) : ((indices[i + 1] < indices[i + 2]) ? 1 : 2);
+		triangle.index[0] = indices[i + first];
+		triangle.index[1] = indices[i + (first + 1) % 3];
+		triangle.index[2] = indices[i + (first + 2) % 3];
+		triangles.push_back(triangle);
+	}
+
+	sort(triangles.begin(), triangles.end(), CompareTriangles);
+}
+
+// Limits, vertex counts and spheres of every meshlet, and the triangles they cover against the source.
+static void CheckMeshlets(const char* mesh, const vector<unsigned int>& source, const vector<unsigned int>& indices,
+	const vector<MeshletBuilderClass::MeshletType>& meshlets, const ObjLoaderClass::VertexType* vertices, int vertexCount)
+{
+	vector<TriangleType> sourceTriangles, triangles;
+	vector<int> covered, used;
+	const float* position;
+	float offset[3];
+	unsigned int i, j;
+	int distinct;
+	bool inside, limits, counted, once;
+
+	covered.assign(indices.size() / 3, 0);
+	used.assign(vertexCount, -1);
+	limits = true;
+	counted = true;
+	inside = true;
+	for (i = 0; i < meshlets.size(); i++)
+	{
+		limits = limits && meshlets[i].triangleCount > 0 && meshlets[i].triangleCount <= (unsigned int)MESHLET_MAX_TRIANGLES &&
+			meshlets[i].vertexCount <= (unsigned int)MESHLET_MAX_VERTICES && meshlets[i].indexStart % 3 == 0 &&
+			meshlets[i].indexStart + meshlets[i].triangleCount * 3 <= indices.size();
+		if (!limits)
+		{
+			break;
+		}
+
+		distinct = 0;
+		for (j = meshlets[i].indexStart; j < meshlets[i].indexStart + meshlets[i].triangleCount * 3; j++)
+		{
+			covered[j / 3] += (j % 3 == 0) ? 1 : 0;
+			distinct += (used[indices[j]] != (int)i) ? 1 : 0;
+			used[indices[j]] = (int)i;
+
+			position = &vertices[indices[j]].x;
+			offset[0] = position[0] - meshlets[i].center[0];
+			offset[1] = position[1] - meshlets[i].center[1];
+			offset[2] = position[2] - meshlets[i].center[2];
+			inside = inside && sqrtf(Dot(offset, offset)) <= meshlets[i].radius * 1.0001f + 1e-5f;
+		}
+		counted = counted && distinct == (int)meshlets[i].vertexCount;
+	}
+
+	once = limits;
+	for (i = 0; once && i < covered.size(); i++)
+	{
+		once = covered[i] == 1;
+	}
+
+	GetTriangles(source, sourceTriangles);
+	GetTriangles(indices, triangles);
+
+	Check(limits, mesh, "meshlet over the vertex or triangle limit");
+	Check(counted, mesh, "meshlet vertex count wrong");
+	Check(inside, mesh, "vertex outside its meshlet sphere");
+	Check(once, mesh, "triangle not in exactly one meshlet");
+	Check(triangles.size() == sourceTriangles.size() && equal(triangles.begin(), triangles.end(), sourceTriangles.begin(),
+		[](const TriangleType& a, const TriangleType& b) { return !CompareTriangles(a, b) && !CompareTriangles(b, a); }), mesh, "triangles changed");
+}
+
+// Every triangle of a meshlet the cone rejected must face away from the camera.
+static bool FacesAway(const MeshletBuilderClass::MeshletType& meshlet, const vector<unsigned int>& indices, const ObjLoaderClass::VertexType* vertices,
+	const float cameraPosition[3])
+{
+	const float *a, *b, *c;
+	float e0[3], e1[3], normal[3], view[3];
+	unsigned int i;
+	int j;
+
+	for (i = meshlet.indexStart; i < meshlet.indexStart + meshlet.triangleCount * 3; i += 3)
+	{
+		a = &vertices[indices[i + 0]].x;
+		b = &vertices[indices[i + 1]].x;
+		c = &vertices[indices[i + 2]].x;
+		for (j = 0; j < 3; j++)
+		{
+			e0[j] = b[j] - a[j];
+			e1[j] = c[j] - a[j];
+			view[j] = a[j] - cameraPosition[j];
+		}
+
+		normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+		normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+		normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+		if (Dot(normal, view) < -1e-4f * sqrtf(Dot(normal, normal) * Dot(view, view)))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Camera on a ring around the target, 20 degrees above it, looking at it.
+static void PlaceCamera(CameraType& camera, const float target[3], float distance, float angle)
+{
+	float elevation, length;
+	int i;
+
+	elevation = 20.0f * 3.14159265f / 180.0f;
+	camera.position[0] = target[0] + distance * cosf(elevation) * sinf(angle);
+	camera.position[1] = target[1] + distance * sinf(elevation);
+	camera.position[2] = target[2] - distance * cosf(elevation) * cosf(angle);
+
+	for (i = 0; i < 3; i++)
+	{
+		camera.forward[i] = (target[i] - camera.position[i]) / distance;
+	}
+
+	// Left handed: right = up x forward with up along y, then up = forward x right.
+	camera.right[0] = camera.forward[2];
+	camera.right[1] = 0.0f;
+	camera.right[2] = -camera.forward[0];
+	length = sqrtf(Dot(camera.right, camera.right));
+	for (i = 0; i < 3; i++)
+	{
+		camera.right[i] /= length;
+	}
+
+	camera.up[0] = camera.forward[1] * camera.right[2] - camera.forward[2] * camera.right[1];
+	camera.up[1] = camera.forward[2] * camera.right[0] - camera.forward[0] * camera.right[2];
+	camera.up[2] = camera.forward[0] * camera.right[1] - camera.forward[1] * camera.right[0];
+
+	camera.tanHalfHeight = tanf(3.14159265f / 8.0f);
+	camera.tanHalfWidth = camera.tanHalfHeight * 800.0f / 600.0f;
+}
+
+// Sphere against the four side planes of the view, in view space.
+static bool InFrustum(const CameraType& camera, const float center[3], float radius)
+{
+	float offset[3], x, y, z;
+	int i;
+
+	for (i = 0; i < 3; i++)
+	{
+		offset[i] = center[i] - camera.position[i];
+	}
+	x = Dot(offset, camera.right);
+	y = Dot(offset, camera.up);
+	z = Dot(offset, camera.forward);
+
+	if (z < -radius)
+	{
+		return false;
+	}
+	if ((fabsf(x) - z * camera.tanHalfWidth) / sqrtf(1.0f + camera.tanHalfWidth * camera.tanHalfWidth) > radius)
+	{
+		return false;
+	}
+	if ((fabsf(y) - z * camera.tanHalfHeight) / sqrtf(1.0f + camera.tanHalfHeight * camera.tanHalfHeight) > radius)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+static void Report(const string& dataDirectory, const char* mesh, int cameraCount)
+{
+	ObjLoaderClass loader;
+	MeshOptimizerClass optimizer;
+	MeshletBuilderClass builder;
+	vector<MeshletBuilderClass::MeshletType> meshlets;
+	vector<unsigned int> indices, source;
+	CameraType camera;
+	string filename;
+	float boundsMin[3], boundsMax[3], center[3], radius, acmrBefore, acmrAfter, atvr;
+	int i, j, vertexCount, vertexTotal, coneCount, frustumMeshlets, backfaceMeshlets, culledTriangles;
+	double frustumFraction, backfaceFraction, triangleFraction;
+	const float* position;
+	bool facesAway;
+
+	filename = dataDirectory + "/" + mesh;
+	if (!loader.Initialize(filename.c_str(), 0))
+	{
+		loader.Shutdown();
+		Check(false, mesh, "could not be read");
+		return;
+	}
+
+	// Build on the optimized mesh, as ModelClass does.
+	indices.assign(loader.GetIndices(), loader.GetIndices() + loader.GetIndexCount());
+	vertexCount = optimizer.Optimize(loader.GetVertices(), loader.GetVertexCount(), sizeof(ObjLoaderClass::VertexType), &indices[0], (int)indices.size());
+	optimizer.AnalyzeVertexCache(&indices[0], (int)indices.size(), vertexCount, VERTEX_CACHE_SIZE, acmrBefore, atvr);
+	source = indices;
+
+	builder.Build(&indices[0], (int)indices.size(), loader.GetVertices(), vertexCount, sizeof(ObjLoaderClass::VertexType), 0, meshlets);
+	for (i = 0; i < (int)meshlets.size(); i++)
+	{
+		optimizer.OptimizeVertexCache(&indices[meshlets[i].indexStart], meshlets[i].triangleCount * 3, vertexCount, VERTEX_CACHE_SIZE);
+	}
+	optimizer.AnalyzeVertexCache(&indices[0], (int)indices.size(), vertexCount, VERTEX_CACHE_SIZE, acmrAfter, atvr);
+
+	CheckMeshlets(mesh, source, indices, meshlets, loader.GetVertices(), vertexCount);
+
+	vertexTotal = 0;
+	coneCount = 0;
+	for (i = 0; i < (int)meshlets.size(); i++)
+	{
+		vertexTotal += meshlets[i].vertexCount;
+		coneCount += (meshlets[i].coneCutoff > 0.0f) ? 1 : 0;
+	}
+
+	// Bounding sphere of the whole mesh, which the camera circles.
+	for (i = 0; i < vertexCount; i++)
+	{
+		position = &loader.GetVertices()[i].x;
+		for (j = 0; j < 3; j++)
+		{
+			boundsMin[j] = (i == 0 || position[j] < boundsMin[j]) ? position[j] : boundsMin[j];
+			boundsMax[j] = (i == 0 || position[j] > boundsMax[j]) ? position[j] : boundsMax[j];
+		}
+	}
+
+	radius = 0.0f;
+	for (j = 0; j < 3; j++)
+	{
+		center[j] = (boundsMin[j] + boundsMax[j]) * 0.5f;
+		radius += (boundsMax[j] - center[j]) * (boundsMax[j] - center[j]);
+	}
+	radius = sqrtf(radius);
+
+	// Same order as ModelClass: the cheaper frustum test first, the cone only for meshlets still in view.
+	frustumFraction = 0.0;
+	backfaceFraction = 0.0;
+	triangleFraction = 0.0;
+	facesAway = true;
+	for (i = 0; i < cameraCount; i++)
+	{
+		PlaceCamera(camera, center, 1.5f * radius, 2.0f * 3.14159265f * i / cameraCount);
+
+		frustumMeshlets = 0;
+		backfaceMeshlets = 0;
+		culledTriangles = 0;
+		for (j = 0; j < (int)meshlets.size(); j++)
+		{
+			if (!InFrustum(camera, meshlets[j].center, meshlets[j].radius))
+			{
+				frustumMeshlets++;
+				culledTriangles += meshlets[j].triangleCount;
+			}
+			else if (MeshletBuilderClass::IsBackfacing(meshlets[j], camera.position))
+			{
+				backfaceMeshlets++;
+				culledTriangles += meshlets[j].triangleCount;
+				facesAway = facesAway && FacesAway(meshlets[j], indices, loader.GetVertices(), camera.position);
+			}
+		}
+
+		frustumFraction += (double)frustumMeshlets / meshlets.size();
+		backfaceFraction += (double)backfaceMeshlets / meshlets.size();
+		triangleFraction += (double)culledTriangles / (indices.size() / 3);
+	}
+
+	Check(facesAway, mesh, "cone rejected a meshlet with a triangle facing the camera");
+
+	printf("%-12s %8d %8.1f %8.1f %7.1f%% %6.3f %6.3f %9.1f%% %9.1f%% %9.1f%%\n", mesh, (int)meshlets.size(), (double)vertexTotal / meshlets.size(),
+		indices.size() / 3.0 / meshlets.size(), coneCount * 100.0 / meshlets.size(), acmrBefore, acmrAfter,
+		frustumFraction * 100.0 / cameraCount, backfaceFraction * 100.0 / cameraCount, triangleFraction * 100.0 / cameraCount);
+
+	loader.Shutdown();
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory;
+	int cameraCount;
+	unsigned int i;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	cameraCount = (argc > 2) ? atoi(argv[2]) : 64;
+	cameraCount = (cameraCount > 0) ? cameraCount : 64;
+
+	printf("%-12s %8s %8s %8s %8s %6s %6s %10s %10s %10s\n", "mesh", "meshlets", "verts", "tris", "cones",
+		"acmr", "after", "frustum", "backface", "tris culled");
+
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		Report(dataDirectory, s_meshes[i], cameraCount);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
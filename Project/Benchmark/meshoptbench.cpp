@@ -0,0 +1,155 @@
+// Mesh optimization report for the obj meshes in Project/data.
+//
+// Loads every mesh the way ModelClass does and measures it before and after MeshOptimizerClass with the
+// usual CPU side metrics: ACMR (post-transform cache misses per triangle, 0.5 is the practical floor for
+// regular grids and 3.0 the worst case), ATVR (vertices transformed per unique vertex, 1.0 is optimal) and
+// overdraw (pixels shaded per pixel covered, averaged over six axis aligned views).
+//
+// The optimized mesh must draw the same set of triangles, from no more vertices, and at the VERTEX_CACHE_SIZE it
+// is optimized for its ACMR and ATVR must be no worse than before. Overdraw is only reported, the optimizer
+// gives a little of it up for the cache order. Exits with 1 if any check failed.
+//
+// Usage: meshoptbench [data directory] [cache size]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../Project/objloaderclass.h"
+#include "../Project/meshoptimizerclass.h"
+
+using namespace std;
+
+static const char* s_meshes[] = { "cube.obj", "car.obj", "penguin.obj", "chicken.obj" };
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+struct TriangleType
+{
+	float corners[3][8];
+};
+
+static bool CompareTriangles(const TriangleType& a, const TriangleType& b)
+{
+	return memcmp(&a, &b, sizeof(TriangleType)) < 0;
+}
+
+// Expand the indexed mesh to its triangles, each rotated to start at its smallest corner, and sort them, so
+// two meshes drawing the same triangles in any order and with any vertex numbering compare equal.
+static void GetTriangles(const ObjLoaderClass::VertexType* vertices, const unsigned int* indices, int indexCount, vector<TriangleType>& triangles)
+{
+	TriangleType triangle;
+	int i, j, first;
+
+	triangles.clear();
+	for (i = 0; i < indexCount; i += 3)
+	{
+		first = 0;
+		for (j = 1; j < 3; j++)
+		{
+			if (memcmp(&vertices[indices[i + j]], &vertices[indices[i + first]], sizeof(ObjLoaderClass::VertexType)) < 0)
+			{
+				first = j;
+			}
+		}
+
+		for (j = 0; j < 3; j++)
+		{
+			memcpy(triangle.corners[j], &vertices[indices[i + (first + j) % 3]], sizeof(ObjLoaderClass::VertexType));
+		}
+		triangles.push_back(triangle);
+	}
+
+	sort(triangles.begin(), triangles.end(), CompareTriangles);
+}
+
+static void Report(const string& dataDirectory, const char* mesh, int cacheSize)
+{
+	ObjLoaderClass loader;
+	MeshOptimizerClass optimizer;
+	vector<ObjLoaderClass::VertexType> vertices;
+	vector<unsigned int> indices;
+	vector<TriangleType> before, after;
+	chrono::high_resolution_clock::time_point start;
+	string filename;
+	float acmrBefore, atvrBefore, overdrawBefore, acmrAfter, atvrAfter, overdrawAfter;
+	double time;
+	int vertexCount, indexCount, sourceVertexCount;
+	bool identical;
+
+	filename = dataDirectory + "/" + mesh;
+	if (!loader.Initialize(filename.c_str(), 0))
+	{
+		loader.Shutdown();
+		Check(false, mesh, "could not be read");
+		return;
+	}
+
+	vertexCount = loader.GetVertexCount();
+	indexCount = loader.GetIndexCount();
+	vertices.assign(loader.GetVertices(), loader.GetVertices() + vertexCount);
+	indices.assign(loader.GetIndices(), loader.GetIndices() + indexCount);
+	loader.Shutdown();
+
+	optimizer.AnalyzeVertexCache(&indices[0], indexCount, vertexCount, cacheSize, acmrBefore, atvrBefore);
+	overdrawBefore = optimizer.AnalyzeOverdraw(&vertices[0], vertexCount, sizeof(ObjLoaderClass::VertexType), &indices[0], indexCount);
+	GetTriangles(&vertices[0], &indices[0], indexCount, before);
+
+	sourceVertexCount = vertexCount;
+	start = chrono::high_resolution_clock::now();
+	vertexCount = optimizer.Optimize(&vertices[0], vertexCount, sizeof(ObjLoaderClass::VertexType), &indices[0], indexCount);
+	time = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+	optimizer.AnalyzeVertexCache(&indices[0], indexCount, vertexCount, cacheSize, acmrAfter, atvrAfter);
+	overdrawAfter = optimizer.AnalyzeOverdraw(&vertices[0], vertexCount, sizeof(ObjLoaderClass::VertexType), &indices[0], indexCount);
+	GetTriangles(&vertices[0], &indices[0], indexCount, after);
+
+	identical = before.size() == after.size() && (before.empty() || memcmp(&before[0], &after[0], before.size() * sizeof(TriangleType)) == 0);
+
+	printf("%-12s %10d %6.3f -> %5.3f %6.3f -> %5.3f %6.3f -> %5.3f %10.2f %10s\n", mesh, indexCount / 3, acmrBefore, acmrAfter,
+		atvrBefore, atvrAfter, overdrawBefore, overdrawAfter, time, identical ? "yes" : "NO");
+
+	Check(identical, mesh, "optimized mesh draws other triangles");
+	Check(vertexCount <= sourceVertexCount, mesh, "optimized mesh has more vertices");
+	Check(cacheSize != VERTEX_CACHE_SIZE || acmrAfter <= acmrBefore, mesh, "ACMR worse after optimizing");
+	Check(cacheSize != VERTEX_CACHE_SIZE || atvrAfter <= atvrBefore, mesh, "ATVR worse after optimizing");
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory;
+	int cacheSize;
+	unsigned int i;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	cacheSize = (argc > 2) ? atoi(argv[2]) : 16;
+	if (cacheSize < 3)
+	{
+		cacheSize = 3;
+	}
+
+	printf("cache size %d\n", cacheSize);
+	printf("%-12s %10s %15s %15s %15s %10s %10s\n", "mesh", "triangles", "ACMR", "ATVR", "overdraw", "ms", "identical");
+
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		Report(dataDirectory, s_meshes[i], cacheSize);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,241 @@
+// Mip chain generator benchmark: box, Kaiser and Lanczos chains of 4096x4096 and 8192x8192 images.
+//
+// No texture that large ships, so the images are car.dds tiled to size, or a procedural pattern when the
+// data directory has no car.dds. Each filter builds the full srgb chain scalar on one thread, with SSE on
+// one thread and with SSE on every core, and the median time is reported with the rate in megatexels of the
+// first level per second. The SSE chain must match the scalar one byte for byte. Small images with known
+// results check the generator itself: a constant image stays constant, a checker of black and white
+// filters to middle grey, 188 in srgb and 128 in linear, and the chain has the right levels and size.
+//
+// Usage: mipbench [data directory] [iterations]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Project/ddsfileclass.h"
+#include "../Project/mipgeneratorclass.h"
+#include "../Project/texturecookerclass.h"
+
+using namespace std;
+
+struct FilterType
+{
+	int filter;
+	const char* name;
+};
+
+static const FilterType s_filters[] =
+{
+	{ MIP_FILTER_BOX, "box" },
+	{ MIP_FILTER_KAISER, "kaiser" },
+	{ MIP_FILTER_LANCZOS, "lanczos" },
+};
+
+static const int s_sizes[] = { 4096, 8192 };
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static size_t ChainSize(int width, int height)
+{
+	size_t size;
+	int level;
+
+	size = 0;
+	for (level = 0; level < MipGeneratorClass::GetLevelCount(width, height); level++)
+	{
+		size += (size_t)((width >> level > 0) ? width >> level : 1) * ((height >> level > 0) ? height >> level : 1) * 4;
+	}
+
+	return size;
+}
+
+static void CheckKnownImages()
+{
+	MipGeneratorClass generator;
+	vector<unsigned char> texels, chain;
+	unsigned int i;
+	size_t j;
+	int x, y, center;
+	bool constant, grey;
+
+	Check(MipGeneratorClass::GetLevelCount(4096, 4096) == 13 && MipGeneratorClass::GetLevelCount(1024, 16) == 11 &&
+		MipGeneratorClass::GetLevelCount(253, 256) == 9 && MipGeneratorClass::GetLevelCount(1, 1) == 1, "level count", "wrong number of levels");
+
+	for (i = 0; i < sizeof(s_filters) / sizeof(s_filters[0]); i++)
+	{
+		generator.Initialize(1, s_filters[i].filter, true);
+
+		// Odd sizes and a side that reaches one texel first.
+		texels.assign((size_t)37 * 23 * 4, 0);
+		for (j = 0; j < texels.size(); j += 4)
+		{
+			texels[j] = 200;
+			texels[j + 1] = 90;
+			texels[j + 2] = 17;
+			texels[j + 3] = 128;
+		}
+		generator.Generate(&texels[0], 37, 23, 37 * 4, true, chain);
+		Check(chain.size() == ChainSize(37, 23), s_filters[i].name, "chain of an odd sized image has the wrong size");
+		constant = true;
+		for (j = 0; j < chain.size(); j++)
+		{
+			constant = constant && chain[j] == texels[j % 4];
+		}
+		Check(constant, s_filters[i].name, "a constant image changed");
+
+		generator.Generate(&texels[0], 37, 1, 37 * 4, false, chain);
+		Check(chain.size() == ChainSize(37, 1), s_filters[i].name, "chain of a single row has the wrong size");
+
+		// Black and white texels average to half the light, not half the srgb value. The box is exact over
+		// the whole level, the sinc filters away from the clamped edges.
+		texels.assign((size_t)16 * 16 * 4, 255);
+		for (y = 0; y < 16; y++)
+		{
+			for (x = 0; x < 16; x++)
+			{
+				memset(&texels[((size_t)y * 16 + x) * 4], ((x + y) & 1) ? 0 : 255, 3);
+			}
+		}
+
+		center = (4 * 8 + 4) * 4 + 16 * 16 * 4;
+		generator.Generate(&texels[0], 16, 16, 16 * 4, true, chain);
+		grey = true;
+		for (j = 16 * 16 * 4; j < 16 * 16 * 4 + 8 * 8 * 4; j++)
+		{
+			grey = grey && ((j % 4 == 3) ? chain[j] == 255 : (chain[j] == 188 || s_filters[i].filter != MIP_FILTER_BOX));
+		}
+		Check(grey && chain[center] == 188, s_filters[i].name, "srgb checker did not filter to 188");
+
+		generator.Generate(&texels[0], 16, 16, 16 * 4, false, chain);
+		grey = true;
+		for (j = 16 * 16 * 4; j < 16 * 16 * 4 + 8 * 8 * 4; j++)
+		{
+			grey = grey && ((j % 4 == 3) ? chain[j] == 255 : (chain[j] == 128 || s_filters[i].filter != MIP_FILTER_BOX));
+		}
+		Check(grey && chain[center] >= 127 && chain[center] <= 128, s_filters[i].name, "linear checker did not filter to 128");
+
+		generator.Shutdown();
+	}
+}
+
+static void BuildImage(const string& dataDirectory, int size, vector<unsigned char>& image)
+{
+	DdsFileClass dds;
+	DdsFileClass::SurfaceType surface;
+	vector<unsigned char> tile;
+	unsigned int random;
+	int x, y;
+
+	image.resize((size_t)size * size * 4);
+
+	if (dds.Initialize((dataDirectory + "/car.dds").c_str()) && dds.GetSurface(0, 0, surface) && TextureCookerClass::ConvertToRgba(dds.GetFormat(), surface, 0))
+	{
+		tile.resize((size_t)surface.width * surface.height * 4);
+		TextureCookerClass::ConvertToRgba(dds.GetFormat(), surface, &tile[0]);
+		for (y = 0; y < size; y++)
+		{
+			for (x = 0; x < size; x++)
+			{
+				memcpy(&image[((size_t)y * size + x) * 4], &tile[(((size_t)y % surface.height) * surface.width + x % surface.width) * 4], 4);
+			}
+		}
+		dds.Shutdown();
+		return;
+	}
+	dds.Shutdown();
+
+	// Gradients with noise, and rings for the filters to ring on.
+	random = 12345;
+	for (y = 0; y < size; y++)
+	{
+		for (x = 0; x < size; x++)
+		{
+			random = random * 1664525 + 1013904223;
+			image[((size_t)y * size + x) * 4] = (unsigned char)(x * 255 / size);
+			image[((size_t)y * size + x) * 4 + 1] = (unsigned char)(y * 255 / size);
+			image[((size_t)y * size + x) * 4 + 2] = (unsigned char)((((x / 7) ^ (y / 5)) & 1) ? 230 : 20);
+			image[((size_t)y * size + x) * 4 + 3] = (unsigned char)(random >> 24);
+		}
+	}
+}
+
+static double TimeGenerate(const vector<unsigned char>& image, int size, int filter, int threadCount, bool vectorized, int iterations, vector<unsigned char>& chain)
+{
+	MipGeneratorClass generator;
+	chrono::high_resolution_clock::time_point start;
+	vector<double> times;
+	int i;
+
+	generator.Initialize(threadCount, filter, vectorized);
+	for (i = 0; i < iterations; i++)
+	{
+		start = chrono::high_resolution_clock::now();
+		generator.Generate(&image[0], size, size, size * 4, true, chain);
+		times.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+	}
+	generator.Shutdown();
+
+	sort(times.begin(), times.end());
+
+	return times[times.size() / 2];
+}
+
+int main(int argc, char** argv)
+{
+	vector<unsigned char> image, reference, chain;
+	string dataDirectory;
+	char name[32];
+	double scalar, vectorized, threaded;
+	unsigned int i, j;
+	int iterations, threadCount;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	iterations = (argc > 2) ? atoi(argv[2]) : 3;
+	iterations = (iterations > 0) ? iterations : 3;
+	threadCount = (int)thread::hardware_concurrency();
+	threadCount = (threadCount > 0) ? threadCount : 1;
+
+	CheckKnownImages();
+
+	printf("%d threads\n", threadCount);
+	printf("%-14s %-8s %9s %9s %9s %10s %5s\n", "image", "filter", "scalar", "sse", "threads", "Mtexel/s", "same");
+
+	for (i = 0; i < sizeof(s_sizes) / sizeof(s_sizes[0]); i++)
+	{
+		BuildImage(dataDirectory, s_sizes[i], image);
+		sprintf(name, "%dx%d", s_sizes[i], s_sizes[i]);
+
+		for (j = 0; j < sizeof(s_filters) / sizeof(s_filters[0]); j++)
+		{
+			scalar = TimeGenerate(image, s_sizes[i], s_filters[j].filter, 1, false, iterations, reference);
+			vectorized = TimeGenerate(image, s_sizes[i], s_filters[j].filter, 1, true, iterations, chain);
+			Check(chain == reference, name, "SSE chain differs from the scalar one");
+			Check(chain.size() == ChainSize(s_sizes[i], s_sizes[i]), name, "chain has the wrong size");
+
+			threaded = TimeGenerate(image, s_sizes[i], s_filters[j].filter, threadCount, true, iterations, chain);
+			Check(chain == reference, name, "threaded chain differs from the single threaded one");
+
+			printf("%-14s %-8s %9.1f %9.1f %9.1f %10.2f %5s\n", name, s_filters[j].name, scalar, vectorized, threaded,
+				(double)s_sizes[i] * s_sizes[i] / threaded / 1000.0, (chain == reference) ? "yes" : "no");
+		}
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
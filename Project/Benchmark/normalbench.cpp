@@ -0,0 +1,301 @@
+// Normal and tangent generation report for the obj meshes in Project/data.
+//
+// Writes a copy of every mesh with its normals left out, loads it and generates them again the way
+// MeshLoaderClass does, on one thread and on at least PARALLEL_THREADS. Prints the time of each, whether both results are
+// the same bit for bit, how many vertices the crease splits added, and the mean and largest angle between
+// the generated and the authored normal of every triangle corner. Then times the tangent frames on the
+// authored mesh and counts the vertices with a mirrored texture mapping.
+//
+// Both runs must give the same result bit for bit and the same triangles as the authored file. Every generated
+// normal must be of unit length and within the crease angle of its corner's face, which any average of the
+// faces within that angle is. Every tangent must be of unit length, or zero where the texture mapping has no
+// gradient, lie in the plane of its vertex normal, and carry a sign of 1 or -1. Exits with 1 if any check failed.
+//
+// Usage: normalbench [data directory] [crease angle]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Project/objloaderclass.h"
+#include "../Project/normalgeneratorclass.h"
+
+using namespace std;
+
+static const char* s_meshes[] = { "cube.obj", "car.obj", "penguin.obj", "chicken.obj" };
+
+static const int RUN_COUNT = 5;
+
+// Threads for the parallel run even on a machine with fewer cores, so the ranges really are split.
+static const int PARALLEL_THREADS = 8;
+
+// Room for float rounding in the unit length, plane and angle checks.
+static const float LENGTH_TOLERANCE = 1e-3f;
+static const float ANGLE_TOLERANCE = 0.01f;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+// Every corner normal must be unit length and no further from its face normal than the crease angle.
+static void CheckNormals(const char* name, const vector<ObjLoaderClass::VertexType>& vertices, const vector<unsigned int>& indices, float creaseAngle)
+{
+	const ObjLoaderClass::VertexType *a, *b, *c, *corner;
+	double e0[3], e1[3], face[3], faceLength, length, angle;
+	int i, j;
+	bool unit, within;
+
+	unit = true;
+	within = true;
+	for (i = 0; i + 3 <= (int)indices.size(); i += 3)
+	{
+		a = &vertices[indices[i + 0]];
+		b = &vertices[indices[i + 1]];
+		c = &vertices[indices[i + 2]];
+		e0[0] = b->x - a->x;
+		e0[1] = b->y - a->y;
+		e0[2] = b->z - a->z;
+		e1[0] = c->x - a->x;
+		e1[1] = c->y - a->y;
+		e1[2] = c->z - a->z;
+		face[0] = e0[1] * e1[2] - e0[2] * e1[1];
+		face[1] = e0[2] * e1[0] - e0[0] * e1[2];
+		face[2] = e0[0] * e1[1] - e0[1] * e1[0];
+		faceLength = sqrt(face[0] * face[0] + face[1] * face[1] + face[2] * face[2]);
+
+		for (j = 0; j < 3; j++)
+		{
+			corner = &vertices[indices[i + j]];
+			length = sqrt(corner->nx * corner->nx + corner->ny * corner->ny + corner->nz * corner->nz);
+			unit = unit && fabs(length - 1.0) <= LENGTH_TOLERANCE;
+
+			// A face with no area has no direction of its own to stay near.
+			if (faceLength > 0.0 && length > 0.0)
+			{
+				angle = (face[0] * corner->nx + face[1] * corner->ny + face[2] * corner->nz) / (faceLength * length);
+				angle = acos(max(-1.0, min(1.0, angle))) * 180.0 / 3.14159265358979;
+				within = within && angle <= creaseAngle + ANGLE_TOLERANCE;
+			}
+		}
+	}
+
+	Check(unit, name, "generated normal not unit length");
+	Check(within, name, "generated normal outside the crease angle of its face");
+}
+
+static void CheckTangents(const char* name, const ObjLoaderClass::VertexType* vertices, int vertexCount, const vector<NormalGeneratorClass::TangentType>& tangents)
+{
+	double length, normalLength, dot;
+	int i;
+	bool unit, inPlane, signs;
+
+	unit = true;
+	inPlane = true;
+	signs = true;
+	for (i = 0; i < (int)tangents.size(); i++)
+	{
+		length = sqrt(tangents[i].x * tangents[i].x + tangents[i].y * tangents[i].y + tangents[i].z * tangents[i].z);
+		normalLength = sqrt(vertices[i].nx * vertices[i].nx + vertices[i].ny * vertices[i].ny + vertices[i].nz * vertices[i].nz);
+		unit = unit && (length == 0.0 || fabs(length - 1.0) <= LENGTH_TOLERANCE);
+		signs = signs && (tangents[i].w == 1.0f || tangents[i].w == -1.0f);
+
+		if (length > 0.0 && normalLength > 0.0)
+		{
+			dot = (tangents[i].x * vertices[i].nx + tangents[i].y * vertices[i].ny + tangents[i].z * vertices[i].nz) / (length * normalLength);
+			inPlane = inPlane && fabs(dot) <= LENGTH_TOLERANCE;
+		}
+	}
+
+	Check((int)tangents.size() == vertexCount, name, "not a tangent for every vertex");
+	Check(unit, name, "tangent not unit length");
+	Check(inPlane, name, "tangent out of the plane of its normal");
+	Check(signs, name, "bitangent sign not 1 or -1");
+}
+
+// Copies an obj file without its vn records and with the normal index dropped from every face corner.
+static bool StripNormals(const string& source, const string& destination)
+{
+	ifstream fin;
+	ofstream fout;
+	string line, token;
+	size_t start, end, slash;
+
+	fin.open(source.c_str());
+	fout.open(destination.c_str());
+	if (fin.fail() || fout.fail())
+	{
+		return false;
+	}
+
+	while (getline(fin, line))
+	{
+		if (line.compare(0, 3, "vn ") == 0)
+		{
+			continue;
+		}
+
+		if (line.compare(0, 2, "f ") == 0)
+		{
+			fout << "f";
+			for (start = 2; start < line.size(); start = end)
+			{
+				start = line.find_first_not_of(" \t\r", start);
+				if (start == string::npos)
+				{
+					break;
+				}
+				end = line.find_first_of(" \t\r", start);
+				end = (end == string::npos) ? line.size() : end;
+
+				// v/t/n becomes v/t and v//n becomes v.
+				token = line.substr(start, end - start);
+				slash = token.find('/');
+				if (slash != string::npos)
+				{
+					slash = token.find('/', slash + 1);
+					token = token.substr(0, slash);
+					if (!token.empty() && token[token.size() - 1] == '/')
+					{
+						token.erase(token.size() - 1);
+					}
+				}
+				fout << " " << token;
+			}
+			fout << "\n";
+			continue;
+		}
+
+		fout << line << "\n";
+	}
+
+	return !fout.fail();
+}
+
+static double GenerateMs(ObjLoaderClass& loader, float creaseAngle, int threadCount, vector<ObjLoaderClass::VertexType>& vertices, vector<unsigned int>& indices)
+{
+	NormalGeneratorClass generator;
+	chrono::high_resolution_clock::time_point start;
+	vector<double> times;
+	int i;
+
+	for (i = 0; i < RUN_COUNT; i++)
+	{
+		indices.assign(loader.GetIndices(), loader.GetIndices() + loader.GetIndexCount());
+
+		start = chrono::high_resolution_clock::now();
+		generator.GenerateNormals(loader.GetVertices(), loader.GetVertexCount(), &indices[0], (int)indices.size(), creaseAngle, threadCount, vertices);
+		times.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+	}
+
+	sort(times.begin(), times.end());
+
+	return times[times.size() / 2];
+}
+
+static void Report(const string& dataDirectory, const char* mesh, float creaseAngle)
+{
+	ObjLoaderClass authored, stripped;
+	NormalGeneratorClass generator;
+	vector<ObjLoaderClass::VertexType> serialVertices, parallelVertices;
+	vector<unsigned int> serialIndices, parallelIndices;
+	vector<NormalGeneratorClass::TangentType> tangents;
+	chrono::high_resolution_clock::time_point start;
+	string filename, strippedFilename;
+	const ObjLoaderClass::VertexType *expected, *generated;
+	double serialMs, parallelMs, tangentMs, angle, angleSum, angleMax;
+	int i, mirrored;
+	bool same, result;
+
+	filename = dataDirectory + "/" + mesh;
+	strippedFilename = string(mesh) + ".nonormals.obj";
+	if (!authored.Initialize(filename.c_str(), 0) || !StripNormals(filename, strippedFilename) || !stripped.Initialize(strippedFilename.c_str(), 0))
+	{
+		authored.Shutdown();
+		stripped.Shutdown();
+		remove(strippedFilename.c_str());
+		Check(false, mesh, "could not be read");
+		return;
+	}
+	remove(strippedFilename.c_str());
+
+	serialMs = GenerateMs(stripped, creaseAngle, 1, serialVertices, serialIndices);
+	parallelMs = GenerateMs(stripped, creaseAngle, max(PARALLEL_THREADS, (int)thread::hardware_concurrency()), parallelVertices, parallelIndices);
+	same = serialVertices.size() == parallelVertices.size() && serialIndices == parallelIndices &&
+		memcmp(&serialVertices[0], &parallelVertices[0], sizeof(ObjLoaderClass::VertexType) * serialVertices.size()) == 0;
+
+	// Both files list the same faces in the same order, so triangle corners line up one to one.
+	angleSum = 0.0;
+	angleMax = 0.0;
+	if (authored.GetIndexCount() == (int)serialIndices.size())
+	{
+		for (i = 0; i < authored.GetIndexCount(); i++)
+		{
+			expected = &authored.GetVertices()[authored.GetIndices()[i]];
+			generated = &serialVertices[serialIndices[i]];
+			angle = (expected->nx * generated->nx + expected->ny * generated->ny + expected->nz * generated->nz) /
+				sqrt(expected->nx * expected->nx + expected->ny * expected->ny + expected->nz * expected->nz);
+			angle = acos(max(-1.0, min(1.0, angle))) * 180.0 / 3.14159265358979;
+			angleSum += angle;
+			angleMax = max(angleMax, angle);
+		}
+	}
+
+	start = chrono::high_resolution_clock::now();
+	result = generator.GenerateTangents(authored.GetVertices(), authored.GetVertexCount(), authored.GetIndices(), authored.GetIndexCount(), 0, tangents);
+	tangentMs = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+	Check(same, mesh, "thread count changed the result");
+	Check(authored.GetIndexCount() == (int)serialIndices.size(), mesh, "generated other triangles than authored");
+	CheckNormals(mesh, serialVertices, serialIndices, creaseAngle);
+	Check(result, mesh, "tangents not generated");
+	CheckTangents(mesh, authored.GetVertices(), authored.GetVertexCount(), tangents);
+
+	mirrored = 0;
+	for (i = 0; i < (int)tangents.size(); i++)
+	{
+		mirrored += (tangents[i].w < 0.0f) ? 1 : 0;
+	}
+
+	printf("%-12s %8d %8d %9.2f %9.2f %5s %9.2f %9.2f %9.2f %8.1f%%\n", mesh, stripped.GetVertexCount(), (int)serialVertices.size(), serialMs, parallelMs,
+		same ? "yes" : "NO", angleSum / max(1, authored.GetIndexCount()), angleMax, tangentMs, mirrored * 100.0 / max(1, (int)tangents.size()));
+
+	authored.Shutdown();
+	stripped.Shutdown();
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory;
+	float creaseAngle;
+	unsigned int i;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	creaseAngle = (argc > 2) ? (float)atof(argv[2]) : NORMAL_CREASE_ANGLE;
+
+	printf("crease angle %.1f degrees, %d threads\n", creaseAngle, max(PARALLEL_THREADS, (int)thread::hardware_concurrency()));
+	printf("%-12s %8s %8s %9s %9s %5s %9s %9s %9s %9s\n", "mesh", "verts", "split", "1 thr ms", "par ms", "same", "mean deg", "max deg",
+		"tangent ms", "mirrored");
+
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		Report(dataDirectory, s_meshes[i], creaseAngle);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
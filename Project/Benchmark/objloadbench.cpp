@@ -0,0 +1,425 @@
+// Load time benchmark for the obj meshes in Project/data.
+//
+// Compares the original two-pass ifstream reader that ModelClass used with ObjLoaderClass, which maps the
+// file and parses it in one pass, then shows how the chunked parser scales from 1 to N threads and checks
+// that every thread count produces exactly the serial output. Finally it reports how much vertex
+// deduplication saves over one vertex per triangle corner, and what opening the cooked .mesh costs
+// compared to parsing the obj again. Only the CPU side is measured, no Direct3D
+// device is needed.
+//
+// Both readers must find the same triangles, every thread count must produce the serial output byte for byte,
+// every index must name a vertex and every vertex be named by one, and the cooked .mesh must hold the triangles
+// the obj does. Exits with 1 if any check failed.
+//
+// Usage: objloadbench [data directory] [iterations] [max threads]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Project/objloaderclass.h"
+#include "../Project/meshcacheclass.h"
+
+using namespace std;
+
+static const char* s_meshes[] = { "cube.obj", "car.obj", "penguin.obj", "chicken.obj" };
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+// The reader ModelClass used before ObjLoaderClass: count records with ifstream::get, then read them again
+// with operator>>. Kept here only as the baseline to measure against.
+static int LegacyLoad(const char* filename)
+{
+	ifstream fin;
+	char input, input2;
+	int vertexCount, textureCount, normalCount, faceCount, faceNum, vertexIndex, texcoordIndex, normalIndex;
+	float x, y, z;
+	int i, v, t, n;
+	bool faceNumRead;
+	float *vertices, *texcoords, *normals;
+	int* faces;
+	float checksum;
+
+	vertexCount = textureCount = normalCount = faceCount = faceNum = 0;
+	faceNumRead = false;
+
+	fin.open(filename);
+	if (fin.fail())
+	{
+		return -1;
+	}
+
+	fin.get(input);
+	while (!fin.eof())
+	{
+		if (input == 'v')
+		{
+			fin.get(input);
+			if (input == ' ') vertexCount++;
+			if (input == 't') textureCount++;
+			if (input == 'n') normalCount++;
+		}
+		if (input == 'f')
+		{
+			fin.get(input);
+			if (input == ' ') faceCount++;
+			if (!faceNumRead)
+			{
+				while (input != '\n')
+				{
+					fin.get(input);
+					if (input == '/') faceNum++;
+				}
+				faceNum = (faceNum == 8) ? 4 : 3;
+				faceNumRead = true;
+			}
+		}
+		while (input != '\n' && !fin.eof())
+		{
+			fin.get(input);
+		}
+		fin.get(input);
+	}
+	fin.close();
+
+	vertices = new float[vertexCount * 3];
+	texcoords = new float[textureCount * 2];
+	normals = new float[normalCount * 3];
+	faces = new int[faceCount * 12];
+	vertexIndex = texcoordIndex = normalIndex = 0;
+	checksum = 0.0f;
+
+	fin.open(filename);
+	fin.get(input);
+	faceCount = 0;
+	while (!fin.eof())
+	{
+		if (input == 'v')
+		{
+			fin.get(input);
+			if (input == ' ')
+			{
+				fin >> x >> y >> z;
+				vertices[vertexIndex * 3] = x; vertices[vertexIndex * 3 + 1] = y; vertices[vertexIndex * 3 + 2] = -z;
+				vertexIndex++;
+			}
+			if (input == 't')
+			{
+				fin >> x >> y;
+				texcoords[texcoordIndex * 2] = x; texcoords[texcoordIndex * 2 + 1] = 1.0f - y;
+				texcoordIndex++;
+			}
+			if (input == 'n')
+			{
+				fin >> x >> y >> z;
+				normals[normalIndex * 3] = x; normals[normalIndex * 3 + 1] = y; normals[normalIndex * 3 + 2] = -z;
+				normalIndex++;
+			}
+		}
+		if (input == 'f')
+		{
+			fin.get(input);
+			if (input == ' ')
+			{
+				for (i = 0; i < faceNum; i++)
+				{
+					fin >> v >> input2 >> t >> input2 >> n;
+					faces[faceCount * 12 + i * 3] = v;
+					faces[faceCount * 12 + i * 3 + 1] = t;
+					faces[faceCount * 12 + i * 3 + 2] = n;
+				}
+				checksum += vertices[(faces[faceCount * 12] - 1) * 3];
+				faceCount++;
+			}
+		}
+		while (input != '\n' && !fin.eof())
+		{
+			fin.get(input);
+		}
+		fin.get(input);
+	}
+	fin.close();
+
+	delete[] vertices;
+	delete[] texcoords;
+	delete[] normals;
+	delete[] faces;
+
+	return (faceNum == 4) ? faceCount * 2 : faceCount;
+}
+
+static int s_threadCount = 1;
+
+static int NewLoad(const char* filename)
+{
+	ObjLoaderClass loader;
+	int polygonCount;
+
+	if (!loader.Initialize(filename, s_threadCount))
+	{
+		loader.Shutdown();
+		return -1;
+	}
+
+	polygonCount = loader.GetPolygonCount();
+	loader.Shutdown();
+
+	return polygonCount;
+}
+
+static double TimeLoad(int (*load)(const char*), const char* filename, int iterations, int& polygonCount)
+{
+	chrono::high_resolution_clock::time_point start;
+	double best, elapsed;
+	int i;
+
+	best = 1e30;
+	polygonCount = -1;
+	for (i = 0; i < iterations; i++)
+	{
+		start = chrono::high_resolution_clock::now();
+		polygonCount = load(filename);
+		elapsed = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+		if (elapsed < best)
+		{
+			best = elapsed;
+		}
+	}
+
+	return best;
+}
+
+// Load the mesh with the given thread count and compare the vertices byte for byte against the serial load.
+static bool MatchesSerial(const char* filename, int threadCount)
+{
+	ObjLoaderClass serial, parallel;
+	bool result;
+
+	result = serial.Initialize(filename, 1) && parallel.Initialize(filename, threadCount);
+	result = result && serial.GetVertexCount() == parallel.GetVertexCount();
+	result = result && (serial.GetVertexCount() == 0 ||
+		memcmp(serial.GetVertices(), parallel.GetVertices(), serial.GetVertexCount() * sizeof(ObjLoaderClass::VertexType)) == 0);
+	result = result && serial.GetIndexCount() == parallel.GetIndexCount();
+	result = result && (serial.GetIndexCount() == 0 ||
+		memcmp(serial.GetIndices(), parallel.GetIndices(), serial.GetIndexCount() * sizeof(unsigned int)) == 0);
+
+	serial.Shutdown();
+	parallel.Shutdown();
+
+	return result;
+}
+
+static void ThreadScaling(const string& dataDirectory, const char* mesh, int iterations, int maxThreads)
+{
+	string filename;
+	double serialTime, time;
+	int threadCount, polygonCount;
+	bool identical;
+
+	filename = dataDirectory + "/" + mesh;
+
+	s_threadCount = 1;
+	serialTime = TimeLoad(NewLoad, filename.c_str(), iterations, polygonCount);
+	if (polygonCount < 0)
+	{
+		Check(false, mesh, "could not be read");
+		return;
+	}
+
+	for (threadCount = 1; threadCount <= maxThreads; threadCount *= 2)
+	{
+		s_threadCount = threadCount;
+		time = TimeLoad(NewLoad, filename.c_str(), iterations, polygonCount);
+		identical = MatchesSerial(filename.c_str(), threadCount);
+
+		printf("%-12s %8d %12.2f %9.2fx %10s\n", mesh, threadCount, time, serialTime / time, identical ? "yes" : "NO");
+		Check(identical, mesh, "threaded load differs from the serial one");
+	}
+}
+
+// Vertex count and buffer memory with one vertex per corner against the deduplicated vertices.
+static void IndexedStats(const string& dataDirectory, const char* mesh)
+{
+	ObjLoaderClass loader;
+	vector<bool> named;
+	string filename;
+	double before, after;
+	int i;
+	bool inside, used;
+
+	filename = dataDirectory + "/" + mesh;
+	if (!loader.Initialize(filename.c_str(), 0))
+	{
+		loader.Shutdown();
+		Check(false, mesh, "could not be read");
+		return;
+	}
+
+	// Deduplication must leave every index naming a vertex and no vertex unnamed.
+	named.assign(loader.GetVertexCount(), false);
+	inside = true;
+	for (i = 0; i < loader.GetIndexCount(); i++)
+	{
+		inside = inside && loader.GetIndices()[i] < (unsigned int)loader.GetVertexCount();
+		if (inside)
+		{
+			named[loader.GetIndices()[i]] = true;
+		}
+	}
+
+	used = true;
+	for (i = 0; i < loader.GetVertexCount(); i++)
+	{
+		used = used && named[i];
+	}
+
+	Check(inside, mesh, "index past the last vertex");
+	Check(used, mesh, "vertex no index names");
+
+	// Both layouts carry a 32 bit index per corner, only the vertex count changes.
+	before = (double)loader.GetIndexCount() * (sizeof(ObjLoaderClass::VertexType) + sizeof(unsigned int));
+	after = (double)loader.GetVertexCount() * sizeof(ObjLoaderClass::VertexType) + (double)loader.GetIndexCount() * sizeof(unsigned int);
+
+	printf("%-12s %12d %12d %8.2fx %12.1f %12.1f\n", mesh, loader.GetIndexCount(), loader.GetVertexCount(),
+		(double)loader.GetIndexCount() / loader.GetVertexCount(), before / 1024.0, after / 1024.0);
+
+	loader.Shutdown();
+}
+
+static int CachedLoad(const char* filename)
+{
+	MeshCacheClass cache;
+	int polygonCount;
+
+	// Hash the source, map the cooked mesh and validate it, which is all ModelClass does before upload.
+	polygonCount = cache.Initialize(filename, sizeof(ObjLoaderClass::VertexType), 0) ? cache.GetIndexCount() / 3 : -1;
+	cache.Shutdown();
+
+	return polygonCount;
+}
+
+static void CookedStats(const string& dataDirectory, const char* mesh, int iterations)
+{
+	MeshCacheClass cache;
+	MeshCacheClass::LodType lod;
+	BoundingVolumeClass::BoundsType bounds;
+	ObjLoaderClass loader;
+	string filename;
+	double parseTime, cachedTime;
+	int polygonCount, cachedPolygonCount;
+	bool result;
+
+	filename = dataDirectory + "/" + mesh;
+
+	// Make sure a current cache exists.
+	if (!cache.Initialize(filename.c_str(), sizeof(ObjLoaderClass::VertexType), 0))
+	{
+		result = loader.Initialize(filename.c_str(), 0);
+		if (result)
+		{
+			// A single detail level covering the whole mesh, without meshlets.
+			lod.indexStart = 0;
+			lod.indexCount = (unsigned int)loader.GetIndexCount();
+			lod.error = 0.0f;
+			lod.meshletStart = 0;
+			lod.meshletCount = 0;
+			BoundingVolumeClass::Compute(loader.GetVertices(), loader.GetVertexCount(), sizeof(ObjLoaderClass::VertexType), bounds);
+			result = cache.Write(loader.GetVertices(), loader.GetVertexCount(), loader.GetIndices(), loader.GetIndexCount(), &lod, 1, 0, 0, bounds);
+		}
+
+		Check(result, mesh, "could not cook");
+		loader.Shutdown();
+	}
+	cache.Shutdown();
+
+	s_threadCount = 0;
+	parseTime = TimeLoad(NewLoad, filename.c_str(), iterations, polygonCount);
+	cachedTime = TimeLoad(CachedLoad, filename.c_str(), iterations, cachedPolygonCount);
+	Check(cachedPolygonCount == polygonCount, mesh, "cooked mesh holds other triangles than the obj");
+
+	printf("%-12s %12.2f %12.2f %9.1fx\n", mesh, parseTime, cachedTime, parseTime / cachedTime);
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory, filename;
+	int iterations, maxThreads, legacyPolygons, newPolygons;
+	double legacyTime, newTime, megabytes;
+	unsigned int i;
+	FILE* file;
+	long size;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	iterations = (argc > 2) ? atoi(argv[2]) : 5;
+	maxThreads = (argc > 3) ? atoi(argv[3]) : (int)thread::hardware_concurrency();
+	if (maxThreads < 1)
+	{
+		maxThreads = 1;
+	}
+
+	// Single threaded loader against the original reader.
+	s_threadCount = 1;
+
+	printf("%-12s %10s %10s %12s %12s %10s %9s\n", "mesh", "bytes", "triangles", "legacy ms", "mapped ms", "MB/s", "speedup");
+
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		filename = dataDirectory + "/" + s_meshes[i];
+
+		file = fopen(filename.c_str(), "rb");
+		if (!file)
+		{
+			Check(false, s_meshes[i], "could not be read");
+			continue;
+		}
+		fseek(file, 0, SEEK_END);
+		size = ftell(file);
+		fclose(file);
+
+		legacyTime = TimeLoad(LegacyLoad, filename.c_str(), iterations, legacyPolygons);
+		newTime = TimeLoad(NewLoad, filename.c_str(), iterations, newPolygons);
+		megabytes = size / (1024.0 * 1024.0);
+
+		printf("%-12s %10ld %10d %12.2f %12.2f %10.1f %8.1fx\n", s_meshes[i], size, newPolygons, legacyTime, newTime,
+			megabytes / (newTime / 1000.0), legacyTime / newTime);
+
+		Check(legacyPolygons == newPolygons, s_meshes[i], "legacy reader found other triangles");
+	}
+
+	// Chunked parsing across threads, on the two large meshes.
+	printf("\n%-12s %8s %12s %10s %10s\n", "mesh", "threads", "mapped ms", "scaling", "identical");
+	ThreadScaling(dataDirectory, "car.obj", iterations, maxThreads);
+	ThreadScaling(dataDirectory, "chicken.obj", iterations, maxThreads);
+
+	// Vertex deduplication.
+	printf("\n%-12s %12s %12s %9s %12s %12s\n", "mesh", "corners", "vertices", "reuse", "before KB", "after KB");
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		IndexedStats(dataDirectory, s_meshes[i]);
+	}
+
+	// Cooked mesh cache against parsing the obj.
+	printf("\n%-12s %12s %12s %10s\n", "mesh", "obj ms", "cooked ms", "speedup");
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		CookedStats(dataDirectory, s_meshes[i], iterations);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,197 @@
+// Vertex quantization report for the obj meshes in Project/data.
+//
+// Packs every mesh into each VertexQuantizerClass layout and prints the vertex buffer size against the
+// float layout ModelClass used before, with the largest position, texture coordinate and normal error
+// of any vertex. The same numbers are written to MeshInfo.txt by the application for the formats it picked.
+//
+// Every packed vertex is decoded again here the way the vertex shader does it. A position, and a unorm texture
+// coordinate, must come back within half a step of its 16 bit grid, a half float texture coordinate within
+// half a unit in the last place, and a normal within MAX_NORMAL_DEGREES; the buffer must be half the size of
+// the float one, and the error the quantizer reports must be the one measured here. Exits with 1 if any check
+// failed.
+//
+// Usage: quantizebench [data directory]
+
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+
+#include "../Project/objloaderclass.h"
+#include "../Project/vertexquantizerclass.h"
+
+using namespace std;
+
+static const char* s_meshes[] = { "cube.obj", "car.obj", "penguin.obj", "chicken.obj" };
+
+// Octahedral snorm16 normals are good to a few thousandths of a degree, the rest is acosf near 1.
+static const float MAX_NORMAL_DEGREES = 0.1f;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static float SignNotZero(float value)
+{
+	return (value >= 0.0f) ? 1.0f : -1.0f;
+}
+
+// The vertex shader's decode of a packed normal.
+static void DecodeNormal(short x, short y, float normal[3])
+{
+	float u, v, length;
+
+	u = fmaxf((float)x / 32767.0f, -1.0f);
+	v = fmaxf((float)y / 32767.0f, -1.0f);
+
+	normal[2] = 1.0f - fabsf(u) - fabsf(v);
+	normal[0] = (normal[2] < 0.0f) ? (1.0f - fabsf(v)) * SignNotZero(u) : u;
+	normal[1] = (normal[2] < 0.0f) ? (1.0f - fabsf(u)) * SignNotZero(v) : v;
+
+	length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	normal[0] /= length;
+	normal[1] /= length;
+	normal[2] /= length;
+}
+
+// Decodes every vertex and checks it against the float one it was packed from.
+static void CheckRoundTrip(const char* name, VertexQuantizerClass& quantizer, const VertexQuantizerClass::FloatVertexType* vertices, int format)
+{
+	const VertexQuantizerClass::QuantizedVertexType* packed;
+	const VertexQuantizerClass::DequantizeType& dequantize = quantizer.GetDequantize();
+	const VertexQuantizerClass::ErrorType& error = quantizer.GetError();
+	float value, original, tolerance, difference, decoded[3], length, dot, position, texcoord, normalDegrees;
+	int i, j;
+	bool positions, texcoords, normals;
+
+	positions = true;
+	texcoords = true;
+	normals = true;
+	position = 0.0f;
+	texcoord = 0.0f;
+	normalDegrees = 0.0f;
+	for (i = 0; i < quantizer.GetVertexCount(); i++)
+	{
+		packed = &quantizer.GetVertices()[i];
+
+		for (j = 0; j < 3; j++)
+		{
+			value = (float)(&packed->x)[j] / 65535.0f * dequantize.positionScale[j] + dequantize.positionOffset[j];
+			original = (&vertices[i].x)[j];
+			difference = fabsf(value - original);
+			tolerance = dequantize.positionScale[j] * 0.5f / 65535.0f + 1e-6f * (fabsf(original) + dequantize.positionScale[j]);
+			positions = positions && difference <= tolerance;
+			position = fmaxf(position, difference);
+		}
+
+		for (j = 0; j < 2; j++)
+		{
+			original = (&vertices[i].tu)[j];
+			if (format == VERTEX_FORMAT_UNORM_UV)
+			{
+				value = (float)(&packed->tu)[j] / 65535.0f * dequantize.texcoordScale[j] + dequantize.texcoordOffset[j];
+				tolerance = dequantize.texcoordScale[j] * 0.5f / 65535.0f + 1e-6f * (fabsf(original) + dequantize.texcoordScale[j]);
+			}
+			else
+			{
+				value = VertexQuantizerClass::HalfToFloat((&packed->tu)[j]);
+				tolerance = fabsf(original) / 2048.0f + 1.0f / 16777216.0f;
+			}
+			difference = fabsf(value - original);
+			texcoords = texcoords && difference <= tolerance;
+			texcoord = fmaxf(texcoord, difference);
+		}
+
+		length = sqrtf(vertices[i].nx * vertices[i].nx + vertices[i].ny * vertices[i].ny + vertices[i].nz * vertices[i].nz);
+		if (length > 0.0f)
+		{
+			DecodeNormal(packed->nx, packed->ny, decoded);
+			dot = (decoded[0] * vertices[i].nx + decoded[1] * vertices[i].ny + decoded[2] * vertices[i].nz) / length;
+			dot = (dot > 1.0f) ? 1.0f : ((dot < -1.0f) ? -1.0f : dot);
+			normalDegrees = fmaxf(normalDegrees, acosf(dot) * 57.2957795f);
+		}
+	}
+	normals = normalDegrees <= MAX_NORMAL_DEGREES;
+
+	Check(positions, name, "position off its 16 bit grid");
+	Check(texcoords, name, "texture coordinate off its grid");
+	Check(normals, name, "normal turned too far");
+	Check(fabsf(error.position - position) <= 1e-6f * (1.0f + position) && fabsf(error.texcoord - texcoord) <= 1e-6f * (1.0f + texcoord) &&
+		fabsf(error.normalDegrees - normalDegrees) <= 1e-3f, name, "reported error not the one measured");
+}
+
+static void Report(const string& dataDirectory, const char* mesh)
+{
+	ObjLoaderClass loader;
+	VertexQuantizerClass quantizer;
+	chrono::high_resolution_clock::time_point start;
+	string filename;
+	int formats[2] = { VERTEX_FORMAT_HALF_UV, VERTEX_FORMAT_UNORM_UV };
+	int i, floatBytes, packedBytes;
+	double time;
+	bool result;
+
+	filename = dataDirectory + "/" + mesh;
+	if (!loader.Initialize(filename.c_str(), 0))
+	{
+		loader.Shutdown();
+		Check(false, mesh, "could not be read");
+		return;
+	}
+
+	floatBytes = loader.GetVertexCount() * VertexQuantizerClass::GetStride(VERTEX_FORMAT_FLOAT);
+
+	for (i = 0; i < 2; i++)
+	{
+		start = chrono::high_resolution_clock::now();
+		result = quantizer.Initialize((const VertexQuantizerClass::FloatVertexType*)loader.GetVertices(), loader.GetVertexCount(), formats[i]);
+		time = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+		if (!result)
+		{
+			quantizer.Shutdown();
+			Check(false, mesh, "could not be packed");
+			continue;
+		}
+
+		const VertexQuantizerClass::ErrorType& error = quantizer.GetError();
+		packedBytes = quantizer.GetVertexCount() * VertexQuantizerClass::GetStride(formats[i]);
+
+		printf("%-12s %-9s %10.1f %10.1f %6.2fx %12.6f %9.5f%% %10.6f %9.4f %8.2f\n", mesh, (formats[i] == VERTEX_FORMAT_HALF_UV) ? "half uv" : "unorm uv",
+			floatBytes / 1024.0, packedBytes / 1024.0, (double)floatBytes / packedBytes, error.position, error.positionRelative * 100.0,
+			error.texcoord, error.normalDegrees, time);
+
+		Check(quantizer.GetVertexCount() == loader.GetVertexCount() && packedBytes * 2 == floatBytes, mesh, "packed buffer not half the float one");
+		CheckRoundTrip(mesh, quantizer, (const VertexQuantizerClass::FloatVertexType*)loader.GetVertices(), formats[i]);
+
+		quantizer.Shutdown();
+	}
+
+	loader.Shutdown();
+}
+
+int main(int argc, char** argv)
+{
+	string dataDirectory;
+	unsigned int i;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+
+	printf("%-12s %-9s %10s %10s %7s %12s %10s %10s %9s %8s\n", "mesh", "format", "float KB", "packed KB", "ratio",
+		"position", "diagonal", "uv", "normal deg", "ms");
+
+	for (i = 0; i < sizeof(s_meshes) / sizeof(s_meshes[0]); i++)
+	{
+		Report(dataDirectory, s_meshes[i]);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
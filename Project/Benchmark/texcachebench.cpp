@@ -0,0 +1,227 @@
+// Texture cache benchmark: a walk through a scene with more textures than the budget holds.
+//
+// The scene is a ring of textures of 64 to 1024 texels a side, and a few of 2048, in BC1, BC7 and RGBA8, each with its full
+// mip chain, and a font texture drawn every frame. The camera moves along the ring and sees a window of it
+// at a time. Each frame touches the textures in view and runs TextureCacheClass::Frame, which "uploads" a
+// texture by copying its levels into memory of their size and releases it by freeing that memory.
+//
+// The walk runs with budgets that hold the whole scene, the textures in view with room to spare, and less
+// than the textures in view, and reports the average bytes resident, the evictions, top levels dropped and
+// reloads per frame, the reload time, and how much of what was drawn was drawn in full. The cache must
+// hold exactly the bytes the uploads did, stay within a budget the textures in view fit in, draw them all
+// in full there, and never evict entirely a texture drawn in the frame it runs for. Exits with 1 if any check
+// failed.
+//
+// Usage: texcachebench [frames]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "../Project/ddsfileclass.h"
+#include "../Project/texturecacheclass.h"
+
+using namespace std;
+
+struct SceneTextureType
+{
+	unsigned int format;
+	int size, mipCount, id;
+	size_t fullBytes;
+	vector<char> levels;
+};
+
+// Textures on the ring, how many of them are in view, and the frames the camera takes from one to the next.
+static const int RING_TEXTURES = 192;
+static const int VIEW_TEXTURES = 24;
+static const int FRAMES_PER_STEP = 8;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static void BuildScene(vector<SceneTextureType>& scene)
+{
+	static const unsigned int formats[] = { DDS_FORMAT_BC1_UNORM, DDS_FORMAT_BC7_UNORM, DDS_FORMAT_R8G8B8A8_UNORM };
+	unsigned int random;
+	int i;
+
+	// The font first, then the ring.
+	scene.resize(RING_TEXTURES + 1);
+	scene[0].format = DDS_FORMAT_R8G8B8A8_UNORM;
+	scene[0].size = 256;
+
+	random = 7;
+	for (i = 1; i <= RING_TEXTURES; i++)
+	{
+		random = random * 1664525 + 1013904223;
+		scene[i].format = formats[(random >> 8) % 3];
+		scene[i].size = 64 << ((random >> 16) % 6);
+		scene[i].size = (scene[i].size == 2048 && (random >> 28) != 0) ? 512 : scene[i].size;
+	}
+
+	for (i = 0; i <= RING_TEXTURES; i++)
+	{
+		for (scene[i].mipCount = 1; (scene[i].size >> scene[i].mipCount) > 0; scene[i].mipCount++)
+		{
+		}
+		scene[i].fullBytes = TextureCacheClass::GetBytes(scene[i].format, scene[i].size, scene[i].size, scene[i].mipCount, 1, 0);
+		scene[i].id = -1;
+	}
+}
+
+static bool InView(int texture, int frame)
+{
+	int first;
+
+	// The font is always drawn, the ring from where the camera is.
+	if (texture == 0)
+	{
+		return true;
+	}
+
+	first = (frame / FRAMES_PER_STEP) % RING_TEXTURES;
+
+	return ((texture - 1 - first + RING_TEXTURES) % RING_TEXTURES) < VIEW_TEXTURES;
+}
+
+static void Walk(const char* name, vector<SceneTextureType>& scene, size_t budget, int frames)
+{
+	TextureCacheClass cache;
+	TextureCacheClass::StatsType stats;
+	vector<char> source;
+	vector<int> textureOf;
+	size_t viewBytes, heldBytes, maxView;
+	double residentSum, drawnFull, drawn;
+	int frame, i;
+	bool result, fits;
+
+	// The source every upload copies from, as large as the largest texture.
+	source.assign(2048 * 2048 * 4 * 2, 1);
+
+	// The cache ids go back to the scene's textures for the uploads.
+	textureOf.assign(scene.size(), -1);
+	result = cache.Initialize(budget, [&](int id, int firstMip)
+	{
+		SceneTextureType& texture = scene[textureOf[id]];
+		size_t bytes;
+
+		bytes = TextureCacheClass::GetBytes(texture.format, texture.size, texture.size, texture.mipCount, 1, firstMip);
+		vector<char>().swap(texture.levels);
+		if (bytes > 0)
+		{
+			texture.levels.assign(source.begin(), source.begin() + bytes);
+		}
+
+		return true;
+	});
+	Check(result, name, "cache could not be initialized");
+
+	// The largest set of textures ever in view together.
+	maxView = 0;
+	for (frame = 0; frame < RING_TEXTURES * FRAMES_PER_STEP; frame += FRAMES_PER_STEP)
+	{
+		viewBytes = 0;
+		for (i = 0; i <= RING_TEXTURES; i++)
+		{
+			viewBytes += InView(i, frame) ? scene[i].fullBytes : 0;
+		}
+		maxView = (viewBytes > maxView) ? viewBytes : maxView;
+	}
+	fits = maxView <= budget;
+
+	// Everything is uploaded in full as it loads, and the cache is told so.
+	for (i = 0; i < (int)scene.size(); i++)
+	{
+		scene[i].levels.assign(source.begin(), source.begin() + scene[i].fullBytes);
+		scene[i].id = cache.Add(scene[i].format, scene[i].size, scene[i].size, scene[i].mipCount, 1, 0);
+		textureOf[scene[i].id] = i;
+	}
+
+	residentSum = 0.0;
+	drawnFull = 0.0;
+	drawn = 0.0;
+	for (frame = 0; frame < frames; frame++)
+	{
+		// Draw what is in view, at the detail it has, then let the cache catch up.
+		for (i = 0; i < (int)scene.size(); i++)
+		{
+			if (!InView(i, frame))
+			{
+				continue;
+			}
+
+			drawn += 1.0;
+			drawnFull += (cache.GetFirstMip(scene[i].id) == 0) ? 1.0 : 0.0;
+			cache.Touch(scene[i].id);
+		}
+
+		cache.Frame();
+		stats = cache.GetStats();
+
+		heldBytes = 0;
+		for (i = 0; i < (int)scene.size(); i++)
+		{
+			heldBytes += scene[i].levels.size();
+			Check(!InView(i, frame) || cache.GetFirstMip(scene[i].id) < scene[i].mipCount, name, "texture drawn this frame was evicted entirely");
+		}
+
+		Check(heldBytes == stats.residentBytes, name, "resident bytes differ from what was uploaded");
+		Check(!fits || stats.residentBytes <= budget, name, "over a budget the textures in view fit in");
+
+		residentSum += (double)stats.residentBytes;
+	}
+
+	stats = cache.GetStats();
+
+	// After the first frames every texture in view must have been drawn in full when they fit.
+	Check(!fits || drawnFull / drawn > 0.95, name, "textures in view not drawn in full");
+
+	printf("%-14s %9.1f %9.1f %9.1f %8.2f %8.2f %8.2f %8.3f %8.3f %7.1f%%\n", name, (double)budget / 1048576.0, (double)maxView / 1048576.0,
+		residentSum / frames / 1048576.0, (double)stats.totalEvictions / frames, (double)stats.totalMipDrops / frames, (double)stats.totalReloads / frames,
+		stats.totalReloads ? stats.totalReloadMilliseconds / stats.totalReloads : 0.0, stats.worstReloadMilliseconds, drawnFull * 100.0 / drawn);
+
+	cache.Shutdown();
+	for (i = 0; i < (int)scene.size(); i++)
+	{
+		vector<char>().swap(scene[i].levels);
+	}
+}
+
+int main(int argc, char** argv)
+{
+	vector<SceneTextureType> scene;
+	size_t sceneBytes;
+	int frames, i;
+
+	frames = (argc > 1) ? atoi(argv[1]) : RING_TEXTURES * FRAMES_PER_STEP;
+	frames = (frames > 0) ? frames : RING_TEXTURES * FRAMES_PER_STEP;
+
+	BuildScene(scene);
+
+	sceneBytes = 0;
+	for (i = 0; i < (int)scene.size(); i++)
+	{
+		sceneBytes += scene[i].fullBytes;
+	}
+
+	printf("%d textures, %.1f MB in full, %d frames\n", (int)scene.size(), (double)sceneBytes / 1048576.0, frames);
+	printf("%-14s %9s %9s %9s %8s %8s %8s %8s %8s %8s\n", "budget", "MB", "view MB", "resident", "evicted", "dropped", "reloads", "ms", "worst ms", "full");
+
+	Walk("whole scene", scene, sceneBytes, frames);
+	Walk("128 MB", scene, 128 * 1048576, frames);
+	Walk("48 MB", scene, 48 * 1048576, frames);
+	Walk("32 MB", scene, 32 * 1048576, frames);
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
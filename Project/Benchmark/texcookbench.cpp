@@ -0,0 +1,221 @@
+// Texture cooker benchmark: BC1, BC3 and BC7 at every quality level for the textures in Project/data.
+//
+// Each texture is cooked in memory by TextureCookerClass on every core, with a full mip chain from the
+// Kaiser filter in linear light for sources that have one level, and the run reports the compression ratio
+// against the source file's texels (the cooked bytes include the generated levels), the time spent on mips, the PSNR of what the cooked file decodes to, and the
+// encode rate in megatexels per second in all and per core. The cooked file must read back with the block
+// format and size of the source and a full chain of levels, stay above a PSNR floor, and every quality level must be at least as good
+// as the one below it. Exits with 1 if any check failed.
+//
+// Given an output directory it also writes the normal quality cook of every texture there, car.dds as
+// car.bc1.dds, car.bc3.dds and car.bc7.dds, the files the game would ship.
+//
+// Usage: texcookbench [data directory] [output directory]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+#include "../Project/ddsfileclass.h"
+#include "../Project/texturecookerclass.h"
+
+using namespace std;
+
+struct FormatType
+{
+	unsigned int format;
+	const char* name;
+	const char* extension;
+};
+
+static const FormatType s_formats[] =
+{
+	{ DDS_FORMAT_BC1_UNORM, "BC1", ".bc1.dds" },
+	{ DDS_FORMAT_BC3_UNORM, "BC3", ".bc3.dds" },
+	{ DDS_FORMAT_BC7_UNORM, "BC7", ".bc7.dds" },
+};
+
+static const char* s_qualities[] = { "fast", "normal", "high" };
+
+// Lowest PSNR a cook may have, far below what any format reaches on real textures.
+static const double MIN_PSNR = 28.0;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static vector<string> ListTextures(const string& dataDirectory)
+{
+	vector<string> names;
+	string name;
+	size_t i;
+
+#ifdef _WIN32
+	WIN32_FIND_DATAA found;
+	HANDLE search;
+
+	search = FindFirstFileA((dataDirectory + "/*.dds").c_str(), &found);
+	if (search != INVALID_HANDLE_VALUE)
+	{
+		do
+		{
+			names.push_back(found.cFileName);
+		} while (FindNextFileA(search, &found));
+		FindClose(search);
+	}
+#else
+	DIR* directory;
+	struct dirent* entry;
+
+	directory = opendir(dataDirectory.c_str());
+	if (directory)
+	{
+		while ((entry = readdir(directory)) != 0)
+		{
+			name = entry->d_name;
+			if (name.size() > 4 && name.compare(name.size() - 4, 4, ".dds") == 0)
+			{
+				names.push_back(name);
+			}
+		}
+		closedir(directory);
+	}
+#endif
+
+	// Skip cooked files left in the data directory by an earlier run.
+	for (i = names.size(); i > 0; i--)
+	{
+		if (names[i - 1].find(".bc") != string::npos)
+		{
+			names.erase(names.begin() + (i - 1));
+		}
+	}
+
+	sort(names.begin(), names.end());
+
+	return names;
+}
+
+static bool IsCookedFormat(unsigned int cooked, unsigned int format)
+{
+	return cooked == format || cooked == format + 1;
+}
+
+static void CookTexture(const string& dataDirectory, const string& outputDirectory, const string& name, int threadCount)
+{
+	DdsFileClass source, cooked;
+	TextureCookerClass cooker;
+	TextureCookerClass::StatsType stats;
+	vector<char> file;
+	string filename, cookedFilename;
+	double rate, previousPsnr;
+	unsigned int i;
+	int quality, mipCount;
+	bool result;
+
+	filename = dataDirectory + "/" + name;
+	if (!source.Initialize(filename.c_str()) || !TextureCookerClass::ConvertToRgba(source.GetFormat(), DdsFileClass::SurfaceType(), 0))
+	{
+		source.Shutdown();
+		return;
+	}
+
+	mipCount = (source.GetMipCount() == 1) ? MipGeneratorClass::GetLevelCount(source.GetWidth(), source.GetHeight()) : source.GetMipCount();
+
+	for (i = 0; i < sizeof(s_formats) / sizeof(s_formats[0]); i++)
+	{
+		previousPsnr = 0.0;
+		for (quality = BLOCK_QUALITY_FAST; quality <= BLOCK_QUALITY_HIGH; quality++)
+		{
+			cooker.Initialize(threadCount, quality, MIP_FILTER_KAISER, true);
+			result = cooker.Cook(&source, s_formats[i].format, file);
+			stats = cooker.GetStats();
+			cooker.Shutdown();
+
+			Check(result, name.c_str(), "could not be cooked");
+			if (!result)
+			{
+				continue;
+			}
+
+			// The cooked file must read back as blocks of the source's size and layout.
+			result = cooked.InitializeFromMemory(&file[0], file.size());
+			Check(result, name.c_str(), "cooked file could not be read");
+			Check(!result || (IsCookedFormat(cooked.GetFormat(), s_formats[i].format) && cooked.GetWidth() == source.GetWidth() &&
+				cooked.GetHeight() == source.GetHeight() && cooked.GetMipCount() == mipCount && cooked.GetArraySize() == source.GetArraySize()),
+				name.c_str(), "cooked file has the wrong layout");
+			cooked.Shutdown();
+
+			Check(stats.psnr >= MIN_PSNR, name.c_str(), "PSNR below the floor");
+			Check(stats.psnr >= previousPsnr, name.c_str(), "a higher quality level is worse");
+			previousPsnr = stats.psnr;
+
+			rate = (double)stats.texelCount / stats.encodeSeconds / 1000000.0;
+			printf("%-14s %-6s %-7s %9u %9u %6.2f:1 %8.2f %8.2f %10.2f %10.2f\n", name.c_str(), s_formats[i].name, s_qualities[quality], (unsigned int)stats.sourceBytes,
+				(unsigned int)stats.cookedBytes, (double)stats.sourceBytes / (double)stats.cookedBytes, stats.psnr, stats.mipSeconds * 1000.0, rate, rate / stats.threadCount);
+		}
+
+		// The normal quality cook is the one written out.
+		if (!outputDirectory.empty())
+		{
+			cookedFilename = outputDirectory + "/" + name.substr(0, name.size() - 4) + s_formats[i].extension;
+			cooker.Initialize(threadCount, BLOCK_QUALITY_NORMAL, MIP_FILTER_KAISER, true);
+			result = cooker.Cook(filename.c_str(), cookedFilename.c_str(), s_formats[i].format);
+			cooker.Shutdown();
+
+			Check(result && cooked.Initialize(cookedFilename.c_str()), cookedFilename.c_str(), "could not be written and read back");
+			cooked.Shutdown();
+		}
+	}
+
+	source.Shutdown();
+
+	return;
+}
+
+int main(int argc, char** argv)
+{
+	vector<string> textures;
+	string dataDirectory, outputDirectory;
+	unsigned int i;
+	int threadCount;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	outputDirectory = (argc > 2) ? argv[2] : "";
+
+	threadCount = (int)thread::hardware_concurrency();
+	threadCount = (threadCount > 0) ? threadCount : 1;
+
+	printf("%d threads\n", threadCount);
+	printf("%-14s %-6s %-7s %9s %9s %8s %8s %8s %10s %10s\n", "texture", "format", "quality", "source", "cooked", "ratio", "psnr", "mip ms", "Mtexel/s", "per core");
+
+	textures = ListTextures(dataDirectory);
+	for (i = 0; i < textures.size(); i++)
+	{
+		CookTexture(dataDirectory, outputDirectory, textures[i], threadCount);
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,448 @@
+// Texture streaming benchmark: how soon streamed textures can be drawn, and the order their levels come in.
+//
+// The textures in Project/data are cooked to BC1 with their full mip chains, with a 4096x4096 one tiled from
+// car.dds, and written to the output directory; font.dds is streamed as it is, a single level the streamer
+// has to read whole. Every texture is added to a TextureStreamerClass in order of priority, the way the
+// registry adds them, then asked for in full, and each read it hands back is "uploaded": parsed as a dds file
+// and compared byte for byte with the levels of the file it came from. At the end the largest texture is
+// evicted and asked for at its tail again.
+//
+// Every texture must first come in as its tail, the levels of TEXTURE_TAIL_SIZE or less, or whole when it
+// cannot be streamed; every tail must come in before any larger level, tails and larger levels each in order
+// of priority; each read after the tail must add exactly one level; and the evicted texture must come back as
+// its tail alone. The run reports for each texture the time until it could be drawn and until it was complete,
+// against reading every file whole in the same order. The files were just written, so the reads mostly come
+// from the page cache. Exits with 1 if any check failed.
+//
+// Usage: texstreambench [data directory] [output directory]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Project/ddsfileclass.h"
+#include "../Project/mappedfileclass.h"
+#include "../Project/texturecookerclass.h"
+#include "../Project/texturestreamerclass.h"
+
+using namespace std;
+
+struct StreamedTextureType
+{
+	string name, filename;
+	float priority;
+	DdsFileClass source;
+	size_t fileSize, tailBytes;
+	int id, tailMip, firstMip, reads;
+	double usableMilliseconds, fullMilliseconds, wholeMilliseconds;
+};
+
+// Side of the large texture, and how long to wait for reads before giving up.
+static const int LARGE_TEXTURE_SIZE = 4096;
+static const double TIMEOUT_MILLISECONDS = 30000.0;
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static bool WriteFile(const string& filename, const vector<char>& file)
+{
+	FILE* output;
+	bool result;
+
+	output = fopen(filename.c_str(), "wb");
+	if (!output)
+	{
+		return false;
+	}
+
+	result = fwrite(&file[0], 1, file.size(), output) == file.size();
+	result = (fclose(output) == 0) && result;
+
+	return result;
+}
+
+static bool CookLarge(const string& dataDirectory, const string& filename, int threadCount)
+{
+	DdsFileClass car, tiled;
+	DdsFileClass::SurfaceType surface;
+	TextureCookerClass cooker;
+	vector<unsigned char> tile;
+	vector<char> source, file;
+	unsigned char* texels;
+	int x, y;
+	bool result;
+
+	result = car.Initialize((dataDirectory + "/car.dds").c_str()) && car.GetSurface(0, 0, surface) && TextureCookerClass::ConvertToRgba(car.GetFormat(), surface, 0);
+	if (!result)
+	{
+		car.Shutdown();
+		return false;
+	}
+
+	tile.resize((size_t)surface.width * surface.height * 4);
+	TextureCookerClass::ConvertToRgba(car.GetFormat(), surface, &tile[0]);
+
+	// An RGBA file of car.dds tiled to size, cooked like the others.
+	source.resize(DDS_WRITTEN_HEADER_SIZE + (size_t)LARGE_TEXTURE_SIZE * LARGE_TEXTURE_SIZE * 4);
+	DdsFileClass::WriteHeader(DDS_FORMAT_R8G8B8A8_UNORM, LARGE_TEXTURE_SIZE, LARGE_TEXTURE_SIZE, 1, 1, false, &source[0]);
+	texels = (unsigned char*)&source[DDS_WRITTEN_HEADER_SIZE];
+	for (y = 0; y < LARGE_TEXTURE_SIZE; y++)
+	{
+		for (x = 0; x < LARGE_TEXTURE_SIZE; x++)
+		{
+			memcpy(&texels[((size_t)y * LARGE_TEXTURE_SIZE + x) * 4], &tile[(((size_t)y % surface.height) * surface.width + x % surface.width) * 4], 4);
+		}
+	}
+	car.Shutdown();
+
+	result = tiled.InitializeFromMemory(&source[0], source.size());
+	if (result)
+	{
+		cooker.Initialize(threadCount, BLOCK_QUALITY_FAST, MIP_FILTER_KAISER, true);
+		result = cooker.Cook(&tiled, DDS_FORMAT_BC1_UNORM, file);
+		cooker.Shutdown();
+	}
+	tiled.Shutdown();
+
+	return result && WriteFile(filename, file);
+}
+
+static bool Cook(const string& sourceFilename, const string& filename, int threadCount)
+{
+	TextureCookerClass cooker;
+	bool result;
+
+	cooker.Initialize(threadCount, BLOCK_QUALITY_FAST, MIP_FILTER_KAISER, true);
+	result = cooker.Cook(sourceFilename.c_str(), filename.c_str(), DDS_FORMAT_BC1_UNORM);
+	cooker.Shutdown();
+
+	return result;
+}
+
+static bool IsStreamable(DdsFileClass& dds)
+{
+	int mipCount;
+
+	for (mipCount = 1; (dds.GetWidth() >> mipCount) > 0 || (dds.GetHeight() >> mipCount) > 0; mipCount++)
+	{
+	}
+
+	return dds.GetDimension() == 2 && DdsFileClass::IsDxgiFormat(dds.GetFormat()) && dds.GetMipCount() == mipCount;
+}
+
+static bool CheckUpload(StreamedTextureType& texture, const TextureStreamerClass::ResultType& result)
+{
+	DdsFileClass read;
+	DdsFileClass::SurfaceType surface, expected;
+	MappedFileClass file;
+	int item, mip;
+	bool same;
+
+	// A file read whole is the file as it is.
+	if (!result.streamable)
+	{
+		same = file.Initialize(texture.filename.c_str()) && file.GetSize() == result.file.size() && memcmp(file.GetData(), &result.file[0], file.GetSize()) == 0;
+		file.Shutdown();
+		return same;
+	}
+
+	// Anything else holds the levels from the first one read, as in the file.
+	same = read.InitializeFromMemory(&result.file[0], result.file.size());
+	same = same && read.GetFormat() == texture.source.GetFormat() && read.GetArraySize() == texture.source.GetArraySize();
+	same = same && read.GetMipCount() == texture.source.GetMipCount() - result.firstMip;
+	for (item = 0; same && item < read.GetArraySize(); item++)
+	{
+		for (mip = 0; same && mip < read.GetMipCount(); mip++)
+		{
+			same = read.GetSurface(mip, item, surface) && texture.source.GetSurface(mip + result.firstMip, item, expected);
+			same = same && surface.width == expected.width && surface.height == expected.height && surface.size == expected.size;
+			same = same && memcmp(surface.data, expected.data, surface.size) == 0;
+		}
+	}
+	read.Shutdown();
+
+	return same;
+}
+
+// Uploads what the streamer read until every texture has the level it waits for, or the time is up, and
+// records the priorities of the textures in the order their tails and their larger levels came in.
+static void Upload(TextureStreamerClass& streamer, vector<StreamedTextureType*>& textures, const vector<int>& waitFor,
+	chrono::high_resolution_clock::time_point start, vector<float>& tailOrder, vector<float>& levelOrder)
+{
+	TextureStreamerClass::ResultType result;
+	StreamedTextureType* texture;
+	double milliseconds;
+	unsigned int i;
+	bool done, tail, allTails;
+
+	while (true)
+	{
+		done = true;
+		for (i = 0; i < textures.size(); i++)
+		{
+			done = done && textures[i]->firstMip <= waitFor[i];
+		}
+
+		milliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+		if (done || milliseconds > TIMEOUT_MILLISECONDS)
+		{
+			break;
+		}
+
+		if (!streamer.GetResult(result))
+		{
+			this_thread::sleep_for(chrono::microseconds(200));
+			continue;
+		}
+
+		texture = 0;
+		for (i = 0; i < textures.size(); i++)
+		{
+			texture = (textures[i]->id == result.id) ? textures[i] : texture;
+		}
+
+		Check(texture != 0, "streamer", "read for a texture never added");
+		if (!texture)
+		{
+			continue;
+		}
+
+		Check(!result.failed, texture->name.c_str(), "read failed");
+		Check(CheckUpload(*texture, result), texture->name.c_str(), "read differs from the file");
+
+		allTails = true;
+		for (i = 0; i < textures.size(); i++)
+		{
+			allTails = allTails && textures[i]->reads > 0;
+		}
+
+		// The first read is the tail, or the whole file; then one level at a time.
+		tail = (texture->firstMip > result.firstMip && texture->firstMip >= texture->source.GetMipCount());
+		if (texture->reads == 0 || tail)
+		{
+			Check(result.firstMip == texture->tailMip, texture->name.c_str(), "first read is not the tail");
+			texture->tailBytes = (texture->reads == 0) ? result.file.size() : texture->tailBytes;
+			texture->usableMilliseconds = (texture->reads == 0) ? milliseconds : texture->usableMilliseconds;
+			tailOrder.push_back(texture->priority);
+		}
+		else
+		{
+			Check(result.firstMip == texture->firstMip - 1, texture->name.c_str(), "read does not add exactly one level");
+			Check(allTails, texture->name.c_str(), "larger level read before every tail");
+			levelOrder.push_back(texture->priority);
+		}
+
+		texture->firstMip = result.firstMip;
+		texture->reads++;
+		if (texture->firstMip == 0)
+		{
+			texture->fullMilliseconds = milliseconds;
+		}
+
+	}
+
+	for (i = 0; i < textures.size(); i++)
+	{
+		Check(textures[i]->firstMip <= waitFor[i], textures[i]->name.c_str(), "level never read");
+	}
+}
+
+static bool IsOrdered(const vector<float>& priorities)
+{
+	unsigned int i;
+
+	for (i = 1; i < priorities.size(); i++)
+	{
+		if (priorities[i] > priorities[i - 1])
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	static const char* names[] = { "seafloor", "large", "car", "ground", "font" };
+	vector<StreamedTextureType*> textures;
+	vector<int> waitFor;
+	vector<float> tailOrder, levelOrder, evictedOrder;
+	TextureStreamerClass streamer;
+	StreamedTextureType* texture;
+	MappedFileClass file;
+	TextureStreamerClass::ResultType read;
+	vector<char> copy;
+	chrono::high_resolution_clock::time_point start;
+	wstring filename;
+	string dataDirectory, outputDirectory;
+	size_t tailBytes, fileBytes;
+	double wholeMilliseconds, lastUsable;
+	unsigned int i;
+	int threadCount, reads;
+	bool result;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+	outputDirectory = (argc > 2) ? argv[2] : ".";
+
+	threadCount = (int)thread::hardware_concurrency();
+	threadCount = (threadCount > 0) ? threadCount : 1;
+
+	// Cook the streamed textures, highest priority first. The font is left as it is.
+	for (i = 0; i < sizeof(names) / sizeof(names[0]); i++)
+	{
+		texture = new StreamedTextureType;
+		texture->name = names[i];
+		texture->priority = (float)(1000 - 200 * (int)i);
+		texture->id = -1;
+		texture->firstMip = 0x7fffffff;
+		texture->reads = 0;
+		texture->tailBytes = 0;
+		texture->usableMilliseconds = 0.0;
+		texture->fullMilliseconds = 0.0;
+		texture->wholeMilliseconds = 0.0;
+
+		if (texture->name == "font")
+		{
+			texture->filename = dataDirectory + "/font.dds";
+			result = true;
+		}
+		else if (texture->name == "large")
+		{
+			texture->filename = outputDirectory + "/large.stream.dds";
+			result = CookLarge(dataDirectory, texture->filename, threadCount);
+		}
+		else
+		{
+			texture->filename = outputDirectory + "/" + texture->name + ".stream.dds";
+			result = Cook(dataDirectory + "/" + texture->name + ".dds", texture->filename, threadCount);
+		}
+
+		result = result && texture->source.Initialize(texture->filename.c_str());
+		Check(result, texture->name.c_str(), "could not be cooked and read back");
+		if (!result)
+		{
+			texture->source.Shutdown();
+			delete texture;
+			continue;
+		}
+
+		for (texture->tailMip = 0; IsStreamable(texture->source) && texture->tailMip < texture->source.GetMipCount() - 1; texture->tailMip++)
+		{
+			if ((texture->source.GetWidth() >> texture->tailMip) <= TEXTURE_TAIL_SIZE && (texture->source.GetHeight() >> texture->tailMip) <= TEXTURE_TAIL_SIZE)
+			{
+				break;
+			}
+		}
+
+		texture->fileSize = 0;
+		textures.push_back(texture);
+	}
+
+	// Reading every file whole in the same order: a texture can be drawn once it and all before it are read.
+	wholeMilliseconds = 0.0;
+	for (i = 0; i < textures.size(); i++)
+	{
+		start = chrono::high_resolution_clock::now();
+		result = file.Initialize(textures[i]->filename.c_str());
+		if (result)
+		{
+			copy.assign(file.GetData(), file.GetData() + file.GetSize());
+			textures[i]->fileSize = file.GetSize();
+		}
+		file.Shutdown();
+
+		wholeMilliseconds += chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+		textures[i]->wholeMilliseconds = wholeMilliseconds;
+	}
+
+	streamer.Initialize();
+
+	// Every texture is added, then asked for in full, both highest priority first. The I/O thread may start on
+	// the first before the last is added, the order of priority still holds for what it has been given.
+	start = chrono::high_resolution_clock::now();
+	for (i = 0; i < textures.size(); i++)
+	{
+		filename.assign(textures[i]->filename.begin(), textures[i]->filename.end());
+		textures[i]->id = streamer.Add(filename.c_str(), textures[i]->priority);
+		Check(textures[i]->id >= 0, textures[i]->name.c_str(), "could not be added");
+	}
+
+	for (i = 0; i < textures.size(); i++)
+	{
+		streamer.Request(textures[i]->id, 0);
+		waitFor.push_back(0);
+	}
+
+	Upload(streamer, textures, waitFor, start, tailOrder, levelOrder);
+	Check(IsOrdered(tailOrder), "streamer", "tails not read in order of priority");
+	Check(IsOrdered(levelOrder), "streamer", "larger levels not read in order of priority");
+
+	// Evicted, the large texture comes back as its tail and no more.
+	texture = 0;
+	for (i = 0; i < textures.size(); i++)
+	{
+		texture = (textures[i]->name == "large") ? textures[i] : texture;
+	}
+
+	if (texture)
+	{
+		streamer.Request(texture->id, texture->tailMip);
+		streamer.SetResident(texture->id, texture->source.GetMipCount());
+		texture->firstMip = texture->source.GetMipCount();
+		for (i = 0; i < textures.size(); i++)
+		{
+			waitFor[i] = (textures[i] == texture) ? texture->tailMip : 0;
+		}
+
+		reads = texture->reads;
+		Upload(streamer, textures, waitFor, chrono::high_resolution_clock::now(), evictedOrder, evictedOrder);
+		Check(texture->reads == reads + 1, texture->name.c_str(), "evicted texture not read back as its tail");
+
+		this_thread::sleep_for(chrono::milliseconds(50));
+		Check(!streamer.GetResult(read), texture->name.c_str(), "evicted texture read past its tail");
+	}
+
+	streamer.Shutdown();
+
+	printf("%-14s %8s %11s %6s %9s %10s %10s %11s %10s\n", "texture", "priority", "size", "levels", "file KB", "tail KB", "usable ms", "full ms", "whole ms");
+	tailBytes = 0;
+	fileBytes = 0;
+	lastUsable = 0.0;
+	for (i = 0; i < textures.size(); i++)
+	{
+		texture = textures[i];
+		printf("%-14s %8.0f %5dx%-5d %6d %9.1f %10.1f %10.2f %11.2f %10.2f\n", texture->name.c_str(), texture->priority, texture->source.GetWidth(),
+			texture->source.GetHeight(), texture->source.GetMipCount(), (double)texture->fileSize / 1024.0, (double)texture->tailBytes / 1024.0,
+			texture->usableMilliseconds, texture->fullMilliseconds, texture->wholeMilliseconds);
+
+		tailBytes += texture->tailBytes;
+		fileBytes += texture->fileSize;
+		lastUsable = (texture->usableMilliseconds > lastUsable) ? texture->usableMilliseconds : lastUsable;
+	}
+
+	printf("\nall usable after %.2f ms and %.1f KB read, %.2f ms and %.1f KB reading every file whole\n", lastUsable, (double)tailBytes / 1024.0,
+		wholeMilliseconds, (double)fileBytes / 1024.0);
+
+	for (i = 0; i < textures.size(); i++)
+	{
+		textures[i]->source.Shutdown();
+		delete textures[i];
+	}
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,260 @@
+// Text batching benchmark: the CPU time a frame of LABEL_COUNT labels takes to set, lay out and gather into one
+// vertex stream, the way TextClass draws them.
+//
+// The glyphs come from Project/data/fontdata.txt. Every label is a sentence of a TextBatchClass, set every
+// frame as a HUD sets its text, in three runs of FRAME_COUNT frames: nothing changing, one label in a hundred
+// showing the frame number, and every label showing it. Each frame the batch is built and, when it changed,
+// copied into a ring of RING_VERTEX_COUNT vertices the way TextClass uploads it, a ring at a time, each piece a
+// draw; an unchanged batch that fit the ring is drawn again from where it is.
+//
+// The ring is the one TextClass draws from, far smaller than the batch, so every changed frame wraps it. An
+// unchanged frame must lay out nothing, and upload nothing when it fit the ring, a changing one lay out exactly
+// the labels that changed; the batch must hold a quad of 4 vertices for every glyph that is not a space, in the
+// order the labels were added, each with its label's color, and drawn with the quad indices 0, 1, 2, 0, 2, 3
+// every triangle must turn clockwise on screen; a batch larger than the ring must be uploaded a ring at a time,
+// each piece whole inside it; and a sentence longer than it was added for, or one never added, must be refused.
+// The run reports per frame the labels laid out, the vertices and bytes uploaded, the draws and the CPU time,
+// against a draw for every label before batching, and the bytes a glyph takes against 6 vertices a glyph.
+// Exits with 1 if any check failed.
+//
+// Usage: textbench [data directory]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "../Project/fontloaderclass.h"
+#include "../Project/textbatchclass.h"
+
+using namespace std;
+
+// Labels drawn, frames each run takes, the longest label and the ring TextClass uploads into.
+static const int LABEL_COUNT = 10000;
+static const int FRAME_COUNT = 100;
+static const int LABEL_LENGTH = 24;
+static const int RING_VERTEX_COUNT = TEXT_RING_QUAD_COUNT * TEXT_QUAD_VERTEX_COUNT;
+static const int SCREEN_WIDTH = 1920;
+static const int SCREEN_HEIGHT = 1080;
+
+// The triangles of a quad, as the shared quad index buffer draws them.
+static const int QUAD_INDICES[TEXT_QUAD_INDEX_COUNT] = { 0, 1, 2, 0, 2, 3 };
+
+static int s_failures = 0;
+
+static void Check(bool condition, const char* name, const char* what)
+{
+	if (!condition)
+	{
+		printf("%-14s FAILED: %s\n", name, what);
+		s_failures++;
+	}
+}
+
+static void GetLabel(int label, int frame, int changeEvery, char* text)
+{
+	// A label that changes shows the frame number, the others keep their own.
+	if (changeEvery > 0 && label % changeEvery == 0)
+	{
+		sprintf(text, "F%d #%d", frame, label);
+	}
+	else
+	{
+		sprintf(text, "#%04d", label);
+	}
+}
+
+static int CountGlyphs(const char* text)
+{
+	int count, i;
+
+	count = 0;
+	for (i = 0; text[i]; i++)
+	{
+		count += (text[i] > ' ' && text[i] < 127) ? 1 : 0;
+	}
+
+	return count;
+}
+
+static bool IsClockwise(const TextBatchClass::VertexType* vertices, int vertexCount)
+{
+	const TextBatchClass::VertexType *a, *b, *c;
+	float cross;
+	int quad, i;
+
+	// Every triangle of every quad, with y going up the screen.
+	for (quad = 0; quad + TEXT_QUAD_VERTEX_COUNT <= vertexCount; quad += TEXT_QUAD_VERTEX_COUNT)
+	{
+		for (i = 0; i < TEXT_QUAD_INDEX_COUNT; i += 3)
+		{
+			a = &vertices[quad + QUAD_INDICES[i + 0]];
+			b = &vertices[quad + QUAD_INDICES[i + 1]];
+			c = &vertices[quad + QUAD_INDICES[i + 2]];
+			cross = (b->x - a->x) * (c->y - a->y) - (b->y - a->y) * (c->x - a->x);
+			if (cross >= 0.0f)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool RunFrames(TextBatchClass& batch, const char* name, int changeEvery, vector<TextBatchClass::VertexType>& ring, int& ringOffset, bool& inRing)
+{
+	const TextBatchClass::VertexType* vertices;
+	chrono::high_resolution_clock::time_point start;
+	char text[64];
+	double milliseconds, totalMilliseconds, worstMilliseconds;
+	long long totalLayouts, totalDraws;
+	unsigned long long totalBytes;
+	size_t bytes;
+	int frame, label, first, count, draws, vertexCount, glyphs, expectedLayouts;
+	bool changed, result;
+
+	totalMilliseconds = 0.0;
+	worstMilliseconds = 0.0;
+	totalLayouts = 0;
+	totalDraws = 0;
+	totalBytes = 0;
+	result = true;
+	vertexCount = 0;
+
+	for (frame = 1; frame <= FRAME_COUNT; frame++)
+	{
+		start = chrono::high_resolution_clock::now();
+
+		// Every label is set, changed or not.
+		glyphs = 0;
+		for (label = 0; label < LABEL_COUNT; label++)
+		{
+			GetLabel(label, frame, changeEvery, text);
+			result = batch.SetSentence(label, text, 10 + (label % 16) * 118, 10 + (label / 16) % 64 * 16, (float)(label % 3) * 0.5f, 1.0f, (float)(label % 5) * 0.25f) && result;
+			glyphs += CountGlyphs(text);
+		}
+
+		// Gathered and copied into the ring only when something changed.
+		changed = batch.Build();
+		vertices = batch.GetVertices();
+		vertexCount = batch.GetVertexCount();
+		bytes = 0;
+		draws = 0;
+
+		if (!changed && inRing)
+		{
+			draws = (vertexCount > 0) ? 1 : 0;
+		}
+		else
+		{
+			for (first = 0; first < vertexCount; first += count)
+			{
+				count = (vertexCount - first < RING_VERTEX_COUNT) ? vertexCount - first : RING_VERTEX_COUNT;
+				ringOffset = (ringOffset + count > RING_VERTEX_COUNT) ? 0 : ringOffset;
+				Check(count % TEXT_QUAD_VERTEX_COUNT == 0 && ringOffset + count <= RING_VERTEX_COUNT, name, "ring piece not whole quads inside the ring");
+				memcpy(&ring[ringOffset], vertices + first, sizeof(TextBatchClass::VertexType) * count);
+				ringOffset += count;
+				bytes += sizeof(TextBatchClass::VertexType) * count;
+				draws++;
+			}
+			inRing = (draws <= 1);
+			Check(draws == (vertexCount + RING_VERTEX_COUNT - 1) / RING_VERTEX_COUNT, name, "batch not drawn a ring at a time");
+		}
+
+		batch.EndFrame(bytes, draws);
+
+		milliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+		totalMilliseconds += milliseconds;
+		worstMilliseconds = (milliseconds > worstMilliseconds) ? milliseconds : worstMilliseconds;
+
+		// Only the labels that changed are laid out again, once the first frame of the run is past.
+		expectedLayouts = (changeEvery > 0) ? (LABEL_COUNT + changeEvery - 1) / changeEvery : 0;
+		if (frame > 1)
+		{
+			Check(batch.GetStats().layouts == expectedLayouts, name, "laid out other than the labels that changed");
+			Check(changeEvery > 0 || !changed, name, "unchanged frame built again");
+			Check(changeEvery > 0 || vertexCount > RING_VERTEX_COUNT || batch.GetStats().uploadBytes == 0, name, "unchanged frame uploaded");
+		}
+		Check(vertexCount == glyphs * TEXT_QUAD_VERTEX_COUNT, name, "batch does not hold 4 vertices a glyph");
+
+		totalLayouts += batch.GetStats().layouts;
+		totalDraws += draws;
+		totalBytes += bytes;
+	}
+
+	Check(result, name, "a label was refused");
+
+	printf("%-14s %8d %10.1f %10d %11.1f %8.2f %8d %10.3f %10.3f\n", name, LABEL_COUNT, (double)totalLayouts / FRAME_COUNT, vertexCount,
+		(double)totalBytes / FRAME_COUNT / 1024.0, (double)totalDraws / FRAME_COUNT, LABEL_COUNT, totalMilliseconds / FRAME_COUNT, worstMilliseconds);
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	FontLoaderClass font;
+	TextBatchClass batch;
+	vector<TextBatchClass::VertexType> ring;
+	const TextBatchClass::VertexType* vertices;
+	string dataDirectory;
+	char text[64];
+	int i, ringOffset, glyphs;
+	bool result, inRing, colored;
+
+	dataDirectory = (argc > 1) ? argv[1] : "../Project/data";
+
+	result = font.Initialize((dataDirectory + "/fontdata.txt").c_str());
+	Check(result, "font", "could not be read");
+	result = result && batch.Initialize(font.GetGlyphs(), 0.0f, 1.0f, SCREEN_WIDTH, SCREEN_HEIGHT);
+	if (!result)
+	{
+		printf("\nFAILED, %d check%s failed\n", s_failures, (s_failures == 1) ? "" : "s");
+		return 1;
+	}
+
+	for (i = 0; i < LABEL_COUNT; i++)
+	{
+		Check(batch.AddSentence(LABEL_LENGTH) == i, "batch", "sentence not added in order");
+	}
+
+	// Too long, and never added.
+	memset(text, 'x', LABEL_LENGTH + 1);
+	text[LABEL_LENGTH + 1] = 0;
+	Check(!batch.SetSentence(0, text, 0, 0, 1.0f, 1.0f, 1.0f), "batch", "took a sentence longer than it was added for");
+	Check(!batch.SetSentence(LABEL_COUNT, "x", 0, 0, 1.0f, 1.0f, 1.0f), "batch", "took a sentence never added");
+
+	ring.resize(RING_VERTEX_COUNT);
+	ringOffset = 0;
+	inRing = false;
+
+	printf("%-14s %8s %10s %10s %11s %8s %8s %10s %10s\n", "frame", "labels", "laid out", "vertices", "upload KB", "draws", "unbatched", "cpu ms", "worst ms");
+	RunFrames(batch, "static", 0, ring, ringOffset, inRing);
+	RunFrames(batch, "1% changing", 100, ring, ringOffset, inRing);
+	RunFrames(batch, "all changing", 1, ring, ringOffset, inRing);
+
+	// The first label leads the batch, in its color, and starts where it was placed.
+	GetLabel(0, FRAME_COUNT, 1, text);
+	glyphs = CountGlyphs(text);
+	vertices = batch.GetVertices();
+	colored = (vertices != 0);
+	for (i = 0; colored && i < glyphs * TEXT_QUAD_VERTEX_COUNT; i++)
+	{
+		colored = vertices[i].color == TextBatchClass::PackColor(0.0f, 1.0f, 0.0f);
+	}
+	Check(colored, "batch", "glyph does not carry its label's color");
+	Check(vertices && IsClockwise(vertices, batch.GetVertexCount()), "batch", "quad triangle not clockwise");
+	Check(vertices && vertices[0].x == (float)(-SCREEN_WIDTH / 2 + 10) && vertices[0].y == (float)(SCREEN_HEIGHT / 2 - 10), "batch", "first label not where it was placed");
+
+	printf("\nglyph          %d vertices, %d bytes, against %d bytes with 6 vertices\n", TEXT_QUAD_VERTEX_COUNT,
+		(int)sizeof(TextBatchClass::VertexType) * TEXT_QUAD_VERTEX_COUNT, (int)sizeof(TextBatchClass::VertexType) * 6);
+
+	batch.Shutdown();
+	font.Shutdown();
+
+	printf("\n%s, %d check%s failed\n", s_failures ? "FAILED" : "ok", s_failures, (s_failures == 1) ? "" : "s");
+
+	return s_failures ? 1 : 0;
+}
@@ -0,0 +1,151 @@
+#include "arenaclass.h"
+
+#include <stdlib.h>
+
+// Largest alignment an allocation can ask for, what malloc guarantees for the blocks on every target.
+static const size_t ARENA_MAX_ALIGNMENT = 16;
+
+// Room for the block header in front of the data, a multiple of the alignment above.
+static const size_t ARENA_HEADER_SIZE = 32;
+
+ArenaClass::ArenaClass()
+{
+	m_first = 0;
+	m_current = 0;
+	m_blockSize = 0;
+	m_usedBytes = 0;
+	m_peakBytes = 0;
+	m_reservedBytes = 0;
+}
+
+ArenaClass::ArenaClass(const ArenaClass& other)
+{
+}
+
+ArenaClass::~ArenaClass()
+{
+}
+
+bool ArenaClass::Initialize(size_t blockSize)
+{
+	m_blockSize = blockSize;
+
+	// Reserve the first block up front, a load that knows its size needs no other.
+	m_first = AddBlock(blockSize);
+	if (!m_first)
+	{
+		return false;
+	}
+	m_current = m_first;
+
+	return true;
+}
+
+void ArenaClass::Shutdown()
+{
+	BlockType* block;
+
+	// Release every block.
+	while (m_first)
+	{
+		block = m_first;
+		m_first = block->next;
+		free(block);
+	}
+
+	m_current = 0;
+	m_usedBytes = 0;
+	m_reservedBytes = 0;
+
+	return;
+}
+
+void ArenaClass::Reset()
+{
+	BlockType* block;
+
+	// Rewind every block, they are filled again in the same order.
+	for (block = m_first; block; block = block->next)
+	{
+		block->used = 0;
+	}
+
+	m_current = m_first;
+	m_usedBytes = 0;
+
+	return;
+}
+
+void* ArenaClass::Allocate(size_t size, size_t alignment)
+{
+	BlockType* block;
+	size_t start;
+
+	if (alignment == 0 || alignment > ARENA_MAX_ALIGNMENT || (alignment & (alignment - 1)) != 0)
+	{
+		return 0;
+	}
+
+	// Take the first block from the current one on with room left, chaining a new one on when none has.
+	block = m_current;
+	while (block)
+	{
+		start = (block->used + alignment - 1) & ~(alignment - 1);
+		if (start + size <= block->size)
+		{
+			break;
+		}
+
+		if (!block->next)
+		{
+			block->next = AddBlock((size > m_blockSize) ? size : m_blockSize);
+		}
+		block = block->next;
+	}
+
+	if (!block)
+	{
+		return 0;
+	}
+
+	m_current = block;
+	m_usedBytes += start + size - block->used;
+	m_peakBytes = (m_usedBytes > m_peakBytes) ? m_usedBytes : m_peakBytes;
+	block->used = start + size;
+
+	return (char*)block + ARENA_HEADER_SIZE + start;
+}
+
+size_t ArenaClass::GetUsedBytes()
+{
+	return m_usedBytes;
+}
+
+size_t ArenaClass::GetPeakBytes()
+{
+	return m_peakBytes;
+}
+
+size_t ArenaClass::GetReservedBytes()
+{
+	return m_reservedBytes;
+}
+
+ArenaClass::BlockType* ArenaClass::AddBlock(size_t size)
+{
+	BlockType* block;
+
+	// The header goes in front of the data.
+	block = (BlockType*)malloc(ARENA_HEADER_SIZE + size);
+	if (!block)
+	{
+		return 0;
+	}
+
+	block->next = 0;
+	block->size = size;
+	block->used = 0;
+	m_reservedBytes += size;
+
+	return block;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef _ARENACLASS_H_
+#define _ARENACLASS_H_
+
+#include <stddef.h>
+
+// Linear allocator for the temporary arrays of one load. Allocation bumps a pointer inside the current block
+// and a new block is chained on when it is full; nothing is freed on its own. Reset rewinds every block for
+// reuse and Shutdown returns them all, so a load's scratch memory goes away in one place whatever path it
+// took. Keeps the high water mark of the bytes handed out, for reporting.
+class ArenaClass
+{
+private:
+	struct BlockType
+	{
+		BlockType* next;
+		size_t size;
+		size_t used;
+	};
+
+public:
+	ArenaClass();
+	ArenaClass(const ArenaClass&);
+	~ArenaClass();
+
+	bool Initialize(size_t);
+	void Shutdown();
+	void Reset();
+
+	void* Allocate(size_t, size_t);
+
+	size_t GetUsedBytes();
+	size_t GetPeakBytes();
+	size_t GetReservedBytes();
+
+private:
+	BlockType* AddBlock(size_t);
+
+private:
+	BlockType* m_first;
+	BlockType* m_current;
+	size_t m_blockSize;
+	size_t m_usedBytes, m_peakBytes, m_reservedBytes;
+};
+#endif
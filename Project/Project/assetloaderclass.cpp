@@ -0,0 +1,117 @@
+#include "assetloaderclass.h"
+
+#include <chrono>
+
+AssetLoaderClass::AssetLoaderClass()
+{
+	m_stopping = false;
+}
+
+AssetLoaderClass::AssetLoaderClass(const AssetLoaderClass& other)
+{
+}
+
+AssetLoaderClass::~AssetLoaderClass()
+{
+}
+
+bool AssetLoaderClass::Initialize(int threadCount)
+{
+	int i;
+
+	// By default every core but the one the render thread runs on.
+	if (threadCount <= 0)
+	{
+		threadCount = (int)thread::hardware_concurrency() - 1;
+		if (threadCount <= 0)
+		{
+			threadCount = 1;
+		}
+	}
+
+	m_stopping = false;
+	for (i = 0; i < threadCount; i++)
+	{
+		m_threads.push_back(thread(&AssetLoaderClass::WorkerThread, this));
+	}
+
+	return true;
+}
+
+void AssetLoaderClass::Shutdown()
+{
+	unsigned int i;
+
+	// Jobs that have not started are dropped, their futures report a broken promise. Running ones finish.
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+		m_jobs.clear();
+	}
+	m_condition.notify_all();
+
+	for (i = 0; i < m_threads.size(); i++)
+	{
+		m_threads[i].join();
+	}
+	m_threads.clear();
+
+	return;
+}
+
+future<bool> AssetLoaderClass::Submit(const function<bool()>& job)
+{
+	packaged_task<bool()> task(job);
+	future<bool> result;
+
+	result = task.get_future();
+
+	// Queue the job and wake up one worker for it.
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_jobs.push_back(move(task));
+	}
+	m_condition.notify_one();
+
+	return result;
+}
+
+int AssetLoaderClass::GetThreadCount()
+{
+	return (int)m_threads.size();
+}
+
+bool AssetLoaderClass::IsReady(future<bool>& result)
+{
+	// A future that was already collected, or never submitted, has nothing left to wait for.
+	if (!result.valid())
+	{
+		return false;
+	}
+
+	return result.wait_for(chrono::seconds(0)) == future_status::ready;
+}
+
+void AssetLoaderClass::WorkerThread()
+{
+	packaged_task<bool()> task;
+
+	while (true)
+	{
+		// Sleep until there is a job or the pool shuts down.
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+			if (m_stopping)
+			{
+				return;
+			}
+
+			task = move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		// Run the job outside the lock, the future picks up its result.
+		task();
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef _ASSETLOADERCLASS_H_
+#define _ASSETLOADERCLASS_H_
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+using namespace std;
+
+// Pool of worker threads that run loading jobs in the background. Each job returns whether it succeeded and
+// Submit hands back a future for that result, so the caller can poll it every frame and finish the part
+// that has to happen on its own thread, like creating the D3D resources, once the job is done.
+class AssetLoaderClass
+{
+public:
+	AssetLoaderClass();
+	AssetLoaderClass(const AssetLoaderClass&);
+	~AssetLoaderClass();
+
+	bool Initialize(int);
+	void Shutdown();
+
+	future<bool> Submit(const function<bool()>&);
+	int GetThreadCount();
+
+	static bool IsReady(future<bool>&);
+
+private:
+	void WorkerThread();
+
+private:
+	vector<thread> m_threads;
+	deque<packaged_task<bool()> > m_jobs;
+	mutex m_mutex;
+	condition_variable m_condition;
+	bool m_stopping;
+};
+#endif
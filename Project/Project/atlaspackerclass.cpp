@@ -0,0 +1,198 @@
+#include "atlaspackerclass.h"
+
+AtlasPackerClass::AtlasPackerClass()
+{
+	m_width = 0;
+	m_height = 0;
+	m_usedArea = 0;
+}
+
+AtlasPackerClass::AtlasPackerClass(const AtlasPackerClass& other)
+{
+}
+
+AtlasPackerClass::~AtlasPackerClass()
+{
+}
+
+bool AtlasPackerClass::Initialize(int width, int height)
+{
+	RectType bin;
+
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	m_width = width;
+	m_height = height;
+	m_usedArea = 0;
+
+	// All of the bin is free.
+	bin.x = 0;
+	bin.y = 0;
+	bin.width = width;
+	bin.height = height;
+
+	m_freeRects.clear();
+	m_freeRects.push_back(bin);
+
+	return true;
+}
+
+void AtlasPackerClass::Shutdown()
+{
+	vector<RectType>().swap(m_freeRects);
+
+	return;
+}
+
+bool AtlasPackerClass::Insert(int width, int height, int& x, int& y)
+{
+	RectType placed;
+	unsigned int i;
+	int best, bestLong, shortSide, longSide, leftWidth, leftHeight;
+
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	// The free rectangle the new one fits the tightest in, by the shorter side left over and then the longer.
+	best = -1;
+	bestLong = 0;
+	for (i = 0; i < m_freeRects.size(); i++)
+	{
+		leftWidth = m_freeRects[i].width - width;
+		leftHeight = m_freeRects[i].height - height;
+		if (leftWidth < 0 || leftHeight < 0)
+		{
+			continue;
+		}
+
+		shortSide = (leftWidth < leftHeight) ? leftWidth : leftHeight;
+		longSide = (leftWidth < leftHeight) ? leftHeight : leftWidth;
+		if (best < 0 || shortSide < best || (shortSide == best && longSide < bestLong))
+		{
+			best = shortSide;
+			bestLong = longSide;
+			x = m_freeRects[i].x;
+			y = m_freeRects[i].y;
+		}
+	}
+
+	if (best < 0)
+	{
+		return false;
+	}
+
+	placed.x = x;
+	placed.y = y;
+	placed.width = width;
+	placed.height = height;
+
+	SplitFreeRects(placed);
+	PruneFreeRects();
+
+	m_usedArea += (long long)width * height;
+
+	return true;
+}
+
+float AtlasPackerClass::GetOccupancy()
+{
+	if (m_width <= 0 || m_height <= 0)
+	{
+		return 0.0f;
+	}
+
+	return (float)((double)m_usedArea / ((double)m_width * m_height));
+}
+
+void AtlasPackerClass::SplitFreeRects(const RectType& placed)
+{
+	vector<RectType> split;
+	RectType free, part;
+	unsigned int i;
+
+	// Every free rectangle the placed one overlaps is replaced by up to four maximal ones around it.
+	for (i = 0; i < m_freeRects.size(); i++)
+	{
+		free = m_freeRects[i];
+		if (placed.x >= free.x + free.width || placed.x + placed.width <= free.x || placed.y >= free.y + free.height || placed.y + placed.height <= free.y)
+		{
+			split.push_back(free);
+			continue;
+		}
+
+		if (placed.x > free.x)
+		{
+			part = free;
+			part.width = placed.x - free.x;
+			split.push_back(part);
+		}
+
+		if (placed.x + placed.width < free.x + free.width)
+		{
+			part = free;
+			part.x = placed.x + placed.width;
+			part.width = free.x + free.width - part.x;
+			split.push_back(part);
+		}
+
+		if (placed.y > free.y)
+		{
+			part = free;
+			part.height = placed.y - free.y;
+			split.push_back(part);
+		}
+
+		if (placed.y + placed.height < free.y + free.height)
+		{
+			part = free;
+			part.y = placed.y + placed.height;
+			part.height = free.y + free.height - part.y;
+			split.push_back(part);
+		}
+	}
+
+	m_freeRects.swap(split);
+
+	return;
+}
+
+void AtlasPackerClass::PruneFreeRects()
+{
+	unsigned int i, j;
+	bool contained;
+
+	// Drop every free rectangle another one contains, of two equal ones the later.
+	for (i = 0; i < m_freeRects.size(); )
+	{
+		contained = false;
+		for (j = 0; j < m_freeRects.size() && !contained; j++)
+		{
+			if (i == j)
+			{
+				continue;
+			}
+
+			contained = m_freeRects[i].x >= m_freeRects[j].x && m_freeRects[i].y >= m_freeRects[j].y &&
+				m_freeRects[i].x + m_freeRects[i].width <= m_freeRects[j].x + m_freeRects[j].width &&
+				m_freeRects[i].y + m_freeRects[i].height <= m_freeRects[j].y + m_freeRects[j].height &&
+				(j < i || m_freeRects[i].x != m_freeRects[j].x || m_freeRects[i].y != m_freeRects[j].y ||
+				m_freeRects[i].width != m_freeRects[j].width || m_freeRects[i].height != m_freeRects[j].height);
+		}
+
+		if (contained)
+		{
+			m_freeRects.erase(m_freeRects.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	return;
+}
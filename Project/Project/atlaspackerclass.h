@@ -0,0 +1,42 @@
+#pragma once
+
+#ifndef _ATLASPACKERCLASS_H_
+#define _ATLASPACKERCLASS_H_
+
+#include <vector>
+using namespace std;
+
+// Packs rectangles into a fixed size bin with MaxRects: the free space is kept as the list of the largest
+// rectangles that fit in it, overlapping each other, and every rectangle goes where it leaves the shortest
+// side of a free one over (best short side fit). Each placement splits the free rectangles it covers into
+// the parts around it and drops those another one contains. Sizes are in whatever units the caller packs
+// in, the texture atlas packs in cells of its alignment so every position stays aligned.
+class AtlasPackerClass
+{
+private:
+	struct RectType
+	{
+		int x, y, width, height;
+	};
+
+public:
+	AtlasPackerClass();
+	AtlasPackerClass(const AtlasPackerClass&);
+	~AtlasPackerClass();
+
+	bool Initialize(int, int);
+	void Shutdown();
+
+	bool Insert(int, int, int&, int&);
+	float GetOccupancy();
+
+private:
+	void SplitFreeRects(const RectType&);
+	void PruneFreeRects();
+
+private:
+	vector<RectType> m_freeRects;
+	int m_width, m_height;
+	long long m_usedArea;
+};
+#endif
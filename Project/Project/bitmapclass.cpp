@@ -5,6 +5,8 @@ BitmapClass::BitmapClass()
 	m_vertexBuffer = 0;
 	m_indexBuffer = 0;
 	m_Texture = 0;
+	m_Registry = 0;
+	m_SharedTexture = 0;
 }
 
 BitmapClass::BitmapClass(const BitmapClass& other)
@@ -15,10 +17,12 @@ BitmapClass::~BitmapClass()
 {
 }
 
-bool BitmapClass::Initialize(ID3D11Device* device, int screenWidth, int screenHeight, WCHAR* textureFilename, int bitmapWidth, int bitmapHeight)
+bool BitmapClass::Initialize(ID3D11Device* device, ResourceRegistryClass* registry, int screenWidth, int screenHeight, WCHAR* textureFilename, int bitmapWidth, int bitmapHeight)
 {
 	bool result;
 
+	m_Registry = registry;
+
 	// Store the screen size.
 	m_screenWidth = screenWidth;
 	m_screenHeight = screenHeight;
@@ -89,17 +93,15 @@ ID3D11ShaderResourceView* BitmapClass::GetTexture()
 bool BitmapClass::InitializeBuffers(ID3D11Device* device)
 {
 	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
+	D3D11_BUFFER_DESC vertexBufferDesc;
+	D3D11_SUBRESOURCE_DATA vertexData;
 	HRESULT result;
-	int i;
 
-	// Set the number of vertices in the vertex array.
-	m_vertexCount = 6;
+	// Set the number of vertices in the vertex array, one quad.
+	m_vertexCount = 4;
 
-	// Set the number of indices in the index array.
-	m_indexCount = m_vertexCount;
+	// Set the number of indices the quad is drawn with.
+	m_indexCount = 6;
 
 	// Create the vertex array.
 	vertices = new VertexType[m_vertexCount];
@@ -108,22 +110,9 @@ bool BitmapClass::InitializeBuffers(ID3D11Device* device)
 		return false;
 	}
 
-	// Create the index array.
-	indices = new unsigned long[m_indexCount];
-	if (!indices)
-	{
-		return false;
-	}
-
 	// Initialize vertex array to zeros at first.
 	memset(vertices, 0, (sizeof(VertexType) * m_vertexCount));
 
-	// Load the index array with data.
-	for (i = 0; i < m_indexCount; i++)
-	{
-		indices[i] = i;
-	}
-
 	// Set up the description of the static vertex buffer.
 	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
 	vertexBufferDesc.ByteWidth = sizeof(VertexType) * m_vertexCount;
@@ -144,43 +133,24 @@ bool BitmapClass::InitializeBuffers(ID3D11Device* device)
 		return false;
 	}
 
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
+	// Release the array now that the vertex buffer has been created and loaded.
+	delete[] vertices;
+	vertices = 0;
 
-	// Create the index buffer.
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
-	if (FAILED(result))
+	// The quad is drawn with the shared quad index buffer.
+	m_indexBuffer = m_Registry->GetQuadIndexBuffer(device);
+	if (!m_indexBuffer)
 	{
 		return false;
 	}
 
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
-
-	delete[] indices;
-	indices = 0;
-
 	return true;
 }
 
 void BitmapClass::ShutdownBuffers()
 {
-	// Release the index buffer.
-	if (m_indexBuffer)
-	{
-		m_indexBuffer->Release();
-		m_indexBuffer = 0;
-	}
+	// The index buffer belongs to the registry.
+	m_indexBuffer = 0;
 
 	// Release the vertex buffer.
 	if (m_vertexBuffer)
@@ -194,7 +164,7 @@ void BitmapClass::ShutdownBuffers()
 
 bool BitmapClass::UpdateBuffers(ID3D11DeviceContext* deviceContext, int positionX, int positionY)
 {
-	float left, right, top, bottom;
+	float left, right, top, bottom, texLeft, texRight, texTop, texBottom;
 	VertexType* vertices;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	VertexType* verticesPtr;
@@ -223,6 +193,12 @@ bool BitmapClass::UpdateBuffers(ID3D11DeviceContext* deviceContext, int position
 	// Calculate the screen coordinates of the bottom of the bitmap.
 	bottom = top - (float)m_bitmapHeight;
 
+	// The whole texture, or its place in the atlas.
+	texLeft = m_remap.uOffset;
+	texRight = m_remap.uOffset + m_remap.uScale;
+	texTop = m_remap.vOffset;
+	texBottom = m_remap.vOffset + m_remap.vScale;
+
 	// Create the vertex array.
 	vertices = new VertexType[m_vertexCount];
 	if (!vertices)
@@ -230,26 +206,18 @@ bool BitmapClass::UpdateBuffers(ID3D11DeviceContext* deviceContext, int position
 		return false;
 	}
 
-	// Load the vertex array with data.
-	// First triangle.
+	// Load the vertex array with the corners of the quad, in the order the quad index buffer draws them.
 	vertices[0].position = D3DXVECTOR3(left, top, 0.0f); // Top left.
-	vertices[0].texture = D3DXVECTOR2(0.0f, 0.0f);
-
-	vertices[1].position = D3DXVECTOR3(right, bottom, 0.0f); // Bottom right.
-	vertices[1].texture = D3DXVECTOR2(1.0f, 1.0f);
-
-	vertices[2].position = D3DXVECTOR3(left, bottom, 0.0f); // Bottom left.
-	vertices[2].texture = D3DXVECTOR2(0.0f, 1.0f);
+	vertices[0].texture = D3DXVECTOR2(texLeft, texTop);
 
-	// Second triangle.
-	vertices[3].position = D3DXVECTOR3(left, top, 0.0f); // Top left.
-	vertices[3].texture = D3DXVECTOR2(0.0f, 0.0f);
+	vertices[1].position = D3DXVECTOR3(right, top, 0.0f); // Top right.
+	vertices[1].texture = D3DXVECTOR2(texRight, texTop);
 
-	vertices[4].position = D3DXVECTOR3(right, top, 0.0f); // Top right.
-	vertices[4].texture = D3DXVECTOR2(1.0f, 0.0f);
+	vertices[2].position = D3DXVECTOR3(right, bottom, 0.0f); // Bottom right.
+	vertices[2].texture = D3DXVECTOR2(texRight, texBottom);
 
-	vertices[5].position = D3DXVECTOR3(right, bottom, 0.0f); // Bottom right.
-	vertices[5].texture = D3DXVECTOR2(1.0f, 1.0f);
+	vertices[3].position = D3DXVECTOR3(left, bottom, 0.0f); // Bottom left.
+	vertices[3].texture = D3DXVECTOR2(texLeft, texBottom);
 
 	// Lock the vertex buffer so it can be written to.
 	result = deviceContext->Map(m_vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
@@ -287,7 +255,7 @@ void BitmapClass::RenderBuffers(ID3D11DeviceContext* deviceContext)
 	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
 
 	// Set the index buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
 
 	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -299,30 +267,42 @@ bool BitmapClass::LoadTexture(ID3D11Device* device, WCHAR* filename)
 {
 	bool result;
 
-	// Create the texture object.
-	m_Texture = new TextureClass;
-	if (!m_Texture)
+	// Draw from the atlas when the texture is packed in it, with the coordinates moved into its place there.
+	m_SharedTexture = m_Registry->AcquireAtlasTexture(filename, m_remap);
+
+	// Otherwise get the texture from the registry, it is only read and created the first time it is asked for.
+	if (!m_SharedTexture)
 	{
-		return false;
+		m_remap.uScale = 1.0f;
+		m_remap.vScale = 1.0f;
+		m_remap.uOffset = 0.0f;
+		m_remap.vOffset = 0.0f;
+
+		m_SharedTexture = m_Registry->AcquireTexture(filename);
+		if (!m_SharedTexture)
+		{
+			return false;
+		}
 	}
 
-	// Initialize the texture object.
-	result = m_Texture->Initialize(device, filename);
+	result = m_Registry->CreateTexture(device, m_SharedTexture, false);
 	if (!result)
 	{
 		return false;
 	}
 
+	m_Texture = m_SharedTexture->texture;
+
 	return true;
 }
 
 void BitmapClass::ReleaseTexture()
 {
-	// Release the texture object.
-	if (m_Texture)
+	// Give the texture back to the registry.
+	if (m_SharedTexture)
 	{
-		m_Texture->Shutdown();
-		delete m_Texture;
+		m_Registry->ReleaseTexture(m_SharedTexture);
+		m_SharedTexture = 0;
 		m_Texture = 0;
 	}
 
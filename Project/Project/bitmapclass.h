@@ -5,7 +5,10 @@
 #include <d3d11.h>
 #include <d3dx10math.h>
 #include "textureclass.h"
+#include "resourceregistryclass.h"
 
+// A textured quad drawn in screen space. Its 4 vertices, top left, top right, bottom right and bottom left, are
+// drawn with the registry's shared quad index buffer.
 class BitmapClass
 {
 private:
@@ -20,7 +23,7 @@ public:
 	BitmapClass(const BitmapClass&);
 	~BitmapClass();
 
-	bool Initialize(ID3D11Device*, int, int, WCHAR*, int, int);
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, int, int, WCHAR*, int, int);
 	void Shutdown();
 	bool Render(ID3D11DeviceContext*, int, int);
 
@@ -40,6 +43,9 @@ private:
 	ID3D11Buffer *m_vertexBuffer, *m_indexBuffer;
 	int m_vertexCount, m_indexCount;
 	TextureClass* m_Texture;
+	ResourceRegistryClass* m_Registry;
+	ResourceRegistryClass::TextureType* m_SharedTexture;
+	TextureAtlasClass::RemapType m_remap;
 
 	int m_screenWidth, m_screenHeight;
 	int m_bitmapWidth, m_bitmapHeight;
@@ -0,0 +1,1272 @@
+#include "blockdecoderclass.h"
+
+#include <string.h>
+#include <thread>
+
+// The SIMD kernels are compiled for their instruction set whatever the build targets, and only run once
+// GetSupportedKernel has seen it on the processor.
+#if defined(_M_X64) || defined(_M_AMD64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BLOCK_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define TARGET_SSE4
+#define TARGET_AVX2
+#else
+#define TARGET_SSE4 __attribute__((target("sse4.1")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+// Rows of blocks below which a range is not worth a thread.
+static const int MIN_RANGE_ROWS = 16;
+
+// BC7 modes: subsets, partition bits, rotation bits, index selection bits, color bits, alpha bits,
+// endpoint p-bits, shared p-bits, index bits and secondary index bits.
+struct Bc7ModeType
+{
+	int subsetCount, partitionBits, rotationBits, indexSelectionBits, colorBits, alphaBits, endpointPBits, sharedPBits, indexBits, secondaryIndexBits;
+};
+
+static const Bc7ModeType BC7_MODES[8] =
+{
+	{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+	{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+	{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+	{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+	{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+	{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+	{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+	{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+};
+
+// Two subset partitions, bit i set when texel i is in the second subset.
+static const unsigned short BC7_PARTITIONS2[64] =
+{
+	0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+	0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+	0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+	0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+// Three subset partitions, two bits per texel with texel 0 lowest.
+static const unsigned int BC7_PARTITIONS3[64] =
+{
+	0xAA685050, 0x6A5A5040, 0x5A5A4200, 0x5450A0A8, 0xA5A50000, 0xA0A05050, 0x5555A0A0, 0x5A5A5050,
+	0xAA550000, 0xAA555500, 0xAAAA5500, 0x90909090, 0x94949494, 0xA4A4A4A4, 0xA9A59450, 0x2A0A4250,
+	0xA5945040, 0x0A425054, 0xA5A5A500, 0x55A0A0A0, 0xA8A85454, 0x6A6A4040, 0xA4A45000, 0x1A1A0500,
+	0x0050A4A4, 0xAAA59090, 0x14696914, 0x69691400, 0xA08585A0, 0xAA821414, 0x50A4A450, 0x6A5A0200,
+	0xA9A58000, 0x5090A0A8, 0xA8A09050, 0x24242424, 0x00AA5500, 0x24924924, 0x24499224, 0x50A50A50,
+	0x500AA550, 0xAAAA4444, 0x66660000, 0xA5A0A5A0, 0x50A050A0, 0x69286928, 0x44AAAA44, 0x66666600,
+	0xAA444444, 0x54A854A8, 0x95809580, 0x96969600, 0xA85454A8, 0x80959580, 0xAA141414, 0x96960000,
+	0xAAAA1414, 0xA05050A0, 0xA0A5A5A0, 0x96000000, 0x40804080, 0xA9A8A9A8, 0xAAAAAA44, 0x2A4A5254,
+};
+
+// Texel whose index drops its top bit, for the second subset of two and the second and third of three.
+static const unsigned char BC7_ANCHORS2[64] =
+{
+	15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+	15, 2, 8, 2, 2, 8, 8, 15, 2, 8, 2, 2, 8, 8, 2, 2,
+	15, 15, 6, 8, 2, 8, 15, 15, 2, 8, 2, 2, 2, 15, 15, 6,
+	6, 2, 6, 8, 15, 15, 2, 2, 15, 15, 15, 15, 15, 2, 2, 15,
+};
+
+static const unsigned char BC7_ANCHORS3_SECOND[64] =
+{
+	3, 3, 15, 15, 8, 3, 15, 15, 8, 8, 6, 6, 6, 5, 3, 3,
+	3, 3, 8, 15, 3, 3, 6, 10, 5, 8, 8, 6, 8, 5, 15, 15,
+	8, 15, 3, 5, 6, 10, 8, 15, 15, 3, 15, 5, 15, 15, 15, 15,
+	3, 15, 5, 5, 5, 8, 5, 10, 5, 10, 8, 13, 15, 12, 3, 3,
+};
+
+static const unsigned char BC7_ANCHORS3_THIRD[64] =
+{
+	15, 8, 8, 3, 15, 15, 3, 8, 15, 15, 15, 15, 15, 15, 15, 8,
+	15, 8, 15, 3, 15, 8, 15, 8, 3, 15, 6, 10, 15, 15, 10, 8,
+	15, 3, 15, 10, 10, 8, 9, 10, 6, 15, 8, 15, 3, 6, 6, 8,
+	15, 3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3, 15, 15, 8,
+};
+
+// Interpolation weights out of 64 for 2, 3 and 4 bit indices.
+static const unsigned char BC7_WEIGHTS2[4] = { 0, 21, 43, 64 };
+static const unsigned char BC7_WEIGHTS3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+static const unsigned char BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// A BC7 block unpacked into the endpoints of each subset and the subset and weights of each texel.
+struct Bc7BlockType
+{
+	unsigned char endpoints[2][16];
+	unsigned char subsets[16];
+	unsigned char colorWeights[16];
+	unsigned char alphaWeights[16];
+	int rotation;
+	bool valid;
+};
+
+// Planar palette of a BC1 color block: four reds, four greens, four blues and four alphas. BC2 and BC3
+// always use four colors, BC1 three and transparent black when the first endpoint is not the larger.
+static void ColorPalette(const unsigned char* block, bool punchThrough, unsigned char* palette)
+{
+	unsigned int color[2];
+	int channel, first, second;
+
+	color[0] = (unsigned int)block[0] | ((unsigned int)block[1] << 8);
+	color[1] = (unsigned int)block[2] | ((unsigned int)block[3] << 8);
+
+	palette[0] = (unsigned char)(((color[0] >> 11) << 3) | (color[0] >> 13));
+	palette[1] = (unsigned char)(((color[1] >> 11) << 3) | (color[1] >> 13));
+	palette[4] = (unsigned char)((((color[0] >> 5) & 0x3F) << 2) | (((color[0] >> 5) & 0x3F) >> 4));
+	palette[5] = (unsigned char)((((color[1] >> 5) & 0x3F) << 2) | (((color[1] >> 5) & 0x3F) >> 4));
+	palette[8] = (unsigned char)(((color[0] & 0x1F) << 3) | ((color[0] & 0x1F) >> 2));
+	palette[9] = (unsigned char)(((color[1] & 0x1F) << 3) | ((color[1] & 0x1F) >> 2));
+
+	for (channel = 0; channel < 3; channel++)
+	{
+		first = palette[channel * 4];
+		second = palette[channel * 4 + 1];
+		if (!punchThrough || color[0] > color[1])
+		{
+			palette[channel * 4 + 2] = (unsigned char)((2 * first + second + 1) / 3);
+			palette[channel * 4 + 3] = (unsigned char)((first + 2 * second + 1) / 3);
+		}
+		else
+		{
+			palette[channel * 4 + 2] = (unsigned char)((first + second + 1) / 2);
+			palette[channel * 4 + 3] = 0;
+		}
+	}
+
+	palette[12] = 255;
+	palette[13] = 255;
+	palette[14] = 255;
+	palette[15] = (!punchThrough || color[0] > color[1]) ? 255 : 0;
+
+	return;
+}
+
+// Eight values of a BC3 alpha or BC4 channel block, six interpolated or four and the two extremes.
+static void ChannelPalette(const unsigned char* block, unsigned char* palette)
+{
+	int first, second, i;
+
+	first = block[0];
+	second = block[1];
+	palette[0] = (unsigned char)first;
+	palette[1] = (unsigned char)second;
+
+	if (first > second)
+	{
+		for (i = 1; i < 7; i++)
+		{
+			palette[i + 1] = (unsigned char)(((7 - i) * first + i * second + 3) / 7);
+		}
+	}
+	else
+	{
+		for (i = 1; i < 5; i++)
+		{
+			palette[i + 1] = (unsigned char)(((5 - i) * first + i * second + 2) / 5);
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	return;
+}
+
+static void ChannelValues(const unsigned char* block, unsigned char* values)
+{
+	unsigned char palette[8];
+	unsigned long long bits;
+	int i;
+
+	ChannelPalette(block, palette);
+
+	bits = 0;
+	for (i = 7; i >= 2; i--)
+	{
+		bits = (bits << 8) | block[i];
+	}
+
+	for (i = 0; i < 16; i++)
+	{
+		values[i] = palette[(bits >> (3 * i)) & 7];
+	}
+
+	return;
+}
+
+static unsigned int ReadBits(const unsigned long long* bits, int& position, int count)
+{
+	unsigned long long value;
+
+	if (count == 0)
+	{
+		return 0;
+	}
+
+	if (position >= 64)
+	{
+		value = bits[1] >> (position - 64);
+	}
+	else if (position + count <= 64)
+	{
+		value = bits[0] >> position;
+	}
+	else
+	{
+		value = (bits[0] >> position) | (bits[1] << (64 - position));
+	}
+	position += count;
+
+	return (unsigned int)(value & ((1ull << count) - 1));
+}
+
+static unsigned char Bc7Weight(unsigned int index, int bitCount)
+{
+	if (bitCount == 2)
+	{
+		return BC7_WEIGHTS2[index];
+	}
+	if (bitCount == 3)
+	{
+		return BC7_WEIGHTS3[index];
+	}
+
+	return BC7_WEIGHTS4[index];
+}
+
+static void ParseBc7(const unsigned char* block, Bc7BlockType& parsed)
+{
+	const Bc7ModeType* mode;
+	unsigned long long bits[2];
+	unsigned int raw[3][2][4], pBits[3][2], partition, indexSelection, index, value;
+	int modeIndex, position, subset, end, channel, channelBits, anchors[3], i;
+
+	// The mode is the lowest set bit, a block without one is reserved and decodes to zero.
+	for (modeIndex = 0; modeIndex < 8 && !(block[0] & (1 << modeIndex)); modeIndex++)
+	{
+	}
+
+	parsed.valid = (modeIndex < 8);
+	if (!parsed.valid)
+	{
+		return;
+	}
+
+	mode = &BC7_MODES[modeIndex];
+	bits[0] = 0;
+	bits[1] = 0;
+	for (i = 7; i >= 0; i--)
+	{
+		bits[0] = (bits[0] << 8) | block[i];
+		bits[1] = (bits[1] << 8) | block[8 + i];
+	}
+
+	position = modeIndex + 1;
+	partition = ReadBits(bits, position, mode->partitionBits);
+	parsed.rotation = (int)ReadBits(bits, position, mode->rotationBits);
+	indexSelection = ReadBits(bits, position, mode->indexSelectionBits);
+
+	// Endpoints a channel at a time, then their p-bits.
+	memset(raw, 0, sizeof(raw));
+	for (channel = 0; channel < 4; channel++)
+	{
+		channelBits = (channel < 3) ? mode->colorBits : mode->alphaBits;
+		for (subset = 0; subset < mode->subsetCount; subset++)
+		{
+			for (end = 0; end < 2; end++)
+			{
+				raw[subset][end][channel] = ReadBits(bits, position, channelBits);
+			}
+		}
+	}
+
+	memset(pBits, 0, sizeof(pBits));
+	for (subset = 0; subset < mode->subsetCount; subset++)
+	{
+		if (mode->endpointPBits)
+		{
+			pBits[subset][0] = ReadBits(bits, position, 1);
+			pBits[subset][1] = ReadBits(bits, position, 1);
+		}
+		else if (mode->sharedPBits)
+		{
+			pBits[subset][0] = ReadBits(bits, position, 1);
+			pBits[subset][1] = pBits[subset][0];
+		}
+	}
+
+	// Append the p-bit and widen to 8 bits by repeating the top bits, alpha is opaque when the mode has none.
+	memset(parsed.endpoints, 0, sizeof(parsed.endpoints));
+	for (subset = 0; subset < mode->subsetCount; subset++)
+	{
+		for (end = 0; end < 2; end++)
+		{
+			for (channel = 0; channel < 4; channel++)
+			{
+				channelBits = (channel < 3) ? mode->colorBits : mode->alphaBits;
+				if (channelBits == 0)
+				{
+					parsed.endpoints[end][subset * 4 + channel] = 255;
+					continue;
+				}
+
+				value = raw[subset][end][channel];
+				if (mode->endpointPBits || mode->sharedPBits)
+				{
+					value = (value << 1) | pBits[subset][end];
+					channelBits++;
+				}
+
+				value <<= 8 - channelBits;
+				parsed.endpoints[end][subset * 4 + channel] = (unsigned char)(value | (value >> channelBits));
+			}
+		}
+	}
+
+	// Subset of every texel and the texels whose index is a bit shorter.
+	anchors[0] = 0;
+	anchors[1] = 0;
+	anchors[2] = 0;
+	for (i = 0; i < 16; i++)
+	{
+		if (mode->subsetCount == 2)
+		{
+			parsed.subsets[i] = (unsigned char)((BC7_PARTITIONS2[partition] >> i) & 1);
+		}
+		else if (mode->subsetCount == 3)
+		{
+			parsed.subsets[i] = (unsigned char)((BC7_PARTITIONS3[partition] >> (2 * i)) & 3);
+		}
+		else
+		{
+			parsed.subsets[i] = 0;
+		}
+	}
+
+	if (mode->subsetCount == 2)
+	{
+		anchors[1] = BC7_ANCHORS2[partition];
+	}
+	else if (mode->subsetCount == 3)
+	{
+		anchors[1] = BC7_ANCHORS3_SECOND[partition];
+		anchors[2] = BC7_ANCHORS3_THIRD[partition];
+	}
+
+	// The primary indices, and the secondary ones of modes 4 and 5. The index selection bit of mode 4 swaps
+	// which of them the color uses.
+	for (i = 0; i < 16; i++)
+	{
+		index = ReadBits(bits, position, mode->indexBits - ((i == anchors[parsed.subsets[i]]) ? 1 : 0));
+		parsed.colorWeights[i] = Bc7Weight(index, mode->indexBits);
+		parsed.alphaWeights[i] = parsed.colorWeights[i];
+	}
+
+	if (mode->secondaryIndexBits)
+	{
+		for (i = 0; i < 16; i++)
+		{
+			index = ReadBits(bits, position, mode->secondaryIndexBits - ((i == 0) ? 1 : 0));
+			if (indexSelection)
+			{
+				parsed.alphaWeights[i] = parsed.colorWeights[i];
+				parsed.colorWeights[i] = Bc7Weight(index, mode->secondaryIndexBits);
+			}
+			else
+			{
+				parsed.alphaWeights[i] = Bc7Weight(index, mode->secondaryIndexBits);
+			}
+		}
+	}
+
+	return;
+}
+
+static void DecodeColorScalar(const unsigned char* block, bool punchThrough, unsigned char* texels, int pitch)
+{
+	unsigned char palette[16];
+	unsigned char* texel;
+	unsigned int bits, index;
+	int i;
+
+	ColorPalette(block, punchThrough, palette);
+	bits = (unsigned int)block[4] | ((unsigned int)block[5] << 8) | ((unsigned int)block[6] << 16) | ((unsigned int)block[7] << 24);
+
+	for (i = 0; i < 16; i++)
+	{
+		index = (bits >> (2 * i)) & 3;
+		texel = texels + (i >> 2) * pitch + (i & 3) * 4;
+		texel[0] = palette[index];
+		texel[1] = palette[4 + index];
+		texel[2] = palette[8 + index];
+		texel[3] = palette[12 + index];
+	}
+
+	return;
+}
+
+static void DecodeBc1Scalar(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	DecodeColorScalar(block, true, texels, pitch);
+
+	return;
+}
+
+static void DecodeBc2Scalar(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	int i;
+
+	DecodeColorScalar(block + 8, false, texels, pitch);
+
+	// Four explicit bits of alpha per texel.
+	for (i = 0; i < 16; i++)
+	{
+		texels[(i >> 2) * pitch + (i & 3) * 4 + 3] = (unsigned char)(((block[i >> 1] >> (4 * (i & 1))) & 0xF) * 17);
+	}
+
+	return;
+}
+
+static void DecodeBc3Scalar(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	unsigned char alpha[16];
+	int i;
+
+	DecodeColorScalar(block + 8, false, texels, pitch);
+
+	ChannelValues(block, alpha);
+	for (i = 0; i < 16; i++)
+	{
+		texels[(i >> 2) * pitch + (i & 3) * 4 + 3] = alpha[i];
+	}
+
+	return;
+}
+
+static void DecodeBc4Scalar(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	unsigned char red[16];
+	unsigned char* texel;
+	int i;
+
+	ChannelValues(block, red);
+	for (i = 0; i < 16; i++)
+	{
+		texel = texels + (i >> 2) * pitch + (i & 3) * 4;
+		texel[0] = red[i];
+		texel[1] = 0;
+		texel[2] = 0;
+		texel[3] = 255;
+	}
+
+	return;
+}
+
+static void DecodeBc5Scalar(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	unsigned char red[16], green[16];
+	unsigned char* texel;
+	int i;
+
+	ChannelValues(block, red);
+	ChannelValues(block + 8, green);
+	for (i = 0; i < 16; i++)
+	{
+		texel = texels + (i >> 2) * pitch + (i & 3) * 4;
+		texel[0] = red[i];
+		texel[1] = green[i];
+		texel[2] = 0;
+		texel[3] = 255;
+	}
+
+	return;
+}
+
+static void DecodeBc7Scalar(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	Bc7BlockType parsed;
+	unsigned char* texel;
+	unsigned char swap;
+	int i, channel, subset, weight;
+
+	ParseBc7(block, parsed);
+
+	for (i = 0; i < 16; i++)
+	{
+		texel = texels + (i >> 2) * pitch + (i & 3) * 4;
+		if (!parsed.valid)
+		{
+			memset(texel, 0, 4);
+			continue;
+		}
+
+		subset = parsed.subsets[i];
+		for (channel = 0; channel < 4; channel++)
+		{
+			weight = (channel < 3) ? parsed.colorWeights[i] : parsed.alphaWeights[i];
+			texel[channel] = (unsigned char)(((64 - weight) * parsed.endpoints[0][subset * 4 + channel] + weight * parsed.endpoints[1][subset * 4 + channel] + 32) >> 6);
+		}
+
+		// A rotation swaps alpha with one of the colors after interpolation.
+		if (parsed.rotation)
+		{
+			swap = texel[3];
+			texel[3] = texel[parsed.rotation - 1];
+			texel[parsed.rotation - 1] = swap;
+		}
+	}
+
+	return;
+}
+
+#ifdef BLOCK_SIMD
+// The 32 bits of color indices behind the endpoints.
+static inline int LoadIndices(const unsigned char* block)
+{
+	int bits;
+
+	memcpy(&bits, block + 4, sizeof(bits));
+
+	return bits;
+}
+
+// Unpacks 16 two bit indices to a byte each: every 16 bit lane takes the byte holding its texel, the
+// multiply moves the texel's bits to the top byte and the shift brings them down.
+TARGET_SSE4 static inline __m128i UnpackIndices2(__m128i bits)
+{
+	__m128i low, high;
+
+	low = _mm_shuffle_epi8(bits, _mm_setr_epi8(0, -1, 0, -1, 0, -1, 0, -1, 1, -1, 1, -1, 1, -1, 1, -1));
+	high = _mm_shuffle_epi8(bits, _mm_setr_epi8(2, -1, 2, -1, 2, -1, 2, -1, 3, -1, 3, -1, 3, -1, 3, -1));
+	low = _mm_srli_epi16(_mm_mullo_epi16(low, _mm_setr_epi16(256, 64, 16, 4, 256, 64, 16, 4)), 8);
+	high = _mm_srli_epi16(_mm_mullo_epi16(high, _mm_setr_epi16(256, 64, 16, 4, 256, 64, 16, 4)), 8);
+
+	return _mm_and_si128(_mm_packus_epi16(low, high), _mm_set1_epi8(3));
+}
+
+// The same for the 16 three bit indices in bytes 2 to 7 of a channel block, which can straddle two bytes.
+TARGET_SSE4 static inline __m128i UnpackIndices3(__m128i bits)
+{
+	__m128i low, high;
+
+	low = _mm_shuffle_epi8(bits, _mm_setr_epi8(2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5));
+	high = _mm_shuffle_epi8(bits, _mm_setr_epi8(5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, -1, 7, -1));
+	low = _mm_srli_epi16(_mm_mullo_epi16(low, _mm_setr_epi16(256, 32, 4, 128, 16, 2, 64, 8)), 8);
+	high = _mm_srli_epi16(_mm_mullo_epi16(high, _mm_setr_epi16(256, 32, 4, 128, 16, 2, 64, 8)), 8);
+
+	return _mm_and_si128(_mm_packus_epi16(low, high), _mm_set1_epi8(7));
+}
+
+// Interleaves four planes of 16 texels into four rows of RGBA.
+TARGET_SSE4 static inline void StoreTexels(__m128i red, __m128i green, __m128i blue, __m128i alpha, unsigned char* texels, int pitch)
+{
+	__m128i redGreen, blueAlpha;
+
+	redGreen = _mm_unpacklo_epi8(red, green);
+	blueAlpha = _mm_unpacklo_epi8(blue, alpha);
+	_mm_storeu_si128((__m128i*)texels, _mm_unpacklo_epi16(redGreen, blueAlpha));
+	_mm_storeu_si128((__m128i*)(texels + pitch), _mm_unpackhi_epi16(redGreen, blueAlpha));
+
+	redGreen = _mm_unpackhi_epi8(red, green);
+	blueAlpha = _mm_unpackhi_epi8(blue, alpha);
+	_mm_storeu_si128((__m128i*)(texels + 2 * pitch), _mm_unpacklo_epi16(redGreen, blueAlpha));
+	_mm_storeu_si128((__m128i*)(texels + 3 * pitch), _mm_unpackhi_epi16(redGreen, blueAlpha));
+
+	return;
+}
+
+TARGET_SSE4 static inline void ColorPlanes(const unsigned char* block, bool punchThrough, __m128i& red, __m128i& green, __m128i& blue, __m128i& alpha)
+{
+	unsigned char palette[16];
+	__m128i table, indices;
+
+	ColorPalette(block, punchThrough, palette);
+	table = _mm_loadu_si128((const __m128i*)palette);
+	indices = UnpackIndices2(_mm_cvtsi32_si128(LoadIndices(block)));
+
+	red = _mm_shuffle_epi8(table, indices);
+	green = _mm_shuffle_epi8(table, _mm_add_epi8(indices, _mm_set1_epi8(4)));
+	blue = _mm_shuffle_epi8(table, _mm_add_epi8(indices, _mm_set1_epi8(8)));
+	alpha = _mm_shuffle_epi8(table, _mm_add_epi8(indices, _mm_set1_epi8(12)));
+
+	return;
+}
+
+TARGET_SSE4 static inline __m128i ChannelPlane(const unsigned char* block)
+{
+	unsigned char palette[16];
+	__m128i bits;
+
+	ChannelPalette(block, palette);
+	bits = _mm_loadl_epi64((const __m128i*)block);
+
+	return _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*)palette), UnpackIndices3(bits));
+}
+
+TARGET_SSE4 static void DecodeBc1Sse4(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	__m128i red, green, blue, alpha;
+
+	ColorPlanes(block, true, red, green, blue, alpha);
+	StoreTexels(red, green, blue, alpha, texels, pitch);
+
+	return;
+}
+
+TARGET_SSE4 static void DecodeBc2Sse4(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	__m128i red, green, blue, alpha, nibbles;
+
+	ColorPlanes(block + 8, false, red, green, blue, alpha);
+
+	// Low and high nibbles interleaved are the texels in order, times 17 widens them to 8 bits.
+	nibbles = _mm_loadl_epi64((const __m128i*)block);
+	alpha = _mm_unpacklo_epi8(_mm_and_si128(nibbles, _mm_set1_epi8(0xF)), _mm_and_si128(_mm_srli_epi16(nibbles, 4), _mm_set1_epi8(0xF)));
+	alpha = _mm_or_si128(alpha, _mm_slli_epi16(alpha, 4));
+
+	StoreTexels(red, green, blue, alpha, texels, pitch);
+
+	return;
+}
+
+TARGET_SSE4 static void DecodeBc3Sse4(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	__m128i red, green, blue, alpha;
+
+	ColorPlanes(block + 8, false, red, green, blue, alpha);
+	alpha = ChannelPlane(block);
+	StoreTexels(red, green, blue, alpha, texels, pitch);
+
+	return;
+}
+
+TARGET_SSE4 static void DecodeBc4Sse4(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	StoreTexels(ChannelPlane(block), _mm_setzero_si128(), _mm_setzero_si128(), _mm_set1_epi8(-1), texels, pitch);
+
+	return;
+}
+
+TARGET_SSE4 static void DecodeBc5Sse4(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	StoreTexels(ChannelPlane(block), ChannelPlane(block + 8), _mm_setzero_si128(), _mm_set1_epi8(-1), texels, pitch);
+
+	return;
+}
+
+TARGET_SSE4 static void DecodeBc7Sse4(const unsigned char* block, unsigned char* texels, int pitch)
+{
+	Bc7BlockType parsed;
+	__m128i first, second, subsets, colorWeights, alphaWeights, spread, select, weights, rotation, low, high;
+	int row;
+
+	ParseBc7(block, parsed);
+	if (!parsed.valid)
+	{
+		for (row = 0; row < 4; row++)
+		{
+			_mm_storeu_si128((__m128i*)(texels + row * pitch), _mm_setzero_si128());
+		}
+		return;
+	}
+
+	first = _mm_loadu_si128((const __m128i*)parsed.endpoints[0]);
+	second = _mm_loadu_si128((const __m128i*)parsed.endpoints[1]);
+	subsets = _mm_loadu_si128((const __m128i*)parsed.subsets);
+	colorWeights = _mm_loadu_si128((const __m128i*)parsed.colorWeights);
+	alphaWeights = _mm_loadu_si128((const __m128i*)parsed.alphaWeights);
+
+	// Byte order after the swap of alpha with red, green or blue.
+	switch (parsed.rotation)
+	{
+	case 1:
+		rotation = _mm_setr_epi8(3, 1, 2, 0, 7, 5, 6, 4, 11, 9, 10, 8, 15, 13, 14, 12);
+		break;
+	case 2:
+		rotation = _mm_setr_epi8(0, 3, 2, 1, 4, 7, 6, 5, 8, 11, 10, 9, 12, 15, 14, 13);
+		break;
+	case 3:
+		rotation = _mm_setr_epi8(0, 1, 3, 2, 4, 5, 7, 6, 8, 9, 11, 10, 12, 13, 15, 14);
+		break;
+	default:
+		rotation = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		break;
+	}
+
+	for (row = 0; row < 4; row++)
+	{
+		// Spread each of the row's four texels over its four channels, pick its subset's endpoints and its
+		// color weight for red, green and blue and alpha weight for alpha.
+		spread = _mm_add_epi8(_mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3), _mm_set1_epi8((char)(row * 4)));
+		select = _mm_add_epi8(_mm_slli_epi16(_mm_shuffle_epi8(subsets, spread), 2), _mm_setr_epi8(0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3));
+		weights = _mm_blendv_epi8(_mm_shuffle_epi8(colorWeights, spread), _mm_shuffle_epi8(alphaWeights, spread),
+			_mm_setr_epi8(0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1));
+
+		low = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_set1_epi16(64), _mm_cvtepu8_epi16(weights)), _mm_cvtepu8_epi16(_mm_shuffle_epi8(first, select))),
+			_mm_mullo_epi16(_mm_cvtepu8_epi16(weights), _mm_cvtepu8_epi16(_mm_shuffle_epi8(second, select))));
+		high = _mm_add_epi16(_mm_mullo_epi16(_mm_sub_epi16(_mm_set1_epi16(64), _mm_cvtepu8_epi16(_mm_srli_si128(weights, 8))),
+			_mm_cvtepu8_epi16(_mm_srli_si128(_mm_shuffle_epi8(first, select), 8))),
+			_mm_mullo_epi16(_mm_cvtepu8_epi16(_mm_srli_si128(weights, 8)), _mm_cvtepu8_epi16(_mm_srli_si128(_mm_shuffle_epi8(second, select), 8))));
+		low = _mm_srli_epi16(_mm_add_epi16(low, _mm_set1_epi16(32)), 6);
+		high = _mm_srli_epi16(_mm_add_epi16(high, _mm_set1_epi16(32)), 6);
+
+		_mm_storeu_si128((__m128i*)(texels + row * pitch), _mm_shuffle_epi8(_mm_packus_epi16(low, high), rotation));
+	}
+
+	return;
+}
+
+// Two blocks side by side, the first in the low 128 bits of every register and the second in the high.
+TARGET_AVX2 static inline __m256i LoadPair(const unsigned char* first, const unsigned char* second, int size)
+{
+	if (size == 8)
+	{
+		return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadl_epi64((const __m128i*)first)), _mm_loadl_epi64((const __m128i*)second), 1);
+	}
+
+	return _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)first)), _mm_loadu_si128((const __m128i*)second), 1);
+}
+
+TARGET_AVX2 static inline __m256i UnpackIndices2Pair(__m256i bits)
+{
+	__m256i low, high, multiply;
+
+	low = _mm256_shuffle_epi8(bits, _mm256_setr_epi8(0, -1, 0, -1, 0, -1, 0, -1, 1, -1, 1, -1, 1, -1, 1, -1, 0, -1, 0, -1, 0, -1, 0, -1, 1, -1, 1, -1, 1, -1, 1, -1));
+	high = _mm256_shuffle_epi8(bits, _mm256_setr_epi8(2, -1, 2, -1, 2, -1, 2, -1, 3, -1, 3, -1, 3, -1, 3, -1, 2, -1, 2, -1, 2, -1, 2, -1, 3, -1, 3, -1, 3, -1, 3, -1));
+	multiply = _mm256_setr_epi16(256, 64, 16, 4, 256, 64, 16, 4, 256, 64, 16, 4, 256, 64, 16, 4);
+	low = _mm256_srli_epi16(_mm256_mullo_epi16(low, multiply), 8);
+	high = _mm256_srli_epi16(_mm256_mullo_epi16(high, multiply), 8);
+
+	return _mm256_and_si256(_mm256_packus_epi16(low, high), _mm256_set1_epi8(3));
+}
+
+TARGET_AVX2 static inline __m256i UnpackIndices3Pair(__m256i bits)
+{
+	__m256i low, high, multiply;
+
+	low = _mm256_shuffle_epi8(bits, _mm256_setr_epi8(2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5, 2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5));
+	high = _mm256_shuffle_epi8(bits, _mm256_setr_epi8(5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, -1, 7, -1, 5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, -1, 7, -1));
+	multiply = _mm256_setr_epi16(256, 32, 4, 128, 16, 2, 64, 8, 256, 32, 4, 128, 16, 2, 64, 8);
+	low = _mm256_srli_epi16(_mm256_mullo_epi16(low, multiply), 8);
+	high = _mm256_srli_epi16(_mm256_mullo_epi16(high, multiply), 8);
+
+	return _mm256_and_si256(_mm256_packus_epi16(low, high), _mm256_set1_epi8(7));
+}
+
+// Each row store covers the row of both blocks, eight texels.
+TARGET_AVX2 static inline void StoreTexelsPair(__m256i red, __m256i green, __m256i blue, __m256i alpha, unsigned char* texels, int pitch)
+{
+	__m256i redGreen, blueAlpha;
+
+	redGreen = _mm256_unpacklo_epi8(red, green);
+	blueAlpha = _mm256_unpacklo_epi8(blue, alpha);
+	_mm256_storeu_si256((__m256i*)texels, _mm256_unpacklo_epi16(redGreen, blueAlpha));
+	_mm256_storeu_si256((__m256i*)(texels + pitch), _mm256_unpackhi_epi16(redGreen, blueAlpha));
+
+	redGreen = _mm256_unpackhi_epi8(red, green);
+	blueAlpha = _mm256_unpackhi_epi8(blue, alpha);
+	_mm256_storeu_si256((__m256i*)(texels + 2 * pitch), _mm256_unpacklo_epi16(redGreen, blueAlpha));
+	_mm256_storeu_si256((__m256i*)(texels + 3 * pitch), _mm256_unpackhi_epi16(redGreen, blueAlpha));
+
+	return;
+}
+
+TARGET_AVX2 static inline void ColorPlanesPair(const unsigned char* first, const unsigned char* second, bool punchThrough, __m256i& red, __m256i& green, __m256i& blue,
+	__m256i& alpha)
+{
+	unsigned char palette[32];
+	__m256i table, indices;
+
+	ColorPalette(first, punchThrough, palette);
+	ColorPalette(second, punchThrough, palette + 16);
+	table = _mm256_loadu_si256((const __m256i*)palette);
+	indices = UnpackIndices2Pair(_mm256_inserti128_si256(_mm256_castsi128_si256(_mm_cvtsi32_si128(LoadIndices(first))), _mm_cvtsi32_si128(LoadIndices(second)), 1));
+
+	red = _mm256_shuffle_epi8(table, indices);
+	green = _mm256_shuffle_epi8(table, _mm256_add_epi8(indices, _mm256_set1_epi8(4)));
+	blue = _mm256_shuffle_epi8(table, _mm256_add_epi8(indices, _mm256_set1_epi8(8)));
+	alpha = _mm256_shuffle_epi8(table, _mm256_add_epi8(indices, _mm256_set1_epi8(12)));
+
+	return;
+}
+
+TARGET_AVX2 static inline __m256i ChannelPlanePair(const unsigned char* first, const unsigned char* second)
+{
+	unsigned char palette[32];
+
+	ChannelPalette(first, palette);
+	ChannelPalette(second, palette + 16);
+
+	return _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i*)palette), UnpackIndices3Pair(LoadPair(first, second, 8)));
+}
+
+TARGET_AVX2 static void DecodeBc1Avx2(const unsigned char* blocks, unsigned char* texels, int pitch)
+{
+	__m256i red, green, blue, alpha;
+
+	ColorPlanesPair(blocks, blocks + 8, true, red, green, blue, alpha);
+	StoreTexelsPair(red, green, blue, alpha, texels, pitch);
+	_mm256_zeroupper();
+
+	return;
+}
+
+TARGET_AVX2 static void DecodeBc2Avx2(const unsigned char* blocks, unsigned char* texels, int pitch)
+{
+	__m256i red, green, blue, alpha, nibbles;
+
+	ColorPlanesPair(blocks + 8, blocks + 24, false, red, green, blue, alpha);
+
+	nibbles = LoadPair(blocks, blocks + 16, 8);
+	alpha = _mm256_unpacklo_epi8(_mm256_and_si256(nibbles, _mm256_set1_epi8(0xF)), _mm256_and_si256(_mm256_srli_epi16(nibbles, 4), _mm256_set1_epi8(0xF)));
+	alpha = _mm256_or_si256(alpha, _mm256_slli_epi16(alpha, 4));
+
+	StoreTexelsPair(red, green, blue, alpha, texels, pitch);
+	_mm256_zeroupper();
+
+	return;
+}
+
+TARGET_AVX2 static void DecodeBc3Avx2(const unsigned char* blocks, unsigned char* texels, int pitch)
+{
+	__m256i red, green, blue, alpha;
+
+	ColorPlanesPair(blocks + 8, blocks + 24, false, red, green, blue, alpha);
+	alpha = ChannelPlanePair(blocks, blocks + 16);
+	StoreTexelsPair(red, green, blue, alpha, texels, pitch);
+	_mm256_zeroupper();
+
+	return;
+}
+
+TARGET_AVX2 static void DecodeBc4Avx2(const unsigned char* blocks, unsigned char* texels, int pitch)
+{
+	StoreTexelsPair(ChannelPlanePair(blocks, blocks + 8), _mm256_setzero_si256(), _mm256_setzero_si256(), _mm256_set1_epi8(-1), texels, pitch);
+	_mm256_zeroupper();
+
+	return;
+}
+
+TARGET_AVX2 static void DecodeBc5Avx2(const unsigned char* blocks, unsigned char* texels, int pitch)
+{
+	StoreTexelsPair(ChannelPlanePair(blocks, blocks + 16), ChannelPlanePair(blocks + 8, blocks + 24), _mm256_setzero_si256(), _mm256_set1_epi8(-1), texels, pitch);
+	_mm256_zeroupper();
+
+	return;
+}
+#endif
+
+BlockDecoderClass::BlockDecoderClass()
+{
+	m_blockFunction = 0;
+	m_pairFunction = 0;
+	m_blockBytes = 0;
+	m_threadCount = 1;
+	m_kernel = BLOCK_KERNEL_SCALAR;
+}
+
+BlockDecoderClass::BlockDecoderClass(const BlockDecoderClass& other)
+{
+}
+
+BlockDecoderClass::~BlockDecoderClass()
+{
+}
+
+bool BlockDecoderClass::Initialize(int threadCount, int kernel)
+{
+	m_threadCount = (threadCount > 0) ? threadCount : 1;
+
+	// Use the kernel asked for, or the best one below it the processor has.
+	m_kernel = GetSupportedKernel();
+	if (kernel < m_kernel)
+	{
+		m_kernel = (kernel > BLOCK_KERNEL_SCALAR) ? kernel : BLOCK_KERNEL_SCALAR;
+	}
+
+	return true;
+}
+
+void BlockDecoderClass::Shutdown()
+{
+	// Release the row list.
+	vector<RowType>().swap(m_rows);
+
+	return;
+}
+
+bool BlockDecoderClass::Decode(DdsFileClass* dds, int mip, int item, unsigned char* texels, int pitch)
+{
+	DdsFileClass::SurfaceType surface;
+	bool result;
+
+	// Only 2D surfaces of the formats there are kernels for.
+	result = dds->GetDimension() == 2 && SelectFunctions(dds->GetFormat()) && dds->GetSurface(mip, item, surface);
+	if (!result)
+	{
+		return false;
+	}
+
+	m_rows.clear();
+	AddRows(surface, texels, pitch);
+	RunRanges((int)m_rows.size());
+
+	return true;
+}
+
+bool BlockDecoderClass::DecodeMipChain(DdsFileClass* dds, int item, vector<unsigned char>& texels)
+{
+	DdsFileClass::SurfaceType surface;
+	size_t offset;
+	int mip;
+
+	if (dds->GetDimension() != 2 || !SelectFunctions(dds->GetFormat()) || item < 0 || item >= dds->GetArraySize())
+	{
+		return false;
+	}
+
+	// The levels follow one another, each with rows of width * 4 bytes.
+	offset = 0;
+	for (mip = 0; mip < dds->GetMipCount(); mip++)
+	{
+		dds->GetSurface(mip, item, surface);
+		offset += (size_t)surface.width * surface.height * 4;
+	}
+	texels.resize(offset);
+
+	// Every row of blocks of every level is one job.
+	m_rows.clear();
+	offset = 0;
+	for (mip = 0; mip < dds->GetMipCount(); mip++)
+	{
+		dds->GetSurface(mip, item, surface);
+		AddRows(surface, &texels[offset], (int)surface.width * 4);
+		offset += (size_t)surface.width * surface.height * 4;
+	}
+	RunRanges((int)m_rows.size());
+
+	return true;
+}
+
+int BlockDecoderClass::GetKernel()
+{
+	return m_kernel;
+}
+
+bool BlockDecoderClass::IsSupported(unsigned int format)
+{
+	switch (format)
+	{
+	case DDS_FORMAT_BC1_UNORM:
+	case DDS_FORMAT_BC1_UNORM_SRGB:
+	case DDS_FORMAT_BC2_UNORM:
+	case DDS_FORMAT_BC2_UNORM_SRGB:
+	case DDS_FORMAT_BC3_UNORM:
+	case DDS_FORMAT_BC3_UNORM_SRGB:
+	case DDS_FORMAT_BC4_UNORM:
+	case DDS_FORMAT_BC5_UNORM:
+	case DDS_FORMAT_BC7_UNORM:
+	case DDS_FORMAT_BC7_UNORM_SRGB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+int BlockDecoderClass::GetSupportedKernel()
+{
+#ifdef BLOCK_SIMD
+#ifdef _MSC_VER
+	int info[4];
+	bool sse4, avx;
+
+	// SSSE3 and SSE4.1, and AVX with its registers saved by the OS before AVX2 counts.
+	__cpuid(info, 0);
+	if (info[0] < 1)
+	{
+		return BLOCK_KERNEL_SCALAR;
+	}
+
+	__cpuid(info, 1);
+	sse4 = (info[2] & (1 << 9)) && (info[2] & (1 << 19));
+	avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+	if (!sse4)
+	{
+		return BLOCK_KERNEL_SCALAR;
+	}
+
+	__cpuid(info, 0);
+	if (avx && info[0] >= 7)
+	{
+		__cpuidex(info, 7, 0);
+		if (info[1] & (1 << 5))
+		{
+			return BLOCK_KERNEL_AVX2;
+		}
+	}
+
+	return BLOCK_KERNEL_SSE4;
+#else
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx2"))
+	{
+		return BLOCK_KERNEL_AVX2;
+	}
+	if (__builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3"))
+	{
+		return BLOCK_KERNEL_SSE4;
+	}
+
+	return BLOCK_KERNEL_SCALAR;
+#endif
+#else
+	return BLOCK_KERNEL_SCALAR;
+#endif
+}
+
+void BlockDecoderClass::DecodeBlock(unsigned int format, const unsigned char* block, unsigned char* texels, int pitch)
+{
+	// The scalar reference every kernel is checked against, unknown formats decode to zero.
+	switch (format)
+	{
+	case DDS_FORMAT_BC1_UNORM:
+	case DDS_FORMAT_BC1_UNORM_SRGB:
+		DecodeBc1Scalar(block, texels, pitch);
+		break;
+	case DDS_FORMAT_BC2_UNORM:
+	case DDS_FORMAT_BC2_UNORM_SRGB:
+		DecodeBc2Scalar(block, texels, pitch);
+		break;
+	case DDS_FORMAT_BC3_UNORM:
+	case DDS_FORMAT_BC3_UNORM_SRGB:
+		DecodeBc3Scalar(block, texels, pitch);
+		break;
+	case DDS_FORMAT_BC4_UNORM:
+		DecodeBc4Scalar(block, texels, pitch);
+		break;
+	case DDS_FORMAT_BC5_UNORM:
+		DecodeBc5Scalar(block, texels, pitch);
+		break;
+	case DDS_FORMAT_BC7_UNORM:
+	case DDS_FORMAT_BC7_UNORM_SRGB:
+		DecodeBc7Scalar(block, texels, pitch);
+		break;
+	default:
+		memset(texels, 0, 16);
+		memset(texels + pitch, 0, 16);
+		memset(texels + 2 * pitch, 0, 16);
+		memset(texels + 3 * pitch, 0, 16);
+		break;
+	}
+
+	return;
+}
+
+// The two subset partitions and anchors, and the index weights, for the encoder to pack blocks this decodes.
+unsigned short BlockDecoderClass::GetBc7Partition(int partition)
+{
+	return BC7_PARTITIONS2[partition & 63];
+}
+
+int BlockDecoderClass::GetBc7Anchor(int partition)
+{
+	return BC7_ANCHORS2[partition & 63];
+}
+
+const unsigned char* BlockDecoderClass::GetBc7Weights(int indexBits)
+{
+	if (indexBits == 2)
+	{
+		return BC7_WEIGHTS2;
+	}
+	if (indexBits == 3)
+	{
+		return BC7_WEIGHTS3;
+	}
+
+	return BC7_WEIGHTS4;
+}
+
+bool BlockDecoderClass::SelectFunctions(unsigned int format)
+{
+	if (!IsSupported(format))
+	{
+		return false;
+	}
+
+	m_blockBytes = (format == DDS_FORMAT_BC1_UNORM || format == DDS_FORMAT_BC1_UNORM_SRGB || format == DDS_FORMAT_BC4_UNORM) ? 8 : 16;
+	m_pairFunction = 0;
+
+	switch (format)
+	{
+	case DDS_FORMAT_BC1_UNORM:
+	case DDS_FORMAT_BC1_UNORM_SRGB:
+		m_blockFunction = DecodeBc1Scalar;
+#ifdef BLOCK_SIMD
+		m_blockFunction = (m_kernel >= BLOCK_KERNEL_SSE4) ? DecodeBc1Sse4 : m_blockFunction;
+		m_pairFunction = (m_kernel >= BLOCK_KERNEL_AVX2) ? DecodeBc1Avx2 : 0;
+#endif
+		break;
+	case DDS_FORMAT_BC2_UNORM:
+	case DDS_FORMAT_BC2_UNORM_SRGB:
+		m_blockFunction = DecodeBc2Scalar;
+#ifdef BLOCK_SIMD
+		m_blockFunction = (m_kernel >= BLOCK_KERNEL_SSE4) ? DecodeBc2Sse4 : m_blockFunction;
+		m_pairFunction = (m_kernel >= BLOCK_KERNEL_AVX2) ? DecodeBc2Avx2 : 0;
+#endif
+		break;
+	case DDS_FORMAT_BC3_UNORM:
+	case DDS_FORMAT_BC3_UNORM_SRGB:
+		m_blockFunction = DecodeBc3Scalar;
+#ifdef BLOCK_SIMD
+		m_blockFunction = (m_kernel >= BLOCK_KERNEL_SSE4) ? DecodeBc3Sse4 : m_blockFunction;
+		m_pairFunction = (m_kernel >= BLOCK_KERNEL_AVX2) ? DecodeBc3Avx2 : 0;
+#endif
+		break;
+	case DDS_FORMAT_BC4_UNORM:
+		m_blockFunction = DecodeBc4Scalar;
+#ifdef BLOCK_SIMD
+		m_blockFunction = (m_kernel >= BLOCK_KERNEL_SSE4) ? DecodeBc4Sse4 : m_blockFunction;
+		m_pairFunction = (m_kernel >= BLOCK_KERNEL_AVX2) ? DecodeBc4Avx2 : 0;
+#endif
+		break;
+	case DDS_FORMAT_BC5_UNORM:
+		m_blockFunction = DecodeBc5Scalar;
+#ifdef BLOCK_SIMD
+		m_blockFunction = (m_kernel >= BLOCK_KERNEL_SSE4) ? DecodeBc5Sse4 : m_blockFunction;
+		m_pairFunction = (m_kernel >= BLOCK_KERNEL_AVX2) ? DecodeBc5Avx2 : 0;
+#endif
+		break;
+	default:
+		// BC7 spends its time unpacking the block in scalar code, so it has no two block kernel.
+		m_blockFunction = DecodeBc7Scalar;
+#ifdef BLOCK_SIMD
+		m_blockFunction = (m_kernel >= BLOCK_KERNEL_SSE4) ? DecodeBc7Sse4 : m_blockFunction;
+#endif
+		break;
+	}
+
+	return true;
+}
+
+void BlockDecoderClass::AddRows(const DdsFileClass::SurfaceType& surface, unsigned char* texels, int pitch)
+{
+	RowType row;
+	unsigned int blockRow;
+
+	for (blockRow = 0; blockRow < surface.rowCount; blockRow++)
+	{
+		row.blocks = (const unsigned char*)surface.data + (size_t)blockRow * surface.rowPitch;
+		row.texels = texels + (size_t)blockRow * 4 * pitch;
+		row.width = (int)surface.width;
+		row.height = ((int)surface.height - (int)blockRow * 4 < 4) ? (int)surface.height - (int)blockRow * 4 : 4;
+		row.pitch = pitch;
+		m_rows.push_back(row);
+	}
+
+	return;
+}
+
+void BlockDecoderClass::DecodeRows(int begin, int end)
+{
+	unsigned char scratch[64];
+	const RowType* row;
+	const unsigned char* block;
+	int i, x, y, count;
+
+	for (i = begin; i < end; i++)
+	{
+		row = &m_rows[i];
+		for (x = 0; x < row->width; x += 4)
+		{
+			block = row->blocks + (x / 4) * m_blockBytes;
+
+			// Whole blocks are written in place, two at a time where there is a kernel for it.
+			if (m_pairFunction && row->height == 4 && x + 8 <= row->width)
+			{
+				m_pairFunction(block, row->texels + x * 4, row->pitch);
+				x += 4;
+			}
+			else if (row->height == 4 && x + 4 <= row->width)
+			{
+				m_blockFunction(block, row->texels + x * 4, row->pitch);
+			}
+			else
+			{
+				// A block over the right or bottom edge of a level is cut to the texels inside it.
+				m_blockFunction(block, scratch, 16);
+				count = (row->width - x < 4) ? row->width - x : 4;
+				for (y = 0; y < row->height; y++)
+				{
+					memcpy(row->texels + y * row->pitch + x * 4, scratch + y * 16, count * 4);
+				}
+			}
+		}
+	}
+
+	return;
+}
+
+void BlockDecoderClass::RunRanges(int count)
+{
+	RangeType* ranges;
+	thread* threads;
+	int rangeCount, i;
+
+	// Small jobs run on the calling thread only.
+	rangeCount = count / MIN_RANGE_ROWS + 1;
+	if (rangeCount > m_threadCount)
+	{
+		rangeCount = m_threadCount;
+	}
+
+	ranges = new RangeType[rangeCount];
+	if (!ranges)
+	{
+		return;
+	}
+
+	for (i = 0; i < rangeCount; i++)
+	{
+		ranges[i].decoder = this;
+		ranges[i].begin = (int)((long long)count * i / rangeCount);
+		ranges[i].end = (int)((long long)count * (i + 1) / rangeCount);
+	}
+
+	// Run every range but the first on a worker thread, and the first one here.
+	threads = 0;
+	if (rangeCount > 1)
+	{
+		threads = new thread[rangeCount - 1];
+		for (i = 1; i < rangeCount; i++)
+		{
+			threads[i - 1] = thread(DecodeRange, &ranges[i]);
+		}
+	}
+
+	DecodeRange(&ranges[0]);
+
+	if (threads)
+	{
+		for (i = 0; i < rangeCount - 1; i++)
+		{
+			threads[i].join();
+		}
+		delete[] threads;
+		threads = 0;
+	}
+
+	delete[] ranges;
+	ranges = 0;
+
+	return;
+}
+
+void BlockDecoderClass::DecodeRange(RangeType* range)
+{
+	range->decoder->DecodeRows(range->begin, range->end);
+
+	return;
+}
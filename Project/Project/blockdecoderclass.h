@@ -0,0 +1,75 @@
+#pragma once
+
+#ifndef _BLOCKDECODERCLASS_H_
+#define _BLOCKDECODERCLASS_H_
+
+#include <vector>
+
+#include "ddsfileclass.h"
+using namespace std;
+
+// Kernels the decoder has, Initialize falls back to the best one the processor runs.
+const int BLOCK_KERNEL_SCALAR = 0;
+const int BLOCK_KERNEL_SSE4 = 1;
+const int BLOCK_KERNEL_AVX2 = 2;
+
+// Decodes block compressed surfaces (BC1, BC2, BC3, BC4, BC5 and BC7, unorm and srgb) to 8 bit RGBA on the
+// CPU, for code that reads texels without a device. BC4 decodes to (r, 0, 0, 255) and BC5 to (r, g, 0, 255),
+// the way the shader sees them.
+// DecodeBlock is the scalar reference. The SSE4 kernels build each block's palette the same way and then
+// look up and interleave all 16 texels with byte shuffles, the AVX2 ones do two neighbouring blocks per
+// register. BC7 unpacks its modes, partitions and indices in scalar code and interpolates in SIMD. Every
+// kernel gives the same bytes as the reference.
+// A surface is split by rows of blocks, a whole mip chain as one job so the small levels do not wait on
+// their own thread.
+class BlockDecoderClass
+{
+private:
+	struct RowType
+	{
+		const unsigned char* blocks;
+		unsigned char* texels;
+		int width, height, pitch;
+	};
+
+	struct RangeType
+	{
+		BlockDecoderClass* decoder;
+		int begin, end;
+	};
+
+	typedef void (*BlockFunction)(const unsigned char*, unsigned char*, int);
+
+public:
+	BlockDecoderClass();
+	BlockDecoderClass(const BlockDecoderClass&);
+	~BlockDecoderClass();
+
+	bool Initialize(int, int);
+	void Shutdown();
+
+	bool Decode(DdsFileClass*, int, int, unsigned char*, int);
+	bool DecodeMipChain(DdsFileClass*, int, vector<unsigned char>&);
+	int GetKernel();
+
+	static bool IsSupported(unsigned int);
+	static int GetSupportedKernel();
+	static void DecodeBlock(unsigned int, const unsigned char*, unsigned char*, int);
+	static unsigned short GetBc7Partition(int);
+	static int GetBc7Anchor(int);
+	static const unsigned char* GetBc7Weights(int);
+
+private:
+	bool SelectFunctions(unsigned int);
+	void AddRows(const DdsFileClass::SurfaceType&, unsigned char*, int);
+	void DecodeRows(int, int);
+	void RunRanges(int);
+
+	static void DecodeRange(RangeType*);
+
+private:
+	vector<RowType> m_rows;
+	BlockFunction m_blockFunction, m_pairFunction;
+	int m_blockBytes, m_threadCount, m_kernel;
+};
+#endif
@@ -0,0 +1,1182 @@
+#include "blockencoderclass.h"
+
+#include <math.h>
+#include <string.h>
+#include <thread>
+
+#include "blockdecoderclass.h"
+
+// Rows of blocks below which a range is not worth a thread. Encoding a row costs far more than decoding it.
+static const int MIN_RANGE_ROWS = 4;
+
+// Power iterations for the principal axis of a block's colors.
+static const int AXIS_ITERATIONS = 8;
+
+// Two subset partitions BC7 tries at normal and high quality, the ones whose texels lie closest to two lines.
+static const int BC7_PARTITIONS_NORMAL = 4;
+static const int BC7_PARTITIONS_HIGH = 16;
+
+// BC7 modes the encoder writes: mode, subsets, color bits, alpha bits, p-bit per endpoint, shared p-bit,
+// index bits.
+struct Bc7ModeType
+{
+	int mode, subsetCount, colorBits, alphaBits, endpointPBits, sharedPBits, indexBits;
+};
+
+static const Bc7ModeType BC7_MODE1 = { 1, 2, 6, 0, 0, 1, 3 };
+static const Bc7ModeType BC7_MODE3 = { 3, 2, 7, 0, 1, 0, 2 };
+static const Bc7ModeType BC7_MODE6 = { 6, 1, 7, 7, 1, 0, 4 };
+
+// One fitted BC7 subset: the endpoint codes without their p-bits, the p-bits, and the index of every texel
+// in the subset.
+struct Bc7SubsetType
+{
+	unsigned int codes[2][4];
+	unsigned int pBits[2];
+	unsigned char indices[16];
+	int error;
+};
+
+// Mean and unit principal axis of the texels in the mask over the first channels, the axis is zero when
+// they are all the same. Returns the spread along the axis, the largest eigenvalue of the covariance.
+static float PrincipalAxis(const unsigned char (*pixels)[4], unsigned int mask, int channelCount, float* mean, float* axis, float* spread)
+{
+	float covariance[4][4], next[4], difference[4], largest, length, along;
+	int count, i, j, k, iteration;
+
+	memset(mean, 0, sizeof(float) * 4);
+	memset(axis, 0, sizeof(float) * 4);
+	memset(covariance, 0, sizeof(covariance));
+	*spread = 0.0f;
+
+	count = 0;
+	for (i = 0; i < 16; i++)
+	{
+		if (mask & (1 << i))
+		{
+			for (j = 0; j < channelCount; j++)
+			{
+				mean[j] += pixels[i][j];
+			}
+			count++;
+		}
+	}
+	if (count == 0)
+	{
+		return 0.0f;
+	}
+
+	for (j = 0; j < channelCount; j++)
+	{
+		mean[j] /= (float)count;
+	}
+
+	for (i = 0; i < 16; i++)
+	{
+		if (mask & (1 << i))
+		{
+			for (j = 0; j < channelCount; j++)
+			{
+				difference[j] = pixels[i][j] - mean[j];
+			}
+			for (j = 0; j < channelCount; j++)
+			{
+				for (k = 0; k < channelCount; k++)
+				{
+					covariance[j][k] += difference[j] * difference[k];
+				}
+			}
+		}
+	}
+
+	// Start from the row of the channel that varies most, it is never orthogonal to the axis.
+	k = 0;
+	for (j = 0; j < channelCount; j++)
+	{
+		*spread += covariance[j][j];
+		k = (covariance[j][j] > covariance[k][k]) ? j : k;
+	}
+	for (j = 0; j < channelCount; j++)
+	{
+		axis[j] = covariance[k][j];
+	}
+
+	for (iteration = 0; iteration < AXIS_ITERATIONS; iteration++)
+	{
+		largest = 0.0f;
+		for (j = 0; j < channelCount; j++)
+		{
+			next[j] = 0.0f;
+			for (k = 0; k < channelCount; k++)
+			{
+				next[j] += covariance[j][k] * axis[k];
+			}
+			largest = (fabsf(next[j]) > largest) ? fabsf(next[j]) : largest;
+		}
+		if (largest == 0.0f)
+		{
+			memset(axis, 0, sizeof(float) * 4);
+			return 0.0f;
+		}
+		for (j = 0; j < channelCount; j++)
+		{
+			axis[j] = next[j] / largest;
+		}
+	}
+
+	length = 0.0f;
+	for (j = 0; j < channelCount; j++)
+	{
+		length += axis[j] * axis[j];
+	}
+	length = sqrtf(length);
+	for (j = 0; j < channelCount; j++)
+	{
+		axis[j] /= length;
+	}
+
+	along = 0.0f;
+	for (j = 0; j < channelCount; j++)
+	{
+		for (k = 0; k < channelCount; k++)
+		{
+			along += axis[j] * covariance[j][k] * axis[k];
+		}
+	}
+
+	return along;
+}
+
+// The two ends of the texels in the mask along the axis through their mean, clamped to the 8 bit range.
+static void AxisEnds(const unsigned char (*pixels)[4], unsigned int mask, int channelCount, float* start, float* end)
+{
+	float mean[4], axis[4], spread, projection, low, high;
+	int i, j;
+
+	PrincipalAxis(pixels, mask, channelCount, mean, axis, &spread);
+
+	low = 0.0f;
+	high = 0.0f;
+	for (i = 0; i < 16; i++)
+	{
+		if (mask & (1 << i))
+		{
+			projection = 0.0f;
+			for (j = 0; j < channelCount; j++)
+			{
+				projection += (pixels[i][j] - mean[j]) * axis[j];
+			}
+			low = (projection < low) ? projection : low;
+			high = (projection > high) ? projection : high;
+		}
+	}
+
+	for (j = 0; j < 4; j++)
+	{
+		start[j] = (j < channelCount) ? mean[j] + axis[j] * low : 255.0f;
+		end[j] = (j < channelCount) ? mean[j] + axis[j] * high : 255.0f;
+		start[j] = (start[j] < 0.0f) ? 0.0f : ((start[j] > 255.0f) ? 255.0f : start[j]);
+		end[j] = (end[j] < 0.0f) ? 0.0f : ((end[j] > 255.0f) ? 255.0f : end[j]);
+	}
+
+	return;
+}
+
+// What is left of the spread of the texels in the mask once their principal axis is taken out, how badly
+// a line fits them.
+static float LineResidual(const unsigned char (*pixels)[4], unsigned int mask, int channelCount)
+{
+	float mean[4], axis[4], spread, along;
+
+	along = PrincipalAxis(pixels, mask, channelCount, mean, axis, &spread);
+
+	return spread - along;
+}
+
+static unsigned int PackColor(const float* color)
+{
+	int red, green, blue;
+
+	red = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+	green = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+	blue = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+
+	return ((unsigned int)red << 11) | ((unsigned int)green << 5) | (unsigned int)blue;
+}
+
+// The four RGB colors BlockDecoderClass decodes for two 565 endpoints, in the four or three color mode.
+static void ColorPalette(unsigned int first, unsigned int second, bool threeColor, int (*palette)[3])
+{
+	int channel;
+
+	palette[0][0] = (int)(((first >> 11) << 3) | (first >> 13));
+	palette[1][0] = (int)(((second >> 11) << 3) | (second >> 13));
+	palette[0][1] = (int)((((first >> 5) & 0x3F) << 2) | (((first >> 5) & 0x3F) >> 4));
+	palette[1][1] = (int)((((second >> 5) & 0x3F) << 2) | (((second >> 5) & 0x3F) >> 4));
+	palette[0][2] = (int)(((first & 0x1F) << 3) | ((first & 0x1F) >> 2));
+	palette[1][2] = (int)(((second & 0x1F) << 3) | ((second & 0x1F) >> 2));
+
+	for (channel = 0; channel < 3; channel++)
+	{
+		if (!threeColor)
+		{
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel] + 1) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel] + 1) / 3;
+		}
+		else
+		{
+			palette[2][channel] = (palette[0][channel] + palette[1][channel] + 1) / 2;
+			palette[3][channel] = 0;
+		}
+	}
+
+	return;
+}
+
+// Packs a BC1 color block from two endpoints in the order the mode needs, with the nearest palette color
+// for every texel, and returns the squared error. Transparent texels take the transparent black of the
+// three color mode, the others never do.
+static int FitColorBlock(const unsigned char (*pixels)[4], unsigned int transparent, const float* start, const float* end, bool threeColor, bool punchThrough,
+						 unsigned char* block)
+{
+	int palette[4][3];
+	unsigned int first, second, swap, indices;
+	int error, best, distance, difference, count, i, j, k;
+	bool three;
+
+	// Four colors need the first endpoint to be the larger, three the smaller.
+	first = PackColor(start);
+	second = PackColor(end);
+	if (threeColor ? (first > second) : (first < second))
+	{
+		swap = first;
+		first = second;
+		second = swap;
+	}
+
+	three = punchThrough && first <= second;
+	ColorPalette(first, second, three, palette);
+	count = three ? 3 : 4;
+
+	error = 0;
+	indices = 0;
+	for (i = 0; i < 16; i++)
+	{
+		if (transparent & (1 << i))
+		{
+			indices |= 3u << (2 * i);
+			continue;
+		}
+
+		best = 0x7FFFFFFF;
+		k = 0;
+		for (j = 0; j < count; j++)
+		{
+			distance = 0;
+			difference = pixels[i][0] - palette[j][0];
+			distance += difference * difference;
+			difference = pixels[i][1] - palette[j][1];
+			distance += difference * difference;
+			difference = pixels[i][2] - palette[j][2];
+			distance += difference * difference;
+			if (distance < best)
+			{
+				best = distance;
+				k = j;
+			}
+		}
+		indices |= (unsigned int)k << (2 * i);
+		error += best;
+	}
+
+	block[0] = (unsigned char)first;
+	block[1] = (unsigned char)(first >> 8);
+	block[2] = (unsigned char)second;
+	block[3] = (unsigned char)(second >> 8);
+	block[4] = (unsigned char)indices;
+	block[5] = (unsigned char)(indices >> 8);
+	block[6] = (unsigned char)(indices >> 16);
+	block[7] = (unsigned char)(indices >> 24);
+
+	return error;
+}
+
+// The endpoints that fit the texels best with the indices of a packed block, by least squares on each
+// channel. False when the indices do not pin the endpoints down.
+static bool RefitColor(const unsigned char (*pixels)[4], unsigned int transparent, const unsigned char* block, bool punchThrough, float* start, float* end)
+{
+	static const float fourWeights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+	static const float threeWeights[4] = { 1.0f, 0.0f, 0.5f, 0.0f };
+	const float* weights;
+	float aa, ab, bb, ax[3], bx[3], a, b, determinant;
+	unsigned int first, second, indices, index;
+	int i, j;
+	bool three;
+
+	first = (unsigned int)block[0] | ((unsigned int)block[1] << 8);
+	second = (unsigned int)block[2] | ((unsigned int)block[3] << 8);
+	indices = (unsigned int)block[4] | ((unsigned int)block[5] << 8) | ((unsigned int)block[6] << 16) | ((unsigned int)block[7] << 24);
+	three = punchThrough && first <= second;
+	weights = three ? threeWeights : fourWeights;
+
+	aa = 0.0f;
+	ab = 0.0f;
+	bb = 0.0f;
+	memset(ax, 0, sizeof(ax));
+	memset(bx, 0, sizeof(bx));
+	for (i = 0; i < 16; i++)
+	{
+		index = (indices >> (2 * i)) & 3;
+		if ((transparent & (1 << i)) || (three && index == 3))
+		{
+			continue;
+		}
+
+		a = weights[index];
+		b = 1.0f - a;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (j = 0; j < 3; j++)
+		{
+			ax[j] += a * pixels[i][j];
+			bx[j] += b * pixels[i][j];
+		}
+	}
+
+	determinant = aa * bb - ab * ab;
+	if (fabsf(determinant) < 1e-4f)
+	{
+		return false;
+	}
+
+	for (j = 0; j < 3; j++)
+	{
+		start[j] = (ax[j] * bb - bx[j] * ab) / determinant;
+		end[j] = (bx[j] * aa - ax[j] * ab) / determinant;
+		start[j] = (start[j] < 0.0f) ? 0.0f : ((start[j] > 255.0f) ? 255.0f : start[j]);
+		end[j] = (end[j] < 0.0f) ? 0.0f : ((end[j] > 255.0f) ? 255.0f : end[j]);
+	}
+
+	return true;
+}
+
+// Refits a packed color block to its own indices until that stops helping.
+static void RefineColor(const unsigned char (*pixels)[4], unsigned int transparent, bool threeColor, bool punchThrough, int iterations, unsigned char* block, int& error)
+{
+	unsigned char candidate[8];
+	float start[3], end[3];
+	int candidateError, i;
+
+	for (i = 0; i < iterations; i++)
+	{
+		if (!RefitColor(pixels, transparent, block, punchThrough, start, end))
+		{
+			return;
+		}
+
+		candidateError = FitColorBlock(pixels, transparent, start, end, threeColor, punchThrough, candidate);
+		if (candidateError >= error)
+		{
+			return;
+		}
+
+		memcpy(block, candidate, sizeof(candidate));
+		error = candidateError;
+	}
+
+	return;
+}
+
+// The color half of BC1, BC2 and BC3. Only BC1 has the three color mode and transparent texels.
+static void EncodeColor(const unsigned char (*pixels)[4], bool punchThrough, int quality, unsigned char* block)
+{
+	unsigned char candidate[8];
+	float start[4], end[4];
+	unsigned int transparent;
+	int error, candidateError, iterations, i;
+
+	transparent = 0;
+	for (i = 0; punchThrough && i < 16; i++)
+	{
+		transparent |= (pixels[i][3] < 128) ? (1u << i) : 0;
+	}
+
+	// Equal endpoints are the three color mode, every index the transparent black.
+	if (transparent == 0xFFFF)
+	{
+		memset(block, 0, 4);
+		memset(block + 4, 0xFF, 4);
+		return;
+	}
+
+	AxisEnds(pixels, ~transparent & 0xFFFF, 3, start, end);
+	error = FitColorBlock(pixels, transparent, start, end, transparent != 0, punchThrough, block);
+	if (quality == BLOCK_QUALITY_FAST)
+	{
+		return;
+	}
+
+	iterations = (quality == BLOCK_QUALITY_HIGH) ? 4 : 1;
+	RefineColor(pixels, transparent, transparent != 0, punchThrough, iterations, block, error);
+
+	// Three colors and black can beat four colors when the block has a third color off the line.
+	if (quality == BLOCK_QUALITY_HIGH && punchThrough && transparent == 0)
+	{
+		candidateError = FitColorBlock(pixels, transparent, start, end, true, punchThrough, candidate);
+		RefineColor(pixels, transparent, true, punchThrough, iterations, candidate, candidateError);
+		if (candidateError < error)
+		{
+			memcpy(block, candidate, sizeof(candidate));
+		}
+	}
+
+	return;
+}
+
+// Packs a BC3 alpha block from two endpoints, eight values when the first is the larger and six and the
+// extremes otherwise, with the nearest value for every texel, and returns the squared error.
+static int FitChannelBlock(const unsigned char* values, int first, int second, unsigned char* block)
+{
+	int palette[8];
+	unsigned long long indices;
+	int error, best, distance, i, j, k;
+
+	palette[0] = first;
+	palette[1] = second;
+	if (first > second)
+	{
+		for (i = 1; i < 7; i++)
+		{
+			palette[i + 1] = ((7 - i) * first + i * second + 3) / 7;
+		}
+	}
+	else
+	{
+		for (i = 1; i < 5; i++)
+		{
+			palette[i + 1] = ((5 - i) * first + i * second + 2) / 5;
+		}
+		palette[6] = 0;
+		palette[7] = 255;
+	}
+
+	error = 0;
+	indices = 0;
+	for (i = 0; i < 16; i++)
+	{
+		best = 0x7FFFFFFF;
+		k = 0;
+		for (j = 0; j < 8; j++)
+		{
+			distance = (values[i] - palette[j]) * (values[i] - palette[j]);
+			if (distance < best)
+			{
+				best = distance;
+				k = j;
+			}
+		}
+		indices |= (unsigned long long)k << (3 * i);
+		error += best;
+	}
+
+	block[0] = (unsigned char)first;
+	block[1] = (unsigned char)second;
+	for (i = 0; i < 6; i++)
+	{
+		block[2 + i] = (unsigned char)(indices >> (8 * i));
+	}
+
+	return error;
+}
+
+// The alpha half of BC3.
+static void EncodeChannel(const unsigned char* values, int quality, unsigned char* block)
+{
+	unsigned char candidate[8];
+	int low, high, innerLow, innerHigh, error, candidateError, first, second, i, j;
+
+	low = 255;
+	high = 0;
+	innerLow = 255;
+	innerHigh = 0;
+	for (i = 0; i < 16; i++)
+	{
+		low = (values[i] < low) ? values[i] : low;
+		high = (values[i] > high) ? values[i] : high;
+		if (values[i] != 0 && values[i] != 255)
+		{
+			innerLow = (values[i] < innerLow) ? values[i] : innerLow;
+			innerHigh = (values[i] > innerHigh) ? values[i] : innerHigh;
+		}
+	}
+
+	error = FitChannelBlock(values, high, low, block);
+	if (quality == BLOCK_QUALITY_FAST || error == 0)
+	{
+		return;
+	}
+
+	// Six values between the texels that are not 0 or 255, which the extremes then take exactly.
+	if ((low == 0 || high == 255) && innerLow <= innerHigh)
+	{
+		candidateError = FitChannelBlock(values, innerLow, innerHigh, candidate);
+		if (candidateError < error)
+		{
+			memcpy(block, candidate, sizeof(candidate));
+			error = candidateError;
+		}
+	}
+
+	// Pull the eight value endpoints in a little, the ends of the range are rarely the best ones.
+	if (quality == BLOCK_QUALITY_HIGH)
+	{
+		for (i = 0; i <= 4; i++)
+		{
+			for (j = 0; j <= 4; j++)
+			{
+				first = high - i;
+				second = low + j;
+				if (first <= second || (i == 0 && j == 0))
+				{
+					continue;
+				}
+
+				candidateError = FitChannelBlock(values, first, second, candidate);
+				if (candidateError < error)
+				{
+					memcpy(block, candidate, sizeof(candidate));
+					error = candidateError;
+				}
+			}
+		}
+	}
+
+	return;
+}
+
+// An 8 bit value expanded from a BC7 endpoint code with its p-bit appended, -1 for none, as the decoder does.
+static int Bc7Expand(unsigned int code, int bits, int pBit)
+{
+	if (pBit >= 0)
+	{
+		code = (code << 1) | (unsigned int)pBit;
+		bits++;
+	}
+
+	code <<= 8 - bits;
+
+	return (int)(code | (code >> bits));
+}
+
+// The code that expands nearest to an 8 bit value.
+static unsigned int Bc7Quantize(float value, int bits, int pBit)
+{
+	float scaled;
+	int guess, code, best, distance, bestDistance;
+
+	scaled = value * (float)((1 << (bits + (pBit >= 0 ? 1 : 0))) - 1) / 255.0f;
+	guess = (int)(((pBit >= 0) ? (scaled - (float)pBit) / 2.0f : scaled) + 0.5f);
+
+	best = 0;
+	bestDistance = 0x7FFFFFFF;
+	for (code = guess - 1; code <= guess + 1; code++)
+	{
+		if (code < 0 || code >= (1 << bits))
+		{
+			continue;
+		}
+
+		distance = Bc7Expand((unsigned int)code, bits, pBit) - (int)(value + 0.5f);
+		distance = distance * distance;
+		if (distance < bestDistance)
+		{
+			bestDistance = distance;
+			best = code;
+		}
+	}
+
+	return (unsigned int)best;
+}
+
+// Quantizes the endpoints of one subset with every p-bit choice the mode has, picks the nearest palette
+// entry for each texel in the mask, and keeps the choice with the least squared error. The entry nearest
+// the texel's projection onto the endpoints and its two neighbours are the only ones measured.
+static void QuantizeBc7Subset(const unsigned char (*pixels)[4], unsigned int mask, const Bc7ModeType& mode, const float* start, const float* end,
+							  Bc7SubsetType& fitted)
+{
+	const unsigned char* weights;
+	unsigned int codes[2][4], indices[16];
+	float direction[4], length, projection;
+	int expanded[2][4], palette[16][4], pBits[2], combination, combinationCount, indexCount, error, best, distance, difference, channelBits, i, j, k,
+		channel, side, nearest, first, last;
+
+	weights = BlockDecoderClass::GetBc7Weights(mode.indexBits);
+	indexCount = 1 << mode.indexBits;
+	combinationCount = mode.endpointPBits ? 4 : (mode.sharedPBits ? 2 : 1);
+
+	fitted.error = 0x7FFFFFFF;
+	for (combination = 0; combination < combinationCount; combination++)
+	{
+		pBits[0] = mode.endpointPBits ? (combination & 1) : (mode.sharedPBits ? combination : -1);
+		pBits[1] = mode.endpointPBits ? (combination >> 1) : pBits[0];
+
+		// Alpha stays opaque in the modes that have none.
+		for (side = 0; side < 2; side++)
+		{
+			for (channel = 0; channel < 4; channel++)
+			{
+				channelBits = (channel < 3) ? mode.colorBits : mode.alphaBits;
+				if (channelBits == 0)
+				{
+					codes[side][channel] = 0;
+					expanded[side][channel] = 255;
+					continue;
+				}
+
+				codes[side][channel] = Bc7Quantize(side ? end[channel] : start[channel], channelBits, pBits[side]);
+				expanded[side][channel] = Bc7Expand(codes[side][channel], channelBits, pBits[side]);
+			}
+		}
+
+		for (j = 0; j < indexCount; j++)
+		{
+			for (channel = 0; channel < 4; channel++)
+			{
+				palette[j][channel] = ((64 - weights[j]) * expanded[0][channel] + weights[j] * expanded[1][channel] + 32) >> 6;
+			}
+		}
+
+		length = 0.0f;
+		for (channel = 0; channel < 4; channel++)
+		{
+			direction[channel] = (float)(expanded[1][channel] - expanded[0][channel]);
+			length += direction[channel] * direction[channel];
+		}
+		length = (length > 0.0f) ? 64.0f / length : 0.0f;
+
+		error = 0;
+		for (i = 0; i < 16 && error < fitted.error; i++)
+		{
+			indices[i] = 0;
+			if (!(mask & (1 << i)))
+			{
+				continue;
+			}
+
+			projection = 0.0f;
+			for (channel = 0; channel < 4; channel++)
+			{
+				projection += (pixels[i][channel] - expanded[0][channel]) * direction[channel];
+			}
+			projection *= length;
+
+			nearest = 0;
+			while (nearest + 1 < indexCount && weights[nearest + 1] <= projection)
+			{
+				nearest++;
+			}
+			first = (nearest > 0) ? nearest - 1 : 0;
+			last = (nearest + 2 < indexCount) ? nearest + 2 : indexCount - 1;
+
+			best = 0x7FFFFFFF;
+			for (j = first; j <= last; j++)
+			{
+				distance = 0;
+				for (k = 0; k < 4; k++)
+				{
+					difference = pixels[i][k] - palette[j][k];
+					distance += difference * difference;
+				}
+				if (distance < best)
+				{
+					best = distance;
+					indices[i] = (unsigned int)j;
+				}
+			}
+			error += best;
+		}
+
+		if (error < fitted.error)
+		{
+			fitted.error = error;
+			memcpy(fitted.codes, codes, sizeof(codes));
+			fitted.pBits[0] = (pBits[0] >= 0) ? (unsigned int)pBits[0] : 0;
+			fitted.pBits[1] = (pBits[1] >= 0) ? (unsigned int)pBits[1] : 0;
+			for (i = 0; i < 16; i++)
+			{
+				fitted.indices[i] = (unsigned char)indices[i];
+			}
+		}
+	}
+
+	return;
+}
+
+// The endpoints that fit the texels in the mask best with their indices, by least squares.
+static bool RefitBc7Subset(const unsigned char (*pixels)[4], unsigned int mask, const Bc7ModeType& mode, const Bc7SubsetType& fitted, float* start, float* end)
+{
+	const unsigned char* weights;
+	float aa, ab, bb, ax[4], bx[4], a, b, determinant;
+	int channelCount, i, j;
+
+	weights = BlockDecoderClass::GetBc7Weights(mode.indexBits);
+	channelCount = mode.alphaBits ? 4 : 3;
+
+	aa = 0.0f;
+	ab = 0.0f;
+	bb = 0.0f;
+	memset(ax, 0, sizeof(ax));
+	memset(bx, 0, sizeof(bx));
+	for (i = 0; i < 16; i++)
+	{
+		if (!(mask & (1 << i)))
+		{
+			continue;
+		}
+
+		b = weights[fitted.indices[i]] / 64.0f;
+		a = 1.0f - b;
+		aa += a * a;
+		ab += a * b;
+		bb += b * b;
+		for (j = 0; j < channelCount; j++)
+		{
+			ax[j] += a * pixels[i][j];
+			bx[j] += b * pixels[i][j];
+		}
+	}
+
+	determinant = aa * bb - ab * ab;
+	if (fabsf(determinant) < 1e-4f)
+	{
+		return false;
+	}
+
+	for (j = 0; j < 4; j++)
+	{
+		start[j] = (j < channelCount) ? (ax[j] * bb - bx[j] * ab) / determinant : 255.0f;
+		end[j] = (j < channelCount) ? (bx[j] * aa - ax[j] * ab) / determinant : 255.0f;
+		start[j] = (start[j] < 0.0f) ? 0.0f : ((start[j] > 255.0f) ? 255.0f : start[j]);
+		end[j] = (end[j] < 0.0f) ? 0.0f : ((end[j] > 255.0f) ? 255.0f : end[j]);
+	}
+
+	return true;
+}
+
+// Fits one subset along its principal axis, then refits it to its own indices until that stops helping.
+static void FitBc7Subset(const unsigned char (*pixels)[4], unsigned int mask, const Bc7ModeType& mode, int refits, Bc7SubsetType& fitted)
+{
+	Bc7SubsetType candidate;
+	float start[4], end[4];
+	int i;
+
+	AxisEnds(pixels, mask, mode.alphaBits ? 4 : 3, start, end);
+	QuantizeBc7Subset(pixels, mask, mode, start, end, fitted);
+
+	for (i = 0; i < refits && fitted.error > 0; i++)
+	{
+		if (!RefitBc7Subset(pixels, mask, mode, fitted, start, end))
+		{
+			return;
+		}
+
+		QuantizeBc7Subset(pixels, mask, mode, start, end, candidate);
+		if (candidate.error >= fitted.error)
+		{
+			return;
+		}
+
+		fitted = candidate;
+	}
+
+	return;
+}
+
+static void WriteBits(unsigned long long* bits, int& position, unsigned int value, int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++, position++)
+	{
+		bits[position / 64] |= (unsigned long long)((value >> i) & 1) << (position % 64);
+	}
+
+	return;
+}
+
+// Writes a BC7 block in the layout ParseBc7 reads. The index of each subset's anchor texel loses its top
+// bit, so a subset whose anchor has it set swaps its endpoints and flips its indices first.
+static void PackBc7(const Bc7ModeType& mode, int partition, Bc7SubsetType* subsets, unsigned char* block)
+{
+	unsigned long long bits[2];
+	unsigned int swap, partitionMask;
+	int anchors[2], subsetOf[16], position, channel, channelBits, subset, side, highest, i;
+
+	partitionMask = (mode.subsetCount == 2) ? BlockDecoderClass::GetBc7Partition(partition) : 0;
+	anchors[0] = 0;
+	anchors[1] = (mode.subsetCount == 2) ? BlockDecoderClass::GetBc7Anchor(partition) : 0;
+	for (i = 0; i < 16; i++)
+	{
+		subsetOf[i] = (partitionMask >> i) & 1;
+	}
+
+	highest = (1 << mode.indexBits) - 1;
+	for (subset = 0; subset < mode.subsetCount; subset++)
+	{
+		if (subsets[subset].indices[anchors[subset]] <= highest / 2)
+		{
+			continue;
+		}
+
+		for (channel = 0; channel < 4; channel++)
+		{
+			swap = subsets[subset].codes[0][channel];
+			subsets[subset].codes[0][channel] = subsets[subset].codes[1][channel];
+			subsets[subset].codes[1][channel] = swap;
+		}
+		swap = subsets[subset].pBits[0];
+		subsets[subset].pBits[0] = subsets[subset].pBits[1];
+		subsets[subset].pBits[1] = swap;
+		for (i = 0; i < 16; i++)
+		{
+			if (subsetOf[i] == subset)
+			{
+				subsets[subset].indices[i] = (unsigned char)(highest - subsets[subset].indices[i]);
+			}
+		}
+	}
+
+	bits[0] = 0;
+	bits[1] = 0;
+	position = 0;
+	WriteBits(bits, position, 1u << mode.mode, mode.mode + 1);
+	if (mode.subsetCount == 2)
+	{
+		WriteBits(bits, position, (unsigned int)partition, 6);
+	}
+
+	// Endpoints a channel at a time, then their p-bits, then the indices.
+	for (channel = 0; channel < 4; channel++)
+	{
+		channelBits = (channel < 3) ? mode.colorBits : mode.alphaBits;
+		for (subset = 0; subset < mode.subsetCount; subset++)
+		{
+			for (side = 0; side < 2; side++)
+			{
+				WriteBits(bits, position, subsets[subset].codes[side][channel], channelBits);
+			}
+		}
+	}
+
+	for (subset = 0; subset < mode.subsetCount; subset++)
+	{
+		if (mode.endpointPBits)
+		{
+			WriteBits(bits, position, subsets[subset].pBits[0], 1);
+			WriteBits(bits, position, subsets[subset].pBits[1], 1);
+		}
+		else if (mode.sharedPBits)
+		{
+			WriteBits(bits, position, subsets[subset].pBits[0], 1);
+		}
+	}
+
+	for (i = 0; i < 16; i++)
+	{
+		WriteBits(bits, position, subsets[subsetOf[i]].indices[i], mode.indexBits - ((i == anchors[subsetOf[i]]) ? 1 : 0));
+	}
+
+	for (i = 0; i < 8; i++)
+	{
+		block[i] = (unsigned char)(bits[0] >> (8 * i));
+		block[8 + i] = (unsigned char)(bits[1] >> (8 * i));
+	}
+
+	return;
+}
+
+static void EncodeBc7(const unsigned char (*pixels)[4], int quality, unsigned char* block)
+{
+	static const Bc7ModeType* twoSubsetModes[2] = { &BC7_MODE1, &BC7_MODE3 };
+	Bc7SubsetType subsets[2];
+	float residuals[64];
+	int order[64], refits, partitionCount, modeCount, error, swap, mode, partition, i, j;
+	unsigned int mask;
+	bool opaque;
+
+	refits = (quality == BLOCK_QUALITY_FAST) ? 0 : ((quality == BLOCK_QUALITY_HIGH) ? 4 : 1);
+
+	// Mode 6, one subset with alpha and 4 bit indices, is the block every quality starts from.
+	FitBc7Subset(pixels, 0xFFFF, BC7_MODE6, refits, subsets[0]);
+	error = subsets[0].error;
+	PackBc7(BC7_MODE6, 0, subsets, block);
+
+	opaque = true;
+	for (i = 0; i < 16; i++)
+	{
+		opaque = opaque && pixels[i][3] == 255;
+	}
+	if (quality == BLOCK_QUALITY_FAST || !opaque || error == 0)
+	{
+		return;
+	}
+
+	// Rank the partitions by how well two lines fit their subsets, ties by number so the ranking is stable.
+	for (i = 0; i < 64; i++)
+	{
+		mask = BlockDecoderClass::GetBc7Partition(i);
+		residuals[i] = LineResidual(pixels, ~mask & 0xFFFF, 3) + LineResidual(pixels, mask, 3);
+		order[i] = i;
+	}
+
+	partitionCount = (quality == BLOCK_QUALITY_HIGH) ? BC7_PARTITIONS_HIGH : BC7_PARTITIONS_NORMAL;
+	for (i = 0; i < partitionCount; i++)
+	{
+		for (j = i + 1; j < 64; j++)
+		{
+			if (residuals[order[j]] < residuals[order[i]])
+			{
+				swap = order[i];
+				order[i] = order[j];
+				order[j] = swap;
+			}
+		}
+	}
+
+	// Mode 1 has 3 bit indices and 6 bit endpoints with a shared p-bit, mode 3 2 bit indices and 7 bit endpoints.
+	modeCount = (quality == BLOCK_QUALITY_HIGH) ? 2 : 1;
+	for (mode = 0; mode < modeCount; mode++)
+	{
+		for (i = 0; i < partitionCount; i++)
+		{
+			partition = order[i];
+			mask = BlockDecoderClass::GetBc7Partition(partition);
+			FitBc7Subset(pixels, ~mask & 0xFFFF, *twoSubsetModes[mode], refits, subsets[0]);
+			if (subsets[0].error >= error)
+			{
+				continue;
+			}
+
+			FitBc7Subset(pixels, mask, *twoSubsetModes[mode], refits, subsets[1]);
+			if (subsets[0].error + subsets[1].error < error)
+			{
+				error = subsets[0].error + subsets[1].error;
+				PackBc7(*twoSubsetModes[mode], partition, subsets, block);
+			}
+		}
+	}
+
+	return;
+}
+
+BlockEncoderClass::BlockEncoderClass()
+{
+	m_texels = 0;
+	m_blocks = 0;
+	m_format = DDS_FORMAT_UNKNOWN;
+	m_width = 0;
+	m_height = 0;
+	m_pitch = 0;
+	m_blockBytes = 0;
+	m_threadCount = 1;
+	m_quality = BLOCK_QUALITY_NORMAL;
+}
+
+BlockEncoderClass::BlockEncoderClass(const BlockEncoderClass& other)
+{
+}
+
+BlockEncoderClass::~BlockEncoderClass()
+{
+}
+
+bool BlockEncoderClass::Initialize(int threadCount, int quality)
+{
+	if (quality < BLOCK_QUALITY_FAST || quality > BLOCK_QUALITY_HIGH)
+	{
+		return false;
+	}
+
+	m_threadCount = (threadCount > 0) ? threadCount : 1;
+	m_quality = quality;
+
+	return true;
+}
+
+void BlockEncoderClass::Shutdown()
+{
+	m_texels = 0;
+	m_blocks = 0;
+
+	return;
+}
+
+bool BlockEncoderClass::Encode(unsigned int format, const unsigned char* texels, int width, int height, int pitch, unsigned char* blocks)
+{
+	if (!IsSupported(format) || width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	// The blocks are written row after row, as many as cover the surface.
+	m_format = format;
+	m_texels = texels;
+	m_blocks = blocks;
+	m_width = width;
+	m_height = height;
+	m_pitch = pitch;
+	m_blockBytes = (format == DDS_FORMAT_BC1_UNORM || format == DDS_FORMAT_BC1_UNORM_SRGB) ? 8 : 16;
+
+	RunRanges((height + 3) / 4);
+
+	return true;
+}
+
+int BlockEncoderClass::GetQuality()
+{
+	return m_quality;
+}
+
+bool BlockEncoderClass::IsSupported(unsigned int format)
+{
+	switch (format)
+	{
+	case DDS_FORMAT_BC1_UNORM:
+	case DDS_FORMAT_BC1_UNORM_SRGB:
+	case DDS_FORMAT_BC3_UNORM:
+	case DDS_FORMAT_BC3_UNORM_SRGB:
+	case DDS_FORMAT_BC7_UNORM:
+	case DDS_FORMAT_BC7_UNORM_SRGB:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void BlockEncoderClass::EncodeBlock(unsigned int format, int quality, const unsigned char* texels, int pitch, unsigned char* block)
+{
+	unsigned char pixels[16][4], alphas[16];
+	int i;
+
+	for (i = 0; i < 16; i++)
+	{
+		memcpy(pixels[i], texels + (i / 4) * pitch + (i % 4) * 4, 4);
+		alphas[i] = pixels[i][3];
+	}
+
+	switch (format)
+	{
+	case DDS_FORMAT_BC1_UNORM:
+	case DDS_FORMAT_BC1_UNORM_SRGB:
+		EncodeColor(pixels, true, quality, block);
+		break;
+	case DDS_FORMAT_BC3_UNORM:
+	case DDS_FORMAT_BC3_UNORM_SRGB:
+		EncodeChannel(alphas, quality, block);
+		EncodeColor(pixels, false, quality, block + 8);
+		break;
+	default:
+		EncodeBc7(pixels, quality, block);
+		break;
+	}
+
+	return;
+}
+
+void BlockEncoderClass::EncodeRows(int begin, int end)
+{
+	unsigned char scratch[64];
+	unsigned char* block;
+	int blockRow, x, y, column, row;
+
+	for (blockRow = begin; blockRow < end; blockRow++)
+	{
+		block = m_blocks + (size_t)blockRow * ((m_width + 3) / 4) * m_blockBytes;
+		for (x = 0; x < m_width; x += 4)
+		{
+			// Whole blocks are read in place, those over the right or bottom edge repeat the last texels.
+			if (x + 4 <= m_width && blockRow * 4 + 4 <= m_height)
+			{
+				EncodeBlock(m_format, m_quality, m_texels + (size_t)blockRow * 4 * m_pitch + x * 4, m_pitch, block);
+			}
+			else
+			{
+				for (y = 0; y < 4; y++)
+				{
+					row = (blockRow * 4 + y < m_height) ? blockRow * 4 + y : m_height - 1;
+					for (column = 0; column < 4; column++)
+					{
+						memcpy(scratch + y * 16 + column * 4, m_texels + (size_t)row * m_pitch + ((x + column < m_width) ? x + column : m_width - 1) * 4, 4);
+					}
+				}
+				EncodeBlock(m_format, m_quality, scratch, 16, block);
+			}
+			block += m_blockBytes;
+		}
+	}
+
+	return;
+}
+
+void BlockEncoderClass::RunRanges(int count)
+{
+	RangeType* ranges;
+	thread* threads;
+	int rangeCount, i;
+
+	// Small jobs run on the calling thread only.
+	rangeCount = count / MIN_RANGE_ROWS + 1;
+	if (rangeCount > m_threadCount)
+	{
+		rangeCount = m_threadCount;
+	}
+
+	ranges = new RangeType[rangeCount];
+	if (!ranges)
+	{
+		return;
+	}
+
+	for (i = 0; i < rangeCount; i++)
+	{
+		ranges[i].encoder = this;
+		ranges[i].begin = (int)((long long)count * i / rangeCount);
+		ranges[i].end = (int)((long long)count * (i + 1) / rangeCount);
+	}
+
+	// Run every range but the first on a worker thread, and the first one here.
+	threads = 0;
+	if (rangeCount > 1)
+	{
+		threads = new thread[rangeCount - 1];
+		for (i = 1; i < rangeCount; i++)
+		{
+			threads[i - 1] = thread(EncodeRange, &ranges[i]);
+		}
+	}
+
+	EncodeRange(&ranges[0]);
+
+	if (threads)
+	{
+		for (i = 0; i < rangeCount - 1; i++)
+		{
+			threads[i].join();
+		}
+		delete[] threads;
+		threads = 0;
+	}
+
+	delete[] ranges;
+	ranges = 0;
+
+	return;
+}
+
+void BlockEncoderClass::EncodeRange(RangeType* range)
+{
+	range->encoder->EncodeRows(range->begin, range->end);
+
+	return;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef _BLOCKENCODERCLASS_H_
+#define _BLOCKENCODERCLASS_H_
+
+#include "ddsfileclass.h"
+
+// How hard the encoder searches. Each level tries everything the one below it does and keeps the better
+// block, so a higher level is never worse.
+const int BLOCK_QUALITY_FAST = 0;
+const int BLOCK_QUALITY_NORMAL = 1;
+const int BLOCK_QUALITY_HIGH = 2;
+
+// Compresses 8 bit RGBA texels to BC1, BC3 or BC7 blocks (unorm or srgb, the texels are taken as stored),
+// for cooking textures ahead of time. Every block is fitted along the principal axis of its colors, then
+// the endpoints are quantized and the indices chosen against the palette BlockDecoderClass decodes, so the
+// error the encoder measures is the error the game sees.
+//   fast    BC1 and BC3 take the ends of the axis, BC7 uses mode 6 only.
+//   normal  endpoints refit to their indices by least squares, BC3 alpha tries its 6 value mode, BC7 also
+//           tries mode 1 on the four two subset partitions that fit best.
+//   high    more refits, BC1 tries its three color mode, BC3 alpha searches around its endpoints, BC7
+//           tries modes 1 and 3 on the best sixteen partitions.
+// BC7 blocks with alpha use mode 6 whatever the quality. A surface is split by rows of blocks over threads.
+class BlockEncoderClass
+{
+private:
+	struct RangeType
+	{
+		BlockEncoderClass* encoder;
+		int begin, end;
+	};
+
+public:
+	BlockEncoderClass();
+	BlockEncoderClass(const BlockEncoderClass&);
+	~BlockEncoderClass();
+
+	bool Initialize(int, int);
+	void Shutdown();
+
+	bool Encode(unsigned int, const unsigned char*, int, int, int, unsigned char*);
+	int GetQuality();
+
+	static bool IsSupported(unsigned int);
+	static void EncodeBlock(unsigned int, int, const unsigned char*, int, unsigned char*);
+
+private:
+	void EncodeRows(int, int);
+	void RunRanges(int);
+
+	static void EncodeRange(RangeType*);
+
+private:
+	const unsigned char* m_texels;
+	unsigned char* m_blocks;
+	unsigned int m_format;
+	int m_width, m_height, m_pitch, m_blockBytes;
+	int m_threadCount, m_quality;
+};
+#endif
@@ -0,0 +1,215 @@
+#include "boundingvolumeclass.h"
+
+#include <math.h>
+#include <string.h>
+
+// SSE is part of every x64 target and the default for 32 bit builds since Visual Studio 2012.
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define BOUNDS_SSE
+#include <xmmintrin.h>
+#endif
+
+#if defined(BOUNDS_SSE) && defined(__AVX__)
+#define BOUNDS_AVX
+#include <immintrin.h>
+#endif
+
+BoundingVolumeClass::BoundingVolumeClass()
+{
+}
+
+BoundingVolumeClass::BoundingVolumeClass(const BoundingVolumeClass& other)
+{
+}
+
+BoundingVolumeClass::~BoundingVolumeClass()
+{
+}
+
+void BoundingVolumeClass::Compute(const void* vertices, int vertexCount, int stride, BoundsType& bounds)
+{
+#ifdef BOUNDS_SSE
+	const char* data;
+	const float* position;
+	__m128 minimum, maximum, minimum2, maximum2, point, center, x, y, z, w, distance, farthest;
+	float result[4];
+	int i, j;
+
+	memset(&bounds, 0, sizeof(bounds));
+	if (vertexCount <= 0)
+	{
+		return;
+	}
+
+	data = (const char*)vertices;
+
+	// The last vertex is read as three floats, every other one as four: the fourth is the next attribute or
+	// the next vertex and lands in a lane that is never looked at.
+	position = (const float*)(data + (size_t)(vertexCount - 1) * stride);
+	minimum = _mm_setr_ps(position[0], position[1], position[2], 0.0f);
+	maximum = minimum;
+	minimum2 = minimum;
+	maximum2 = minimum;
+
+#ifdef BOUNDS_AVX
+	__m256 minimum8, maximum8, pair;
+
+	// Two vertices per register, the halves are folded together afterwards.
+	minimum8 = _mm256_insertf128_ps(_mm256_castps128_ps256(minimum), minimum, 1);
+	maximum8 = minimum8;
+	for (i = 0; i + 1 < vertexCount - 1; i += 2)
+	{
+		pair = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps((const float*)(data + (size_t)i * stride))),
+			_mm_loadu_ps((const float*)(data + (size_t)(i + 1) * stride)), 1);
+		minimum8 = _mm256_min_ps(minimum8, pair);
+		maximum8 = _mm256_max_ps(maximum8, pair);
+	}
+
+	minimum = _mm_min_ps(_mm256_castps256_ps128(minimum8), _mm256_extractf128_ps(minimum8, 1));
+	maximum = _mm_max_ps(_mm256_castps256_ps128(maximum8), _mm256_extractf128_ps(maximum8, 1));
+#else
+	// Two independent chains so consecutive min and max do not wait on each other.
+	for (i = 0; i + 1 < vertexCount - 1; i += 2)
+	{
+		point = _mm_loadu_ps((const float*)(data + (size_t)i * stride));
+		minimum = _mm_min_ps(minimum, point);
+		maximum = _mm_max_ps(maximum, point);
+
+		point = _mm_loadu_ps((const float*)(data + (size_t)(i + 1) * stride));
+		minimum2 = _mm_min_ps(minimum2, point);
+		maximum2 = _mm_max_ps(maximum2, point);
+	}
+
+	minimum = _mm_min_ps(minimum, minimum2);
+	maximum = _mm_max_ps(maximum, maximum2);
+#endif
+
+	for (; i < vertexCount - 1; i++)
+	{
+		point = _mm_loadu_ps((const float*)(data + (size_t)i * stride));
+		minimum = _mm_min_ps(minimum, point);
+		maximum = _mm_max_ps(maximum, point);
+	}
+
+	_mm_storeu_ps(result, minimum);
+	memcpy(bounds.boundsMin, result, sizeof(bounds.boundsMin));
+	_mm_storeu_ps(result, maximum);
+	memcpy(bounds.boundsMax, result, sizeof(bounds.boundsMax));
+
+	for (j = 0; j < 3; j++)
+	{
+		bounds.center[j] = (bounds.boundsMin[j] + bounds.boundsMax[j]) * 0.5f;
+	}
+
+	// Farthest vertex from the centre, four vertices at a time turned into x, y and z registers.
+	center = _mm_setr_ps(bounds.center[0], bounds.center[1], bounds.center[2], 0.0f);
+	farthest = _mm_setzero_ps();
+	for (i = 0; i + 4 < vertexCount; i += 4)
+	{
+		x = _mm_sub_ps(_mm_loadu_ps((const float*)(data + (size_t)i * stride)), center);
+		y = _mm_sub_ps(_mm_loadu_ps((const float*)(data + (size_t)(i + 1) * stride)), center);
+		z = _mm_sub_ps(_mm_loadu_ps((const float*)(data + (size_t)(i + 2) * stride)), center);
+		w = _mm_sub_ps(_mm_loadu_ps((const float*)(data + (size_t)(i + 3) * stride)), center);
+		_MM_TRANSPOSE4_PS(x, y, z, w);
+
+		distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+		farthest = _mm_max_ps(farthest, distance);
+	}
+
+	_mm_storeu_ps(result, farthest);
+	result[0] = (result[0] > result[1]) ? result[0] : result[1];
+	result[2] = (result[2] > result[3]) ? result[2] : result[3];
+	result[0] = (result[0] > result[2]) ? result[0] : result[2];
+
+	// The last few, including the one that may not be read past, one at a time.
+	for (; i < vertexCount; i++)
+	{
+		position = (const float*)(data + (size_t)i * stride);
+		result[1] = (position[0] - bounds.center[0]) * (position[0] - bounds.center[0]) + (position[1] - bounds.center[1]) * (position[1] - bounds.center[1]) +
+			(position[2] - bounds.center[2]) * (position[2] - bounds.center[2]);
+		result[0] = (result[0] > result[1]) ? result[0] : result[1];
+	}
+
+	bounds.radius = sqrtf(result[0]);
+#else
+	ComputeScalar(vertices, vertexCount, stride, bounds);
+#endif
+
+	return;
+}
+
+void BoundingVolumeClass::ComputeScalar(const void* vertices, int vertexCount, int stride, BoundsType& bounds)
+{
+	const float* position;
+	float distance, farthest;
+	int i, j;
+
+	memset(&bounds, 0, sizeof(bounds));
+	if (vertexCount <= 0)
+	{
+		return;
+	}
+
+	for (i = 0; i < vertexCount; i++)
+	{
+		position = (const float*)((const char*)vertices + (size_t)i * stride);
+		for (j = 0; j < 3; j++)
+		{
+			bounds.boundsMin[j] = (i == 0 || position[j] < bounds.boundsMin[j]) ? position[j] : bounds.boundsMin[j];
+			bounds.boundsMax[j] = (i == 0 || position[j] > bounds.boundsMax[j]) ? position[j] : bounds.boundsMax[j];
+		}
+	}
+
+	for (j = 0; j < 3; j++)
+	{
+		bounds.center[j] = (bounds.boundsMin[j] + bounds.boundsMax[j]) * 0.5f;
+	}
+
+	farthest = 0.0f;
+	for (i = 0; i < vertexCount; i++)
+	{
+		position = (const float*)((const char*)vertices + (size_t)i * stride);
+		distance = (position[0] - bounds.center[0]) * (position[0] - bounds.center[0]) + (position[1] - bounds.center[1]) * (position[1] - bounds.center[1]) +
+			(position[2] - bounds.center[2]) * (position[2] - bounds.center[2]);
+		farthest = (distance > farthest) ? distance : farthest;
+	}
+
+	bounds.radius = sqrtf(farthest);
+
+	return;
+}
+
+void BoundingVolumeClass::Transform(const BoundsType& bounds, const float* matrix, BoundsType& result)
+{
+	float low, high, scale, length;
+	int i, j;
+
+	// Row vector convention: p' = p * matrix, the translation in the last row. Each output axis of the box
+	// takes whichever end of each input axis makes it smaller or larger (Arvo).
+	for (j = 0; j < 3; j++)
+	{
+		result.boundsMin[j] = matrix[12 + j];
+		result.boundsMax[j] = matrix[12 + j];
+		result.center[j] = matrix[12 + j];
+
+		for (i = 0; i < 3; i++)
+		{
+			low = matrix[i * 4 + j] * bounds.boundsMin[i];
+			high = matrix[i * 4 + j] * bounds.boundsMax[i];
+			result.boundsMin[j] += (low < high) ? low : high;
+			result.boundsMax[j] += (low < high) ? high : low;
+			result.center[j] += matrix[i * 4 + j] * bounds.center[i];
+		}
+	}
+
+	// The sphere grows with the longest axis of the matrix.
+	scale = 0.0f;
+	for (i = 0; i < 3; i++)
+	{
+		length = sqrtf(matrix[i * 4] * matrix[i * 4] + matrix[i * 4 + 1] * matrix[i * 4 + 1] + matrix[i * 4 + 2] * matrix[i * 4 + 2]);
+		scale = (length > scale) ? length : scale;
+	}
+	result.radius = bounds.radius * scale;
+
+	return;
+}
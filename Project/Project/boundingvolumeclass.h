@@ -0,0 +1,31 @@
+#pragma once
+
+#ifndef _BOUNDINGVOLUMECLASS_H_
+#define _BOUNDINGVOLUMECLASS_H_
+
+// Axis aligned box and bounding sphere of a mesh. The box is a min/max reduction over the vertex positions,
+// which lead every vertex, done a vertex per SSE register (two per register when the build targets AVX).
+// The sphere is centred on the box and reaches the farthest vertex, which is never larger than the sphere
+// around the box's corners. Transform moves both into another space, the box staying axis aligned around
+// the moved one.
+class BoundingVolumeClass
+{
+public:
+	struct BoundsType
+	{
+		float boundsMin[3];
+		float boundsMax[3];
+		float center[3];
+		float radius;
+	};
+
+public:
+	BoundingVolumeClass();
+	BoundingVolumeClass(const BoundingVolumeClass&);
+	~BoundingVolumeClass();
+
+	static void Compute(const void*, int, int, BoundsType&);
+	static void ComputeScalar(const void*, int, int, BoundsType&);
+	static void Transform(const BoundsType&, const float*, BoundsType&);
+};
+#endif
@@ -0,0 +1,656 @@
+#include "ddsfileclass.h"
+
+#include <string.h>
+
+// Sizes of the fixed parts in front of the texels: the magic number, the header and the DX10 header.
+static const size_t DDS_MAGIC_SIZE = 4;
+static const size_t DDS_HEADER_SIZE = 124;
+static const size_t DDS_HEADER_DX10_SIZE = 20;
+
+// Header and pixel format flags read and written here.
+static const unsigned int DDSD_CAPS = 0x1;
+static const unsigned int DDSD_HEIGHT = 0x2;
+static const unsigned int DDSD_WIDTH = 0x4;
+static const unsigned int DDSD_PIXELFORMAT = 0x1000;
+static const unsigned int DDSD_MIPMAPCOUNT = 0x20000;
+static const unsigned int DDSD_LINEARSIZE = 0x80000;
+static const unsigned int DDSD_DEPTH = 0x800000;
+static const unsigned int DDPF_ALPHAPIXELS = 0x1;
+static const unsigned int DDPF_ALPHA = 0x2;
+static const unsigned int DDPF_FOURCC = 0x4;
+static const unsigned int DDPF_RGB = 0x40;
+static const unsigned int DDPF_LUMINANCE = 0x20000;
+static const unsigned int DDSCAPS_COMPLEX = 0x8;
+static const unsigned int DDSCAPS_TEXTURE = 0x1000;
+static const unsigned int DDSCAPS_MIPMAP = 0x400000;
+static const unsigned int DDSCAPS2_CUBEMAP = 0x200;
+static const unsigned int DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+static const unsigned int DDSCAPS2_VOLUME = 0x200000;
+static const unsigned int DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+// Largest texture Direct3D 11 creates, anything beyond is a corrupt header.
+static const int DDS_MAX_SIZE = 16384;
+static const int DDS_MAX_DEPTH = 2048;
+static const int DDS_MAX_ARRAY_SIZE = 2048;
+
+static unsigned int FourCC(char a, char b, char c, char d)
+{
+	return (unsigned int)(unsigned char)a | ((unsigned int)(unsigned char)b << 8) | ((unsigned int)(unsigned char)c << 16) | ((unsigned int)(unsigned char)d << 24);
+}
+
+DdsFileClass::DdsFileClass()
+{
+	m_File = 0;
+	m_fileData = 0;
+	m_fileSize = 0;
+	m_data = 0;
+	m_dataSize = 0;
+	m_format = DDS_FORMAT_UNKNOWN;
+	m_dimension = 0;
+	m_cubemap = false;
+	m_width = 0;
+	m_height = 0;
+	m_depth = 0;
+	m_mipCount = 0;
+	m_arraySize = 0;
+}
+
+DdsFileClass::DdsFileClass(const DdsFileClass& other)
+{
+}
+
+DdsFileClass::~DdsFileClass()
+{
+}
+
+bool DdsFileClass::Initialize(const char* filename)
+{
+	bool result;
+
+	// Create the file mapping object.
+	m_File = new MappedFileClass;
+	if (!m_File)
+	{
+		return false;
+	}
+
+	// Map the file, the surfaces point into the mapping.
+	result = m_File->Initialize(filename);
+	if (!result)
+	{
+		return false;
+	}
+
+	return InitializeFromMemory(m_File->GetData(), m_File->GetSize());
+}
+
+bool DdsFileClass::Initialize(const wchar_t* filename)
+{
+	bool result;
+
+	// Create the file mapping object.
+	m_File = new MappedFileClass;
+	if (!m_File)
+	{
+		return false;
+	}
+
+	// Map the file, the surfaces point into the mapping.
+	result = m_File->Initialize(filename);
+	if (!result)
+	{
+		return false;
+	}
+
+	return InitializeFromMemory(m_File->GetData(), m_File->GetSize());
+}
+
+bool DdsFileClass::InitializeFromMemory(const char* data, size_t size)
+{
+	m_fileData = data;
+	m_fileSize = size;
+
+	return Parse();
+}
+
+void DdsFileClass::Shutdown()
+{
+	// Release the file mapping, if the file was mapped here.
+	if (m_File)
+	{
+		m_File->Shutdown();
+		delete m_File;
+		m_File = 0;
+	}
+
+	m_fileData = 0;
+	m_fileSize = 0;
+	m_data = 0;
+	m_dataSize = 0;
+
+	return;
+}
+
+unsigned int DdsFileClass::GetFormat()
+{
+	return m_format;
+}
+
+int DdsFileClass::GetDimension()
+{
+	return m_dimension;
+}
+
+bool DdsFileClass::IsCubemap()
+{
+	return m_cubemap;
+}
+
+int DdsFileClass::GetWidth()
+{
+	return m_width;
+}
+
+int DdsFileClass::GetHeight()
+{
+	return m_height;
+}
+
+int DdsFileClass::GetDepth()
+{
+	return m_depth;
+}
+
+int DdsFileClass::GetMipCount()
+{
+	return m_mipCount;
+}
+
+int DdsFileClass::GetArraySize()
+{
+	return m_arraySize;
+}
+
+bool DdsFileClass::GetSurface(int mip, int item, SurfaceType& surface)
+{
+	SurfaceType level;
+	size_t offset, itemSize;
+	int i;
+
+	if (!m_data || mip < 0 || mip >= m_mipCount || item < 0 || item >= m_arraySize)
+	{
+		return false;
+	}
+
+	// Every array slice holds its whole mip chain, so skip the slices in front and the larger levels.
+	itemSize = m_dataSize / m_arraySize;
+	offset = itemSize * item;
+	for (i = 0; i < mip; i++)
+	{
+		MeasureSurface(i, level);
+		offset += level.size;
+	}
+
+	MeasureSurface(mip, surface);
+	surface.data = m_data + offset;
+
+	return true;
+}
+
+size_t DdsFileClass::GetDataSize()
+{
+	return m_dataSize;
+}
+
+bool DdsFileClass::IsDxgiFormat(unsigned int format)
+{
+	return format != DDS_FORMAT_UNKNOWN && format < DDS_FORMAT_LEGACY;
+}
+
+bool DdsFileClass::IsBlockCompressed(unsigned int format)
+{
+	unsigned int blockBytes, bitsPerPixel;
+
+	return GetFormatSize(format, blockBytes, bitsPerPixel) && blockBytes > 0;
+}
+
+bool DdsFileClass::GetFormatSize(unsigned int format, unsigned int& blockBytes, unsigned int& bitsPerPixel)
+{
+	// Block compressed formats take a fixed size per 4x4 block, the rest a fixed size per texel.
+	blockBytes = 0;
+	bitsPerPixel = 0;
+	switch (format)
+	{
+	case DDS_FORMAT_BC1_UNORM:
+	case DDS_FORMAT_BC1_UNORM_SRGB:
+	case DDS_FORMAT_BC4_UNORM:
+	case DDS_FORMAT_BC4_SNORM:
+		blockBytes = 8;
+		break;
+	case DDS_FORMAT_BC2_UNORM:
+	case DDS_FORMAT_BC2_UNORM_SRGB:
+	case DDS_FORMAT_BC3_UNORM:
+	case DDS_FORMAT_BC3_UNORM_SRGB:
+	case DDS_FORMAT_BC5_UNORM:
+	case DDS_FORMAT_BC5_SNORM:
+	case DDS_FORMAT_BC6H_UF16:
+	case DDS_FORMAT_BC6H_SF16:
+	case DDS_FORMAT_BC7_UNORM:
+	case DDS_FORMAT_BC7_UNORM_SRGB:
+		blockBytes = 16;
+		break;
+	case DDS_FORMAT_R8_UNORM:
+	case DDS_FORMAT_A8_UNORM:
+		bitsPerPixel = 8;
+		break;
+	case DDS_FORMAT_R8G8_UNORM:
+	case DDS_FORMAT_R16_FLOAT:
+	case DDS_FORMAT_R16_UNORM:
+	case DDS_FORMAT_B5G6R5_UNORM:
+	case DDS_FORMAT_B5G5R5A1_UNORM:
+	case DDS_FORMAT_B4G4R4A4_UNORM:
+		bitsPerPixel = 16;
+		break;
+	case DDS_FORMAT_B8G8R8:
+		bitsPerPixel = 24;
+		break;
+	case DDS_FORMAT_R10G10B10A2_UNORM:
+	case DDS_FORMAT_R8G8B8A8_UNORM:
+	case DDS_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DDS_FORMAT_R16G16_UNORM:
+	case DDS_FORMAT_R32_FLOAT:
+	case DDS_FORMAT_B8G8R8A8_UNORM:
+	case DDS_FORMAT_B8G8R8X8_UNORM:
+	case DDS_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DDS_FORMAT_B8G8R8X8_UNORM_SRGB:
+	case DDS_FORMAT_R8G8B8X8:
+		bitsPerPixel = 32;
+		break;
+	case DDS_FORMAT_R16G16B16A16_FLOAT:
+	case DDS_FORMAT_R16G16B16A16_UNORM:
+		bitsPerPixel = 64;
+		break;
+	case DDS_FORMAT_R32G32B32A32_FLOAT:
+		bitsPerPixel = 128;
+		break;
+	default:
+		return false;
+	}
+
+	return true;
+}
+
+void DdsFileClass::WriteHeader(unsigned int format, int width, int height, int mipCount, int arraySize, bool cubemap, char* data)
+{
+	unsigned int header[DDS_HEADER_SIZE / 4], extended[DDS_HEADER_DX10_SIZE / 4], blockBytes, bitsPerPixel;
+
+	GetFormatSize(format, blockBytes, bitsPerPixel);
+
+	memset(header, 0, sizeof(header));
+	header[0] = DDS_HEADER_SIZE;
+	header[1] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | (blockBytes ? DDSD_LINEARSIZE : 0);
+	header[2] = (unsigned int)height;
+	header[3] = (unsigned int)width;
+	header[6] = (unsigned int)mipCount;
+
+	// Bytes in the first level, or in a row of it.
+	if (blockBytes)
+	{
+		header[4] = (unsigned int)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+	}
+	else
+	{
+		header[4] = ((unsigned int)width * bitsPerPixel + 7) / 8;
+	}
+
+	header[18] = 32;
+	header[19] = DDPF_FOURCC;
+	header[20] = FourCC('D', 'X', '1', '0');
+	header[26] = DDSCAPS_TEXTURE | ((mipCount > 1 || cubemap) ? DDSCAPS_COMPLEX : 0) | ((mipCount > 1) ? DDSCAPS_MIPMAP : 0);
+	header[27] = cubemap ? (DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES) : 0;
+
+	// A 2D texture, whose array size counts cubes rather than their faces.
+	extended[0] = format;
+	extended[1] = 3;
+	extended[2] = cubemap ? DDS_RESOURCE_MISC_TEXTURECUBE : 0;
+	extended[3] = (unsigned int)(cubemap ? arraySize / 6 : arraySize);
+	extended[4] = 0;
+
+	memcpy(data, "DDS ", DDS_MAGIC_SIZE);
+	memcpy(data + DDS_MAGIC_SIZE, header, DDS_HEADER_SIZE);
+	memcpy(data + DDS_MAGIC_SIZE + DDS_HEADER_SIZE, extended, DDS_HEADER_DX10_SIZE);
+
+	return;
+}
+
+bool DdsFileClass::Parse()
+{
+	unsigned int header[DDS_HEADER_SIZE / 4], extended[DDS_HEADER_DX10_SIZE / 4];
+	unsigned int flags, caps2, faces, blockBytes, bitsPerPixel;
+	unsigned long long total, rowPitch, rowCount, slicePitch;
+	size_t headerSize;
+	int largest, maxMips, mip, width, height, depth;
+	bool result;
+
+	m_data = 0;
+	m_dataSize = 0;
+
+	// The magic number and a header of the right size, with a pixel format of the right size.
+	if (m_fileSize < DDS_MAGIC_SIZE + DDS_HEADER_SIZE || memcmp(m_fileData, "DDS ", DDS_MAGIC_SIZE) != 0)
+	{
+		return false;
+	}
+
+	memcpy(header, m_fileData + DDS_MAGIC_SIZE, DDS_HEADER_SIZE);
+	if (header[0] != DDS_HEADER_SIZE || header[18] != 32)
+	{
+		return false;
+	}
+
+	flags = header[1];
+	caps2 = header[27];
+	m_height = (int)header[2];
+	m_width = (int)header[3];
+	m_depth = ((flags & DDSD_DEPTH) && header[5] > 0) ? (int)header[5] : 1;
+	m_mipCount = (header[6] > 0) ? (int)header[6] : 1;
+	m_arraySize = 1;
+	m_cubemap = false;
+	headerSize = DDS_MAGIC_SIZE + DDS_HEADER_SIZE;
+
+	// The DX10 header names the format directly and adds arrays, the plain one describes the texel layout.
+	if ((header[19] & DDPF_FOURCC) && header[20] == FourCC('D', 'X', '1', '0'))
+	{
+		if (m_fileSize < headerSize + DDS_HEADER_DX10_SIZE)
+		{
+			return false;
+		}
+
+		memcpy(extended, m_fileData + headerSize, DDS_HEADER_DX10_SIZE);
+		headerSize += DDS_HEADER_DX10_SIZE;
+
+		m_format = extended[0];
+		m_arraySize = (int)extended[3];
+		if (!IsDxgiFormat(m_format) || !GetFormatSize(m_format, blockBytes, bitsPerPixel) || extended[3] == 0 || extended[3] > (unsigned int)DDS_MAX_ARRAY_SIZE)
+		{
+			return false;
+		}
+
+		// Resource dimension 2, 3 and 4 are 1D, 2D and 3D.
+		switch (extended[1])
+		{
+		case 2:
+			m_dimension = 1;
+			result = (m_height == 1 && m_depth == 1);
+			break;
+		case 3:
+			m_dimension = 2;
+			m_cubemap = (extended[2] & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+			m_arraySize *= m_cubemap ? 6 : 1;
+			result = (m_depth == 1);
+			break;
+		case 4:
+			m_dimension = 3;
+			result = (m_arraySize == 1);
+			break;
+		default:
+			result = false;
+			break;
+		}
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		result = ParsePixelFormat(&header[18]);
+		if (!result)
+		{
+			return false;
+		}
+
+		m_dimension = (caps2 & DDSCAPS2_VOLUME) ? 3 : 2;
+
+		// A cube map stores each face it has, only complete ones can be created.
+		if (caps2 & DDSCAPS2_CUBEMAP)
+		{
+			faces = caps2 & DDSCAPS2_CUBEMAP_ALLFACES;
+			if (faces != DDSCAPS2_CUBEMAP_ALLFACES || m_dimension != 2)
+			{
+				return false;
+			}
+
+			m_cubemap = true;
+			m_arraySize = 6;
+		}
+
+		if (m_dimension == 2 && m_depth != 1)
+		{
+			return false;
+		}
+	}
+
+	// Sizes Direct3D can create, cube faces square, and no more mip levels than the largest side has.
+	if (m_width < 1 || m_height < 1 || m_width > DDS_MAX_SIZE || m_height > DDS_MAX_SIZE || m_depth > DDS_MAX_DEPTH || (m_cubemap && m_width != m_height))
+	{
+		return false;
+	}
+
+	largest = (m_width > m_height) ? m_width : m_height;
+	largest = (m_depth > largest) ? m_depth : largest;
+	for (maxMips = 1; (largest >> maxMips) > 0; maxMips++)
+	{
+	}
+
+	if (m_mipCount > maxMips)
+	{
+		return false;
+	}
+
+	// Add up the mip chain of one slice, none of its surfaces may be larger than a subresource can describe.
+	GetFormatSize(m_format, blockBytes, bitsPerPixel);
+	total = 0;
+	for (mip = 0; mip < m_mipCount; mip++)
+	{
+		width = (m_width >> mip > 0) ? m_width >> mip : 1;
+		height = (m_height >> mip > 0) ? m_height >> mip : 1;
+		depth = (m_depth >> mip > 0) ? m_depth >> mip : 1;
+
+		if (blockBytes)
+		{
+			rowPitch = (unsigned long long)((width + 3) / 4) * blockBytes;
+			rowCount = (unsigned long long)((height + 3) / 4);
+		}
+		else
+		{
+			rowPitch = ((unsigned long long)width * bitsPerPixel + 7) / 8;
+			rowCount = (unsigned long long)height;
+		}
+
+		slicePitch = rowPitch * rowCount;
+		if (slicePitch > 0xFFFFFFFFull)
+		{
+			return false;
+		}
+
+		total += slicePitch * depth;
+	}
+	total *= (unsigned long long)m_arraySize;
+
+	// Every surface must lie inside the file, so a truncated download or copy is rejected here.
+	if (total > (unsigned long long)(m_fileSize - headerSize))
+	{
+		return false;
+	}
+
+	m_data = m_fileData + headerSize;
+	m_dataSize = (size_t)total;
+
+	return true;
+}
+
+bool DdsFileClass::ParsePixelFormat(const unsigned int* pixelFormat)
+{
+	unsigned int flags, fourCC, bitCount, red, green, blue, alpha;
+
+	flags = pixelFormat[1];
+	fourCC = pixelFormat[2];
+	bitCount = pixelFormat[3];
+	red = pixelFormat[4];
+	green = pixelFormat[5];
+	blue = pixelFormat[6];
+	alpha = pixelFormat[7];
+
+	m_format = DDS_FORMAT_UNKNOWN;
+
+	// Compressed formats by their FourCC, and the float formats by their D3DFORMAT value in its place.
+	if (flags & DDPF_FOURCC)
+	{
+		if (fourCC == FourCC('D', 'X', 'T', '1'))
+		{
+			m_format = DDS_FORMAT_BC1_UNORM;
+		}
+		else if (fourCC == FourCC('D', 'X', 'T', '2') || fourCC == FourCC('D', 'X', 'T', '3'))
+		{
+			m_format = DDS_FORMAT_BC2_UNORM;
+		}
+		else if (fourCC == FourCC('D', 'X', 'T', '4') || fourCC == FourCC('D', 'X', 'T', '5'))
+		{
+			m_format = DDS_FORMAT_BC3_UNORM;
+		}
+		else if (fourCC == FourCC('A', 'T', 'I', '1') || fourCC == FourCC('B', 'C', '4', 'U'))
+		{
+			m_format = DDS_FORMAT_BC4_UNORM;
+		}
+		else if (fourCC == FourCC('B', 'C', '4', 'S'))
+		{
+			m_format = DDS_FORMAT_BC4_SNORM;
+		}
+		else if (fourCC == FourCC('A', 'T', 'I', '2') || fourCC == FourCC('B', 'C', '5', 'U'))
+		{
+			m_format = DDS_FORMAT_BC5_UNORM;
+		}
+		else if (fourCC == FourCC('B', 'C', '5', 'S'))
+		{
+			m_format = DDS_FORMAT_BC5_SNORM;
+		}
+		else if (fourCC == 36)
+		{
+			m_format = DDS_FORMAT_R16G16B16A16_UNORM;
+		}
+		else if (fourCC == 111)
+		{
+			m_format = DDS_FORMAT_R16_FLOAT;
+		}
+		else if (fourCC == 113)
+		{
+			m_format = DDS_FORMAT_R16G16B16A16_FLOAT;
+		}
+		else if (fourCC == 114)
+		{
+			m_format = DDS_FORMAT_R32_FLOAT;
+		}
+		else if (fourCC == 116)
+		{
+			m_format = DDS_FORMAT_R32G32B32A32_FLOAT;
+		}
+
+		return m_format != DDS_FORMAT_UNKNOWN;
+	}
+
+	// Alpha is only there when the flags say so, the mask is left over in some writers' files.
+	if (!(flags & DDPF_ALPHAPIXELS))
+	{
+		alpha = 0;
+	}
+
+	// Uncompressed formats by their bit masks.
+	if (flags & DDPF_RGB)
+	{
+		if (bitCount == 32 && red == 0xFF0000 && green == 0xFF00 && blue == 0xFF)
+		{
+			m_format = (alpha == 0xFF000000) ? DDS_FORMAT_B8G8R8A8_UNORM : DDS_FORMAT_B8G8R8X8_UNORM;
+		}
+		else if (bitCount == 32 && red == 0xFF && green == 0xFF00 && blue == 0xFF0000)
+		{
+			m_format = (alpha == 0xFF000000) ? DDS_FORMAT_R8G8B8A8_UNORM : DDS_FORMAT_R8G8B8X8;
+		}
+		else if (bitCount == 32 && red == 0x3FF && green == 0xFFC00 && blue == 0x3FF00000)
+		{
+			m_format = DDS_FORMAT_R10G10B10A2_UNORM;
+		}
+		else if (bitCount == 32 && red == 0xFFFF && green == 0xFFFF0000 && blue == 0)
+		{
+			m_format = DDS_FORMAT_R16G16_UNORM;
+		}
+		else if (bitCount == 24 && red == 0xFF0000 && green == 0xFF00 && blue == 0xFF)
+		{
+			m_format = DDS_FORMAT_B8G8R8;
+		}
+		else if (bitCount == 16 && red == 0xF800 && green == 0x7E0 && blue == 0x1F)
+		{
+			m_format = DDS_FORMAT_B5G6R5_UNORM;
+		}
+		else if (bitCount == 16 && red == 0x7C00 && green == 0x3E0 && blue == 0x1F && alpha == 0x8000)
+		{
+			m_format = DDS_FORMAT_B5G5R5A1_UNORM;
+		}
+		else if (bitCount == 16 && red == 0xF00 && green == 0xF0 && blue == 0xF && alpha == 0xF000)
+		{
+			m_format = DDS_FORMAT_B4G4R4A4_UNORM;
+		}
+	}
+	else if (flags & DDPF_LUMINANCE)
+	{
+		if (bitCount == 8 && red == 0xFF)
+		{
+			m_format = DDS_FORMAT_R8_UNORM;
+		}
+		else if (bitCount == 16 && red == 0xFFFF)
+		{
+			m_format = DDS_FORMAT_R16_UNORM;
+		}
+		else if (bitCount == 16 && red == 0xFF && alpha == 0xFF00)
+		{
+			m_format = DDS_FORMAT_R8G8_UNORM;
+		}
+	}
+	else if (flags & DDPF_ALPHA)
+	{
+		if (bitCount == 8)
+		{
+			m_format = DDS_FORMAT_A8_UNORM;
+		}
+	}
+
+	return m_format != DDS_FORMAT_UNKNOWN;
+}
+
+void DdsFileClass::MeasureSurface(int mip, SurfaceType& surface)
+{
+	unsigned int blockBytes, bitsPerPixel;
+
+	surface.width = (m_width >> mip > 0) ? (unsigned int)(m_width >> mip) : 1;
+	surface.height = (m_height >> mip > 0) ? (unsigned int)(m_height >> mip) : 1;
+	surface.depth = (m_depth >> mip > 0) ? (unsigned int)(m_depth >> mip) : 1;
+
+	// Rows of 4x4 blocks for the compressed formats, rows of texels packed without padding for the rest.
+	GetFormatSize(m_format, blockBytes, bitsPerPixel);
+	if (blockBytes)
+	{
+		surface.rowPitch = ((surface.width + 3) / 4) * blockBytes;
+		surface.rowCount = (surface.height + 3) / 4;
+	}
+	else
+	{
+		surface.rowPitch = (surface.width * bitsPerPixel + 7) / 8;
+		surface.rowCount = surface.height;
+	}
+
+	surface.slicePitch = surface.rowPitch * surface.rowCount;
+	surface.size = (size_t)surface.slicePitch * surface.depth;
+	surface.data = 0;
+
+	return;
+}
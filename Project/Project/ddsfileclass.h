@@ -0,0 +1,114 @@
+#pragma once
+
+#ifndef _DDSFILECLASS_H_
+#define _DDSFILECLASS_H_
+
+#include <stddef.h>
+
+#include "mappedfileclass.h"
+
+// Texel formats a DDS file can hold. Those Direct3D can sample as stored have their DXGI_FORMAT value, so
+// they can be passed straight to CreateTexture2D. The legacy layouts without one sit above DDS_FORMAT_LEGACY
+// and have to be converted first.
+const unsigned int DDS_FORMAT_UNKNOWN = 0;
+const unsigned int DDS_FORMAT_R32G32B32A32_FLOAT = 2;
+const unsigned int DDS_FORMAT_R16G16B16A16_FLOAT = 10;
+const unsigned int DDS_FORMAT_R16G16B16A16_UNORM = 11;
+const unsigned int DDS_FORMAT_R10G10B10A2_UNORM = 24;
+const unsigned int DDS_FORMAT_R8G8B8A8_UNORM = 28;
+const unsigned int DDS_FORMAT_R8G8B8A8_UNORM_SRGB = 29;
+const unsigned int DDS_FORMAT_R16G16_UNORM = 35;
+const unsigned int DDS_FORMAT_R32_FLOAT = 41;
+const unsigned int DDS_FORMAT_R8G8_UNORM = 49;
+const unsigned int DDS_FORMAT_R16_FLOAT = 54;
+const unsigned int DDS_FORMAT_R16_UNORM = 56;
+const unsigned int DDS_FORMAT_R8_UNORM = 61;
+const unsigned int DDS_FORMAT_A8_UNORM = 65;
+const unsigned int DDS_FORMAT_BC1_UNORM = 71;
+const unsigned int DDS_FORMAT_BC1_UNORM_SRGB = 72;
+const unsigned int DDS_FORMAT_BC2_UNORM = 74;
+const unsigned int DDS_FORMAT_BC2_UNORM_SRGB = 75;
+const unsigned int DDS_FORMAT_BC3_UNORM = 77;
+const unsigned int DDS_FORMAT_BC3_UNORM_SRGB = 78;
+const unsigned int DDS_FORMAT_BC4_UNORM = 80;
+const unsigned int DDS_FORMAT_BC4_SNORM = 81;
+const unsigned int DDS_FORMAT_BC5_UNORM = 83;
+const unsigned int DDS_FORMAT_BC5_SNORM = 84;
+const unsigned int DDS_FORMAT_B5G6R5_UNORM = 85;
+const unsigned int DDS_FORMAT_B5G5R5A1_UNORM = 86;
+const unsigned int DDS_FORMAT_B8G8R8A8_UNORM = 87;
+const unsigned int DDS_FORMAT_B8G8R8X8_UNORM = 88;
+const unsigned int DDS_FORMAT_B8G8R8A8_UNORM_SRGB = 91;
+const unsigned int DDS_FORMAT_B8G8R8X8_UNORM_SRGB = 93;
+const unsigned int DDS_FORMAT_BC6H_UF16 = 95;
+const unsigned int DDS_FORMAT_BC6H_SF16 = 96;
+const unsigned int DDS_FORMAT_BC7_UNORM = 98;
+const unsigned int DDS_FORMAT_BC7_UNORM_SRGB = 99;
+const unsigned int DDS_FORMAT_B4G4R4A4_UNORM = 115;
+const unsigned int DDS_FORMAT_LEGACY = 0x10000;
+const unsigned int DDS_FORMAT_B8G8R8 = DDS_FORMAT_LEGACY + 1;
+const unsigned int DDS_FORMAT_R8G8B8X8 = DDS_FORMAT_LEGACY + 2;
+
+// Bytes WriteHeader puts in front of the surfaces: the magic number, the header and the DX10 header.
+const size_t DDS_WRITTEN_HEADER_SIZE = 148;
+
+// Reader for DDS files, the plain header and the DX10 extended one. Initialize maps the file and
+// InitializeFromMemory reads a file already in memory, which must outlive the object. Nothing is copied:
+// after the header is checked against the file size, GetSurface points every mip level of every array slice
+// (or cube face) into the data, laid out the way D3D11_SUBRESOURCE_DATA wants it. WriteHeader writes the
+// DX10 header of a 2D texture whose surfaces follow in that same layout, for the cookers.
+class DdsFileClass
+{
+public:
+	struct SurfaceType
+	{
+		const char* data;
+		size_t size;
+		unsigned int width, height, depth;
+		unsigned int rowPitch, rowCount, slicePitch;
+	};
+
+public:
+	DdsFileClass();
+	DdsFileClass(const DdsFileClass&);
+	~DdsFileClass();
+
+	bool Initialize(const char*);
+	bool Initialize(const wchar_t*);
+	bool InitializeFromMemory(const char*, size_t);
+	void Shutdown();
+
+	unsigned int GetFormat();
+	int GetDimension();
+	bool IsCubemap();
+	int GetWidth();
+	int GetHeight();
+	int GetDepth();
+	int GetMipCount();
+	int GetArraySize();
+	bool GetSurface(int, int, SurfaceType&);
+	size_t GetDataSize();
+
+	static bool IsDxgiFormat(unsigned int);
+	static bool IsBlockCompressed(unsigned int);
+	static bool GetFormatSize(unsigned int, unsigned int&, unsigned int&);
+	static void WriteHeader(unsigned int, int, int, int, int, bool, char*);
+
+private:
+	bool Parse();
+	bool ParsePixelFormat(const unsigned int*);
+	void MeasureSurface(int, SurfaceType&);
+
+private:
+	MappedFileClass* m_File;
+	const char* m_fileData;
+	size_t m_fileSize;
+	const char* m_data;
+	size_t m_dataSize;
+	unsigned int m_format;
+	int m_dimension;
+	bool m_cubemap;
+	int m_width, m_height, m_depth;
+	int m_mipCount, m_arraySize;
+};
+#endif
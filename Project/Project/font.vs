@@ -11,12 +11,14 @@ struct VertexInputType
 {
 	float4 position : POSITION;
 	float2 tex : TEXCOORD0;
+	float4 color : COLOR;
 };
 
 struct PixelInputType
 {
 	float4 position : SV_POSITION;
 	float2 tex : TEXCOORD0;
+	float4 color : COLOR;
 };
 
 // Vertex Shader
@@ -35,5 +37,8 @@ PixelInputType FontVertexShader(VertexInputType input)
 	// Store the texture coordinates for the pixel shader.
 	output.tex = input.tex;
 
+	// Every glyph carries the color of its sentence.
+	output.color = input.color;
+
 	return output;
 }
\ No newline at end of file
@@ -1,9 +1,15 @@
 #include "fontclass.h"
 
+#include <string.h>
+
 FontClass::FontClass()
 {
 	m_Font = 0;
 	m_Texture = 0;
+	m_Registry = 0;
+	m_SharedTexture = 0;
+	m_top = 0.0f;
+	m_bottom = 1.0f;
 }
 
 FontClass::FontClass(const FontClass& other) 
@@ -14,10 +20,13 @@ FontClass::~FontClass()
 {
 }
 
-bool FontClass::Initialize(ID3D11Device* device, char* fontFilename, WCHAR* textureFilename)
+bool FontClass::Initialize(ID3D11Device* device, ResourceRegistryClass* registry, char* fontFilename, WCHAR* textureFilename)
 {
 
 	bool result;
+
+	m_Registry = registry;
+
 	// Load in the text file containing the font data.
 	result = LoadFontData(fontFilename);
 	if (!result)
@@ -48,47 +57,36 @@ void FontClass::Shutdown()
 
 bool FontClass::LoadFontData(char* filename)
 {
-	ifstream fin;
-	int i;
-	char temp;
+	FontLoaderClass* loader;
+	bool result;
 
 	// Create the font spacing buffer.
-	m_Font = new FontType[95];
+	m_Font = new FontType[FONT_GLYPH_COUNT];
 	if (!m_Font)
 	{
 		return false;
 	}
 
-	// Read in the font size and spacing between chars.
-	fin.open(filename);
-	if (fin.fail())
+	// Create the font loader object.
+	loader = new FontLoaderClass;
+	if (!loader)
 	{
 		return false;
 	}
 
-	// Read in the 95 used ascii characters for text.
-	for (i = 0; i < 95; i++)
+	// Read in the font size and spacing between chars.
+	result = loader->Initialize(filename);
+	if (result)
 	{
-		fin.get(temp);
-		while (temp != ' ')
-		{
-			fin.get(temp);
-		}
-		fin.get(temp);
-		while (temp != ' ')
-		{
-			fin.get(temp);
-		}
-
-		fin >> m_Font[i].left;
-		fin >> m_Font[i].right;
-		fin >> m_Font[i].size;
+		memcpy(m_Font, loader->GetGlyphs(), sizeof(FontType) * FONT_GLYPH_COUNT);
 	}
 
-	// Close the file.
-	fin.close();
+	// Release the loader now that the spacing has been copied out.
+	loader->Shutdown();
+	delete loader;
+	loader = 0;
 
-	return true;
+	return result;
 }
 
 void FontClass::ReleaseFontData()
@@ -105,32 +103,52 @@ void FontClass::ReleaseFontData()
 
 bool FontClass::LoadTexture(ID3D11Device* device, WCHAR* filename)
 {
+	TextureAtlasClass::RemapType remap;
+	int i;
 	bool result;
 
-	// Create the texture object.
-	m_Texture = new TextureClass;
-	if (!m_Texture)
+	// Draw from the atlas when the font is packed in it, every glyph moved into the font's place there.
+	m_SharedTexture = m_Registry->AcquireAtlasTexture(filename, remap);
+	if (m_SharedTexture)
 	{
-		return false;
+		for (i = 0; i < FONT_GLYPH_COUNT; i++)
+		{
+			m_Font[i].left = m_Font[i].left * remap.uScale + remap.uOffset;
+			m_Font[i].right = m_Font[i].right * remap.uScale + remap.uOffset;
+		}
+
+		m_top = remap.vOffset;
+		m_bottom = remap.vOffset + remap.vScale;
+	}
+
+	// Otherwise get the texture from the registry, it is only read and created the first time it is asked for.
+	if (!m_SharedTexture)
+	{
+		m_SharedTexture = m_Registry->AcquireTexture(filename);
+		if (!m_SharedTexture)
+		{
+			return false;
+		}
 	}
 
-	// Initialize the texture object.
-	result = m_Texture->Initialize(device, filename);
+	result = m_Registry->CreateTexture(device, m_SharedTexture, false);
 	if (!result)
 	{
 		return false;
 	}
 
+	m_Texture = m_SharedTexture->texture;
+
 	return true;
 }
 
 void FontClass::ReleaseTexture()
 {
-	// Release the texture object.
-	if (m_Texture)
+	// Give the texture back to the registry.
+	if (m_SharedTexture)
 	{
-		m_Texture->Shutdown();
-		delete m_Texture;
+		m_Registry->ReleaseTexture(m_SharedTexture);
+		m_SharedTexture = 0;
 		m_Texture = 0;
 	}
 
@@ -142,67 +160,17 @@ ID3D11ShaderResourceView* FontClass::GetTexture()
 	return m_Texture->GetTexture();
 }
 
-void FontClass::BuildVertexArray(void* vertices, char* sentence, float drawX, float drawY)
+const FontClass::FontType* FontClass::GetGlyphs()
 {
-	VertexType* vertexPtr;
-	int numLetters, index, i, letter;
-
-	// Coerce the input vertices into a VertexType structure.
-	vertexPtr = (VertexType*)vertices;
-
-	// Get the number of letters in the sentence.
-	numLetters = (int)strlen(sentence);
-
-	// Initialize the index to the vertex array.
-	index = 0;
-
-	// Draw each letter onto a quad.
-	for (i = 0; i < numLetters; i++)
-	{
-		letter = ((int)sentence[i]) - 32;
+	return m_Font;
+}
 
-		// If the letter is a space then just move over three pixels.
-		if (letter == 0)
-		{
-			drawX = drawX + 3.0f;
-		}
-		else
-		{
-			// First triangle in quad.
-			// Top left.
-			vertexPtr[index].position = D3DXVECTOR3(drawX, drawY, 0.0f);
-			vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].left, 0.0f);
-			index++;
-
-			//Bottom right.
-			vertexPtr[index].position = D3DXVECTOR3((drawX + m_Font[letter].size), (drawY - 16), 0.0f);
-			vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].right, 1.0f);
-			index++;
-
-			// Bottom left.
-			vertexPtr[index].position = D3DXVECTOR3(drawX, (drawY - 16), 0.0f);
-			vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].left, 1.0f);
-			index++;
-
-			// Second triangle in quad.
-			// Top left.
-			vertexPtr[index].position = D3DXVECTOR3(drawX, drawY, 0.0f); 
-			vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].left, 0.0f);
-			index++;
-
-			// Top right.
-			vertexPtr[index].position = D3DXVECTOR3(drawX + m_Font[letter].size, drawY, 0.0f);
-			vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].right, 0.0f);
-			index++;
-			// Bottom right.
-			vertexPtr[index].position = D3DXVECTOR3((drawX + m_Font[letter].size), (drawY - 16), 0.0f);
-			vertexPtr[index].texture = D3DXVECTOR2(m_Font[letter].right, 1.0f);
-			index++;
-
-			// Update the x location for drawing by the size of the letter and one pixel.
-			drawX = drawX + m_Font[letter].size + 1.0f;
-		}
-	}
+float FontClass::GetTop()
+{
+	return m_top;
+}
 
-	return;
-}
\ No newline at end of file
+float FontClass::GetBottom()
+{
+	return m_bottom;
+}
@@ -4,38 +4,28 @@
 
 #include <d3d11.h>
 #include <d3dx10math.h>
-#include <fstream>
-
-using namespace std;
 
 #include "textureclass.h"
+#include "resourceregistryclass.h"
+#include "fontloaderclass.h"
 
 class FontClass
 {
 private:
-	struct FontType
-	{
-		float left, right;
-		int size;
-	};
-
-	struct VertexType
-	{
-		D3DXVECTOR3 position;
-		D3DXVECTOR2 texture;
-	};
+	typedef FontLoaderClass::GlyphType FontType;
 
 public:
 	FontClass();
 	FontClass(const FontClass&);
 	~FontClass();
 
-	bool Initialize(ID3D11Device*, char*, WCHAR*);
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, char*, WCHAR*);
 	void Shutdown();
 
 	ID3D11ShaderResourceView* GetTexture();
-
-	void BuildVertexArray(void*, char*, float, float);
+	const FontType* GetGlyphs();
+	float GetTop();
+	float GetBottom();
 
 private:
 	bool LoadFontData(char*);
@@ -46,5 +36,8 @@ private:
 private:
 	FontType* m_Font;
 	TextureClass* m_Texture;
+	ResourceRegistryClass* m_Registry;
+	ResourceRegistryClass::TextureType* m_SharedTexture;
+	float m_top, m_bottom;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "fontloaderclass.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Longest line the spacing file is expected to hold.
+static const int FONT_MAX_LINE = 128;
+
+FontLoaderClass::FontLoaderClass()
+{
+	memset(m_glyphs, 0, sizeof(m_glyphs));
+}
+
+FontLoaderClass::FontLoaderClass(const FontLoaderClass& other)
+{
+}
+
+FontLoaderClass::~FontLoaderClass()
+{
+}
+
+bool FontLoaderClass::Initialize(const char* filename)
+{
+	MappedFileClass* file;
+	const char *position, *end, *lineEnd;
+	bool result;
+	int i;
+
+	// Create the mapped file object.
+	file = new MappedFileClass;
+	if (!file)
+	{
+		return false;
+	}
+
+	// Map the font spacing file.
+	result = file->Initialize(filename);
+	if (!result)
+	{
+		file->Shutdown();
+		delete file;
+		return false;
+	}
+
+	// Read in the 95 used ascii characters for text, one per line.
+	position = file->GetData();
+	end = position + file->GetSize();
+	for (i = 0; i < FONT_GLYPH_COUNT && result; i++)
+	{
+		lineEnd = (const char*)memchr(position, '\n', end - position);
+		lineEnd = lineEnd ? lineEnd : end;
+
+		result = ParseLine(position, lineEnd, m_glyphs[i]);
+		position = (lineEnd < end) ? lineEnd + 1 : end;
+	}
+
+	// Release the mapped file object.
+	file->Shutdown();
+	delete file;
+	file = 0;
+
+	return result;
+}
+
+void FontLoaderClass::Shutdown()
+{
+	return;
+}
+
+const FontLoaderClass::GlyphType* FontLoaderClass::GetGlyphs()
+{
+	return m_glyphs;
+}
+
+bool FontLoaderClass::ParseLine(const char* begin, const char* end, GlyphType& glyph)
+{
+	char line[FONT_MAX_LINE];
+	char *position, *next;
+	size_t length;
+
+	// Copy the line so the number parsers stop at its end, the mapping is not terminated.
+	length = end - begin;
+	if (length >= sizeof(line))
+	{
+		return false;
+	}
+	memcpy(line, begin, length);
+	line[length] = '\0';
+
+	// Skip the ascii code and the character after it, which may itself be a space.
+	position = strchr(line, ' ');
+	if (!position || position[1] == '\0')
+	{
+		return false;
+	}
+	position += 2;
+
+	glyph.left = (float)strtod(position, &next);
+	if (next == position)
+	{
+		return false;
+	}
+
+	position = next;
+	glyph.right = (float)strtod(position, &next);
+	if (next == position)
+	{
+		return false;
+	}
+
+	position = next;
+	glyph.size = (int)strtol(position, &next, 10);
+	if (next == position)
+	{
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#ifndef _FONTLOADERCLASS_H_
+#define _FONTLOADERCLASS_H_
+
+#include "mappedfileclass.h"
+
+// Number of characters in a font, the printable ascii range from space to tilde.
+const int FONT_GLYPH_COUNT = 95;
+
+// Reads the font spacing file: one line per character holding its ascii code, the character, the left and
+// right texture coordinate of the glyph and its width in pixels. No Direct3D dependency.
+class FontLoaderClass
+{
+public:
+	struct GlyphType
+	{
+		float left, right;
+		int size;
+	};
+
+public:
+	FontLoaderClass();
+	FontLoaderClass(const FontLoaderClass&);
+	~FontLoaderClass();
+
+	bool Initialize(const char*);
+	void Shutdown();
+
+	const GlyphType* GetGlyphs();
+
+private:
+	bool ParseLine(const char*, const char*, GlyphType&);
+
+private:
+	GlyphType m_glyphs[FONT_GLYPH_COUNT];
+};
+#endif
@@ -0,0 +1,105 @@
+#include "frustumclass.h"
+
+#include <math.h>
+
+FrustumClass::FrustumClass()
+{
+}
+
+FrustumClass::FrustumClass(const FrustumClass& other)
+{
+}
+
+FrustumClass::~FrustumClass()
+{
+}
+
+void FrustumClass::ConstructFrustum(D3DXMATRIX matrix)
+{
+	int i;
+
+	// Calculate near plane of frustum.
+	m_planes[0].a = matrix._13;
+	m_planes[0].b = matrix._23;
+	m_planes[0].c = matrix._33;
+	m_planes[0].d = matrix._43;
+
+	// Calculate far plane of frustum.
+	m_planes[1].a = matrix._14 - matrix._13;
+	m_planes[1].b = matrix._24 - matrix._23;
+	m_planes[1].c = matrix._34 - matrix._33;
+	m_planes[1].d = matrix._44 - matrix._43;
+
+	// Calculate left plane of frustum.
+	m_planes[2].a = matrix._14 + matrix._11;
+	m_planes[2].b = matrix._24 + matrix._21;
+	m_planes[2].c = matrix._34 + matrix._31;
+	m_planes[2].d = matrix._44 + matrix._41;
+
+	// Calculate right plane of frustum.
+	m_planes[3].a = matrix._14 - matrix._11;
+	m_planes[3].b = matrix._24 - matrix._21;
+	m_planes[3].c = matrix._34 - matrix._31;
+	m_planes[3].d = matrix._44 - matrix._41;
+
+	// Calculate top plane of frustum.
+	m_planes[4].a = matrix._14 - matrix._12;
+	m_planes[4].b = matrix._24 - matrix._22;
+	m_planes[4].c = matrix._34 - matrix._32;
+	m_planes[4].d = matrix._44 - matrix._42;
+
+	// Calculate bottom plane of frustum.
+	m_planes[5].a = matrix._14 + matrix._12;
+	m_planes[5].b = matrix._24 + matrix._22;
+	m_planes[5].c = matrix._34 + matrix._32;
+	m_planes[5].d = matrix._44 + matrix._42;
+
+	// Normalize the planes so a plane distance can be compared with a radius.
+	for (i = 0; i < 6; i++)
+	{
+		D3DXPlaneNormalize(&m_planes[i], &m_planes[i]);
+	}
+
+	return;
+}
+
+bool FrustumClass::CheckSphere(float xCenter, float yCenter, float zCenter, float radius)
+{
+	D3DXVECTOR3 center;
+	int i;
+
+	center = D3DXVECTOR3(xCenter, yCenter, zCenter);
+
+	// Check if the sphere is completely behind any of the planes of the view frustum.
+	for (i = 0; i < 6; i++)
+	{
+		if (D3DXPlaneDotCoord(&m_planes[i], &center) < -radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool FrustumClass::CheckRectangle(float xCenter, float yCenter, float zCenter, float xSize, float ySize, float zSize)
+{
+	D3DXVECTOR3 center;
+	float extent;
+	int i;
+
+	center = D3DXVECTOR3(xCenter, yCenter, zCenter);
+
+	// Check if the box is completely behind any of the planes: its half sizes projected onto the plane normal
+	// give how far its nearest corner reaches towards the plane.
+	for (i = 0; i < 6; i++)
+	{
+		extent = xSize * fabsf(m_planes[i].a) + ySize * fabsf(m_planes[i].b) + zSize * fabsf(m_planes[i].c);
+		if (D3DXPlaneDotCoord(&m_planes[i], &center) < -extent)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#ifndef _FRUSTUMCLASS_H_
+#define _FRUSTUMCLASS_H_
+
+#include <d3dx10math.h>
+
+// The six planes of a view frustum. Built from a world * view * projection matrix the planes are in the
+// model's own space, so bounds stored with the model are tested without moving them into the world. Built
+// from view * projection they are in world space.
+class FrustumClass
+{
+public:
+	FrustumClass();
+	FrustumClass(const FrustumClass&);
+	~FrustumClass();
+
+	void ConstructFrustum(D3DXMATRIX);
+
+	bool CheckSphere(float, float, float, float);
+	bool CheckRectangle(float, float, float, float, float, float);
+
+private:
+	D3DXPLANE m_planes[6];
+};
+#endif
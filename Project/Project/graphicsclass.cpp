@@ -6,7 +6,15 @@ GraphicsClass::GraphicsClass()
 	m_Camera = 0;
 
 	for (int i = 0; i < 4; i++)
+	{
 		m_Model[i] = 0;
+		m_modelReady[i] = false;
+	}
+	m_Placeholder = 0;
+	m_AssetLoader = 0;
+	m_Registry = 0;
+	m_allModelsReady = false;
+	m_hwnd = 0;
 	m_LightShader = 0;
 	m_Light = 0;
 
@@ -19,6 +27,7 @@ GraphicsClass::GraphicsClass()
 	useLightingEffect[2] = true;
 
 	allPolygonCount = 0;
+	m_screenHeight = 0;
 }
 
 GraphicsClass::GraphicsClass(const GraphicsClass& other)
@@ -33,6 +42,14 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 {
 	bool result;
 	D3DXMATRIX baseViewMatrix;
+	char* modelFilename;
+	WCHAR* textureFilename;
+	vector<string> atlasSources;
+	int vertexFormat, residency;
+
+	// Keep the screen height for working out how large models are on screen, and the window for load errors.
+	m_screenHeight = screenHeight;
+	m_hwnd = hwnd;
 
 	// Create the Direct3D object.
 	m_D3D = new D3DClass;
@@ -63,6 +80,35 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 	m_Camera->Render();
 	m_Camera->GetViewMatrix(baseViewMatrix);
 
+	// Create the resource registry object, shared by everything that loads a mesh or a texture.
+	m_Registry = new ResourceRegistryClass;
+	if (!m_Registry)
+	{
+		return false;
+	}
+
+	// Initialize the resource registry object, with the GPU memory its textures may take.
+	result = m_Registry->Initialize(TEXTURE_BUDGET_BYTES, STREAM_TEXTURES);
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the resource registry object.", L"Error", MB_OK);
+		return false;
+	}
+
+	// Pack the font and the small textures into one atlas, cooked on the first run.
+	if (USE_TEXTURE_ATLAS)
+	{
+		atlasSources.push_back("../Project/data/font.dds");
+		atlasSources.push_back("../Project/data/seafloor.dds");
+
+		result = m_Registry->LoadAtlas(ATLAS_TABLE_FILE, atlasSources, ATLAS_FORMAT);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not load the texture atlas.", L"Error", MB_OK);
+			return false;
+		}
+	}
+
 	// Create the text object.
 	m_Text = new TextClass;
 	if (!m_Text)
@@ -71,13 +117,46 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 	}
 
 	// Initialize the text object.
-	result = m_Text->Initialize(m_D3D->GetDevice(), m_D3D->GetDeviceContext(), hwnd, screenWidth, screenHeight, baseViewMatrix);
+	result = m_Text->Initialize(m_D3D->GetDevice(), m_D3D->GetDeviceContext(), m_Registry, hwnd, screenWidth, screenHeight, baseViewMatrix);
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the text object.", L"Error", MB_OK);
 		return false;
 	}
 
+	// Create the placeholder object, drawn where a model is still loading.
+	m_Placeholder = new ModelClass;
+	if (!m_Placeholder)
+	{
+		return false;
+	}
+
+	// Initialize the placeholder object.
+	result = m_Placeholder->InitializePlaceholder(m_D3D->GetDevice());
+	if (!result)
+	{
+		MessageBox(hwnd, L"Could not initialize the placeholder object.", L"Error", MB_OK);
+		return false;
+	}
+
+	if (ASYNC_ASSET_LOADING)
+	{
+		// Create the asset loader object.
+		m_AssetLoader = new AssetLoaderClass;
+		if (!m_AssetLoader)
+		{
+			return false;
+		}
+
+		// Initialize the asset loader object with a thread per core, less the one rendering.
+		result = m_AssetLoader->Initialize(0);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not initialize the asset loader object.", L"Error", MB_OK);
+			return false;
+		}
+	}
+
 	for (int i = 0; i < 4; i++)
 	{
 		// Create the model object.
@@ -87,44 +166,61 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 			return false;
 		}
 
-		// Initialize the model object.
 		switch (i)
 		{
 		case 0:
-			result = m_Model[i]->Initialize(m_D3D->GetDevice(), "../Project/data/cube.obj", L"../Project/data/ground.dds");
-			if (!result)
-			{
-				MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
-				return false;
-			}
+			modelFilename = "../Project/data/cube.obj";
+			textureFilename = L"../Project/data/ground.dds";
+			vertexFormat = VERTEX_FORMAT_FLOAT;
+			residency = MESH_RESIDENCY_POSITIONS;
 			break;
 		case 1:
-			result = m_Model[i]->Initialize(m_D3D->GetDevice(), "../Project/data/car.obj", L"../Project/data/car.dds");
-			if (!result)
-			{
-				MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
-				return false;
-			}
+			modelFilename = "../Project/data/car.obj";
+			textureFilename = L"../Project/data/car.dds";
+			vertexFormat = VERTEX_FORMAT_UNORM_UV;
+			residency = MESH_RESIDENCY_NONE;
 			break;
 		case 2:
-			result = m_Model[i]->Initialize(m_D3D->GetDevice(), "../Project/data/penguin.obj", L"../Project/data/penguin.dds");
-			if (!result)
-			{
-				MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
-				return false;
-			}
+			modelFilename = "../Project/data/penguin.obj";
+			textureFilename = L"../Project/data/penguin.dds";
+			vertexFormat = VERTEX_FORMAT_UNORM_UV;
+			residency = MESH_RESIDENCY_NONE;
 			break;
-		case 3:
-			result = m_Model[i]->Initialize(m_D3D->GetDevice(), "../Project/data/chicken.obj", L"../Project/data/chicken.dds");
-			if (!result)
-			{
-				MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
-				return false;
-			}
+		default:
+			modelFilename = "../Project/data/chicken.obj";
+			textureFilename = L"../Project/data/chicken.dds";
+			vertexFormat = VERTEX_FORMAT_HALF_UV;
+			residency = MESH_RESIDENCY_NONE;
 			break;
 		}
 
-		allPolygonCount += m_Model[i]->GetPolygonCount();
+		// Read and prepare the model on a loading thread, its buffers and texture are created once it is done.
+		if (ASYNC_ASSET_LOADING)
+		{
+			ModelClass* model = m_Model[i];
+			ResourceRegistryClass* registry = m_Registry;
+
+			m_modelLoads[i] = m_AssetLoader->Submit([=]() { return model->Load(registry, modelFilename, textureFilename, OPTIMIZE_MESHES, vertexFormat, MESH_LOD_COUNT, residency); });
+			continue;
+		}
+
+		// Initialize the model object.
+		result = m_Model[i]->Initialize(m_D3D->GetDevice(), m_Registry, modelFilename, textureFilename, OPTIMIZE_MESHES, vertexFormat, MESH_LOD_COUNT, residency);
+		if (!result)
+		{
+			MessageBox(hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
+			return false;
+		}
+
+		m_modelReady[i] = true;
+	}
+
+	// Report the vertex format each model was uploaded in and what the packing cost in precision.
+	if (!ASYNC_ASSET_LOADING)
+	{
+		m_allModelsReady = true;
+		WriteMeshInfo();
+		WriteMemoryInfo();
 	}
 
 	// Create the light shader object.
@@ -179,7 +275,7 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 	//}
 
 	//// Initialize the bitmap object.
-	//result = m_Bitmap->Initialize(m_D3D->GetDevice(), screenWidth, screenHeight, L"../Project/data/seafloor.dds", 256, 256);
+	//result = m_Bitmap->Initialize(m_D3D->GetDevice(), m_Registry, screenWidth, screenHeight, L"../Project/data/seafloor.dds", 256, 256);
 	//if (!result)
 	//{
 	//	MessageBox(hwnd, L"Could not initialize the bitmap object.", L"Error", MB_OK);
@@ -191,9 +287,11 @@ bool GraphicsClass::Initialize(int screenWidth, int screenHeight, HWND hwnd)
 
 void GraphicsClass::Shutdown()
 {
-	// Release the text object.
+	// Release the text object, after reporting what its sentences cost to keep up to date.
 	if (m_Text)
 	{
+		WriteTextInfo();
+
 		m_Text->Shutdown();
 		delete m_Text;
 		m_Text = 0;
@@ -214,6 +312,35 @@ void GraphicsClass::Shutdown()
 		m_LightShader = 0;
 	}
 
+	// Release the asset loader object first, so no loading thread still works on a model.
+	if (m_AssetLoader)
+	{
+		m_AssetLoader->Shutdown();
+		delete m_AssetLoader;
+		m_AssetLoader = 0;
+	}
+
+	// Report how much the meshlet culling saved over the run before the models go.
+	if (CULL_MESHLETS)
+	{
+		WriteCullInfo();
+	}
+
+	// Report what the texture budget cost in evictions and reloads, and what the atlas saved in binds.
+	if (m_Registry)
+	{
+		WriteTextureCacheInfo();
+		WriteAtlasInfo();
+	}
+
+	// Release the placeholder object.
+	if (m_Placeholder)
+	{
+		m_Placeholder->Shutdown();
+		delete m_Placeholder;
+		m_Placeholder = 0;
+	}
+
 	// Release the model object.
 	for (int i = 0; i < 4; i++)
 	{
@@ -248,6 +375,14 @@ void GraphicsClass::Shutdown()
 		m_Camera = 0;
 	}
 
+	// Release the resource registry object once nothing holds a mesh or texture from it any more.
+	if (m_Registry)
+	{
+		m_Registry->Shutdown();
+		delete m_Registry;
+		m_Registry = 0;
+	}
+
 	// Release the Direct3D object.
 	if (m_D3D)
 	{
@@ -271,6 +406,19 @@ bool GraphicsClass::Frame(int fps, int cpu, float frameTime)
 		rotation -= 360.0f;
 	}
 
+	// Create the resources of the models that finished loading since the last frame.
+	if (!m_allModelsReady)
+	{
+		result = FinishLoads();
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	// Keep the textures drawn last frame and evict what was not drawn for longest when over the budget.
+	m_Registry->UpdateTextures(m_D3D->GetDevice());
+
 	// Render the graphics scene.
 	result = Render(rotation);
 	if (!result)
@@ -279,20 +427,20 @@ bool GraphicsClass::Frame(int fps, int cpu, float frameTime)
 	}
 
 	// Set the frames per second.
-	result = m_Text->SetFps(fps, m_D3D->GetDeviceContext());
+	result = m_Text->SetFps(fps);
 	if (!result)
 	{
 		return false;
 	}
 
 	// Set the cpu usage.
-	result = m_Text->SetCpu(cpu, m_D3D->GetDeviceContext());
+	result = m_Text->SetCpu(cpu);
 	if (!result)
 	{
 		return false;
 	}
 
-	result = m_Text->SetPolygonNum(allPolygonCount, m_D3D->GetDeviceContext());
+	result = m_Text->SetPolygonNum(allPolygonCount);
 	if (!result)
 	{
 		return false;
@@ -306,9 +454,52 @@ CameraClass * GraphicsClass::GetCamera()
 	return m_Camera;
 }
 
+bool GraphicsClass::FinishLoads()
+{
+	bool result;
+	int i, readyCount;
+
+	readyCount = 0;
+	for (i = 0; i < 4; i++)
+	{
+		if (!m_modelReady[i] && AssetLoaderClass::IsReady(m_modelLoads[i]))
+		{
+			// The file work is done, only the device calls are left for this thread.
+			result = m_modelLoads[i].get();
+			if (result)
+			{
+				result = m_Model[i]->CreateResources(m_D3D->GetDevice());
+			}
+
+			if (!result)
+			{
+				MessageBox(m_hwnd, L"Could not initialize the model object.", L"Error", MB_OK);
+				return false;
+			}
+
+			m_modelReady[i] = true;
+		}
+
+		readyCount += m_modelReady[i] ? 1 : 0;
+	}
+
+	// Report the vertex format each model was uploaded in and what the packing cost in precision.
+	if (readyCount == 4)
+	{
+		m_allModelsReady = true;
+		WriteMeshInfo();
+		WriteMemoryInfo();
+	}
+
+	return true;
+}
+
 bool GraphicsClass::Render(float rotation)
 {
 	D3DXMATRIX viewMatrix, projectionMatrix, worldMatrix, orthoMatrix;
+	FrustumClass frustum;
+	ID3D11ShaderResourceView* texture;
+	int drawnPolygonCount;
 	bool result;
 
 	// Clear the buffers to begin the scene.
@@ -370,7 +561,11 @@ bool GraphicsClass::Render(float rotation)
 	//	return false;
 	//}
 	
+	// World space frustum for testing the models' world bounds.
+	frustum.ConstructFrustum(viewMatrix * projectionMatrix);
+
 	// Put the model vertex and index buffers on the graphics pipeline to prepare them for drawing.		
+	drawnPolygonCount = 0;
 	for (int i = 0; i < 4; i++)
 	{
 		switch (i)
@@ -395,14 +590,309 @@ bool GraphicsClass::Render(float rotation)
 			break;
 		}
 
+		// Draw a box where the model will be until it has finished loading.
+		if (!m_modelReady[i])
+		{
+			drawnPolygonCount += m_Placeholder->GetIndexCount() / 3;
+
+			m_Placeholder->Render(m_D3D->GetDeviceContext());
+
+			result = m_LightShader->Render(m_D3D->GetDeviceContext(), m_Placeholder->GetIndexCount(), m_Model[i]->GetPlacementMatrix(), viewMatrix, projectionMatrix, m_Placeholder->GetTexture(), m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(), m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower(), useLightingEffect,
+				m_Placeholder->GetVertexFormat(), m_Placeholder->GetDequantize());
+			if (!result)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		// Move the bounds to where the model was placed, and skip it when its box is out of view.
+		m_Model[i]->UpdateWorldBounds();
+
+		const BoundingVolumeClass::BoundsType& bounds = m_Model[i]->GetWorldBounds();
+		if (!frustum.CheckRectangle(bounds.center[0], bounds.center[1], bounds.center[2], (bounds.boundsMax[0] - bounds.boundsMin[0]) * 0.5f,
+			(bounds.boundsMax[1] - bounds.boundsMin[1]) * 0.5f, (bounds.boundsMax[2] - bounds.boundsMin[2]) * 0.5f))
+		{
+			continue;
+		}
+
+		// Pick the detail level from how large the model is on screen. The projection's y scale over half the
+		// screen height turns a size at distance 1 into pixels.
+		m_Model[i]->SelectLod(m_Camera->GetPosition(), projectionMatrix._22 * m_screenHeight * 0.5f, LOD_PIXEL_ERROR);
+
+		// The larger levels of the textures that cover the most of the screen are streamed in first.
+		m_Registry->SetTexturePriority(m_Model[i]->GetSharedTexture(), m_Model[i]->GetProjectedSize());
+
+		// Drop the meshlets of that level that are out of view or face away from the camera.
+		if (CULL_MESHLETS)
+		{
+			result = m_Model[i]->Cull(m_D3D->GetDeviceContext(), viewMatrix, projectionMatrix, m_Camera->GetPosition());
+			if (!result)
+			{
+				return false;
+			}
+		}
+
+		drawnPolygonCount += m_Model[i]->GetIndexCount() / 3;
+		if (m_Model[i]->GetIndexCount() == 0)
+		{
+			continue;
+		}
+
 		m_Model[i]->Render(m_D3D->GetDeviceContext());
 
+		// A texture the cache evicted entirely is read back before the next frame, and a streamed one has none
+		// until its smallest levels are in; until then the model wears the placeholder's.
+		texture = m_Model[i]->GetTexture();
+		texture = texture ? texture : m_Placeholder->GetTexture();
+
 		// Render the model using the light shader.
-		result = m_LightShader->Render(m_D3D->GetDeviceContext(), m_Model[i]->GetIndexCount(), m_Model[i]->GetWorldMatrix(), viewMatrix, projectionMatrix, m_Model[i]->GetTexture(), m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(), m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower(), useLightingEffect);
+		result = m_LightShader->Render(m_D3D->GetDeviceContext(), m_Model[i]->GetIndexCount(), m_Model[i]->GetWorldMatrix(), viewMatrix, projectionMatrix, texture, m_Light->GetDirection(), m_Light->GetAmbientColor(), m_Light->GetDiffuseColor(), m_Camera->GetPosition(), m_Light->GetSpecularColor(), m_Light->GetSpecularPower(), useLightingEffect,
+			m_Model[i]->GetVertexFormat(), m_Model[i]->GetDequantize());
 	}
 
+	// Report the triangles of the detail levels and meshlets that were actually drawn.
+	allPolygonCount = drawnPolygonCount;
+
 	// Present the rendered scene to the screen.
 	m_D3D->EndScene();
 
 	return true;
+}
+
+void GraphicsClass::WriteMeshInfo()
+{
+	std::ofstream MeshFile;
+	int i, j, floatBytes, vertexBytes;
+
+	MeshFile.open("MeshInfo.txt");
+	if (!MeshFile.is_open())
+	{
+		return;
+	}
+
+	for (i = 0; i < 4; i++)
+	{
+		const VertexQuantizerClass::ErrorType& error = m_Model[i]->GetQuantizationError();
+
+		floatBytes = m_Model[i]->GetVertexCount() * VertexQuantizerClass::GetStride(VERTEX_FORMAT_FLOAT);
+		vertexBytes = m_Model[i]->GetVertexCount() * m_Model[i]->GetVertexStride();
+
+		MeshFile << m_Model[i]->GetName() << " : " << VertexQuantizerClass::GetFormatName(m_Model[i]->GetVertexFormat()) << std::endl;
+		MeshFile << "  vertices " << m_Model[i]->GetVertexCount() << ", " << vertexBytes << " bytes (float " << floatBytes << " bytes)" << std::endl;
+		MeshFile << "  max error position " << error.position << " (" << error.positionRelative * 100.0f << "% of diagonal), uv " << error.texcoord
+			<< ", normal " << error.normalDegrees << " degrees" << std::endl;
+		MeshFile << "  load scratch peak " << m_Model[i]->GetTransientPeakBytes() << " bytes, "
+			<< (m_Model[i]->IsFromCache() ? "read from cache" : (m_Model[i]->IsCacheWritten() ? "cache written" : "cache not written")) << std::endl;
+
+		for (j = 0; j < m_Model[i]->GetLodCount(); j++)
+		{
+			MeshFile << "  lod " << j << " : " << m_Model[i]->GetLodPolygonCount(j) << " triangles, error " << m_Model[i]->GetLodError(j) * 100.0f << "% of size, "
+				<< m_Model[i]->GetLodMeshletCount(j) << " meshlets" << std::endl;
+		}
+	}
+
+	MeshFile.close();
+
+	return;
+}
+
+void GraphicsClass::WriteCullInfo()
+{
+	std::ofstream CullFile;
+	unsigned long long meshlets, frustumCulled, backfaceCulled, triangles, drawnTriangles;
+	int i;
+
+	CullFile.open("CullInfo.txt");
+	if (!CullFile.is_open())
+	{
+		return;
+	}
+
+	// Fractions over every frame rendered, for each model and all of them together.
+	meshlets = frustumCulled = backfaceCulled = triangles = drawnTriangles = 0;
+	for (i = 0; i < 4; i++)
+	{
+		if (!m_Model[i])
+		{
+			continue;
+		}
+
+		const ModelClass::CullStatsType& stats = m_Model[i]->GetCullStats();
+		if (stats.meshlets == 0)
+		{
+			continue;
+		}
+
+		CullFile << m_Model[i]->GetName() << " : " << stats.frames << " frames, " << stats.meshlets / stats.frames << " meshlets per frame" << std::endl;
+		CullFile << "  meshlets culled " << (stats.frustumCulled + stats.backfaceCulled) * 100.0 / stats.meshlets << "% (frustum "
+			<< stats.frustumCulled * 100.0 / stats.meshlets << "%, backface " << stats.backfaceCulled * 100.0 / stats.meshlets << "%)" << std::endl;
+		CullFile << "  triangles culled " << (stats.triangles - stats.drawnTriangles) * 100.0 / stats.triangles << "%" << std::endl;
+
+		meshlets += stats.meshlets;
+		frustumCulled += stats.frustumCulled;
+		backfaceCulled += stats.backfaceCulled;
+		triangles += stats.triangles;
+		drawnTriangles += stats.drawnTriangles;
+	}
+
+	if (meshlets > 0)
+	{
+		CullFile << "all : meshlets culled " << (frustumCulled + backfaceCulled) * 100.0 / meshlets << "% (frustum " << frustumCulled * 100.0 / meshlets
+			<< "%, backface " << backfaceCulled * 100.0 / meshlets << "%), triangles culled " << (triangles - drawnTriangles) * 100.0 / triangles << "%" << std::endl;
+	}
+
+	CullFile.close();
+
+	return;
+}
+
+void GraphicsClass::WriteTextureCacheInfo()
+{
+	std::ofstream CacheFile;
+	TextureCacheClass::StatsType stats;
+
+	m_Registry->GetTextureCacheStats(stats);
+	if (stats.frameCount == 0)
+	{
+		return;
+	}
+
+	CacheFile.open("TextureCacheInfo.txt");
+	if (!CacheFile.is_open())
+	{
+		return;
+	}
+
+	CacheFile << "budget " << stats.budgetBytes << " bytes, peak resident " << stats.peakResidentBytes << " bytes over " << stats.frameCount << " frames" << std::endl;
+	CacheFile << "last frame : " << stats.textureCount << " textures, " << stats.residentBytes << " of " << stats.fullBytes << " bytes resident, "
+		<< stats.reducedCount << " reduced, " << stats.evictedCount << " evicted" << std::endl;
+	CacheFile << "evictions " << stats.totalEvictions << ", top levels dropped " << stats.totalMipDrops << ", reloads " << stats.totalReloads << std::endl;
+	if (stats.totalReloads > 0)
+	{
+		CacheFile << "reload " << stats.totalReloadMilliseconds / stats.totalReloads << " ms on average, " << stats.worstReloadMilliseconds << " ms at worst" << std::endl;
+	}
+
+	CacheFile.close();
+
+	return;
+}
+
+void GraphicsClass::WriteAtlasInfo()
+{
+	std::ofstream AtlasFile;
+	TextureCacheClass::StatsType cacheStats;
+	TextureAtlasClass::StatsType stats;
+	ResourceRegistryClass::StatsType registryStats;
+	unsigned long long bindCount, bindsSkipped;
+	bool atlas;
+
+	m_Registry->GetTextureCacheStats(cacheStats);
+	if (cacheStats.frameCount == 0)
+	{
+		return;
+	}
+
+	AtlasFile.open("AtlasInfo.txt");
+	if (!AtlasFile.is_open())
+	{
+		return;
+	}
+
+	atlas = m_Registry->GetAtlasStats(stats);
+	if (atlas)
+	{
+		m_Registry->GetStats(registryStats);
+		AtlasFile << "atlas " << stats.width << "x" << stats.height << ", " << stats.mipCount << " levels, " << stats.entryCount << " textures, occupancy "
+			<< stats.occupancy * 100.0f << "%" << std::endl;
+		AtlasFile << "drawn from the atlas : " << registryStats.atlasHits << " textures" << std::endl;
+	}
+	else
+	{
+		AtlasFile << "no atlas" << std::endl;
+	}
+
+	// A bind left out is one the atlas saved whenever the two draws would have had textures of their own.
+	TextureClass::GetBindCounts(bindCount, bindsSkipped);
+	AtlasFile << "binds " << (double)bindCount / cacheStats.frameCount << " per frame, " << (double)bindsSkipped / cacheStats.frameCount
+		<< " per frame left out as already bound, over " << cacheStats.frameCount << " frames" << std::endl;
+
+	AtlasFile.close();
+
+	return;
+}
+
+void GraphicsClass::WriteTextInfo()
+{
+	std::ofstream TextFile;
+	const TextBatchClass::StatsType& stats = m_Text->GetStats();
+
+	if (stats.frameCount == 0)
+	{
+		return;
+	}
+
+	TextFile.open("TextInfo.txt");
+	if (!TextFile.is_open())
+	{
+		return;
+	}
+
+	TextFile << "last frame : " << stats.sentenceCount << " sentences, " << stats.updates << " set, " << stats.layouts << " laid out, " << stats.vertexCount
+		<< " vertices, " << stats.uploadBytes << " bytes uploaded, " << stats.draws << " draws" << std::endl;
+	TextFile << "per frame over " << stats.frameCount << " frames : " << (double)stats.totalUpdates / stats.frameCount << " sentences set, "
+		<< (double)stats.totalLayouts / stats.frameCount << " laid out, " << (double)stats.totalUploadBytes / stats.frameCount << " bytes uploaded, "
+		<< (double)stats.totalDraws / stats.frameCount << " draws" << std::endl;
+
+	TextFile.close();
+
+	return;
+}
+
+void GraphicsClass::WriteMemoryInfo()
+{
+	std::ofstream MemoryFile;
+	ModelClass::MemoryStatsType stats;
+	ResourceRegistryClass::StatsType registryStats;
+	size_t cpuBytes, gpuBytes, cpuTotal, gpuTotal;
+	const char* residencyNames[] = { "none", "full", "positions" };
+	int i;
+
+	MemoryFile.open("MemoryInfo.txt");
+	if (!MemoryFile.is_open())
+	{
+		return;
+	}
+
+	cpuTotal = 0;
+	gpuTotal = 0;
+	for (i = 0; i < 4; i++)
+	{
+		m_Model[i]->GetMemoryStats(stats);
+
+		cpuBytes = stats.cpuIndices + stats.cpuMeshlets + stats.cpuVertices;
+		gpuBytes = stats.gpuVertices + stats.gpuIndices + stats.gpuVisibleIndices + stats.gpuTexture;
+
+		MemoryFile << m_Model[i]->GetName() << " : residency " << residencyNames[m_Model[i]->GetResidency()] << std::endl;
+		MemoryFile << "  cpu " << cpuBytes << " bytes (indices " << stats.cpuIndices << ", meshlets " << stats.cpuMeshlets << ", vertices "
+			<< stats.cpuVertices << ")" << std::endl;
+		MemoryFile << "  gpu " << gpuBytes << " bytes (vertex buffer " << stats.gpuVertices << ", index buffer " << stats.gpuIndices
+			<< ", visible index buffer " << stats.gpuVisibleIndices << ", texture " << stats.gpuTexture << ")" << std::endl;
+
+		cpuTotal += cpuBytes;
+		gpuTotal += gpuBytes;
+	}
+
+	MemoryFile << "all : cpu " << cpuTotal << " bytes, gpu " << gpuTotal << " bytes" << std::endl;
+
+	// Models drawn from the same files share one copy, the sums above count it for each of them.
+	m_Registry->GetStats(registryStats);
+	MemoryFile << "registry : " << registryStats.meshCount << " meshes, " << registryStats.meshHits << " hits, " << registryStats.meshMisses << " misses, "
+		<< registryStats.meshBytesSaved << " bytes saved" << std::endl;
+	MemoryFile << "registry : " << registryStats.textureCount << " textures, " << registryStats.textureHits << " hits, " << registryStats.textureMisses
+		<< " misses, " << registryStats.textureBytesSaved << " bytes saved" << std::endl;
+
+	MemoryFile.close();
+
+	return;
 }
\ No newline at end of file
@@ -3,6 +3,9 @@
 #ifndef _GRAPHICSCLASS_H_
 #define _GRAPHICSCLASS_H_
 
+#include <fstream>
+#include <future>
+
 #include "d3dclass.h"
 #include "cameraclass.h"
 #include "modelclass.h"
@@ -11,12 +14,24 @@
 #include "textureshaderclass.h"
 #include "bitmapclass.h"
 #include "textclass.h"
+#include "assetloaderclass.h"
+#include "resourceregistryclass.h"
 
 // Globals
 const bool FULL_SCREEN = false;
 const bool VSYNC_ENABLED = true;
 const float SCREEN_DEPTH = 1000.0f;
 const float SCREEN_NEAR = 0.1f;
+const bool OPTIMIZE_MESHES = true;
+const int MESH_LOD_COUNT = 4;
+const float LOD_PIXEL_ERROR = 1.0f;
+const bool CULL_MESHLETS = true;
+const bool ASYNC_ASSET_LOADING = true;
+const size_t TEXTURE_BUDGET_BYTES = 64 * 1024 * 1024;
+const bool STREAM_TEXTURES = true;
+const bool USE_TEXTURE_ATLAS = true;
+const char* const ATLAS_TABLE_FILE = "../Project/data/atlas.txt";
+const unsigned int ATLAS_FORMAT = DDS_FORMAT_BC3_UNORM;
 
 class GraphicsClass
 {
@@ -32,7 +47,14 @@ public:
 	CameraClass* GetCamera();		
 
 private:
+	bool FinishLoads();
 	bool Render(float);
+	void WriteMeshInfo();
+	void WriteCullInfo();
+	void WriteTextureCacheInfo();
+	void WriteAtlasInfo();
+	void WriteTextInfo();
+	void WriteMemoryInfo();
 
 private:
 	D3DClass* m_D3D;
@@ -40,9 +62,17 @@ private:
 	BitmapClass* m_Bitmap;
 	CameraClass* m_Camera;
 	ModelClass* m_Model[4];
+	ModelClass* m_Placeholder;
+	AssetLoaderClass* m_AssetLoader;
+	ResourceRegistryClass* m_Registry;
+	future<bool> m_modelLoads[4];
+	bool m_modelReady[4];
+	bool m_allModelsReady;
+	HWND m_hwnd;
 	LightShaderClass* m_LightShader;
 	LightClass* m_Light;
 	TextClass* m_Text;
+	int m_screenHeight;
 
 public:
 	bool useLightingEffect[3];
@@ -0,0 +1,54 @@
+#include "hashclass.h"
+
+#include <string.h>
+
+HashClass::HashClass()
+{
+}
+
+HashClass::HashClass(const HashClass& other)
+{
+}
+
+HashClass::~HashClass()
+{
+}
+
+unsigned long long HashClass::HashData(const char* data, size_t size)
+{
+	unsigned long long hash, word;
+	size_t i;
+
+	// FNV-1a, eight bytes per step. The multiply only carries bits upwards, so each word is mixed first or its
+	// high bytes would never reach the low bits of the hash.
+	hash = 14695981039346656037ull;
+	for (i = 0; i + 8 <= size; i += 8)
+	{
+		memcpy(&word, data + i, 8);
+		hash = (hash ^ Mix(word)) * 1099511628211ull;
+	}
+
+	for (; i < size; i++)
+	{
+		hash = (hash ^ (unsigned char)data[i]) * 1099511628211ull;
+	}
+
+	return Mix(hash ^ (unsigned long long)size);
+}
+
+unsigned long long HashClass::Combine(unsigned long long hash, unsigned long long other)
+{
+	return (hash ^ other) * 1099511628211ull;
+}
+
+unsigned long long HashClass::Mix(unsigned long long value)
+{
+	// The 64 bit finalizer of MurmurHash3, every input bit flips each output bit about half the time.
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdull;
+	value ^= value >> 33;
+	value *= 0xc4ceb93fe53a6ca3ull;
+	value ^= value >> 33;
+
+	return value;
+}
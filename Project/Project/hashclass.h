@@ -0,0 +1,26 @@
+#pragma once
+
+#ifndef _HASHCLASS_H_
+#define _HASHCLASS_H_
+
+#include <stddef.h>
+
+// 64 bit hash of a block of bytes for telling contents apart cheaply: cooked files from their sources, shared
+// resources from one another, text from what it was. It is FNV-1a taken eight bytes at a time, each word mixed
+// first so every one of its bits reaches every bit of the hash, and the result mixed again. Combine folds a
+// second hash into a first, order mattering. Equal hashes only make equal contents likely; nothing that has to
+// resist a deliberate collision, or that shares data on a match, may rely on them alone.
+class HashClass
+{
+public:
+	HashClass();
+	HashClass(const HashClass&);
+	~HashClass();
+
+	static unsigned long long HashData(const char*, size_t);
+	static unsigned long long Combine(unsigned long long, unsigned long long);
+
+private:
+	static unsigned long long Mix(unsigned long long);
+};
+#endif
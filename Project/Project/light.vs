@@ -12,6 +12,17 @@ cbuffer CameraBuffer
 	float padding;
 };
 
+// Bounds the quantized positions and texture coordinates are relative to, see VertexQuantizerClass.
+cbuffer DequantizeBuffer
+{
+	float3 positionScale;
+	float padding2;
+	float3 positionOffset;
+	float padding3;
+	float2 texcoordScale;
+	float2 texcoordOffset;
+};
+
 // Type definitions
 struct VertexInputType
 {
@@ -20,6 +31,14 @@ struct VertexInputType
 	float3 normal : NORMAL;
 };
 
+// The 16 byte layout: unorm16 position, half or unorm16 texture coordinate and an octahedral snorm16 normal.
+struct QuantizedVertexInputType
+{
+	float4 position : POSITION;
+	float2 tex : TEXCOORD0;
+	float2 normal : NORMAL;
+};
+
 struct PixelInputType
 {
 	float4 position : SV_POSITION;
@@ -61,4 +80,25 @@ PixelInputType LightVertexShader(VertexInputType input)
 	output.viewDirection = normalize(output.viewDirection);
 
 	return output;
+}
+
+// Vertex Shader for quantized vertices
+PixelInputType LightQuantizedVertexShader(QuantizedVertexInputType input)
+{
+	VertexInputType vertex;
+	float3 normal;
+	float fold;
+
+	// Scale the position and texture coordinate back out of their bounds.
+	vertex.position = float4(input.position.xyz * positionScale + positionOffset, 1.0f);
+	vertex.tex = input.tex * texcoordScale + texcoordOffset;
+
+	// Unfold the octahedral normal, the lower half was folded over the diagonals.
+	normal = float3(input.normal.xy, 1.0f - abs(input.normal.x) - abs(input.normal.y));
+	fold = saturate(-normal.z);
+	normal.xy += (normal.xy >= 0.0f) ? -fold : fold;
+	vertex.normal = normalize(normal);
+
+	// The rest is the same as for full float vertices.
+	return LightVertexShader(vertex);
 }
\ No newline at end of file
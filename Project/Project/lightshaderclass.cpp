@@ -1,10 +1,16 @@
 #include "lightshaderclass.h"
 
+#include "textureclass.h"
+
 LightShaderClass::LightShaderClass()
 {
 	m_vertexShader = 0;
 	m_pixelShader = 0;
 	m_layout = 0;
+	m_quantizedVertexShader = 0;
+	m_halfUvLayout = 0;
+	m_unormUvLayout = 0;
+	m_dequantizeBuffer = 0;
 	m_matrixBuffer = 0;
 	m_sampleState = 0;
 	m_lightBuffer = 0;
@@ -41,19 +47,21 @@ void LightShaderClass::Shutdown()
 	return;
 }
 
-bool LightShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 ambientColor, D3DXVECTOR4 diffuseColor, D3DXVECTOR3 cameraPosition, D3DXVECTOR4 specularColor, float specularPower, bool useLightingEffect[3])
+bool LightShaderClass::Render(ID3D11DeviceContext* deviceContext, int indexCount, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 ambientColor, D3DXVECTOR4 diffuseColor, D3DXVECTOR3 cameraPosition, D3DXVECTOR4 specularColor, float specularPower, bool useLightingEffect[3],
+							  int vertexFormat, const VertexQuantizerClass::DequantizeType* dequantize)
 {
 	bool result;
 
 	// Set the shader parameters that it will use for rendering.
-	result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambientColor, diffuseColor, cameraPosition, specularColor, specularPower, useLightingEffect);
+	result = SetShaderParameters(deviceContext, worldMatrix, viewMatrix, projectionMatrix, texture, lightDirection, ambientColor, diffuseColor, cameraPosition, specularColor, specularPower, useLightingEffect,
+								 (vertexFormat == VERTEX_FORMAT_FLOAT) ? 0 : dequantize);
 	if (!result)
 	{
 		return false;
 	}
 
 	// Now render the prepared buffers with the shader.
-	RenderShader(deviceContext, indexCount);
+	RenderShader(deviceContext, indexCount, vertexFormat);
 
 	return true;
 }
@@ -63,9 +71,11 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 	HRESULT result;
 	ID3D10Blob* errorMessage;
 	ID3D10Blob* vertexShaderBuffer;
+	ID3D10Blob* quantizedVertexShaderBuffer;
 	ID3D10Blob* pixelShaderBuffer;
 	D3D11_INPUT_ELEMENT_DESC polygonLayout[3];
 	unsigned int numElements;
+	D3D11_BUFFER_DESC dequantizeBufferDesc;
 	D3D11_SAMPLER_DESC samplerDesc;
 	D3D11_BUFFER_DESC matrixBufferDesc;	
 	D3D11_BUFFER_DESC lightBufferDesc;
@@ -74,6 +84,7 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 	// Initialize the pointers this function will use to null.
 	errorMessage = 0;
 	vertexShaderBuffer = 0;
+	quantizedVertexShaderBuffer = 0;
 	pixelShaderBuffer = 0;
 
 	// Compile the vertex shader code.
@@ -94,6 +105,22 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 		return false;
 	}
 
+	// Compile the vertex shader for the quantized vertex layouts from the same file.
+	result = D3DX11CompileFromFile(vsFilename, NULL, NULL, "LightQuantizedVertexShader", "vs_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &quantizedVertexShaderBuffer, &errorMessage, NULL);
+	if (FAILED(result))
+	{
+		if (errorMessage)
+		{
+			OutputShaderErrorMessage(errorMessage, hwnd, vsFilename);
+		}
+		else
+		{
+			MessageBox(hwnd, vsFilename, L"Missing Shader File", MB_OK);
+		}
+
+		return false;
+	}
+
 	// Compile the pixel shader code.
 	result = D3DX11CompileFromFile(psFilename, NULL, NULL, "LightPixelShader", "ps_5_0", D3D10_SHADER_ENABLE_STRICTNESS, 0, NULL, &pixelShaderBuffer, &errorMessage, NULL);
 	if (FAILED(result))
@@ -119,6 +146,12 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 		return false;
 	}
 
+	result = device->CreateVertexShader(quantizedVertexShaderBuffer->GetBufferPointer(), quantizedVertexShaderBuffer->GetBufferSize(), NULL, &m_quantizedVertexShader);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
 	// Create the pixel shader from the buffer.
 	result = device->CreatePixelShader(pixelShaderBuffer->GetBufferPointer(), pixelShaderBuffer->GetBufferSize(), NULL, &m_pixelShader);
 	if (FAILED(result))
@@ -162,10 +195,33 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 		return false;
 	}
 
-	// Release the vertex shader buffer and pixel shader buffer since they are no longer needed.
+	// The quantized layouts match VertexQuantizerClass::QuantizedVertexType, 16 bytes per vertex.
+	// Only the texture coordinate format differs between the half and the unorm version.
+	polygonLayout[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+	polygonLayout[1].Format = DXGI_FORMAT_R16G16_FLOAT;
+	polygonLayout[2].Format = DXGI_FORMAT_R16G16_SNORM;
+
+	result = device->CreateInputLayout(polygonLayout, numElements, quantizedVertexShaderBuffer->GetBufferPointer(), quantizedVertexShaderBuffer->GetBufferSize(), &m_halfUvLayout);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	polygonLayout[1].Format = DXGI_FORMAT_R16G16_UNORM;
+
+	result = device->CreateInputLayout(polygonLayout, numElements, quantizedVertexShaderBuffer->GetBufferPointer(), quantizedVertexShaderBuffer->GetBufferSize(), &m_unormUvLayout);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Release the vertex shader buffers and pixel shader buffer since they are no longer needed.
 	vertexShaderBuffer->Release();
 	vertexShaderBuffer = 0;
 
+	quantizedVertexShaderBuffer->Release();
+	quantizedVertexShaderBuffer = 0;
+
 	pixelShaderBuffer->Release();
 	pixelShaderBuffer = 0;
 
@@ -237,11 +293,32 @@ bool LightShaderClass::InitializeShader(ID3D11Device* device, HWND hwnd, WCHAR*
 		return false;
 	}
 
+	// Setup the description of the dequantize dynamic constant buffer that is in the quantized vertex shader.
+	dequantizeBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+	dequantizeBufferDesc.ByteWidth = sizeof(DequantizeBufferType);
+	dequantizeBufferDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	dequantizeBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	dequantizeBufferDesc.MiscFlags = 0;
+	dequantizeBufferDesc.StructureByteStride = 0;
+
+	result = device->CreateBuffer(&dequantizeBufferDesc, NULL, &m_dequantizeBuffer);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
 	return true;
 }
 
 void LightShaderClass::ShutdownShader()
 {
+	// Release the dequantize constant buffer.
+	if (m_dequantizeBuffer)
+	{
+		m_dequantizeBuffer->Release();
+		m_dequantizeBuffer = 0;
+	}
+
 	// Release the camera constant buffer.
 	if (m_cameraBuffer)
 	{
@@ -277,6 +354,26 @@ void LightShaderClass::ShutdownShader()
 		m_layout = 0;
 	}
 
+	// Release the quantized layouts.
+	if (m_unormUvLayout)
+	{
+		m_unormUvLayout->Release();
+		m_unormUvLayout = 0;
+	}
+
+	if (m_halfUvLayout)
+	{
+		m_halfUvLayout->Release();
+		m_halfUvLayout = 0;
+	}
+
+	// Release the quantized vertex shader.
+	if (m_quantizedVertexShader)
+	{
+		m_quantizedVertexShader->Release();
+		m_quantizedVertexShader = 0;
+	}
+
 	// Release the pixel shader.
 	if (m_pixelShader)
 	{
@@ -328,13 +425,14 @@ void LightShaderClass::OutputShaderErrorMessage(ID3D10Blob* errorMessage, HWND h
 	return;
 }
 
-bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 ambientColor, D3DXVECTOR4 diffuseColor, D3DXVECTOR3 cameraPosition, D3DXVECTOR4 specularColor, float specularPower, bool useLightingEffect[3])
+bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, ID3D11ShaderResourceView* texture, D3DXVECTOR3 lightDirection, D3DXVECTOR4 ambientColor, D3DXVECTOR4 diffuseColor, D3DXVECTOR3 cameraPosition, D3DXVECTOR4 specularColor, float specularPower, bool useLightingEffect[3], const VertexQuantizerClass::DequantizeType* dequantize)
 {
 	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
 	MatrixBufferType* dataPtr;
 	LightBufferType* dataPtr2;
 	CameraBufferType* dataPtr3;
+	DequantizeBufferType* dataPtr4;
 	unsigned int bufferNumber;
 
 	// Transpose the matrices to prepare them for the shader.
@@ -366,8 +464,8 @@ bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, D
 	// Finanly set the constant buffer in the vertex shader with the updated values.
 	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
 
-	// Set shader texture resource in the pixel shader.
-	deviceContext->PSSetShaderResources(0, 1, &texture);
+	// Set shader texture resource in the pixel shader, unless it is already set.
+	TextureClass::Bind(deviceContext, texture);
 
 	// Lock the light constant buffer so it can be written to.
 	result = deviceContext->Map(m_lightBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
@@ -422,16 +520,55 @@ bool LightShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext, D
 	// Now set the camera constant buffer in the vertex shader with the updated values.
 	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_cameraBuffer);
 
+	// Quantized models also need the bounds their vertices were packed into.
+	if (dequantize)
+	{
+		result = deviceContext->Map(m_dequantizeBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		dataPtr4 = (DequantizeBufferType*)mappedResource.pData;
+
+		dataPtr4->positionScale = D3DXVECTOR3(dequantize->positionScale);
+		dataPtr4->padding = 0.0f;
+		dataPtr4->positionOffset = D3DXVECTOR3(dequantize->positionOffset);
+		dataPtr4->padding2 = 0.0f;
+		dataPtr4->texcoordScale = D3DXVECTOR2(dequantize->texcoordScale);
+		dataPtr4->texcoordOffset = D3DXVECTOR2(dequantize->texcoordOffset);
+
+		deviceContext->Unmap(m_dequantizeBuffer, 0);
+
+		// The dequantize constant buffer follows the camera buffer in the vertex shader.
+		bufferNumber = 2;
+
+		deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_dequantizeBuffer);
+	}
+
 	return true;
 }
 
-void LightShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount)
+void LightShaderClass::RenderShader(ID3D11DeviceContext* deviceContext, int indexCount, int vertexFormat)
 {
-	// Set the vertex input layout.
-	deviceContext->IASetInputLayout(m_layout);
+	// Set the vertex input layout and vertex shader matching the model's vertex format.
+	switch (vertexFormat)
+	{
+	case VERTEX_FORMAT_HALF_UV:
+		deviceContext->IASetInputLayout(m_halfUvLayout);
+		deviceContext->VSSetShader(m_quantizedVertexShader, NULL, 0);
+		break;
+	case VERTEX_FORMAT_UNORM_UV:
+		deviceContext->IASetInputLayout(m_unormUvLayout);
+		deviceContext->VSSetShader(m_quantizedVertexShader, NULL, 0);
+		break;
+	default:
+		deviceContext->IASetInputLayout(m_layout);
+		deviceContext->VSSetShader(m_vertexShader, NULL, 0);
+		break;
+	}
 
-	// Set the vertex and pixel shaders that will be used to render this triangle.
-	deviceContext->VSSetShader(m_vertexShader, NULL, 0);
+	// Set the pixel shader that will be used to render this triangle.
 	deviceContext->PSSetShader(m_pixelShader, NULL, 0);
 
 	// Set the sampler state in the pixel shader.
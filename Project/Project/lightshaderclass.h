@@ -7,6 +7,8 @@
 #include <d3dx11async.h>
 #include <fstream>
 
+#include "vertexquantizerclass.h"
+
 using namespace std;
 
 class LightShaderClass
@@ -38,6 +40,16 @@ private:
 		float padding;
 	};	
 
+	struct DequantizeBufferType
+	{
+		D3DXVECTOR3 positionScale;
+		float padding;
+		D3DXVECTOR3 positionOffset;
+		float padding2;
+		D3DXVECTOR2 texcoordScale;
+		D3DXVECTOR2 texcoordOffset;
+	};
+
 public:
 	LightShaderClass();
 	LightShaderClass(const LightShaderClass&);
@@ -46,20 +58,25 @@ public:
 	bool Initialize(ID3D11Device*, HWND);
 	void Shutdown();
 	bool Render(ID3D11DeviceContext*, int, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX,
-				ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4, D3DXVECTOR4, D3DXVECTOR3, D3DXVECTOR4, float, bool[3]);
+				ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4, D3DXVECTOR4, D3DXVECTOR3, D3DXVECTOR4, float, bool[3],
+				int, const VertexQuantizerClass::DequantizeType*);
 
 private:
 	bool InitializeShader(ID3D11Device*, HWND, WCHAR*, WCHAR*);
 	void ShutdownShader();
 	void OutputShaderErrorMessage(ID3D10Blob*, HWND, WCHAR*);
 
-	bool SetShaderParameters(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4, D3DXVECTOR4, D3DXVECTOR3, D3DXVECTOR4, float, bool[3]);
-	void RenderShader(ID3D11DeviceContext*, int);
+	bool SetShaderParameters(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXMATRIX, ID3D11ShaderResourceView*, D3DXVECTOR3, D3DXVECTOR4, D3DXVECTOR4, D3DXVECTOR3, D3DXVECTOR4, float, bool[3], const VertexQuantizerClass::DequantizeType*);
+	void RenderShader(ID3D11DeviceContext*, int, int);
 	   
 private:
 	ID3D11VertexShader* m_vertexShader;
 	ID3D11PixelShader* m_pixelShader;
 	ID3D11InputLayout* m_layout;
+	ID3D11VertexShader* m_quantizedVertexShader;
+	ID3D11InputLayout* m_halfUvLayout;
+	ID3D11InputLayout* m_unormUvLayout;
+	ID3D11Buffer* m_dequantizeBuffer;
 	ID3D11Buffer* m_matrixBuffer;
 	ID3D11SamplerState* m_sampleState;
 	ID3D11Buffer* m_lightBuffer;
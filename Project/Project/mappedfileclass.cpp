@@ -0,0 +1,189 @@
+#include "mappedfileclass.h"
+
+#ifndef _WIN32
+#include <stdlib.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+MappedFileClass::MappedFileClass()
+{
+	m_data = 0;
+	m_size = 0;
+
+#ifdef _WIN32
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = 0;
+#else
+	m_file = -1;
+#endif
+}
+
+MappedFileClass::MappedFileClass(const MappedFileClass& other)
+{
+}
+
+MappedFileClass::~MappedFileClass()
+{
+}
+
+bool MappedFileClass::Initialize(const char* filename)
+{
+#ifdef _WIN32
+	// Open the file for sequential read only access.
+	m_file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+#else
+	// Open the file for read only access.
+	m_file = open(filename, O_RDONLY);
+#endif
+
+	return MapFile();
+}
+
+bool MappedFileClass::Initialize(const wchar_t* filename)
+{
+#ifdef _WIN32
+	// Open the file for sequential read only access.
+	m_file = CreateFileW(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+
+	return MapFile();
+#else
+	char narrowFilename[PATH_MAX];
+	size_t length;
+
+	// Paths are narrow strings here, in the current locale's encoding.
+	length = wcstombs(narrowFilename, filename, sizeof(narrowFilename));
+	if (length == (size_t)-1 || length >= sizeof(narrowFilename))
+	{
+		return false;
+	}
+
+	return Initialize(narrowFilename);
+#endif
+}
+
+bool MappedFileClass::MapFile()
+{
+#ifdef _WIN32
+	LARGE_INTEGER fileSize;
+
+	if (m_file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+
+	if (!GetFileSizeEx(m_file, &fileSize))
+	{
+		return false;
+	}
+	m_size = (size_t)fileSize.QuadPart;
+
+	// An empty file can not be mapped, but it is still a valid file.
+	if (m_size == 0)
+	{
+		return true;
+	}
+
+	// Map the whole file into the address space.
+	m_mapping = CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m_mapping)
+	{
+		return false;
+	}
+
+	m_data = (const char*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!m_data)
+	{
+		return false;
+	}
+#else
+	struct stat fileInfo;
+	void* data;
+
+	if (m_file < 0)
+	{
+		return false;
+	}
+
+	if (fstat(m_file, &fileInfo) != 0)
+	{
+		return false;
+	}
+	m_size = (size_t)fileInfo.st_size;
+
+	// An empty file can not be mapped, but it is still a valid file.
+	if (m_size == 0)
+	{
+		return true;
+	}
+
+	// Map the whole file into the address space.
+	data = mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	m_data = (const char*)data;
+
+	// The file is read front to back, so let the kernel read ahead aggressively.
+	madvise(data, m_size, MADV_SEQUENTIAL);
+#endif
+
+	return true;
+}
+
+void MappedFileClass::Shutdown()
+{
+#ifdef _WIN32
+	// Release the view and the mapping object.
+	if (m_data)
+	{
+		UnmapViewOfFile(m_data);
+		m_data = 0;
+	}
+
+	if (m_mapping)
+	{
+		CloseHandle(m_mapping);
+		m_mapping = 0;
+	}
+
+	// Close the file.
+	if (m_file != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_file);
+		m_file = INVALID_HANDLE_VALUE;
+	}
+#else
+	// Release the mapping.
+	if (m_data)
+	{
+		munmap((void*)m_data, m_size);
+		m_data = 0;
+	}
+
+	// Close the file.
+	if (m_file >= 0)
+	{
+		close(m_file);
+		m_file = -1;
+	}
+#endif
+
+	m_size = 0;
+
+	return;
+}
+
+const char* MappedFileClass::GetData()
+{
+	return m_data;
+}
+
+size_t MappedFileClass::GetSize()
+{
+	return m_size;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#ifndef _MAPPEDFILECLASS_H_
+#define _MAPPEDFILECLASS_H_
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+class MappedFileClass
+{
+public:
+	MappedFileClass();
+	MappedFileClass(const MappedFileClass&);
+	~MappedFileClass();
+
+	bool Initialize(const char*);
+	bool Initialize(const wchar_t*);
+	void Shutdown();
+
+	const char* GetData();
+	size_t GetSize();
+
+private:
+	bool MapFile();
+
+private:
+	const char* m_data;
+	size_t m_size;
+
+#ifdef _WIN32
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	int m_file;
+#endif
+};
+#endif
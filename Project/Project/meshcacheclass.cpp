@@ -0,0 +1,329 @@
+#include "meshcacheclass.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+
+#include "hashclass.h"
+
+// Bump whenever the layout of the cooked file or the hash of its source changes, older caches are then rebuilt
+// from the source.
+static const unsigned int MESH_VERSION = 5;
+
+// Vertex data starts on a cache line boundary after the header, which must fit in front of it.
+static const unsigned int MESH_DATA_ALIGNMENT = 128;
+
+MeshCacheClass::MeshCacheClass()
+{
+	m_File = 0;
+	m_header = 0;
+	m_sourceHash = 0;
+	m_sourceSize = 0;
+	m_vertexStride = 0;
+	m_flags = 0;
+}
+
+MeshCacheClass::MeshCacheClass(const MeshCacheClass& other)
+{
+}
+
+MeshCacheClass::~MeshCacheClass()
+{
+}
+
+bool MeshCacheClass::Initialize(const char* sourceFilename, int vertexStride, unsigned int flags)
+{
+	MappedFileClass* source;
+	size_t extension;
+	bool result;
+
+	m_vertexStride = vertexStride;
+	m_flags = flags;
+
+	// The cache lives next to the source file with a .mesh extension.
+	m_cacheFilename = sourceFilename;
+	extension = m_cacheFilename.find_last_of('.');
+	if (extension != string::npos && m_cacheFilename.find_first_of("/\\", extension) == string::npos)
+	{
+		m_cacheFilename.erase(extension);
+	}
+	m_cacheFilename += ".mesh";
+
+	// Hash the source so an edited model is never served from a stale cache.
+	source = new MappedFileClass;
+	if (!source)
+	{
+		return false;
+	}
+
+	result = source->Initialize(sourceFilename);
+	if (result)
+	{
+		m_sourceHash = HashClass::HashData(source->GetData(), source->GetSize());
+		m_sourceSize = source->GetSize();
+	}
+
+	source->Shutdown();
+	delete source;
+	source = 0;
+
+	if (!result)
+	{
+		return false;
+	}
+
+	// Map the cooked file, if there is one.
+	m_File = new MappedFileClass;
+	if (!m_File)
+	{
+		return false;
+	}
+
+	// Make sure it is complete and was cooked from this exact source. A cache that is not stays unmapped, so
+	// Write can replace the file.
+	result = m_File->Initialize(m_cacheFilename.c_str());
+	if (result)
+	{
+		result = Validate();
+	}
+
+	if (!result)
+	{
+		m_File->Shutdown();
+		delete m_File;
+		m_File = 0;
+		return false;
+	}
+
+	return true;
+}
+
+void MeshCacheClass::Shutdown()
+{
+	// Release the mapping of the cooked file.
+	if (m_File)
+	{
+		m_File->Shutdown();
+		delete m_File;
+		m_File = 0;
+	}
+
+	m_header = 0;
+
+	return;
+}
+
+bool MeshCacheClass::Write(const void* vertices, int vertexCount, const unsigned int* indices, int indexCount, const LodType* lods, int lodCount,
+						   const MeshletBuilderClass::MeshletType* meshlets, int meshletCount, const BoundingVolumeClass::BoundsType& bounds)
+{
+	ofstream fout;
+	HeaderType header;
+	string temporaryFilename;
+	char padding[MESH_DATA_ALIGNMENT];
+	bool result;
+
+	// A cache still mapped can not be replaced.
+	if (m_File)
+	{
+		return false;
+	}
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "MESH", 4);
+	header.version = MESH_VERSION;
+	header.vertexStride = (unsigned int)m_vertexStride;
+	header.vertexCount = (unsigned int)vertexCount;
+	header.indexCount = (unsigned int)indexCount;
+	header.vertexOffset = MESH_DATA_ALIGNMENT;
+	header.indexOffset = header.vertexOffset + header.vertexStride * header.vertexCount;
+	header.flags = m_flags;
+	header.lodCount = (unsigned int)lodCount;
+	header.lodOffset = header.indexOffset + sizeof(unsigned int) * header.indexCount;
+	header.meshletCount = (unsigned int)meshletCount;
+	header.meshletOffset = header.lodOffset + sizeof(LodType) * header.lodCount;
+	header.sourceHash = m_sourceHash;
+	header.sourceSize = m_sourceSize;
+
+	// Bounding box and sphere, the sphere is centred on the box.
+	memcpy(header.boundsMin, bounds.boundsMin, sizeof(header.boundsMin));
+	memcpy(header.boundsMax, bounds.boundsMax, sizeof(header.boundsMax));
+	header.boundsRadius = bounds.radius;
+
+	// Write the header, padded out to the data alignment, followed by the vertex, index, detail level and meshlet arrays.
+	// They go to a file next to the cache that replaces it once complete, so a crash never leaves half a cache.
+	temporaryFilename = m_cacheFilename + ".tmp";
+	fout.open(temporaryFilename.c_str(), ios::out | ios::binary | ios::trunc);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	memset(padding, 0, sizeof(padding));
+	fout.write((const char*)&header, sizeof(header));
+	fout.write(padding, MESH_DATA_ALIGNMENT - sizeof(header));
+	fout.write((const char*)vertices, (streamsize)header.vertexStride * header.vertexCount);
+	fout.write((const char*)indices, (streamsize)sizeof(unsigned int) * header.indexCount);
+	fout.write((const char*)lods, (streamsize)sizeof(LodType) * header.lodCount);
+	fout.write((const char*)meshlets, (streamsize)sizeof(MeshletBuilderClass::MeshletType) * header.meshletCount);
+
+	fout.close();
+	result = !fout.fail();
+
+#ifdef _WIN32
+	result = result && MoveFileExA(temporaryFilename.c_str(), m_cacheFilename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	result = result && rename(temporaryFilename.c_str(), m_cacheFilename.c_str()) == 0;
+#endif
+
+	if (!result)
+	{
+		remove(temporaryFilename.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+const void* MeshCacheClass::GetVertices()
+{
+	return m_File->GetData() + m_header->vertexOffset;
+}
+
+int MeshCacheClass::GetVertexCount()
+{
+	return m_header ? (int)m_header->vertexCount : 0;
+}
+
+const unsigned int* MeshCacheClass::GetIndices()
+{
+	return (const unsigned int*)(m_File->GetData() + m_header->indexOffset);
+}
+
+int MeshCacheClass::GetIndexCount()
+{
+	return m_header ? (int)m_header->indexCount : 0;
+}
+
+const MeshCacheClass::LodType* MeshCacheClass::GetLods()
+{
+	return (const LodType*)(m_File->GetData() + m_header->lodOffset);
+}
+
+int MeshCacheClass::GetLodCount()
+{
+	return m_header ? (int)m_header->lodCount : 0;
+}
+
+const MeshletBuilderClass::MeshletType* MeshCacheClass::GetMeshlets()
+{
+	return (const MeshletBuilderClass::MeshletType*)(m_File->GetData() + m_header->meshletOffset);
+}
+
+int MeshCacheClass::GetMeshletCount()
+{
+	return m_header ? (int)m_header->meshletCount : 0;
+}
+
+void MeshCacheClass::GetBounds(BoundingVolumeClass::BoundsType& bounds)
+{
+	int i;
+
+	for (i = 0; i < 3; i++)
+	{
+		bounds.boundsMin[i] = m_header->boundsMin[i];
+		bounds.boundsMax[i] = m_header->boundsMax[i];
+		bounds.center[i] = (m_header->boundsMin[i] + m_header->boundsMax[i]) * 0.5f;
+	}
+	bounds.radius = m_header->boundsRadius;
+
+	return;
+}
+
+bool MeshCacheClass::Validate()
+{
+	const HeaderType* header;
+	const LodType* lods;
+	const MeshletBuilderClass::MeshletType* meshlets;
+	const unsigned int* indices;
+	unsigned long long vertexEnd, indexEnd, lodEnd, meshletEnd;
+	unsigned int i, j;
+
+	if (m_File->GetSize() < sizeof(HeaderType))
+	{
+		return false;
+	}
+
+	header = (const HeaderType*)m_File->GetData();
+
+	if (memcmp(header->magic, "MESH", 4) != 0 || header->version != MESH_VERSION)
+	{
+		return false;
+	}
+
+	if (header->vertexStride != (unsigned int)m_vertexStride || header->flags != m_flags || header->indexCount % 3 != 0)
+	{
+		return false;
+	}
+
+	if (header->sourceHash != m_sourceHash || header->sourceSize != m_sourceSize)
+	{
+		return false;
+	}
+
+	// The arrays must lie inside the file, so a cache cut short by a crash is rejected.
+	vertexEnd = (unsigned long long)header->vertexOffset + (unsigned long long)header->vertexStride * header->vertexCount;
+	indexEnd = (unsigned long long)header->indexOffset + sizeof(unsigned int) * (unsigned long long)header->indexCount;
+	lodEnd = (unsigned long long)header->lodOffset + sizeof(LodType) * (unsigned long long)header->lodCount;
+	meshletEnd = (unsigned long long)header->meshletOffset + sizeof(MeshletBuilderClass::MeshletType) * (unsigned long long)header->meshletCount;
+	if (header->vertexOffset < sizeof(HeaderType) || vertexEnd > header->indexOffset || indexEnd > header->lodOffset || lodEnd > header->meshletOffset ||
+		meshletEnd > m_File->GetSize())
+	{
+		return false;
+	}
+
+	// At least the full mesh, and no more levels than a model can hold.
+	if (header->lodCount < 1 || header->lodCount > (unsigned int)MESH_MAX_LODS || header->indexOffset % sizeof(unsigned int) != 0 ||
+		header->lodOffset % sizeof(unsigned int) != 0 || header->meshletOffset % sizeof(unsigned int) != 0)
+	{
+		return false;
+	}
+
+	// Every detail level must be whole triangles inside the index array, and its meshlets inside the level.
+	lods = (const LodType*)(m_File->GetData() + header->lodOffset);
+	meshlets = (const MeshletBuilderClass::MeshletType*)(m_File->GetData() + header->meshletOffset);
+	for (i = 0; i < header->lodCount; i++)
+	{
+		if (lods[i].indexCount % 3 != 0 || (unsigned long long)lods[i].indexStart + lods[i].indexCount > header->indexCount)
+		{
+			return false;
+		}
+
+		if ((unsigned long long)lods[i].meshletStart + lods[i].meshletCount > header->meshletCount)
+		{
+			return false;
+		}
+
+		for (j = lods[i].meshletStart; j < lods[i].meshletStart + lods[i].meshletCount; j++)
+		{
+			if (meshlets[j].indexStart < lods[i].indexStart ||
+				(unsigned long long)meshlets[j].indexStart + meshlets[j].triangleCount * 3ull > (unsigned long long)lods[i].indexStart + lods[i].indexCount)
+			{
+				return false;
+			}
+		}
+	}
+
+	// Every index must name a vertex of the file, the bounds, culling and packing read the vertices it names.
+	indices = (const unsigned int*)(m_File->GetData() + header->indexOffset);
+	for (i = 0; i < header->indexCount; i++)
+	{
+		if (indices[i] >= header->vertexCount)
+		{
+			return false;
+		}
+	}
+
+	m_header = header;
+
+	return true;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#ifndef _MESHCACHECLASS_H_
+#define _MESHCACHECLASS_H_
+
+#include <string>
+
+#include "mappedfileclass.h"
+#include "meshletbuilderclass.h"
+#include "boundingvolumeclass.h"
+using namespace std;
+
+// Processing steps applied to the cooked data. A cache cooked with different steps is rebuilt.
+const unsigned int MESH_FLAG_OPTIMIZED = 0x1;
+const unsigned int MESH_FLAG_LOD_SHIFT = 8;
+
+// Most detail levels a cooked mesh can hold, level 0 being the full mesh.
+const int MESH_MAX_LODS = 4;
+
+// Cooked binary copy of a model next to its source file (car.obj -> car.mesh), so a valid cache skips the obj
+// parser, the optimizer, the simplifier and the meshlet builder. The vertices are stored as float vertices: a
+// model uploaded in the float format takes them straight from the file mapping, a quantized one packs them
+// again on every load. The index, detail level and meshlet arrays are copied out of the mapping.
+// The index array holds every detail level back to back, all indexing the same vertices, and each level is
+// split into meshlets whose index ranges follow one another inside it.
+class MeshCacheClass
+{
+public:
+	struct LodType
+	{
+		unsigned int indexStart;
+		unsigned int indexCount;
+		float error;
+		unsigned int meshletStart;
+		unsigned int meshletCount;
+	};
+
+private:
+	struct HeaderType
+	{
+		char magic[4];
+		unsigned int version;
+		unsigned int vertexStride;
+		unsigned int vertexCount;
+		unsigned int indexCount;
+		unsigned int vertexOffset;
+		unsigned int indexOffset;
+		unsigned int flags;
+		unsigned int lodCount;
+		unsigned int lodOffset;
+		unsigned int meshletCount;
+		unsigned int meshletOffset;
+		unsigned long long sourceHash;
+		unsigned long long sourceSize;
+		float boundsMin[3];
+		float boundsMax[3];
+		float boundsRadius;
+	};
+
+public:
+	MeshCacheClass();
+	MeshCacheClass(const MeshCacheClass&);
+	~MeshCacheClass();
+
+	bool Initialize(const char*, int, unsigned int);
+	void Shutdown();
+	bool Write(const void*, int, const unsigned int*, int, const LodType*, int, const MeshletBuilderClass::MeshletType*, int, const BoundingVolumeClass::BoundsType&);
+
+	const void* GetVertices();
+	int GetVertexCount();
+	const unsigned int* GetIndices();
+	int GetIndexCount();
+	const LodType* GetLods();
+	int GetLodCount();
+	const MeshletBuilderClass::MeshletType* GetMeshlets();
+	int GetMeshletCount();
+	void GetBounds(BoundingVolumeClass::BoundsType&);
+
+private:
+	bool Validate();
+
+private:
+	MappedFileClass* m_File;
+	const HeaderType* m_header;
+	string m_cacheFilename;
+	unsigned long long m_sourceHash, m_sourceSize;
+	int m_vertexStride;
+	unsigned int m_flags;
+};
+#endif
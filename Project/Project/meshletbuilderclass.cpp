@@ -0,0 +1,455 @@
+#include "meshletbuilderclass.h"
+
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+// A meshlet that runs out of connected triangles is closed once it is this full, otherwise it grows on
+// with the nearest triangle left, so small separate parts do not each end up in a meshlet of their own.
+static const int MESHLET_MIN_TRIANGLES = MESHLET_MAX_TRIANGLES / 4;
+
+// How much a normal pointing away from the meshlet's average counts against a triangle, next to its distance.
+static const float CONE_WEIGHT = 2.0f;
+
+struct SortPositionType
+{
+	float x, y, z;
+	unsigned int index;
+};
+
+static bool ComparePositions(const SortPositionType& a, const SortPositionType& b)
+{
+	if (a.x != b.x)
+	{
+		return a.x < b.x;
+	}
+	if (a.y != b.y)
+	{
+		return a.y < b.y;
+	}
+	if (a.z != b.z)
+	{
+		return a.z < b.z;
+	}
+
+	return a.index < b.index;
+}
+
+static inline const float* GetPosition(const void* vertices, int stride, unsigned int index)
+{
+	return (const float*)((const char*)vertices + (size_t)index * stride);
+}
+
+// Unnormalized face normal, pointing out of a clockwise front face; its length is twice the area.
+static inline void FaceNormal(const float* a, const float* b, const float* c, float normal[3])
+{
+	float e0[3], e1[3];
+	int i;
+
+	for (i = 0; i < 3; i++)
+	{
+		e0[i] = b[i] - a[i];
+		e1[i] = c[i] - a[i];
+	}
+
+	normal[0] = e0[1] * e1[2] - e0[2] * e1[1];
+	normal[1] = e0[2] * e1[0] - e0[0] * e1[2];
+	normal[2] = e0[0] * e1[1] - e0[1] * e1[0];
+}
+
+MeshletBuilderClass::MeshletBuilderClass()
+{
+}
+
+MeshletBuilderClass::MeshletBuilderClass(const MeshletBuilderClass& other)
+{
+}
+
+MeshletBuilderClass::~MeshletBuilderClass()
+{
+}
+
+void MeshletBuilderClass::Build(unsigned int* indices, int indexCount, const void* vertices, int vertexCount, int stride, unsigned int indexBase,
+								vector<MeshletType>& meshlets)
+{
+	vector<unsigned int> output, positions;
+	vector<int> vertexStamp, positionStamp;
+	vector<unsigned char> emitted;
+	MeshletType meshlet;
+	float centroid[3], normal[3], length, distance, cost, bestCost, expectedRadius, area;
+	int triangleCount, emittedCount, scan, stamp, best, bestExtra, extra, meshletVertices, meshletTriangles, meshletStart;
+	int i, j, k, t;
+	unsigned int index, position;
+
+	triangleCount = indexCount / 3;
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	// Centroids, normals and the triangles around every position, which is what the meshlets grow along.
+	BuildTriangles(indices, indexCount, vertices, stride);
+	BuildAdjacency(indices, indexCount, vertices, vertexCount, stride);
+
+	// Rough radius of a full meshlet, the distance scale of the growing cost.
+	area = 0.0f;
+	for (i = 0; i < triangleCount; i++)
+	{
+		FaceNormal(GetPosition(vertices, stride, indices[i * 3 + 0]), GetPosition(vertices, stride, indices[i * 3 + 1]), GetPosition(vertices, stride, indices[i * 3 + 2]), normal);
+		area += 0.5f * sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	}
+	expectedRadius = sqrtf(area / triangleCount * MESHLET_MAX_TRIANGLES / 3.14159265f);
+	expectedRadius = (expectedRadius > 0.0f) ? expectedRadius : 1.0f;
+
+	output.reserve(indexCount);
+	emitted.assign(triangleCount, 0);
+	vertexStamp.assign(vertexCount, -1);
+	positionStamp.assign(m_adjacencyOffsets.size() - 1, -1);
+
+	emittedCount = 0;
+	scan = 0;
+	stamp = 0;
+	meshletVertices = 0;
+	meshletTriangles = 0;
+	meshletStart = 0;
+	centroid[0] = centroid[1] = centroid[2] = 0.0f;
+	normal[0] = normal[1] = normal[2] = 0.0f;
+
+	while (emittedCount < triangleCount)
+	{
+		// Take the triangle around the meshlet's positions that adds the fewest new vertices, and among those
+		// the one closest to its centre and best lined up with its normals.
+		best = -1;
+		bestExtra = 4;
+		bestCost = FLT_MAX;
+		if (meshletTriangles > 0 && meshletTriangles < MESHLET_MAX_TRIANGLES)
+		{
+			length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+			length = (length > 0.0f) ? 1.0f / length : 0.0f;
+
+			for (i = 0; i < (int)positions.size(); i++)
+			{
+				for (j = m_adjacencyOffsets[positions[i]]; j < m_adjacencyOffsets[positions[i] + 1]; j++)
+				{
+					t = m_adjacency[j];
+					if (emitted[t])
+					{
+						continue;
+					}
+
+					extra = 0;
+					for (k = 0; k < 3; k++)
+					{
+						extra += (vertexStamp[indices[t * 3 + k]] != stamp) ? 1 : 0;
+					}
+
+					if (meshletVertices + extra > MESHLET_MAX_VERTICES || extra > bestExtra)
+					{
+						continue;
+					}
+
+					distance = 0.0f;
+					cost = 0.0f;
+					for (k = 0; k < 3; k++)
+					{
+						distance += (m_centroids[t * 3 + k] - centroid[k] / meshletTriangles) * (m_centroids[t * 3 + k] - centroid[k] / meshletTriangles);
+						cost += m_normals[t * 3 + k] * normal[k] * length;
+					}
+					cost = sqrtf(distance) / expectedRadius + CONE_WEIGHT * (1.0f - cost);
+
+					if (extra < bestExtra || cost < bestCost)
+					{
+						best = t;
+						bestExtra = extra;
+						bestCost = cost;
+					}
+				}
+			}
+
+			// Nothing connected is left; a meshlet that is still small takes the nearest triangle that fits.
+			if (best < 0 && meshletTriangles < MESHLET_MIN_TRIANGLES && meshletVertices + 3 <= MESHLET_MAX_VERTICES)
+			{
+				for (t = scan; t < triangleCount; t++)
+				{
+					if (emitted[t])
+					{
+						continue;
+					}
+
+					distance = 0.0f;
+					for (k = 0; k < 3; k++)
+					{
+						distance += (m_centroids[t * 3 + k] - centroid[k] / meshletTriangles) * (m_centroids[t * 3 + k] - centroid[k] / meshletTriangles);
+					}
+
+					if (distance < bestCost)
+					{
+						best = t;
+						bestCost = distance;
+					}
+				}
+			}
+		}
+
+		// Close the meshlet when it is full or has nothing left to grow into.
+		if (best < 0 && meshletTriangles > 0)
+		{
+			meshlet.indexStart = indexBase + (unsigned int)meshletStart;
+			meshlet.triangleCount = (unsigned int)meshletTriangles;
+			meshlet.vertexCount = (unsigned int)meshletVertices;
+			ComputeBounds(&output[meshletStart], vertices, stride, meshlet);
+			meshlets.push_back(meshlet);
+
+			stamp++;
+			positions.clear();
+			meshletVertices = 0;
+			meshletTriangles = 0;
+			meshletStart = (int)output.size();
+			centroid[0] = centroid[1] = centroid[2] = 0.0f;
+			normal[0] = normal[1] = normal[2] = 0.0f;
+			continue;
+		}
+
+		// A new meshlet starts at the first triangle left in the source order.
+		if (best < 0)
+		{
+			while (emitted[scan])
+			{
+				scan++;
+			}
+			best = scan;
+		}
+
+		// Add the triangle to the meshlet.
+		emitted[best] = 1;
+		emittedCount++;
+		meshletTriangles++;
+		for (k = 0; k < 3; k++)
+		{
+			index = indices[best * 3 + k];
+			output.push_back(index);
+
+			if (vertexStamp[index] != stamp)
+			{
+				vertexStamp[index] = stamp;
+				meshletVertices++;
+			}
+
+			position = m_positionIds[index];
+			if (positionStamp[position] != stamp)
+			{
+				positionStamp[position] = stamp;
+				positions.push_back(position);
+			}
+
+			centroid[k] += m_centroids[best * 3 + k];
+			normal[k] += m_normals[best * 3 + k];
+		}
+	}
+
+	// Close the last meshlet.
+	meshlet.indexStart = indexBase + (unsigned int)meshletStart;
+	meshlet.triangleCount = (unsigned int)meshletTriangles;
+	meshlet.vertexCount = (unsigned int)meshletVertices;
+	ComputeBounds(&output[meshletStart], vertices, stride, meshlet);
+	meshlets.push_back(meshlet);
+
+	// Write the triangles back in meshlet order.
+	for (i = 0; i < indexCount; i++)
+	{
+		indices[i] = output[i];
+	}
+
+	return;
+}
+
+bool MeshletBuilderClass::IsBackfacing(const MeshletType& meshlet, const float cameraPosition[3])
+{
+	float offset[3], along, distanceSquared, across, sinAngle;
+	int i;
+
+	// The normals spread 90 degrees or more, some triangle always faces the camera.
+	if (meshlet.coneCutoff <= 0.0f)
+	{
+		return false;
+	}
+
+	// Every triangle faces away when the whole sphere lies inside the cone around the axis whose half angle is
+	// 90 degrees less the spread of the normals, with its apex at the camera.
+	along = 0.0f;
+	distanceSquared = 0.0f;
+	for (i = 0; i < 3; i++)
+	{
+		offset[i] = meshlet.center[i] - cameraPosition[i];
+		along += offset[i] * meshlet.coneAxis[i];
+		distanceSquared += offset[i] * offset[i];
+	}
+
+	across = sqrtf(max(distanceSquared - along * along, 0.0f));
+	sinAngle = sqrtf(max(1.0f - meshlet.coneCutoff * meshlet.coneCutoff, 0.0f));
+
+	return meshlet.coneCutoff * along - sinAngle * across >= meshlet.radius;
+}
+
+void MeshletBuilderClass::BuildTriangles(const unsigned int* indices, int indexCount, const void* vertices, int stride)
+{
+	const float *a, *b, *c;
+	float normal[3], length;
+	int i, j, triangleCount;
+
+	triangleCount = indexCount / 3;
+	m_centroids.resize(triangleCount * 3);
+	m_normals.resize(triangleCount * 3);
+
+	for (i = 0; i < triangleCount; i++)
+	{
+		a = GetPosition(vertices, stride, indices[i * 3 + 0]);
+		b = GetPosition(vertices, stride, indices[i * 3 + 1]);
+		c = GetPosition(vertices, stride, indices[i * 3 + 2]);
+
+		FaceNormal(a, b, c, normal);
+		length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		length = (length > 0.0f) ? 1.0f / length : 0.0f;
+
+		for (j = 0; j < 3; j++)
+		{
+			m_centroids[i * 3 + j] = (a[j] + b[j] + c[j]) / 3.0f;
+			m_normals[i * 3 + j] = normal[j] * length;
+		}
+	}
+
+	return;
+}
+
+void MeshletBuilderClass::BuildAdjacency(const unsigned int* indices, int indexCount, const void* vertices, int vertexCount, int stride)
+{
+	vector<SortPositionType> sorted;
+	vector<int> fill;
+	const float* position;
+	int i, first, positionCount;
+
+	// Vertices split only by a texture coordinate or normal seam share a position id, so meshlets grow across
+	// seams as well.
+	sorted.resize(vertexCount);
+	for (i = 0; i < vertexCount; i++)
+	{
+		position = GetPosition(vertices, stride, (unsigned int)i);
+		sorted[i].x = position[0];
+		sorted[i].y = position[1];
+		sorted[i].z = position[2];
+		sorted[i].index = (unsigned int)i;
+	}
+	sort(sorted.begin(), sorted.end(), ComparePositions);
+
+	m_positionIds.resize(vertexCount);
+	positionCount = 0;
+	for (i = 0; i < vertexCount; i = first)
+	{
+		for (first = i; first < vertexCount; first++)
+		{
+			if (sorted[first].x != sorted[i].x || sorted[first].y != sorted[i].y || sorted[first].z != sorted[i].z)
+			{
+				break;
+			}
+			m_positionIds[sorted[first].index] = (unsigned int)positionCount;
+		}
+		positionCount++;
+	}
+
+	// Triangles around each position, as offsets into one array.
+	m_adjacencyOffsets.assign(positionCount + 1, 0);
+	for (i = 0; i < indexCount; i++)
+	{
+		m_adjacencyOffsets[m_positionIds[indices[i]] + 1]++;
+	}
+	for (i = 0; i < positionCount; i++)
+	{
+		m_adjacencyOffsets[i + 1] += m_adjacencyOffsets[i];
+	}
+
+	m_adjacency.resize(indexCount);
+	fill.assign(m_adjacencyOffsets.begin(), m_adjacencyOffsets.end() - 1);
+	for (i = 0; i < indexCount; i++)
+	{
+		m_adjacency[fill[m_positionIds[indices[i]]]++] = i / 3;
+	}
+
+	return;
+}
+
+void MeshletBuilderClass::ComputeBounds(const unsigned int* indices, const void* vertices, int stride, MeshletType& meshlet)
+{
+	const float* position;
+	float boundsMin[3], boundsMax[3], normal[3], axis[3], offset[3], length, distance, radius, minimumDot, dot;
+	int i, j, indexCount;
+
+	indexCount = (int)meshlet.triangleCount * 3;
+
+	// Sphere around the box of the positions.
+	for (i = 0; i < indexCount; i++)
+	{
+		position = GetPosition(vertices, stride, indices[i]);
+		for (j = 0; j < 3; j++)
+		{
+			boundsMin[j] = (i == 0 || position[j] < boundsMin[j]) ? position[j] : boundsMin[j];
+			boundsMax[j] = (i == 0 || position[j] > boundsMax[j]) ? position[j] : boundsMax[j];
+		}
+	}
+
+	for (j = 0; j < 3; j++)
+	{
+		meshlet.center[j] = (boundsMin[j] + boundsMax[j]) * 0.5f;
+	}
+
+	radius = 0.0f;
+	for (i = 0; i < indexCount; i++)
+	{
+		position = GetPosition(vertices, stride, indices[i]);
+		distance = 0.0f;
+		for (j = 0; j < 3; j++)
+		{
+			offset[j] = position[j] - meshlet.center[j];
+			distance += offset[j] * offset[j];
+		}
+		radius = max(radius, distance);
+	}
+	meshlet.radius = sqrtf(radius);
+
+	// Cone around the face normals: the axis is their average, the cutoff the cosine of the widest of them.
+	axis[0] = axis[1] = axis[2] = 0.0f;
+	for (i = 0; i < indexCount; i += 3)
+	{
+		FaceNormal(GetPosition(vertices, stride, indices[i]), GetPosition(vertices, stride, indices[i + 1]), GetPosition(vertices, stride, indices[i + 2]), normal);
+		length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 0.0f)
+		{
+			for (j = 0; j < 3; j++)
+			{
+				axis[j] += normal[j] / length;
+			}
+		}
+	}
+
+	length = sqrtf(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+	for (j = 0; j < 3; j++)
+	{
+		meshlet.coneAxis[j] = (length > 0.0f) ? axis[j] / length : 0.0f;
+	}
+
+	minimumDot = (length > 0.0f) ? 1.0f : -1.0f;
+	for (i = 0; i < indexCount && minimumDot > 0.0f; i += 3)
+	{
+		FaceNormal(GetPosition(vertices, stride, indices[i]), GetPosition(vertices, stride, indices[i + 1]), GetPosition(vertices, stride, indices[i + 2]), normal);
+		length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 0.0f)
+		{
+			dot = (normal[0] * meshlet.coneAxis[0] + normal[1] * meshlet.coneAxis[1] + normal[2] * meshlet.coneAxis[2]) / length;
+			minimumDot = min(minimumDot, dot);
+		}
+	}
+
+	// Zero or less means the normals spread too far for the meshlet to ever face away as a whole.
+	meshlet.coneCutoff = (minimumDot > 0.0f) ? minimumDot : -1.0f;
+
+	return;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#ifndef _MESHLETBUILDERCLASS_H_
+#define _MESHLETBUILDERCLASS_H_
+
+#include <vector>
+using namespace std;
+
+// Limits of one meshlet, the sizes mesh shader hardware is tuned for.
+const int MESHLET_MAX_VERTICES = 64;
+const int MESHLET_MAX_TRIANGLES = 124;
+
+// Splits an indexed triangle list into meshlets: small clusters of neighbouring triangles, each with a
+// bounding sphere and a cone bounding its normals, so a whole cluster can be skipped when it is outside the
+// view or faces away from the camera. The triangles are reordered in place so every meshlet is one
+// contiguous index range. Vertices are passed as a byte stride with the position as the first three floats.
+class MeshletBuilderClass
+{
+public:
+	struct MeshletType
+	{
+		unsigned int indexStart;
+		unsigned int triangleCount;
+		unsigned int vertexCount;
+		float center[3];
+		float radius;
+		float coneAxis[3];
+		float coneCutoff;
+	};
+
+public:
+	MeshletBuilderClass();
+	MeshletBuilderClass(const MeshletBuilderClass&);
+	~MeshletBuilderClass();
+
+	void Build(unsigned int*, int, const void*, int, int, unsigned int, vector<MeshletType>&);
+
+	static bool IsBackfacing(const MeshletType&, const float[3]);
+
+private:
+	void BuildTriangles(const unsigned int*, int, const void*, int);
+	void BuildAdjacency(const unsigned int*, int, const void*, int, int);
+	void ComputeBounds(const unsigned int*, const void*, int, MeshletType&);
+
+private:
+	vector<float> m_centroids, m_normals;
+	vector<unsigned int> m_positionIds;
+	vector<int> m_adjacencyOffsets, m_adjacency;
+};
+#endif
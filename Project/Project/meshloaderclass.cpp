@@ -0,0 +1,791 @@
+#include "meshloaderclass.h"
+
+#include <string.h>
+#include <algorithm>
+
+// Largest error, relative to the size of the mesh, one detail level may add to the one before it.
+static const float LOD_MAX_ERROR = 0.05f;
+
+// Alignment of the arrays taken from the load arena.
+static const size_t MESH_ARENA_ALIGNMENT = 16;
+
+MeshLoaderClass::MeshLoaderClass()
+{
+	m_vertices = 0;
+	m_floatVertices = 0;
+	m_sourceIndices = 0;
+	m_indices = 0;
+	m_meshlets = 0;
+	m_vertexCount = 0;
+	m_indexCount = 0;
+	m_meshletCount = 0;
+	m_polygonCount = 0;
+	m_vertexFormat = VERTEX_FORMAT_FLOAT;
+	m_fromCache = false;
+	m_cacheWritten = false;
+
+	memset(m_lods, 0, sizeof(m_lods));
+	m_lodCount = 0;
+	memset(&m_bounds, 0, sizeof(m_bounds));
+
+	memset(&m_dequantize, 0, sizeof(m_dequantize));
+	memset(&m_quantizationError, 0, sizeof(m_quantizationError));
+	m_unitTexcoords = false;
+
+	m_residency = MESH_RESIDENCY_NONE;
+	m_retainedVertices = 0;
+	m_positions = 0;
+
+	m_Cache = 0;
+	m_Arena = 0;
+	m_transientPeakBytes = 0;
+	m_uploadVertices = 0;
+}
+
+MeshLoaderClass::MeshLoaderClass(const MeshLoaderClass& other)
+{
+}
+
+MeshLoaderClass::~MeshLoaderClass()
+{
+}
+
+bool MeshLoaderClass::Initialize(const char* filename, bool optimize, int vertexFormat, int lodCount, int residency)
+{
+	unsigned int flags;
+	bool result;
+
+	// The cache keeps full float vertices, they are packed into the requested format at the end.
+	m_vertexFormat = vertexFormat;
+	m_residency = residency;
+
+	// Create the mesh cache object.
+	m_Cache = new MeshCacheClass;
+	if (!m_Cache)
+	{
+		return false;
+	}
+
+	// Map the cooked mesh if there is one that is up to date with the model file and was cooked the same way.
+	flags = (optimize ? MESH_FLAG_OPTIMIZED : 0) | ((unsigned int)lodCount << MESH_FLAG_LOD_SHIFT);
+	result = m_Cache->Initialize(filename, sizeof(ObjLoaderClass::VertexType), flags);
+	m_fromCache = result;
+	if (result)
+	{
+		m_vertexCount = m_Cache->GetVertexCount();
+		m_indexCount = m_Cache->GetIndexCount();
+
+		// Copy the detail levels, level 0 is the full mesh.
+		m_lodCount = m_Cache->GetLodCount();
+		memcpy(m_lods, m_Cache->GetLods(), sizeof(MeshCacheClass::LodType) * m_lodCount);
+		m_polygonCount = m_lods[0].indexCount / 3;
+
+		m_Cache->GetBounds(m_bounds);
+
+		// Keep the indices and meshlets, the culling pass copies the visible meshlets' triangles every frame.
+		m_meshletCount = m_Cache->GetMeshletCount();
+		m_indices = new unsigned int[m_indexCount];
+		m_meshlets = new MeshletBuilderClass::MeshletType[m_meshletCount];
+		if (!m_indices || !m_meshlets)
+		{
+			return false;
+		}
+
+		memcpy(m_indices, m_Cache->GetIndices(), sizeof(unsigned int) * m_indexCount);
+		memcpy(m_meshlets, m_Cache->GetMeshlets(), sizeof(MeshletBuilderClass::MeshletType) * m_meshletCount);
+
+		// The vertices are uploaded straight from the mapped file, which stays open until then.
+		m_floatVertices = (const ObjLoaderClass::VertexType*)m_Cache->GetVertices();
+		m_uploadVertices = m_floatVertices;
+	}
+	else
+	{
+		// Load in the model data, with room behind the indices for the lower detail levels.
+		result = LoadModel(filename, lodCount);
+		if (result && optimize)
+		{
+			// Reorder the model for the vertex cache, overdraw and vertex fetch before it is uploaded and cooked.
+			OptimizeModel();
+		}
+
+		if (result)
+		{
+			// Build the lower detail levels behind the full mesh in the index array.
+			result = GenerateLods(lodCount, optimize);
+		}
+
+		if (result)
+		{
+			// Split every level into meshlets for the culling pass.
+			result = BuildMeshlets(optimize);
+		}
+
+		// Cook the mesh so the next run can skip the obj parser. A read only data folder is not an error.
+		if (result)
+		{
+			ComputeBounds();
+			m_cacheWritten = m_Cache->Write(m_vertices, m_vertexCount, m_indices, m_indexCount, m_lods, m_lodCount, m_meshlets, m_meshletCount, m_bounds);
+			m_floatVertices = m_vertices;
+			m_uploadVertices = m_vertices;
+		}
+
+		// Nothing is read from the cache, release it.
+		m_Cache->Shutdown();
+		delete m_Cache;
+		m_Cache = 0;
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	// Pack the vertices into the compact layout if the model asked for one.
+	if (m_vertexFormat != VERTEX_FORMAT_FLOAT)
+	{
+		result = PackVertices();
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool MeshLoaderClass::InitializeBox()
+{
+	static const float normals[6][3] = { { 1.0f, 0.0f, 0.0f }, { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, -1.0f } };
+	static const float corners[4][2] = { { -1.0f, -1.0f }, { -1.0f, 1.0f }, { 1.0f, 1.0f }, { 1.0f, -1.0f } };
+	float u[3], v[3];
+	int face, i, j;
+
+	m_vertexFormat = VERTEX_FORMAT_FLOAT;
+
+	// A unit box, four vertices and two triangles per face.
+	m_vertexCount = 24;
+	m_indexCount = 36;
+	m_polygonCount = 12;
+
+	m_vertices = (ObjLoaderClass::VertexType*)AllocateTransient(sizeof(ObjLoaderClass::VertexType) * m_vertexCount);
+	m_indices = new unsigned int[m_indexCount];
+	if (!m_vertices || !m_indices)
+	{
+		return false;
+	}
+
+	for (face = 0; face < 6; face++)
+	{
+		// Two axes across the face, ordered so the triangles wind clockwise seen from outside.
+		u[0] = (normals[face][0] == 0.0f) ? 1.0f : 0.0f;
+		u[1] = (normals[face][0] == 0.0f) ? 0.0f : 1.0f;
+		u[2] = 0.0f;
+		v[0] = u[1] * normals[face][2] - u[2] * normals[face][1];
+		v[1] = u[2] * normals[face][0] - u[0] * normals[face][2];
+		v[2] = u[0] * normals[face][1] - u[1] * normals[face][0];
+
+		for (i = 0; i < 4; i++)
+		{
+			ObjLoaderClass::VertexType& vertex = m_vertices[face * 4 + i];
+
+			vertex.x = 0.5f * (normals[face][0] + corners[i][0] * u[0] + corners[i][1] * v[0]);
+			vertex.y = 0.5f * (normals[face][1] + corners[i][0] * u[1] + corners[i][1] * v[1]);
+			vertex.z = 0.5f * (normals[face][2] + corners[i][0] * u[2] + corners[i][1] * v[2]);
+			vertex.tu = 0.5f * (corners[i][0] + 1.0f);
+			vertex.tv = 0.5f * (corners[i][1] + 1.0f);
+			vertex.nx = normals[face][0];
+			vertex.ny = normals[face][1];
+			vertex.nz = normals[face][2];
+		}
+
+		for (j = 0; j < 3; j++)
+		{
+			m_indices[face * 6 + j] = face * 4 + j;
+			m_indices[face * 6 + 3 + j] = face * 4 + ((j == 0) ? 0 : j + 1);
+		}
+	}
+
+	// One detail level and no meshlets, it is always drawn whole.
+	m_lodCount = 1;
+	m_lods[0].indexStart = 0;
+	m_lods[0].indexCount = (unsigned int)m_indexCount;
+	m_lods[0].error = 0.0f;
+	m_lods[0].meshletStart = 0;
+	m_lods[0].meshletCount = 0;
+	m_meshletCount = 0;
+
+	ComputeBounds();
+	m_floatVertices = m_vertices;
+	m_uploadVertices = m_vertices;
+
+	return true;
+}
+
+void MeshLoaderClass::Shutdown()
+{
+	// Release the upload data first, then the arrays kept for culling and the retained vertices.
+	ReleaseUploadData();
+
+	if (m_retainedVertices)
+	{
+		delete[] m_retainedVertices;
+		m_retainedVertices = 0;
+	}
+
+	if (m_positions)
+	{
+		delete[] m_positions;
+		m_positions = 0;
+	}
+
+	if (m_indices)
+	{
+		delete[] m_indices;
+		m_indices = 0;
+	}
+
+	if (m_meshlets)
+	{
+		delete[] m_meshlets;
+		m_meshlets = 0;
+	}
+
+	return;
+}
+
+void MeshLoaderClass::ReleaseUploadData()
+{
+	// Copy out what the residency policy keeps while the float vertices are still around. Without the memory
+	// for it the mesh simply keeps nothing, it still draws.
+	if (m_floatVertices && !RetainVertices())
+	{
+		m_residency = MESH_RESIDENCY_NONE;
+	}
+
+	// Release the mapping of the cooked mesh.
+	if (m_Cache)
+	{
+		m_Cache->Shutdown();
+		delete m_Cache;
+		m_Cache = 0;
+	}
+
+	// Release the load arena and with it every temporary array: the float and packed vertices and the
+	// scratch indices. Its high water mark is kept for the mesh report.
+	if (m_Arena)
+	{
+		m_transientPeakBytes = m_Arena->GetPeakBytes();
+		m_Arena->Shutdown();
+		delete m_Arena;
+		m_Arena = 0;
+	}
+
+	m_vertices = 0;
+	m_floatVertices = 0;
+	m_sourceIndices = 0;
+	m_uploadVertices = 0;
+
+	return;
+}
+
+const void* MeshLoaderClass::GetVertices()
+{
+	return m_uploadVertices;
+}
+
+int MeshLoaderClass::GetVertexCount()
+{
+	return m_vertexCount;
+}
+
+int MeshLoaderClass::GetVertexFormat()
+{
+	return m_vertexFormat;
+}
+
+int MeshLoaderClass::GetVertexStride()
+{
+	return VertexQuantizerClass::GetStride(m_vertexFormat);
+}
+
+const unsigned int* MeshLoaderClass::GetIndices()
+{
+	return m_indices;
+}
+
+int MeshLoaderClass::GetIndexCount()
+{
+	return m_indexCount;
+}
+
+const MeshCacheClass::LodType* MeshLoaderClass::GetLods()
+{
+	return m_lods;
+}
+
+int MeshLoaderClass::GetLodCount()
+{
+	return m_lodCount;
+}
+
+const MeshletBuilderClass::MeshletType* MeshLoaderClass::GetMeshlets()
+{
+	return m_meshlets;
+}
+
+int MeshLoaderClass::GetMeshletCount()
+{
+	return m_meshletCount;
+}
+
+int MeshLoaderClass::GetPolygonCount()
+{
+	return m_polygonCount;
+}
+
+void MeshLoaderClass::GetBounds(BoundingVolumeClass::BoundsType& bounds)
+{
+	bounds = m_bounds;
+
+	return;
+}
+
+bool MeshLoaderClass::IsFromCache()
+{
+	return m_fromCache;
+}
+
+bool MeshLoaderClass::IsCacheWritten()
+{
+	return m_cacheWritten;
+}
+
+size_t MeshLoaderClass::GetTransientPeakBytes()
+{
+	return m_Arena ? m_Arena->GetPeakBytes() : m_transientPeakBytes;
+}
+
+int MeshLoaderClass::GetResidency()
+{
+	return m_residency;
+}
+
+const ObjLoaderClass::VertexType* MeshLoaderClass::GetRetainedVertices()
+{
+	return m_retainedVertices;
+}
+
+const float* MeshLoaderClass::GetPositions()
+{
+	if (m_retainedVertices)
+	{
+		return &m_retainedVertices[0].x;
+	}
+
+	return m_positions;
+}
+
+int MeshLoaderClass::GetPositionStride()
+{
+	return m_retainedVertices ? sizeof(ObjLoaderClass::VertexType) : sizeof(float) * 3;
+}
+
+size_t MeshLoaderClass::GetCpuBytes()
+{
+	return sizeof(unsigned int) * m_indexCount + sizeof(MeshletBuilderClass::MeshletType) * m_meshletCount + GetRetainedBytes();
+}
+
+size_t MeshLoaderClass::GetRetainedBytes()
+{
+	if (m_retainedVertices)
+	{
+		return sizeof(ObjLoaderClass::VertexType) * m_vertexCount;
+	}
+
+	if (m_positions)
+	{
+		return sizeof(float) * 3 * m_vertexCount;
+	}
+
+	return 0;
+}
+
+const VertexQuantizerClass::DequantizeType& MeshLoaderClass::GetDequantize()
+{
+	return m_dequantize;
+}
+
+const VertexQuantizerClass::ErrorType& MeshLoaderClass::GetQuantizationError()
+{
+	return m_quantizationError;
+}
+
+bool MeshLoaderClass::HasUnitTexcoords()
+{
+	return m_unitTexcoords;
+}
+
+bool MeshLoaderClass::LoadModel(const char* filename, int lodCount)
+{
+	ObjLoaderClass* loader;
+	NormalGeneratorClass* generator;
+	vector<ObjLoaderClass::VertexType> generatedVertices;
+	const ObjLoaderClass::VertexType* vertices;
+	size_t vertexBytes, indexBytes;
+	bool result;
+
+	// Create the obj loader object.
+	loader = new ObjLoaderClass;
+	if (!loader)
+	{
+		return false;
+	}
+
+	// Map the model file and parse it in a single pass, split across every core.
+	result = loader->Initialize(filename, 0);
+	if (!result)
+	{
+		loader->Shutdown();
+		delete loader;
+		return false;
+	}
+
+	// Corners that share a position, texture coordinate and normal share one vertex.
+	vertices = loader->GetVertices();
+	m_vertexCount = loader->GetVertexCount();
+	m_indexCount = loader->GetIndexCount();
+	m_polygonCount = loader->GetPolygonCount();
+
+	// Fill in the normals the file left out. Vertices on a crease are split, which renumbers the indices.
+	if (!NormalGeneratorClass::HasNormals(vertices, m_vertexCount))
+	{
+		generator = new NormalGeneratorClass;
+		if (!generator)
+		{
+			loader->Shutdown();
+			delete loader;
+			return false;
+		}
+
+		result = generator->GenerateNormals(vertices, m_vertexCount, loader->GetIndices(), m_indexCount, NORMAL_CREASE_ANGLE, 0, generatedVertices);
+		delete generator;
+		generator = 0;
+
+		if (!result)
+		{
+			loader->Shutdown();
+			delete loader;
+			return false;
+		}
+
+		vertices = generatedVertices.empty() ? 0 : &generatedVertices[0];
+		m_vertexCount = (int)generatedVertices.size();
+	}
+
+	// Both arrays only live until the upload, take them from one arena block sized for them and every
+	// detail level.
+	lodCount = max(min(lodCount, MESH_MAX_LODS), 1);
+	vertexBytes = sizeof(ObjLoaderClass::VertexType) * m_vertexCount;
+	indexBytes = sizeof(unsigned int) * m_indexCount * lodCount;
+
+	result = ReserveTransient(vertexBytes + indexBytes + MESH_ARENA_ALIGNMENT);
+	if (result)
+	{
+		m_vertices = (ObjLoaderClass::VertexType*)AllocateTransient(vertexBytes);
+		m_sourceIndices = (unsigned int*)AllocateTransient(indexBytes);
+		result = m_vertices && m_sourceIndices;
+	}
+
+	if (!result)
+	{
+		loader->Shutdown();
+		delete loader;
+		return false;
+	}
+
+	memcpy(m_vertices, vertices, vertexBytes);
+	memcpy(m_sourceIndices, loader->GetIndices(), sizeof(unsigned int) * m_indexCount);
+
+	// Release the loader now that the model data has been copied out.
+	loader->Shutdown();
+	delete loader;
+	loader = 0;
+
+	return true;
+}
+
+void MeshLoaderClass::OptimizeModel()
+{
+	MeshOptimizerClass* optimizer;
+
+	// Create the mesh optimizer object.
+	optimizer = new MeshOptimizerClass;
+	if (!optimizer)
+	{
+		return;
+	}
+
+	// Reorder the triangles and vertices in place. Vertices no triangle uses are dropped from the end.
+	m_vertexCount = optimizer->Optimize(m_vertices, m_vertexCount, sizeof(ObjLoaderClass::VertexType), m_sourceIndices, m_indexCount);
+
+	// Release the mesh optimizer object.
+	delete optimizer;
+	optimizer = 0;
+
+	return;
+}
+
+bool MeshLoaderClass::GenerateLods(int lodCount, bool optimize)
+{
+	MeshSimplifierClass* simplifier;
+	MeshOptimizerClass* optimizer;
+	MeshCacheClass::LodType* source;
+	int level, indexTotal, targetCount, count;
+	float error;
+
+	// Level 0 is the full mesh.
+	m_lodCount = 1;
+	m_lods[0].indexStart = 0;
+	m_lods[0].indexCount = (unsigned int)m_indexCount;
+	m_lods[0].error = 0.0f;
+	m_lods[0].meshletStart = 0;
+	m_lods[0].meshletCount = 0;
+
+	// LoadModel left room for every level behind level 0, none of them is larger than it.
+	lodCount = min(lodCount, MESH_MAX_LODS);
+
+	simplifier = new MeshSimplifierClass;
+	optimizer = new MeshOptimizerClass;
+	if (!simplifier || !optimizer)
+	{
+		delete simplifier;
+		delete optimizer;
+		return false;
+	}
+
+	// Each level is simplified from the one before it to half of its triangles.
+	indexTotal = m_indexCount;
+	for (level = 1; level < lodCount; level++)
+	{
+		source = &m_lods[level - 1];
+		targetCount = (int)source->indexCount / 6 * 3;
+
+		count = simplifier->Simplify(m_sourceIndices + indexTotal, m_sourceIndices + source->indexStart, source->indexCount, m_vertices, m_vertexCount, sizeof(ObjLoaderClass::VertexType),
+									 targetCount, LOD_MAX_ERROR, error);
+
+		// Stop when the error limit or the seams keep the level from getting meaningfully smaller.
+		if (count == 0 || count > (int)source->indexCount * 9 / 10)
+		{
+			break;
+		}
+
+		// The vertex order was set for level 0, only the triangle order is optimized here.
+		if (optimize)
+		{
+			optimizer->OptimizeVertexCache(m_sourceIndices + indexTotal, count, m_vertexCount, VERTEX_CACHE_SIZE);
+		}
+
+		// Errors add up along the chain.
+		m_lods[level].indexStart = (unsigned int)indexTotal;
+		m_lods[level].indexCount = (unsigned int)count;
+		m_lods[level].error = source->error + error;
+		m_lods[level].meshletStart = 0;
+		m_lods[level].meshletCount = 0;
+
+		indexTotal += count;
+		m_lodCount++;
+	}
+
+	delete simplifier;
+	simplifier = 0;
+	delete optimizer;
+	optimizer = 0;
+
+	// Copy out the levels that were kept, the culling pass reads them for as long as the model lives.
+	m_indexCount = indexTotal;
+	m_indices = new unsigned int[m_indexCount];
+	if (!m_indices)
+	{
+		return false;
+	}
+	memcpy(m_indices, m_sourceIndices, sizeof(unsigned int) * m_indexCount);
+
+	return true;
+}
+
+bool MeshLoaderClass::BuildMeshlets(bool optimize)
+{
+	MeshletBuilderClass* builder;
+	MeshOptimizerClass* optimizer;
+	vector<MeshletBuilderClass::MeshletType> meshlets;
+	int level, i;
+
+	// Create the meshlet builder and mesh optimizer objects.
+	builder = new MeshletBuilderClass;
+	optimizer = new MeshOptimizerClass;
+	if (!builder || !optimizer)
+	{
+		delete builder;
+		delete optimizer;
+		return false;
+	}
+
+	// Each level is regrouped on its own, so its meshlets stay inside its index range.
+	for (level = 0; level < m_lodCount; level++)
+	{
+		m_lods[level].meshletStart = (unsigned int)meshlets.size();
+		builder->Build(m_indices + m_lods[level].indexStart, m_lods[level].indexCount, m_vertices, m_vertexCount, sizeof(ObjLoaderClass::VertexType), m_lods[level].indexStart, meshlets);
+		m_lods[level].meshletCount = (unsigned int)meshlets.size() - m_lods[level].meshletStart;
+	}
+
+	// Regrouping undoes part of the vertex cache order, so it is redone inside every meshlet.
+	if (optimize)
+	{
+		for (i = 0; i < (int)meshlets.size(); i++)
+		{
+			optimizer->OptimizeVertexCache(m_indices + meshlets[i].indexStart, meshlets[i].triangleCount * 3, m_vertexCount, VERTEX_CACHE_SIZE);
+		}
+	}
+
+	// Release the meshlet builder and mesh optimizer objects.
+	delete builder;
+	builder = 0;
+	delete optimizer;
+	optimizer = 0;
+
+	m_meshletCount = (int)meshlets.size();
+	m_meshlets = new MeshletBuilderClass::MeshletType[m_meshletCount];
+	if (!m_meshlets)
+	{
+		return false;
+	}
+
+	for (i = 0; i < m_meshletCount; i++)
+	{
+		m_meshlets[i] = meshlets[i];
+	}
+
+	return true;
+}
+
+void MeshLoaderClass::ComputeBounds()
+{
+	// Box and sphere of the float positions, before they are packed. They are cooked with the mesh.
+	BoundingVolumeClass::Compute(m_vertices, m_vertexCount, sizeof(ObjLoaderClass::VertexType), m_bounds);
+
+	return;
+}
+
+bool MeshLoaderClass::PackVertices()
+{
+	VertexQuantizerClass* quantizer;
+	void* packed;
+	bool result;
+
+	// Create the quantizer object.
+	quantizer = new VertexQuantizerClass;
+	if (!quantizer)
+	{
+		return false;
+	}
+
+	result = quantizer->Initialize((const VertexQuantizerClass::FloatVertexType*)m_uploadVertices, m_vertexCount, m_vertexFormat);
+	if (result)
+	{
+		// Keep the bounds for the shader, the error for the mesh report and whether the texture coordinates stay
+		// inside the texture, which is known for good once the vertices are packed.
+		m_dequantize = quantizer->GetDequantize();
+		m_quantizationError = quantizer->GetError();
+		m_unitTexcoords = quantizer->HasUnitTexcoords();
+
+		// Move the packed vertices into the arena with the other upload data.
+		packed = AllocateTransient(sizeof(VertexQuantizerClass::QuantizedVertexType) * m_vertexCount);
+		result = packed != 0;
+	}
+
+	if (result)
+	{
+		memcpy(packed, quantizer->GetVertices(), sizeof(VertexQuantizerClass::QuantizedVertexType) * m_vertexCount);
+		m_uploadVertices = packed;
+	}
+
+	// Release the quantizer object.
+	quantizer->Shutdown();
+	delete quantizer;
+	quantizer = 0;
+
+	return result;
+}
+
+bool MeshLoaderClass::ReserveTransient(size_t size)
+{
+	bool result;
+
+	if (m_Arena)
+	{
+		return true;
+	}
+
+	// Create the arena object, its first block sized for what the load is about to take from it.
+	m_Arena = new ArenaClass;
+	if (!m_Arena)
+	{
+		return false;
+	}
+
+	result = m_Arena->Initialize(size);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void* MeshLoaderClass::AllocateTransient(size_t size)
+{
+	if (!ReserveTransient(size))
+	{
+		return 0;
+	}
+
+	return m_Arena->Allocate(size, MESH_ARENA_ALIGNMENT);
+}
+
+bool MeshLoaderClass::RetainVertices()
+{
+	int i;
+
+	switch (m_residency)
+	{
+	case MESH_RESIDENCY_FULL:
+		m_retainedVertices = new ObjLoaderClass::VertexType[m_vertexCount];
+		if (!m_retainedVertices)
+		{
+			return false;
+		}
+
+		memcpy(m_retainedVertices, m_floatVertices, sizeof(ObjLoaderClass::VertexType) * m_vertexCount);
+		break;
+
+	case MESH_RESIDENCY_POSITIONS:
+		m_positions = new float[m_vertexCount * 3];
+		if (!m_positions)
+		{
+			return false;
+		}
+
+		for (i = 0; i < m_vertexCount; i++)
+		{
+			m_positions[i * 3 + 0] = m_floatVertices[i].x;
+			m_positions[i * 3 + 1] = m_floatVertices[i].y;
+			m_positions[i * 3 + 2] = m_floatVertices[i].z;
+		}
+		break;
+
+	default:
+		break;
+	}
+
+	return true;
+}
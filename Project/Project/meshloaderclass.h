@@ -0,0 +1,106 @@
+#pragma once
+
+#ifndef _MESHLOADERCLASS_H_
+#define _MESHLOADERCLASS_H_
+
+#include "objloaderclass.h"
+#include "normalgeneratorclass.h"
+#include "meshcacheclass.h"
+#include "meshoptimizerclass.h"
+#include "meshsimplifierclass.h"
+#include "meshletbuilderclass.h"
+#include "vertexquantizerclass.h"
+#include "arenaclass.h"
+
+// What a mesh keeps on the CPU once it is uploaded. The indices and meshlets stay in every case, culling
+// reads them each frame. FULL keeps the float vertices, POSITIONS only their positions, for picking and
+// collision.
+const int MESH_RESIDENCY_NONE = 0;
+const int MESH_RESIDENCY_FULL = 1;
+const int MESH_RESIDENCY_POSITIONS = 2;
+
+// CPU side of loading a model, with no Direct3D dependency: maps the cooked .mesh or parses, optimizes,
+// simplifies and splits the obj and cooks it, then packs the vertices into the requested format. The result
+// is ready to be copied into buffers as it is. ReleaseUploadData frees what is only needed for that copy and
+// keeps the indices, detail levels and meshlets the culling pass reads every frame. The arrays only needed
+// until then come from one arena, released in a single step.
+class MeshLoaderClass
+{
+public:
+	MeshLoaderClass();
+	MeshLoaderClass(const MeshLoaderClass&);
+	~MeshLoaderClass();
+
+	bool Initialize(const char*, bool, int, int, int);
+	bool InitializeBox();
+	void Shutdown();
+	void ReleaseUploadData();
+
+	const void* GetVertices();
+	int GetVertexCount();
+	int GetVertexFormat();
+	int GetVertexStride();
+	const unsigned int* GetIndices();
+	int GetIndexCount();
+	const MeshCacheClass::LodType* GetLods();
+	int GetLodCount();
+	const MeshletBuilderClass::MeshletType* GetMeshlets();
+	int GetMeshletCount();
+	int GetPolygonCount();
+	void GetBounds(BoundingVolumeClass::BoundsType&);
+	bool IsFromCache();
+	bool IsCacheWritten();
+	size_t GetTransientPeakBytes();
+
+	int GetResidency();
+	const ObjLoaderClass::VertexType* GetRetainedVertices();
+	const float* GetPositions();
+	int GetPositionStride();
+	size_t GetCpuBytes();
+	size_t GetRetainedBytes();
+
+	const VertexQuantizerClass::DequantizeType& GetDequantize();
+	const VertexQuantizerClass::ErrorType& GetQuantizationError();
+	bool HasUnitTexcoords();
+
+private:
+	bool LoadModel(const char*, int);
+	void OptimizeModel();
+	bool GenerateLods(int, bool);
+	bool BuildMeshlets(bool);
+	void ComputeBounds();
+	bool PackVertices();
+	bool ReserveTransient(size_t);
+	void* AllocateTransient(size_t);
+	bool RetainVertices();
+
+private:
+	ObjLoaderClass::VertexType* m_vertices;
+	const ObjLoaderClass::VertexType* m_floatVertices;
+	unsigned int* m_sourceIndices;
+	unsigned int* m_indices;
+	MeshletBuilderClass::MeshletType* m_meshlets;
+	int m_vertexCount, m_indexCount, m_meshletCount, m_polygonCount;
+	int m_vertexFormat;
+	bool m_fromCache, m_cacheWritten;
+
+	MeshCacheClass::LodType m_lods[MESH_MAX_LODS];
+	int m_lodCount;
+	BoundingVolumeClass::BoundsType m_bounds;
+
+	VertexQuantizerClass::DequantizeType m_dequantize;
+	VertexQuantizerClass::ErrorType m_quantizationError;
+	bool m_unitTexcoords;
+
+	// What is left of the vertices after the upload, by the residency policy.
+	int m_residency;
+	ObjLoaderClass::VertexType* m_retainedVertices;
+	float* m_positions;
+
+	// Held from Initialize until ReleaseUploadData, the vertices to upload point into one of them.
+	MeshCacheClass* m_Cache;
+	ArenaClass* m_Arena;
+	size_t m_transientPeakBytes;
+	const void* m_uploadVertices;
+};
+#endif
@@ -0,0 +1,595 @@
+#include "meshoptimizerclass.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+// How much worse than Tipsify's own order a cluster may get when it is split for overdraw sorting.
+static const float OVERDRAW_THRESHOLD = 1.05f;
+
+// Side of the square depth buffer the overdraw analysis rasterizes into.
+static const int OVERDRAW_RESOLUTION = 256;
+
+static inline const float* GetPosition(const void* vertices, int stride, unsigned int index)
+{
+	return (const float*)((const char*)vertices + (size_t)index * stride);
+}
+
+// Push one triangle through a FIFO cache simulation and return how many of its vertices missed.
+static int SimulateTriangle(const unsigned int* triangle, vector<int>& timestamps, int& time, int cacheSize)
+{
+	int i, misses;
+
+	misses = 0;
+	for (i = 0; i < 3; i++)
+	{
+		if (time - timestamps[triangle[i]] > cacheSize)
+		{
+			timestamps[triangle[i]] = time;
+			time++;
+			misses++;
+		}
+	}
+
+	return misses;
+}
+
+MeshOptimizerClass::MeshOptimizerClass()
+{
+}
+
+MeshOptimizerClass::MeshOptimizerClass(const MeshOptimizerClass& other)
+{
+}
+
+MeshOptimizerClass::~MeshOptimizerClass()
+{
+}
+
+int MeshOptimizerClass::Optimize(void* vertices, int vertexCount, int stride, unsigned int* indices, int indexCount)
+{
+	vector<unsigned int> cacheOrder;
+	float cacheAcmr, sortedAcmr, atvr;
+
+	// Triangle order for the vertex cache first, the overdraw pass only moves whole clusters of that order.
+	OptimizeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_SIZE);
+	AnalyzeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_SIZE, cacheAcmr, atvr);
+	cacheOrder.assign(indices, indices + indexCount);
+
+	OptimizeOverdraw(indices, indexCount, vertices, vertexCount, stride, VERTEX_CACHE_SIZE, OVERDRAW_THRESHOLD);
+	AnalyzeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_SIZE, sortedAcmr, atvr);
+
+	// The threshold only bounds each cluster, keep the vertex cache order when the mesh as a whole got worse.
+	if (sortedAcmr > cacheAcmr * OVERDRAW_THRESHOLD && indexCount > 0)
+	{
+		memcpy(indices, &cacheOrder[0], sizeof(unsigned int) * indexCount);
+	}
+
+	// Vertex order last, as it depends on the final triangle order.
+	return OptimizeVertexFetch(vertices, vertexCount, stride, indices, indexCount);
+}
+
+void MeshOptimizerClass::OptimizeVertexCache(unsigned int* indices, int indexCount, int vertexCount, int cacheSize)
+{
+	vector<int> offsets, adjacency, live, cacheTime, deadEnd, candidates;
+	vector<char> emitted;
+	vector<unsigned int> result;
+	int triangleCount, i, j, k, triangle, vertex, fanning, cursor, time, outputCount, priority, bestPriority;
+
+	triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+	{
+		return;
+	}
+
+	// Build the list of triangles using each vertex.
+	offsets.assign(vertexCount + 1, 0);
+	live.assign(vertexCount, 0);
+	for (i = 0; i < indexCount; i++)
+	{
+		offsets[indices[i] + 1]++;
+		live[indices[i]]++;
+	}
+
+	for (i = 0; i < vertexCount; i++)
+	{
+		offsets[i + 1] += offsets[i];
+	}
+
+	adjacency.resize(indexCount);
+	for (i = 0; i < indexCount; i++)
+	{
+		adjacency[offsets[indices[i]]++] = i / 3;
+	}
+
+	// The fill above moved every offset to the end of its list, shift them back.
+	for (i = vertexCount; i > 0; i--)
+	{
+		offsets[i] = offsets[i - 1];
+	}
+	offsets[0] = 0;
+
+	// Tipsify: fan around a vertex emitting all of its triangles, then move on to the vertex among the ones just
+	// touched that will still be in the cache when its remaining triangles are emitted.
+	cacheTime.assign(vertexCount, 0);
+	emitted.assign(triangleCount, 0);
+	result.resize(indexCount);
+	deadEnd.reserve(indexCount);
+	candidates.reserve(64);
+
+	time = cacheSize + 1;
+	cursor = 0;
+	fanning = 0;
+	outputCount = 0;
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		for (j = offsets[fanning]; j < offsets[fanning + 1]; j++)
+		{
+			triangle = adjacency[j];
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			for (k = 0; k < 3; k++)
+			{
+				vertex = (int)indices[triangle * 3 + k];
+				result[outputCount++] = (unsigned int)vertex;
+
+				deadEnd.push_back(vertex);
+				candidates.push_back(vertex);
+				live[vertex]--;
+
+				if (time - cacheTime[vertex] > cacheSize)
+				{
+					cacheTime[vertex] = time;
+					time++;
+				}
+			}
+
+			emitted[triangle] = 1;
+		}
+
+		// Pick the next fanning vertex from the candidates.
+		fanning = -1;
+		bestPriority = -1;
+		for (j = 0; j < (int)candidates.size(); j++)
+		{
+			vertex = candidates[j];
+			if (live[vertex] <= 0)
+			{
+				continue;
+			}
+
+			priority = 0;
+			if (time - cacheTime[vertex] + 2 * live[vertex] <= cacheSize)
+			{
+				priority = time - cacheTime[vertex];
+			}
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				fanning = vertex;
+			}
+		}
+
+		// At a dead end, back track through recently used vertices, then fall back to the next unfinished one.
+		if (fanning < 0)
+		{
+			while (!deadEnd.empty())
+			{
+				vertex = deadEnd.back();
+				deadEnd.pop_back();
+				if (live[vertex] > 0)
+				{
+					fanning = vertex;
+					break;
+				}
+			}
+		}
+
+		if (fanning < 0)
+		{
+			while (cursor < vertexCount)
+			{
+				if (live[cursor] > 0)
+				{
+					fanning = cursor;
+					break;
+				}
+				cursor++;
+			}
+		}
+	}
+
+	memcpy(indices, &result[0], sizeof(unsigned int) * outputCount);
+
+	return;
+}
+
+void MeshOptimizerClass::OptimizeOverdraw(unsigned int* indices, int indexCount, const void* vertices, int vertexCount, int stride, int cacheSize, float threshold)
+{
+	vector<ClusterType> clusters;
+	vector<unsigned int> result;
+	const float *a, *b, *c;
+	float meshCentroid[3], centroid[3], normal[3], edge1[3], edge2[3], cross[3];
+	float area, meshArea, length;
+	int i, j, k, outputCount;
+
+	if (indexCount < 3)
+	{
+		return;
+	}
+
+	// Break the cache optimized order into clusters that can be moved around without hurting the cache much.
+	FindClusters(indices, indexCount, vertexCount, cacheSize, threshold, clusters);
+
+	// Area weighted centroid of the whole mesh.
+	meshCentroid[0] = meshCentroid[1] = meshCentroid[2] = 0.0f;
+	meshArea = 0.0f;
+	for (i = 0; i < indexCount; i += 3)
+	{
+		a = GetPosition(vertices, stride, indices[i]);
+		b = GetPosition(vertices, stride, indices[i + 1]);
+		c = GetPosition(vertices, stride, indices[i + 2]);
+
+		for (k = 0; k < 3; k++)
+		{
+			edge1[k] = b[k] - a[k];
+			edge2[k] = c[k] - a[k];
+		}
+		cross[0] = edge1[1] * edge2[2] - edge1[2] * edge2[1];
+		cross[1] = edge1[2] * edge2[0] - edge1[0] * edge2[2];
+		cross[2] = edge1[0] * edge2[1] - edge1[1] * edge2[0];
+		area = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+		for (k = 0; k < 3; k++)
+		{
+			meshCentroid[k] += (a[k] + b[k] + c[k]) * area;
+		}
+		meshArea += area;
+	}
+
+	for (k = 0; k < 3; k++)
+	{
+		meshCentroid[k] = (meshArea > 0.0f) ? meshCentroid[k] / (meshArea * 3.0f) : 0.0f;
+	}
+
+	// Clusters that face outwards from the center are likely to occlude the rest, so they should be drawn first.
+	for (i = 0; i < (int)clusters.size(); i++)
+	{
+		centroid[0] = centroid[1] = centroid[2] = 0.0f;
+		normal[0] = normal[1] = normal[2] = 0.0f;
+		meshArea = 0.0f;
+
+		for (j = clusters[i].start; j < clusters[i].start + clusters[i].count; j++)
+		{
+			a = GetPosition(vertices, stride, indices[j * 3]);
+			b = GetPosition(vertices, stride, indices[j * 3 + 1]);
+			c = GetPosition(vertices, stride, indices[j * 3 + 2]);
+
+			for (k = 0; k < 3; k++)
+			{
+				edge1[k] = b[k] - a[k];
+				edge2[k] = c[k] - a[k];
+			}
+			cross[0] = edge1[1] * edge2[2] - edge1[2] * edge2[1];
+			cross[1] = edge1[2] * edge2[0] - edge1[0] * edge2[2];
+			cross[2] = edge1[0] * edge2[1] - edge1[1] * edge2[0];
+			area = sqrtf(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+
+			for (k = 0; k < 3; k++)
+			{
+				centroid[k] += (a[k] + b[k] + c[k]) * area;
+				normal[k] += cross[k];
+			}
+			meshArea += area;
+		}
+
+		length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		clusters[i].sortKey = 0.0f;
+		if (meshArea > 0.0f && length > 0.0f)
+		{
+			for (k = 0; k < 3; k++)
+			{
+				clusters[i].sortKey += (centroid[k] / (meshArea * 3.0f) - meshCentroid[k]) * (normal[k] / length);
+			}
+		}
+	}
+
+	stable_sort(clusters.begin(), clusters.end(), CompareClusters);
+
+	// Write the triangles back out in cluster order.
+	result.resize(indexCount);
+	outputCount = 0;
+	for (i = 0; i < (int)clusters.size(); i++)
+	{
+		memcpy(&result[outputCount], &indices[clusters[i].start * 3], sizeof(unsigned int) * clusters[i].count * 3);
+		outputCount += clusters[i].count * 3;
+	}
+
+	memcpy(indices, &result[0], sizeof(unsigned int) * outputCount);
+
+	return;
+}
+
+int MeshOptimizerClass::OptimizeVertexFetch(void* vertices, int vertexCount, int stride, unsigned int* indices, int indexCount)
+{
+	vector<int> remap;
+	vector<char> source;
+	int i, next;
+
+	if (vertexCount == 0)
+	{
+		return 0;
+	}
+
+	// Number the vertices in the order the triangles first use them.
+	remap.assign(vertexCount, -1);
+	next = 0;
+	for (i = 0; i < indexCount; i++)
+	{
+		if (remap[indices[i]] < 0)
+		{
+			remap[indices[i]] = next++;
+		}
+		indices[i] = (unsigned int)remap[indices[i]];
+	}
+
+	// Move the vertices into that order. Vertices no triangle uses are dropped.
+	source.resize((size_t)vertexCount * stride);
+	memcpy(&source[0], vertices, source.size());
+	for (i = 0; i < vertexCount; i++)
+	{
+		if (remap[i] >= 0)
+		{
+			memcpy((char*)vertices + (size_t)remap[i] * stride, &source[(size_t)i * stride], stride);
+		}
+	}
+
+	return next;
+}
+
+void MeshOptimizerClass::AnalyzeVertexCache(const unsigned int* indices, int indexCount, int vertexCount, int cacheSize, float& acmr, float& atvr)
+{
+	vector<int> timestamps;
+	vector<char> used;
+	int i, time, misses, usedCount;
+
+	acmr = 0.0f;
+	atvr = 0.0f;
+	if (indexCount < 3)
+	{
+		return;
+	}
+
+	timestamps.assign(vertexCount, -cacheSize - 1);
+	used.assign(vertexCount, 0);
+	time = 0;
+	misses = 0;
+	usedCount = 0;
+
+	for (i = 0; i + 2 < indexCount; i += 3)
+	{
+		misses += SimulateTriangle(&indices[i], timestamps, time, cacheSize);
+	}
+
+	for (i = 0; i < indexCount; i++)
+	{
+		if (!used[indices[i]])
+		{
+			used[indices[i]] = 1;
+			usedCount++;
+		}
+	}
+
+	// Average cache miss ratio per triangle, and transformed vertices per vertex (1.0 is optimal).
+	acmr = (float)misses / (float)(indexCount / 3);
+	atvr = (float)misses / (float)usedCount;
+
+	return;
+}
+
+float MeshOptimizerClass::AnalyzeOverdraw(const void* vertices, int vertexCount, int stride, const unsigned int* indices, int indexCount)
+{
+	vector<float> depth;
+	float boundsMin[3], boundsMax[3], extent, scale, triangle[3][3], edge1[3], edge2[3], normalAxis;
+	const float* position[3];
+	int axis, direction, i, j, k, u, v, shaded, covered;
+
+	if (vertexCount == 0 || indexCount < 3)
+	{
+		return 0.0f;
+	}
+
+	// Fit the mesh into the depth buffer keeping its proportions.
+	for (k = 0; k < 3; k++)
+	{
+		boundsMin[k] = FLT_MAX;
+		boundsMax[k] = -FLT_MAX;
+	}
+
+	for (i = 0; i < vertexCount; i++)
+	{
+		position[0] = GetPosition(vertices, stride, (unsigned int)i);
+		for (k = 0; k < 3; k++)
+		{
+			boundsMin[k] = min(boundsMin[k], position[0][k]);
+			boundsMax[k] = max(boundsMax[k], position[0][k]);
+		}
+	}
+
+	extent = max(boundsMax[0] - boundsMin[0], max(boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]));
+	scale = (extent > 0.0f) ? (float)(OVERDRAW_RESOLUTION - 1) / extent : 0.0f;
+
+	shaded = 0;
+	covered = 0;
+	depth.resize(OVERDRAW_RESOLUTION * OVERDRAW_RESOLUTION);
+
+	// Render the front faces in index order from the six axis directions with an early depth test, counting
+	// every pixel that passes against every pixel that ends up covered.
+	for (axis = 0; axis < 3; axis++)
+	{
+		u = (axis + 1) % 3;
+		v = (axis + 2) % 3;
+
+		for (direction = -1; direction <= 1; direction += 2)
+		{
+			fill(depth.begin(), depth.end(), FLT_MAX);
+
+			for (i = 0; i + 2 < indexCount; i += 3)
+			{
+				for (j = 0; j < 3; j++)
+				{
+					position[j] = GetPosition(vertices, stride, indices[i + j]);
+				}
+
+				for (k = 0; k < 3; k++)
+				{
+					edge1[k] = position[1][k] - position[0][k];
+					edge2[k] = position[2][k] - position[0][k];
+				}
+
+				// The component of the face normal along the view axis decides if this is a back face.
+				normalAxis = edge1[u] * edge2[v] - edge1[v] * edge2[u];
+				if (normalAxis * direction >= 0.0f)
+				{
+					continue;
+				}
+
+				for (j = 0; j < 3; j++)
+				{
+					triangle[j][0] = (position[j][u] - boundsMin[u]) * scale;
+					triangle[j][1] = (position[j][v] - boundsMin[v]) * scale;
+					triangle[j][2] = (position[j][axis] - boundsMin[axis]) * direction;
+				}
+
+				RasterizeTriangle(triangle, depth, OVERDRAW_RESOLUTION, shaded, covered);
+			}
+		}
+	}
+
+	return (covered > 0) ? (float)shaded / (float)covered : 0.0f;
+}
+
+void MeshOptimizerClass::FindClusters(const unsigned int* indices, int indexCount, int vertexCount, int cacheSize, float threshold, vector<ClusterType>& clusters)
+{
+	vector<int> timestamps, hardStarts;
+	ClusterType cluster;
+	int triangleCount, i, j, time, misses, clusterEnd, clusterMisses;
+	float clusterThreshold;
+
+	triangleCount = indexCount / 3;
+	clusters.clear();
+
+	// Hard boundaries: Tipsify restarted from a vertex that was no longer cached, so all three vertices missed.
+	timestamps.assign(vertexCount, -cacheSize - 1);
+	time = 0;
+	for (i = 0; i < triangleCount; i++)
+	{
+		misses = SimulateTriangle(&indices[i * 3], timestamps, time, cacheSize);
+		if (i == 0 || misses == 3)
+		{
+			hardStarts.push_back(i);
+		}
+	}
+	hardStarts.push_back(triangleCount);
+
+	// Soft boundaries: split a hard cluster again wherever the cache would still do almost as well from a cold start.
+	for (i = 0; i + 1 < (int)hardStarts.size(); i++)
+	{
+		clusterEnd = hardStarts[i + 1];
+
+		time += cacheSize + 1;
+		clusterMisses = 0;
+		for (j = hardStarts[i]; j < clusterEnd; j++)
+		{
+			clusterMisses += SimulateTriangle(&indices[j * 3], timestamps, time, cacheSize);
+		}
+		clusterThreshold = threshold * (float)clusterMisses / (float)(clusterEnd - hardStarts[i]);
+
+		cluster.start = hardStarts[i];
+		cluster.sortKey = 0.0f;
+		time += cacheSize + 1;
+		misses = 0;
+		for (j = hardStarts[i]; j < clusterEnd; j++)
+		{
+			misses += SimulateTriangle(&indices[j * 3], timestamps, time, cacheSize);
+
+			if (j + 1 < clusterEnd && (float)misses / (float)(j + 1 - cluster.start) <= clusterThreshold)
+			{
+				cluster.count = j + 1 - cluster.start;
+				clusters.push_back(cluster);
+
+				cluster.start = j + 1;
+				time += cacheSize + 1;
+				misses = 0;
+			}
+		}
+
+		cluster.count = clusterEnd - cluster.start;
+		clusters.push_back(cluster);
+	}
+
+	return;
+}
+
+bool MeshOptimizerClass::CompareClusters(const ClusterType& a, const ClusterType& b)
+{
+	return a.sortKey > b.sortKey;
+}
+
+void MeshOptimizerClass::RasterizeTriangle(const float triangle[3][3], vector<float>& depth, int resolution, int& shaded, int& covered)
+{
+	float area, w0, w1, w2, px, py, z;
+	int minX, minY, maxX, maxY, x, y;
+	float* pixel;
+
+	area = (triangle[1][0] - triangle[0][0]) * (triangle[2][1] - triangle[0][1]) - (triangle[1][1] - triangle[0][1]) * (triangle[2][0] - triangle[0][0]);
+	if (area == 0.0f)
+	{
+		return;
+	}
+
+	minX = max(0, (int)floorf(min(triangle[0][0], min(triangle[1][0], triangle[2][0]))));
+	minY = max(0, (int)floorf(min(triangle[0][1], min(triangle[1][1], triangle[2][1]))));
+	maxX = min(resolution - 1, (int)ceilf(max(triangle[0][0], max(triangle[1][0], triangle[2][0]))));
+	maxY = min(resolution - 1, (int)ceilf(max(triangle[0][1], max(triangle[1][1], triangle[2][1]))));
+
+	// Sample at pixel centers, accepting either winding since facing was decided by the caller.
+	for (y = minY; y <= maxY; y++)
+	{
+		py = (float)y + 0.5f;
+		for (x = minX; x <= maxX; x++)
+		{
+			px = (float)x + 0.5f;
+
+			w0 = ((triangle[2][0] - triangle[1][0]) * (py - triangle[1][1]) - (triangle[2][1] - triangle[1][1]) * (px - triangle[1][0])) / area;
+			w1 = ((triangle[0][0] - triangle[2][0]) * (py - triangle[2][1]) - (triangle[0][1] - triangle[2][1]) * (px - triangle[2][0])) / area;
+			w2 = 1.0f - w0 - w1;
+			if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f)
+			{
+				continue;
+			}
+
+			z = w0 * triangle[0][2] + w1 * triangle[1][2] + w2 * triangle[2][2];
+			pixel = &depth[y * resolution + x];
+			if (z < *pixel)
+			{
+				if (*pixel == FLT_MAX)
+				{
+					covered++;
+				}
+				*pixel = z;
+				shaded++;
+			}
+		}
+	}
+
+	return;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#ifndef _MESHOPTIMIZERCLASS_H_
+#define _MESHOPTIMIZERCLASS_H_
+
+#include <vector>
+using namespace std;
+
+// Post-transform cache size the optimizer and the analysis assume, a common FIFO size on current GPUs.
+const int VERTEX_CACHE_SIZE = 16;
+
+// Reorders indexed triangle lists for the GPU. First the triangles are ordered for post-transform vertex cache
+// hits (Tipsify). Then clusters of those triangles are sorted front to back for less overdraw, an order kept only
+// when the whole mesh's ACMR stays within the overdraw threshold of the cache order. Last the vertices are put
+// into first use order for fetch locality. Vertices are passed as a byte stride with the position as the first
+// three floats.
+class MeshOptimizerClass
+{
+private:
+	struct ClusterType
+	{
+		int start, count;
+		float sortKey;
+	};
+
+public:
+	MeshOptimizerClass();
+	MeshOptimizerClass(const MeshOptimizerClass&);
+	~MeshOptimizerClass();
+
+	int Optimize(void*, int, int, unsigned int*, int);
+
+	void OptimizeVertexCache(unsigned int*, int, int, int);
+	void OptimizeOverdraw(unsigned int*, int, const void*, int, int, int, float);
+	int OptimizeVertexFetch(void*, int, int, unsigned int*, int);
+
+	void AnalyzeVertexCache(const unsigned int*, int, int, int, float&, float&);
+	float AnalyzeOverdraw(const void*, int, int, const unsigned int*, int);
+
+private:
+	void FindClusters(const unsigned int*, int, int, int, float, vector<ClusterType>&);
+	void RasterizeTriangle(const float[3][3], vector<float>&, int, int&, int&);
+
+	static bool CompareClusters(const ClusterType&, const ClusterType&);
+};
+#endif
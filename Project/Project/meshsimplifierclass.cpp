@@ -0,0 +1,617 @@
+#include "meshsimplifierclass.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+// Border and seam edges also get a plane through the edge at right angles to the triangle, weighted well
+// above the surface so the outline survives longer than the interior.
+static const double EDGE_WEIGHT = 10.0;
+
+struct SortPositionType
+{
+	float x, y, z;
+	unsigned int index;
+};
+
+static bool ComparePositions(const SortPositionType& a, const SortPositionType& b)
+{
+	if (a.x != b.x)
+	{
+		return a.x < b.x;
+	}
+	if (a.y != b.y)
+	{
+		return a.y < b.y;
+	}
+	if (a.z != b.z)
+	{
+		return a.z < b.z;
+	}
+
+	return a.index < b.index;
+}
+
+static inline unsigned long long EdgeKey(unsigned int a, unsigned int b)
+{
+	return ((unsigned long long)a << 32) | b;
+}
+
+static inline void Cross(const double a[3], const double b[3], double result[3])
+{
+	result[0] = a[1] * b[2] - a[2] * b[1];
+	result[1] = a[2] * b[0] - a[0] * b[2];
+	result[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+MeshSimplifierClass::MeshSimplifierClass()
+{
+}
+
+MeshSimplifierClass::MeshSimplifierClass(const MeshSimplifierClass& other)
+{
+}
+
+MeshSimplifierClass::~MeshSimplifierClass()
+{
+}
+
+int MeshSimplifierClass::Simplify(unsigned int* destination, const unsigned int* indices, int indexCount, const void* vertices, int vertexCount, int stride,
+								  int targetIndexCount, float targetError, float& resultError)
+{
+	vector<CollapseType> collapses;
+	vector<unsigned int> collapse;
+	vector<unsigned char> locked;
+	CollapseType candidate, reverse;
+	unsigned int a, b, c, r0, r1;
+	double errorLimit, maxError;
+	int count, i, j, direction, trianglesToRemove, removed, outputCount;
+	bool open;
+
+	resultError = 0.0f;
+
+	memcpy(destination, indices, sizeof(unsigned int) * indexCount);
+	count = indexCount;
+	if (indexCount < 3 || vertexCount == 0)
+	{
+		return count;
+	}
+
+	// Everything that depends only on the source mesh is worked out once.
+	BuildPositions(vertices, vertexCount, stride);
+	BuildEdges(destination, count);
+	ClassifyVertices(destination, count);
+	BuildQuadrics(destination, count);
+
+	collapse.resize(vertexCount);
+	locked.resize(vertexCount);
+	errorLimit = (double)targetError * (double)targetError;
+	maxError = 0.0;
+
+	// Each pass collapses the cheapest edges that do not touch each other, then rebuilds the index list.
+	while (count > targetIndexCount)
+	{
+		BuildEdges(destination, count);
+
+		// Triangles around each position, for the flip test, and which vertices are still in use.
+		m_adjacencyOffsets.assign(vertexCount + 1, 0);
+		m_used.assign(vertexCount, 0);
+		for (i = 0; i < count; i++)
+		{
+			m_adjacencyOffsets[m_remap[destination[i]] + 1]++;
+			m_used[destination[i]] = 1;
+		}
+		for (i = 0; i < vertexCount; i++)
+		{
+			m_adjacencyOffsets[i + 1] += m_adjacencyOffsets[i];
+		}
+		m_adjacency.resize(count);
+		for (i = 0; i < count; i++)
+		{
+			m_adjacency[m_adjacencyOffsets[m_remap[destination[i]]]++] = i / 3;
+		}
+		for (i = vertexCount; i > 0; i--)
+		{
+			m_adjacencyOffsets[i] = m_adjacencyOffsets[i - 1];
+		}
+		m_adjacencyOffsets[0] = 0;
+
+		// Every edge the vertex kinds allow, in the cheaper of its allowed directions.
+		collapses.clear();
+		for (i = 0; i < count; i += 3)
+		{
+			for (j = 0; j < 3; j++)
+			{
+				a = destination[i + j];
+				b = destination[i + (j + 1) % 3];
+				if (m_remap[a] == m_remap[b])
+				{
+					continue;
+				}
+
+				open = !HasPositionEdge(m_remap[b], m_remap[a]);
+
+				candidate.v0 = a;
+				candidate.v1 = b;
+				candidate.error = -1.0;
+				reverse.v0 = b;
+				reverse.v1 = a;
+				reverse.error = -1.0;
+
+				for (direction = 0; direction < 2; direction++)
+				{
+					CollapseType& option = (direction == 0) ? candidate : reverse;
+
+					if (m_kind[option.v0] == KIND_LOCKED || (m_kind[option.v0] == KIND_BORDER && (m_kind[option.v1] != KIND_BORDER || !open)))
+					{
+						continue;
+					}
+
+					if (!MatchWedges(option.v0, option.v1, 0))
+					{
+						continue;
+					}
+
+					r0 = m_remap[option.v0];
+					r1 = m_remap[option.v1];
+					option.error = (EvaluateQuadric(m_quadrics[r0], &m_positions[option.v1 * 3]) + EvaluateQuadric(m_quadrics[r1], &m_positions[option.v1 * 3])) /
+						(m_quadrics[r0].weight + m_quadrics[r1].weight + 1e-30);
+					option.error = fabs(option.error);
+				}
+
+				if (candidate.error >= 0.0 && (reverse.error < 0.0 || candidate.error <= reverse.error))
+				{
+					collapses.push_back(candidate);
+				}
+				else if (reverse.error >= 0.0)
+				{
+					collapses.push_back(reverse);
+				}
+			}
+		}
+
+		sort(collapses.begin(), collapses.end(), CompareCollapses);
+
+		for (i = 0; i < vertexCount; i++)
+		{
+			collapse[i] = (unsigned int)i;
+		}
+		memset(&locked[0], 0, locked.size());
+
+		trianglesToRemove = (count - targetIndexCount) / 3;
+		removed = 0;
+
+		for (i = 0; i < (int)collapses.size(); i++)
+		{
+			if (collapses[i].error > errorLimit || removed >= trianglesToRemove)
+			{
+				break;
+			}
+
+			r0 = m_remap[collapses[i].v0];
+			r1 = m_remap[collapses[i].v1];
+			if (locked[r0] || locked[r1])
+			{
+				continue;
+			}
+
+			if (HasFlips(destination, collapses[i].v0, collapses[i].v1))
+			{
+				continue;
+			}
+
+			// Every vertex at the position moves, each onto the vertex at the target it shares an edge with.
+			MatchWedges(collapses[i].v0, collapses[i].v1, &collapse[0]);
+
+			AddQuadric(m_quadrics[r1], m_quadrics[r0]);
+			locked[r0] = 1;
+			locked[r1] = 1;
+
+			removed += (m_kind[collapses[i].v0] == KIND_BORDER) ? 1 : 2;
+			maxError = max(maxError, collapses[i].error);
+		}
+
+		if (removed == 0)
+		{
+			break;
+		}
+
+		// Apply the collapses and drop the triangles that lost an edge.
+		outputCount = 0;
+		for (i = 0; i < count; i += 3)
+		{
+			a = collapse[destination[i]];
+			b = collapse[destination[i + 1]];
+			c = collapse[destination[i + 2]];
+
+			if (m_remap[a] == m_remap[b] || m_remap[b] == m_remap[c] || m_remap[c] == m_remap[a])
+			{
+				continue;
+			}
+
+			destination[outputCount++] = a;
+			destination[outputCount++] = b;
+			destination[outputCount++] = c;
+		}
+
+		count = outputCount;
+	}
+
+	resultError = (float)sqrt(maxError);
+
+	return count;
+}
+
+void MeshSimplifierClass::BuildPositions(const void* vertices, int vertexCount, int stride)
+{
+	vector<SortPositionType> sorted;
+	const float* position;
+	float boundsMin[3], boundsMax[3], extent;
+	int i, j, first;
+
+	// Copy the positions scaled into the unit cube, so errors come out relative to the mesh size.
+	m_positions.resize(vertexCount * 3);
+	sorted.resize(vertexCount);
+	for (i = 0; i < vertexCount; i++)
+	{
+		position = (const float*)((const char*)vertices + (size_t)i * stride);
+		for (j = 0; j < 3; j++)
+		{
+			m_positions[i * 3 + j] = position[j];
+			boundsMin[j] = (i == 0 || position[j] < boundsMin[j]) ? position[j] : boundsMin[j];
+			boundsMax[j] = (i == 0 || position[j] > boundsMax[j]) ? position[j] : boundsMax[j];
+		}
+
+		sorted[i].x = position[0];
+		sorted[i].y = position[1];
+		sorted[i].z = position[2];
+		sorted[i].index = (unsigned int)i;
+	}
+
+	extent = max(boundsMax[0] - boundsMin[0], max(boundsMax[1] - boundsMin[1], boundsMax[2] - boundsMin[2]));
+	extent = (extent > 0.0f) ? extent : 1.0f;
+	for (i = 0; i < vertexCount; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			m_positions[i * 3 + j] = (m_positions[i * 3 + j] - boundsMin[j]) / extent;
+		}
+	}
+
+	// Vertices at the same position map to the lowest of them, and are linked in a ring through m_wedge.
+	sort(sorted.begin(), sorted.end(), ComparePositions);
+
+	m_remap.resize(vertexCount);
+	m_wedge.resize(vertexCount);
+	for (i = 0; i < vertexCount; i = first)
+	{
+		for (first = i + 1; first < vertexCount; first++)
+		{
+			if (sorted[first].x != sorted[i].x || sorted[first].y != sorted[i].y || sorted[first].z != sorted[i].z)
+			{
+				break;
+			}
+		}
+
+		for (j = i; j < first; j++)
+		{
+			m_remap[sorted[j].index] = sorted[i].index;
+			m_wedge[sorted[j].index] = sorted[(j + 1 < first) ? j + 1 : i].index;
+		}
+	}
+
+	return;
+}
+
+void MeshSimplifierClass::BuildEdges(const unsigned int* indices, int indexCount)
+{
+	int i, j;
+
+	m_edges.resize(indexCount);
+	m_positionEdges.resize(indexCount);
+	for (i = 0; i < indexCount; i += 3)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			m_edges[i + j] = EdgeKey(indices[i + j], indices[i + (j + 1) % 3]);
+			m_positionEdges[i + j] = EdgeKey(m_remap[indices[i + j]], m_remap[indices[i + (j + 1) % 3]]);
+		}
+	}
+
+	sort(m_edges.begin(), m_edges.end());
+	sort(m_positionEdges.begin(), m_positionEdges.end());
+
+	return;
+}
+
+void MeshSimplifierClass::ClassifyVertices(const unsigned int* indices, int indexCount)
+{
+	vector<unsigned char> borderIn, borderOut;
+	unsigned int a, b;
+	int vertexCount, i, j;
+
+	vertexCount = (int)m_remap.size();
+	borderIn.assign(vertexCount, 0);
+	borderOut.assign(vertexCount, 0);
+
+	// An edge between two positions without its opposite is on the border of the surface. Seams are not
+	// borders here, they are handled when a collapse matches up the vertices on each side.
+	for (i = 0; i < indexCount; i += 3)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			a = m_remap[indices[i + j]];
+			b = m_remap[indices[i + (j + 1) % 3]];
+			if (HasPositionEdge(b, a))
+			{
+				continue;
+			}
+
+			borderOut[a] = (unsigned char)min(borderOut[a] + 1, 255);
+			borderIn[b] = (unsigned char)min(borderIn[b] + 1, 255);
+		}
+	}
+
+	// Every vertex at a position gets the kind of the position.
+	m_kind.resize(vertexCount);
+	for (i = 0; i < vertexCount; i++)
+	{
+		a = m_remap[i];
+		if (borderIn[a] == 0 && borderOut[a] == 0)
+		{
+			m_kind[i] = KIND_MANIFOLD;
+		}
+		else if (borderIn[a] == 1 && borderOut[a] == 1)
+		{
+			m_kind[i] = KIND_BORDER;
+		}
+		else
+		{
+			m_kind[i] = KIND_LOCKED;
+		}
+	}
+
+	return;
+}
+
+void MeshSimplifierClass::BuildQuadrics(const unsigned int* indices, int indexCount)
+{
+	QuadricType zero;
+	const float* p[3];
+	double edge1[3], edge2[3], normal[3], perpendicular[3], length, area, distance;
+	unsigned int a, b;
+	int i, j, k;
+
+	memset(&zero, 0, sizeof(zero));
+	m_quadrics.assign(m_remap.size(), zero);
+
+	for (i = 0; i < indexCount; i += 3)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			p[j] = &m_positions[indices[i + j] * 3];
+		}
+
+		for (k = 0; k < 3; k++)
+		{
+			edge1[k] = p[1][k] - p[0][k];
+			edge2[k] = p[2][k] - p[0][k];
+		}
+		Cross(edge1, edge2, normal);
+		length = sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length == 0.0)
+		{
+			continue;
+		}
+
+		for (k = 0; k < 3; k++)
+		{
+			normal[k] /= length;
+		}
+		area = length * 0.5;
+		distance = -(normal[0] * p[0][0] + normal[1] * p[0][1] + normal[2] * p[0][2]);
+
+		// The plane of the triangle, weighted by its area, for each of its corners.
+		for (j = 0; j < 3; j++)
+		{
+			AddPlane(m_quadrics[m_remap[indices[i + j]]], normal, distance, area);
+		}
+
+		// Open edges, both on the border and along seams.
+		for (j = 0; j < 3; j++)
+		{
+			a = indices[i + j];
+			b = indices[i + (j + 1) % 3];
+			if (HasEdge(b, a))
+			{
+				continue;
+			}
+
+			for (k = 0; k < 3; k++)
+			{
+				edge1[k] = p[(j + 1) % 3][k] - p[j][k];
+			}
+			Cross(edge1, normal, perpendicular);
+			length = sqrt(perpendicular[0] * perpendicular[0] + perpendicular[1] * perpendicular[1] + perpendicular[2] * perpendicular[2]);
+			if (length == 0.0)
+			{
+				continue;
+			}
+
+			for (k = 0; k < 3; k++)
+			{
+				perpendicular[k] /= length;
+			}
+			distance = -(perpendicular[0] * p[j][0] + perpendicular[1] * p[j][1] + perpendicular[2] * p[j][2]);
+
+			// The cross product with the unit normal has the edge length, so this weight is its length squared.
+			AddPlane(m_quadrics[m_remap[a]], perpendicular, distance, length * length * EDGE_WEIGHT);
+			AddPlane(m_quadrics[m_remap[b]], perpendicular, distance, length * length * EDGE_WEIGHT);
+		}
+	}
+
+	return;
+}
+
+bool MeshSimplifierClass::HasEdge(unsigned int a, unsigned int b)
+{
+	return binary_search(m_edges.begin(), m_edges.end(), EdgeKey(a, b));
+}
+
+bool MeshSimplifierClass::HasPositionEdge(unsigned int a, unsigned int b)
+{
+	return binary_search(m_positionEdges.begin(), m_positionEdges.end(), EdgeKey(a, b));
+}
+
+bool MeshSimplifierClass::MatchWedges(unsigned int v0, unsigned int v1, unsigned int* collapse)
+{
+	unsigned int wedge, target;
+	bool found;
+
+	// Each vertex at v0's position that is still in use must share an edge with a vertex at v1's position,
+	// which then takes over its triangles with attributes that continue across them. A side of a seam that
+	// does not reach v1 would have nowhere to go, so the collapse is not allowed.
+	wedge = v0;
+	do
+	{
+		if (m_used[wedge])
+		{
+			found = false;
+			target = v1;
+			do
+			{
+				if (HasEdge(wedge, target) || HasEdge(target, wedge))
+				{
+					found = true;
+					break;
+				}
+				target = m_wedge[target];
+			} while (target != v1);
+
+			if (!found)
+			{
+				return false;
+			}
+
+			if (collapse)
+			{
+				collapse[wedge] = target;
+			}
+		}
+
+		wedge = m_wedge[wedge];
+	} while (wedge != v0);
+
+	return true;
+}
+
+bool MeshSimplifierClass::HasFlips(const unsigned int* indices, unsigned int v0, unsigned int v1)
+{
+	const float* p[3];
+	double edge1[3], edge2[3], before[3], after[3];
+	unsigned int r0, r1, remap;
+	int i, j, k, triangle, moved;
+	bool collapses;
+
+	r0 = m_remap[v0];
+	r1 = m_remap[v1];
+
+	// Every triangle around the collapsed position that survives must keep facing the same way.
+	for (i = m_adjacencyOffsets[r0]; i < m_adjacencyOffsets[r0 + 1]; i++)
+	{
+		triangle = m_adjacency[i];
+
+		moved = -1;
+		collapses = false;
+		for (j = 0; j < 3; j++)
+		{
+			remap = m_remap[indices[triangle * 3 + j]];
+			p[j] = &m_positions[indices[triangle * 3 + j] * 3];
+			if (remap == r0)
+			{
+				moved = j;
+			}
+			collapses = collapses || remap == r1;
+		}
+
+		if (collapses || moved < 0)
+		{
+			continue;
+		}
+
+		for (k = 0; k < 3; k++)
+		{
+			edge1[k] = p[1][k] - p[0][k];
+			edge2[k] = p[2][k] - p[0][k];
+		}
+		Cross(edge1, edge2, before);
+
+		p[moved] = &m_positions[v1 * 3];
+		for (k = 0; k < 3; k++)
+		{
+			edge1[k] = p[1][k] - p[0][k];
+			edge2[k] = p[2][k] - p[0][k];
+		}
+		Cross(edge1, edge2, after);
+
+		if (before[0] * after[0] + before[1] * after[1] + before[2] * after[2] <= 0.0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void MeshSimplifierClass::AddPlane(QuadricType& quadric, const double normal[3], double distance, double weight)
+{
+	quadric.a00 += weight * normal[0] * normal[0];
+	quadric.a11 += weight * normal[1] * normal[1];
+	quadric.a22 += weight * normal[2] * normal[2];
+	quadric.a01 += weight * normal[0] * normal[1];
+	quadric.a02 += weight * normal[0] * normal[2];
+	quadric.a12 += weight * normal[1] * normal[2];
+	quadric.b0 += weight * normal[0] * distance;
+	quadric.b1 += weight * normal[1] * distance;
+	quadric.b2 += weight * normal[2] * distance;
+	quadric.c += weight * distance * distance;
+	quadric.weight += weight;
+
+	return;
+}
+
+void MeshSimplifierClass::AddQuadric(QuadricType& quadric, const QuadricType& other)
+{
+	quadric.a00 += other.a00;
+	quadric.a11 += other.a11;
+	quadric.a22 += other.a22;
+	quadric.a01 += other.a01;
+	quadric.a02 += other.a02;
+	quadric.a12 += other.a12;
+	quadric.b0 += other.b0;
+	quadric.b1 += other.b1;
+	quadric.b2 += other.b2;
+	quadric.c += other.c;
+	quadric.weight += other.weight;
+
+	return;
+}
+
+double MeshSimplifierClass::EvaluateQuadric(const QuadricType& quadric, const float* position)
+{
+	double x, y, z;
+
+	x = position[0];
+	y = position[1];
+	z = position[2];
+
+	// Weighted sum of squared distances to the planes: p'Ap + 2b'p + c.
+	return quadric.a00 * x * x + quadric.a11 * y * y + quadric.a22 * z * z +
+		2.0 * (quadric.a01 * x * y + quadric.a02 * x * z + quadric.a12 * y * z) +
+		2.0 * (quadric.b0 * x + quadric.b1 * y + quadric.b2 * z) + quadric.c;
+}
+
+bool MeshSimplifierClass::CompareCollapses(const CollapseType& a, const CollapseType& b)
+{
+	return a.error < b.error;
+}
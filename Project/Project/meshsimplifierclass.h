@@ -0,0 +1,68 @@
+#pragma once
+
+#ifndef _MESHSIMPLIFIERCLASS_H_
+#define _MESHSIMPLIFIERCLASS_H_
+
+#include <vector>
+using namespace std;
+
+// Reduces an indexed triangle list by collapsing edges onto existing vertices in order of quadric error
+// (Garland-Heckbert), so the result shares the vertex buffer of the source. Positions on an open border
+// only move along the border. Where a texture coordinate or normal seam splits a position into several
+// vertices, all of them move together, each onto a vertex at the target it shares an edge with, so seams
+// never tear; seam and border edges carry extra quadric weight so their outline is kept.
+// Vertices are passed as a byte stride with the position as the first three floats.
+class MeshSimplifierClass
+{
+private:
+	enum VertexKind
+	{
+		KIND_MANIFOLD,
+		KIND_BORDER,
+		KIND_LOCKED
+	};
+
+	struct QuadricType
+	{
+		double a00, a11, a22, a01, a02, a12;
+		double b0, b1, b2;
+		double c, weight;
+	};
+
+	struct CollapseType
+	{
+		unsigned int v0, v1;
+		double error;
+	};
+
+public:
+	MeshSimplifierClass();
+	MeshSimplifierClass(const MeshSimplifierClass&);
+	~MeshSimplifierClass();
+
+	int Simplify(unsigned int*, const unsigned int*, int, const void*, int, int, int, float, float&);
+
+private:
+	void BuildPositions(const void*, int, int);
+	void BuildEdges(const unsigned int*, int);
+	void ClassifyVertices(const unsigned int*, int);
+	void BuildQuadrics(const unsigned int*, int);
+	bool HasEdge(unsigned int, unsigned int);
+	bool HasPositionEdge(unsigned int, unsigned int);
+	bool MatchWedges(unsigned int, unsigned int, unsigned int*);
+	bool HasFlips(const unsigned int*, unsigned int, unsigned int);
+
+	static void AddPlane(QuadricType&, const double[3], double, double);
+	static void AddQuadric(QuadricType&, const QuadricType&);
+	static double EvaluateQuadric(const QuadricType&, const float*);
+	static bool CompareCollapses(const CollapseType&, const CollapseType&);
+
+private:
+	vector<float> m_positions;
+	vector<unsigned int> m_remap, m_wedge;
+	vector<unsigned char> m_kind, m_used;
+	vector<unsigned long long> m_edges, m_positionEdges;
+	vector<QuadricType> m_quadrics;
+	vector<int> m_adjacencyOffsets, m_adjacency;
+};
+#endif
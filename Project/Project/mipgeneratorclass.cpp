@@ -0,0 +1,485 @@
+#include "mipgeneratorclass.h"
+
+#include <math.h>
+#include <string.h>
+#include <thread>
+
+// SSE is part of every x64 target and the default for 32 bit builds since Visual Studio 2012.
+#if defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1) || defined(__SSE__)
+#define MIP_SSE
+#include <xmmintrin.h>
+#endif
+
+static const float PI = 3.14159265358979f;
+
+// Reach of the windowed sinc filters in texels of the smaller level, and the Kaiser window's alpha.
+static const float SINC_RADIUS = 3.0f;
+static const float KAISER_ALPHA = 4.0f;
+
+static float Sinc(float x)
+{
+	if (fabsf(x) < 1e-6f)
+	{
+		return 1.0f;
+	}
+
+	return sinf(PI * x) / (PI * x);
+}
+
+// Modified Bessel function of the first kind, order zero, by its power series.
+static float Bessel0(float x)
+{
+	float sum, term, half;
+	int k;
+
+	sum = 1.0f;
+	term = 1.0f;
+	half = x * 0.5f;
+	for (k = 1; k < 32 && term > sum * 1e-8f; k++)
+	{
+		term *= (half / (float)k) * (half / (float)k);
+		sum += term;
+	}
+
+	return sum;
+}
+
+static float SrgbToLinear(float value)
+{
+	return (value <= 0.04045f) ? value / 12.92f : powf((value + 0.055f) / 1.055f, 2.4f);
+}
+
+MipGeneratorClass::MipGeneratorClass()
+{
+	m_source = 0;
+	m_destination = 0;
+	m_sourceWidth = 0;
+	m_sourceHeight = 0;
+	m_destinationWidth = 0;
+	m_destinationHeight = 0;
+	m_threadCount = 1;
+	m_filter = MIP_FILTER_BOX;
+	m_vectorized = true;
+	m_srgb = false;
+}
+
+MipGeneratorClass::MipGeneratorClass(const MipGeneratorClass& other)
+{
+}
+
+MipGeneratorClass::~MipGeneratorClass()
+{
+}
+
+bool MipGeneratorClass::Initialize(int threadCount, int filter, bool vectorized)
+{
+	int i, value;
+
+	if (filter != MIP_FILTER_BOX && filter != MIP_FILTER_KAISER && filter != MIP_FILTER_LANCZOS)
+	{
+		return false;
+	}
+
+	m_threadCount = (threadCount > 0) ? threadCount : 1;
+	m_filter = filter;
+	m_vectorized = vectorized;
+
+	// Linear light of every srgb value, and the linear light halfway between each value and the next, where
+	// rounding back to srgb moves up. The last one is past any linear value.
+	for (i = 0; i < 256; i++)
+	{
+		m_toLinear[i] = SrgbToLinear((float)i / 255.0f);
+	}
+	for (i = 0; i < 255; i++)
+	{
+		m_thresholds[i] = SrgbToLinear(((float)i + 0.5f) / 255.0f);
+	}
+	m_thresholds[255] = 2.0f;
+
+	// The srgb value at the start of each step, never above the one a linear value in the step rounds to.
+	value = 0;
+	for (i = 0; i <= MIP_ENCODE_STEPS; i++)
+	{
+		while (m_thresholds[value] <= (float)i / (float)MIP_ENCODE_STEPS)
+		{
+			value++;
+		}
+		m_fromLinear[i] = (unsigned char)value;
+	}
+
+	return true;
+}
+
+void MipGeneratorClass::Shutdown()
+{
+	// Release the kernels.
+	vector<int>().swap(m_columns.first);
+	vector<int>().swap(m_columns.count);
+	vector<int>().swap(m_columns.indices);
+	vector<float>().swap(m_columns.weights);
+	vector<int>().swap(m_rows.first);
+	vector<int>().swap(m_rows.count);
+	vector<int>().swap(m_rows.indices);
+	vector<float>().swap(m_rows.weights);
+
+	return;
+}
+
+bool MipGeneratorClass::Generate(const unsigned char* texels, int width, int height, int pitch, bool srgb, vector<unsigned char>& chain)
+{
+	size_t size, offset;
+	int levelCount, level, levelWidth, levelHeight, y;
+
+	if (width <= 0 || height <= 0)
+	{
+		return false;
+	}
+
+	// The levels follow one another, each with rows of width * 4 bytes.
+	levelCount = GetLevelCount(width, height);
+	size = 0;
+	for (level = 0; level < levelCount; level++)
+	{
+		levelWidth = (width >> level > 0) ? width >> level : 1;
+		levelHeight = (height >> level > 0) ? height >> level : 1;
+		size += (size_t)levelWidth * levelHeight * 4;
+	}
+	chain.resize(size);
+
+	for (y = 0; y < height; y++)
+	{
+		memcpy(&chain[(size_t)y * width * 4], texels + (size_t)y * pitch, (size_t)width * 4);
+	}
+
+	m_srgb = srgb;
+	offset = 0;
+	levelWidth = width;
+	levelHeight = height;
+	for (level = 1; level < levelCount; level++)
+	{
+		m_source = &chain[offset];
+		m_sourceWidth = levelWidth;
+		m_sourceHeight = levelHeight;
+
+		offset += (size_t)levelWidth * levelHeight * 4;
+		levelWidth = (levelWidth > 1) ? levelWidth / 2 : 1;
+		levelHeight = (levelHeight > 1) ? levelHeight / 2 : 1;
+
+		m_destination = &chain[offset];
+		m_destinationWidth = levelWidth;
+		m_destinationHeight = levelHeight;
+
+		BuildKernel(m_sourceWidth, m_destinationWidth, m_columns);
+		BuildKernel(m_sourceHeight, m_destinationHeight, m_rows);
+		RunRanges((m_destinationHeight + MIP_BAND_ROWS - 1) / MIP_BAND_ROWS);
+	}
+
+	return true;
+}
+
+int MipGeneratorClass::GetLevelCount(int width, int height)
+{
+	int largest, count;
+
+	largest = (width > height) ? width : height;
+	for (count = 1; (largest >> count) > 0; count++)
+	{
+	}
+
+	return count;
+}
+
+void MipGeneratorClass::BuildKernel(int sourceSize, int destinationSize, KernelType& kernel)
+{
+	float scale, center, support, weight, total;
+	size_t start, i;
+	int destination, source, low, high;
+
+	kernel.first.resize(destinationSize);
+	kernel.count.resize(destinationSize);
+	kernel.indices.clear();
+	kernel.weights.clear();
+
+	// A side already down to one texel stays as it is while the other one shrinks.
+	scale = (float)sourceSize / (float)destinationSize;
+	support = ((m_filter == MIP_FILTER_BOX) ? 0.5f : SINC_RADIUS) * scale;
+	for (destination = 0; destination < destinationSize; destination++)
+	{
+		start = kernel.indices.size();
+		kernel.first[destination] = (int)start;
+
+		if (sourceSize == destinationSize)
+		{
+			kernel.indices.push_back(destination);
+			kernel.weights.push_back(1.0f);
+			kernel.count[destination] = 1;
+			continue;
+		}
+
+		// Every source texel whose center is under the filter, in the smaller level's units, clamped at the edges.
+		center = ((float)destination + 0.5f) * scale;
+		low = (int)floorf(center - support);
+		high = (int)ceilf(center + support);
+		total = 0.0f;
+		for (source = low; source <= high; source++)
+		{
+			weight = FilterWeight(m_filter, ((float)source + 0.5f - center) / scale);
+			if (weight == 0.0f)
+			{
+				continue;
+			}
+
+			kernel.indices.push_back((source < 0) ? 0 : ((source >= sourceSize) ? sourceSize - 1 : source));
+			kernel.weights.push_back(weight);
+			total += weight;
+		}
+
+		for (i = start; i < kernel.weights.size(); i++)
+		{
+			kernel.weights[i] /= total;
+		}
+		kernel.count[destination] = (int)(kernel.weights.size() - start);
+	}
+
+	return;
+}
+
+void MipGeneratorClass::FilterBands(int begin, int end)
+{
+	vector<float> linear, rows, sum;
+	const int* indices;
+	const float* weights;
+	const float* row;
+	int band, firstY, lastY, firstRow, lastRow, rowFloats, y, tap, x;
+#ifdef MIP_SSE
+	__m128 weight;
+#endif
+
+	rowFloats = m_destinationWidth * 4;
+	linear.resize((size_t)m_sourceWidth * 4);
+	sum.resize(rowFloats);
+
+	for (band = begin; band < end; band++)
+	{
+		firstY = band * MIP_BAND_ROWS;
+		lastY = (firstY + MIP_BAND_ROWS < m_destinationHeight) ? firstY + MIP_BAND_ROWS : m_destinationHeight;
+
+		// The rows of the larger level under the band, each filtered across once.
+		firstRow = m_sourceHeight;
+		lastRow = 0;
+		for (y = firstY; y < lastY; y++)
+		{
+			for (tap = 0; tap < m_rows.count[y]; tap++)
+			{
+				firstRow = (m_rows.indices[m_rows.first[y] + tap] < firstRow) ? m_rows.indices[m_rows.first[y] + tap] : firstRow;
+				lastRow = (m_rows.indices[m_rows.first[y] + tap] > lastRow) ? m_rows.indices[m_rows.first[y] + tap] : lastRow;
+			}
+		}
+
+		rows.resize((size_t)(lastRow - firstRow + 1) * rowFloats);
+		for (y = firstRow; y <= lastRow; y++)
+		{
+			FilterRow(m_source + (size_t)y * m_sourceWidth * 4, &linear[0], &rows[(size_t)(y - firstRow) * rowFloats]);
+		}
+
+		// Then down, the weighted rows added in tap order.
+		for (y = firstY; y < lastY; y++)
+		{
+			indices = &m_rows.indices[m_rows.first[y]];
+			weights = &m_rows.weights[m_rows.first[y]];
+			memset(&sum[0], 0, sizeof(float) * rowFloats);
+
+			for (tap = 0; tap < m_rows.count[y]; tap++)
+			{
+				row = &rows[(size_t)(indices[tap] - firstRow) * rowFloats];
+#ifdef MIP_SSE
+				if (m_vectorized)
+				{
+					weight = _mm_set1_ps(weights[tap]);
+					for (x = 0; x < rowFloats; x += 4)
+					{
+						_mm_storeu_ps(&sum[x], _mm_add_ps(_mm_loadu_ps(&sum[x]), _mm_mul_ps(weight, _mm_loadu_ps(row + x))));
+					}
+					continue;
+				}
+#endif
+				for (x = 0; x < rowFloats; x++)
+				{
+					sum[x] += weights[tap] * row[x];
+				}
+			}
+
+			StoreRow(&sum[0], m_destination + (size_t)y * m_destinationWidth * 4);
+		}
+	}
+
+	return;
+}
+
+void MipGeneratorClass::FilterRow(const unsigned char* texels, float* linear, float* filtered)
+{
+	const int* indices;
+	const float* weights;
+	float total;
+	int x, tap, channel;
+#ifdef MIP_SSE
+	__m128 sum;
+#endif
+
+	// Into linear light, alpha as it is.
+	for (x = 0; x < m_sourceWidth * 4; x += 4)
+	{
+		for (channel = 0; channel < 3; channel++)
+		{
+			linear[x + channel] = m_srgb ? m_toLinear[texels[x + channel]] : (float)texels[x + channel] / 255.0f;
+		}
+		linear[x + 3] = (float)texels[x + 3] / 255.0f;
+	}
+
+	// Across, a texel at a time.
+	for (x = 0; x < m_destinationWidth; x++)
+	{
+		indices = &m_columns.indices[m_columns.first[x]];
+		weights = &m_columns.weights[m_columns.first[x]];
+#ifdef MIP_SSE
+		if (m_vectorized)
+		{
+			sum = _mm_setzero_ps();
+			for (tap = 0; tap < m_columns.count[x]; tap++)
+			{
+				sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[tap]), _mm_loadu_ps(linear + indices[tap] * 4)));
+			}
+			_mm_storeu_ps(filtered + x * 4, sum);
+			continue;
+		}
+#endif
+		for (channel = 0; channel < 4; channel++)
+		{
+			total = 0.0f;
+			for (tap = 0; tap < m_columns.count[x]; tap++)
+			{
+				total += weights[tap] * linear[indices[tap] * 4 + channel];
+			}
+			filtered[x * 4 + channel] = total;
+		}
+	}
+
+	return;
+}
+
+void MipGeneratorClass::StoreRow(const float* sum, unsigned char* texels)
+{
+	float value;
+	int x, channel, code;
+
+	for (x = 0; x < m_destinationWidth * 4; x += 4)
+	{
+		for (channel = 0; channel < 4; channel++)
+		{
+			// The sinc filters ring past the ends of the range.
+			value = sum[x + channel];
+			value = (value < 0.0f) ? 0.0f : ((value > 1.0f) ? 1.0f : value);
+
+			if (!m_srgb || channel == 3)
+			{
+				texels[x + channel] = (unsigned char)(value * 255.0f + 0.5f);
+				continue;
+			}
+
+			// The srgb value is the number of halfway points at or below the linear one, counted on from the
+			// start of its step in the table.
+			code = m_fromLinear[(int)(value * (float)MIP_ENCODE_STEPS)];
+			while (m_thresholds[code] <= value)
+			{
+				code++;
+			}
+			texels[x + channel] = (unsigned char)code;
+		}
+	}
+
+	return;
+}
+
+void MipGeneratorClass::RunRanges(int count)
+{
+	RangeType* ranges;
+	thread* threads;
+	int rangeCount, i;
+
+	rangeCount = (count < m_threadCount) ? count : m_threadCount;
+	if (rangeCount < 1)
+	{
+		return;
+	}
+
+	ranges = new RangeType[rangeCount];
+	if (!ranges)
+	{
+		return;
+	}
+
+	for (i = 0; i < rangeCount; i++)
+	{
+		ranges[i].generator = this;
+		ranges[i].begin = (int)((long long)count * i / rangeCount);
+		ranges[i].end = (int)((long long)count * (i + 1) / rangeCount);
+	}
+
+	// Run every range but the first on a worker thread, and the first one here.
+	threads = 0;
+	if (rangeCount > 1)
+	{
+		threads = new thread[rangeCount - 1];
+		for (i = 1; i < rangeCount; i++)
+		{
+			threads[i - 1] = thread(FilterRange, &ranges[i]);
+		}
+	}
+
+	FilterRange(&ranges[0]);
+
+	if (threads)
+	{
+		for (i = 0; i < rangeCount - 1; i++)
+		{
+			threads[i].join();
+		}
+		delete[] threads;
+		threads = 0;
+	}
+
+	delete[] ranges;
+	ranges = 0;
+
+	return;
+}
+
+float MipGeneratorClass::FilterWeight(int filter, float x)
+{
+	x = fabsf(x);
+
+	switch (filter)
+	{
+	case MIP_FILTER_BOX:
+		return (x < 0.5f) ? 1.0f : ((x == 0.5f) ? 0.5f : 0.0f);
+	case MIP_FILTER_KAISER:
+		if (x >= SINC_RADIUS)
+		{
+			return 0.0f;
+		}
+		return Sinc(x) * Bessel0(KAISER_ALPHA * sqrtf(1.0f - (x / SINC_RADIUS) * (x / SINC_RADIUS))) / Bessel0(KAISER_ALPHA);
+	default:
+		if (x >= SINC_RADIUS)
+		{
+			return 0.0f;
+		}
+		return Sinc(x) * Sinc(x / SINC_RADIUS);
+	}
+}
+
+void MipGeneratorClass::FilterRange(RangeType* range)
+{
+	range->generator->FilterBands(range->begin, range->end);
+
+	return;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#ifndef _MIPGENERATORCLASS_H_
+#define _MIPGENERATORCLASS_H_
+
+#include <vector>
+using namespace std;
+
+// Filters the generator downsamples with, each as wide as it is in the units of the smaller level: a box
+// over the texels each one covers, a Kaiser windowed sinc three texels out (alpha 4), and Lanczos 3.
+// NONE is for callers that keep the levels they have.
+const int MIP_FILTER_NONE = 0;
+const int MIP_FILTER_BOX = 1;
+const int MIP_FILTER_KAISER = 2;
+const int MIP_FILTER_LANCZOS = 3;
+
+// Rows of the smaller level one job filters, with the rows of the larger level under them.
+const int MIP_BAND_ROWS = 16;
+
+// Steps of the table that finds the srgb value nearest to a linear one, to within a value or two.
+const int MIP_ENCODE_STEPS = 4096;
+
+// Builds the full mip chain of an 8 bit RGBA image, each level from the one above it, halving each side
+// down to 1x1. The filter is separable: every band of rows of the new level filters the rows under it
+// horizontally into linear floats, then filters those vertically, so no level is ever held in floats
+// whole. Bands run in parallel. With srgb set the color channels are converted to linear light before
+// filtering and back after it, rounding to the nearest srgb value, alpha is always linear. Both passes
+// keep a whole texel in one SSE register; without vectorized they run the same sums channel by channel,
+// with the same result. Edges are clamped.
+class MipGeneratorClass
+{
+private:
+	// Source texels and weights of each texel of the smaller level along one axis.
+	struct KernelType
+	{
+		vector<int> first, count;
+		vector<int> indices;
+		vector<float> weights;
+	};
+
+	struct RangeType
+	{
+		MipGeneratorClass* generator;
+		int begin, end;
+	};
+
+public:
+	MipGeneratorClass();
+	MipGeneratorClass(const MipGeneratorClass&);
+	~MipGeneratorClass();
+
+	bool Initialize(int, int, bool);
+	void Shutdown();
+
+	bool Generate(const unsigned char*, int, int, int, bool, vector<unsigned char>&);
+
+	static int GetLevelCount(int, int);
+
+private:
+	void BuildKernel(int, int, KernelType&);
+	void FilterBands(int, int);
+	void FilterRow(const unsigned char*, float*, float*);
+	void StoreRow(const float*, unsigned char*);
+	void RunRanges(int);
+
+	static float FilterWeight(int, float);
+	static void FilterRange(RangeType*);
+
+private:
+	KernelType m_columns, m_rows;
+	const unsigned char* m_source;
+	unsigned char* m_destination;
+	int m_sourceWidth, m_sourceHeight, m_destinationWidth, m_destinationHeight;
+	int m_threadCount, m_filter;
+	bool m_vectorized, m_srgb;
+	float m_toLinear[256];
+	float m_thresholds[256];
+	unsigned char m_fromLinear[MIP_ENCODE_STEPS + 1];
+};
+#endif
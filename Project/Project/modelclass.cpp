@@ -1,12 +1,43 @@
 #include "modelclass.h"
 
+#include <string.h>
+
+// Colour of the box drawn in place of a model that is still loading, 0xAABBGGRR.
+static const unsigned int PLACEHOLDER_COLOR = 0xFF808080;
+
 ModelClass::ModelClass()
 {
 	m_vertexBuffer = 0;
 	m_indexBuffer = 0;
+	m_visibleIndexBuffer = 0;
 
 	m_Texture = 0;
-	m_model = 0;
+	m_Mesh = 0;
+	m_Registry = 0;
+	m_SharedMesh = 0;
+	m_SharedTexture = 0;
+	m_indices = 0;
+	m_vertexCount = 0;
+	m_indexCount = 0;
+
+	m_vertexFormat = VERTEX_FORMAT_FLOAT;
+	m_vertexStride = sizeof(VertexType);
+	memset(&m_dequantize, 0, sizeof(m_dequantize));
+	memset(&m_quantizationError, 0, sizeof(m_quantizationError));
+
+	memset(m_lods, 0, sizeof(m_lods));
+	m_lodCount = 0;
+	m_lod = 0;
+	m_projectedSize = 0.0f;
+	memset(&m_bounds, 0, sizeof(m_bounds));
+	memset(&m_worldBounds, 0, sizeof(m_worldBounds));
+
+	m_meshlets = 0;
+	m_meshletVisible = 0;
+	m_meshletCount = 0;
+	m_drawIndexCount = 0;
+	m_drawVisible = false;
+	memset(&m_cullStats, 0, sizeof(m_cullStats));
 
 	D3DXMatrixIdentity(&m_worldMatrix);
 	D3DXMatrixIdentity(&m_scaling);
@@ -24,37 +55,166 @@ ModelClass::~ModelClass()
 {
 }
 
-bool ModelClass::Initialize(ID3D11Device* device, char* modelFilename, WCHAR* textureFilename)
+bool ModelClass::Initialize(ID3D11Device* device, ResourceRegistryClass* registry, char* modelFilename, WCHAR* textureFilename, bool optimize, int vertexFormat,
+							int lodCount, int residency)
 {
 	bool result;
 
-	result = ReadObjFileCount(modelFilename);
+	// Read and prepare the model on this thread, then create its resources right away.
+	result = Load(registry, modelFilename, textureFilename, optimize, vertexFormat, lodCount, residency);
 	if (!result)
 	{
 		return false;
 	}
 
-	// Load in the model data,
-	result = LoadModel(modelFilename);
+	result = CreateResources(device);
 	if (!result)
 	{
 		return false;
 	}
 
-	// Load the texture for this model.
-	result = InitializeBuffers(device);
+	return true;
+}
+
+bool ModelClass::Load(ResourceRegistryClass* registry, char* modelFilename, WCHAR* textureFilename, bool optimize, int vertexFormat, int lodCount, int residency)
+{
+	TextureAtlasClass::RemapType remap;
+	bool result;
+
+	m_name = modelFilename;
+	m_Registry = registry;
+
+	// Get the mesh from the registry. It reads the cooked mesh, or cooks it from the model file, in the vertex
+	// format the model asked for, unless another model already did. The residency policy decides what of the
+	// vertices stays on the CPU after the upload.
+	m_SharedMesh = m_Registry->AcquireMesh(modelFilename, optimize, vertexFormat, lodCount, residency);
+	if (!m_SharedMesh)
+	{
+		return false;
+	}
+
+	m_Mesh = m_SharedMesh->loader;
+
+	result = InitializeMesh();
 	if (!result)
 	{
 		return false;
 	}
 
+	// Draw from the atlas when the texture is packed in it and the coordinates stay inside it, the dequantize
+	// values of this model move them into the texture's place there.
+	m_SharedTexture = HasUnitTexcoords() ? m_Registry->AcquireAtlasTexture(textureFilename, remap) : 0;
+	if (m_SharedTexture)
+	{
+		m_dequantize.texcoordOffset[0] = m_dequantize.texcoordOffset[0] * remap.uScale + remap.uOffset;
+		m_dequantize.texcoordOffset[1] = m_dequantize.texcoordOffset[1] * remap.vScale + remap.vOffset;
+		m_dequantize.texcoordScale[0] *= remap.uScale;
+		m_dequantize.texcoordScale[1] *= remap.vScale;
+	}
+
+	// Otherwise get the texture file read in, it is turned into a texture with the other resources.
+	if (!m_SharedTexture)
+	{
+		m_SharedTexture = m_Registry->AcquireTexture(textureFilename);
+		if (!m_SharedTexture)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ModelClass::CreateResources(ID3D11Device* device)
+{
+	bool result;
+
+	// Use the buffers of a mesh another model already uploaded.
+	if (m_SharedMesh->vertexBuffer)
+	{
+		m_vertexBuffer = m_SharedMesh->vertexBuffer;
+		m_vertexBuffer->AddRef();
+		m_indexBuffer = m_SharedMesh->indexBuffer;
+		m_indexBuffer->AddRef();
+	}
+
+	// Initialize the vertex and index buffers.
+	result = InitializeBuffers(device, m_Mesh->GetVertices(), m_indices);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Hand them to the registry for the next model drawn from this mesh.
+	if (!m_SharedMesh->vertexBuffer)
+	{
+		m_SharedMesh->vertexBuffer = m_vertexBuffer;
+		m_SharedMesh->vertexBuffer->AddRef();
+		m_SharedMesh->indexBuffer = m_indexBuffer;
+		m_SharedMesh->indexBuffer->AddRef();
+	}
+
 	// Load the texture for this model.
-	result = LoadTexture(device, textureFilename);
+	result = LoadTexture(device);
 	if (!result)
 	{
 		return false;
 	}
 
+	// The mapped cache and vertices are not needed once the resources exist.
+	ReleaseUploadData();
+
+	return true;
+}
+
+bool ModelClass::InitializePlaceholder(ID3D11Device* device)
+{
+	bool result;
+
+	m_name = "placeholder";
+
+	// Create the mesh loader object.
+	m_Mesh = new MeshLoaderClass;
+	if (!m_Mesh)
+	{
+		return false;
+	}
+
+	// A unit box, with no detail levels or meshlets.
+	result = m_Mesh->InitializeBox();
+	if (!result)
+	{
+		return false;
+	}
+
+	result = InitializeMesh();
+	if (!result)
+	{
+		return false;
+	}
+
+	// Initialize the vertex and index buffers.
+	result = InitializeBuffers(device, m_Mesh->GetVertices(), m_indices);
+	if (!result)
+	{
+		return false;
+	}
+
+	// A plain grey texture in place of a texture file.
+	m_Texture = new TextureClass;
+	if (!m_Texture)
+	{
+		return false;
+	}
+
+	result = m_Texture->InitializeFromColor(device, PLACEHOLDER_COLOR);
+	if (!result)
+	{
+		return false;
+	}
+
+	ReleaseUploadData();
+
 	return true;
 }
 
@@ -82,7 +242,153 @@ void ModelClass::Render(ID3D11DeviceContext* deviceContext)
 
 int ModelClass::GetIndexCount()
 {
-	return m_indexCount;
+	return m_drawVisible ? m_drawIndexCount : m_lods[m_lod].indexCount;
+}
+
+int ModelClass::SelectLod(D3DXVECTOR3 cameraPosition, float pixelScale, float maxPixelError)
+{
+	D3DXVECTOR3 offset;
+	float radius, distance;
+	int i;
+
+	// The bounding sphere as UpdateWorldBounds moved it into the world this frame.
+	radius = m_worldBounds.radius;
+	offset = D3DXVECTOR3(m_worldBounds.center) - cameraPosition;
+	distance = D3DXVec3Length(&offset);
+
+	// Size of the model on screen in pixels, as large as the screen once the camera is inside the bounds.
+	m_projectedSize = 2.0f * radius * pixelScale / ((distance > radius) ? distance : radius);
+
+	// Full detail when the camera is inside the bounds. Every meshlet is drawn until culled again.
+	m_lod = 0;
+	m_drawVisible = false;
+	if (distance <= radius)
+	{
+		return m_lod;
+	}
+
+	// Level errors are relative to the model size, so the size on screen turns them into pixels; take the
+	// coarsest level that stays under the limit.
+	for (i = m_lodCount - 1; i > 0; i--)
+	{
+		if (m_lods[i].error * m_projectedSize <= maxPixelError)
+		{
+			m_lod = i;
+			break;
+		}
+	}
+
+	return m_lod;
+}
+
+float ModelClass::GetProjectedSize()
+{
+	return m_projectedSize;
+}
+
+bool ModelClass::Cull(ID3D11DeviceContext* deviceContext, D3DXMATRIX viewMatrix, D3DXMATRIX projectionMatrix, D3DXVECTOR3 cameraPosition)
+{
+	FrustumClass frustum;
+	D3DXMATRIX world, inverseWorld;
+	D3DXVECTOR3 camera;
+	D3D11_MAPPED_SUBRESOURCE mappedResource;
+	const MeshletBuilderClass::MeshletType* meshlet;
+	unsigned int* indices;
+	int i, first, end, visibleCount;
+	bool inView, mirrored;
+	HRESULT result;
+
+	const MeshCacheClass::LodType& lod = m_lods[m_lod];
+
+	m_drawVisible = false;
+	if (lod.meshletCount == 0)
+	{
+		return true;
+	}
+
+	// Test in the model's own space: the frustum planes come from the full transform and the camera is moved
+	// back through the world matrix.
+	world = GetWorldMatrix();
+	frustum.ConstructFrustum(world * viewMatrix * projectionMatrix);
+	D3DXMatrixInverse(&inverseWorld, NULL, &world);
+	D3DXVec3TransformCoord(&camera, &cameraPosition, &inverseWorld);
+
+	// A mirroring world matrix turns the winding around, the normal cones only hold without one.
+	mirrored = D3DXMatrixDeterminant(&world) < 0.0f;
+
+	// The whole model is rejected at once when its bounds are out of view.
+	inView = frustum.CheckSphere(m_bounds.center[0], m_bounds.center[1], m_bounds.center[2], m_bounds.radius);
+
+	visibleCount = 0;
+	for (i = 0; i < (int)lod.meshletCount; i++)
+	{
+		meshlet = &m_meshlets[lod.meshletStart + i];
+		m_meshletVisible[i] = 0;
+
+		if (!inView || !frustum.CheckSphere(meshlet->center[0], meshlet->center[1], meshlet->center[2], meshlet->radius))
+		{
+			m_cullStats.frustumCulled++;
+		}
+		else if (!mirrored && MeshletBuilderClass::IsBackfacing(*meshlet, camera))
+		{
+			m_cullStats.backfaceCulled++;
+		}
+		else
+		{
+			m_meshletVisible[i] = 1;
+			visibleCount += meshlet->triangleCount * 3;
+		}
+	}
+
+	m_cullStats.frames++;
+	m_cullStats.meshlets += lod.meshletCount;
+	m_cullStats.triangles += lod.indexCount / 3;
+	m_cullStats.drawnTriangles += visibleCount / 3;
+
+	// Nothing was culled, the level is drawn straight from the static index buffer.
+	if (visibleCount == (int)lod.indexCount)
+	{
+		return true;
+	}
+
+	m_drawVisible = true;
+	m_drawIndexCount = visibleCount;
+	if (visibleCount == 0)
+	{
+		return true;
+	}
+
+	// Lock the visible index buffer so it can be written to.
+	result = deviceContext->Map(m_visibleIndexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Copy the triangles of the visible meshlets, one run of neighbouring meshlets at a time.
+	indices = (unsigned int*)mappedResource.pData;
+	for (i = 0; i < (int)lod.meshletCount; i = end)
+	{
+		if (!m_meshletVisible[i])
+		{
+			end = i + 1;
+			continue;
+		}
+
+		for (end = i + 1; end < (int)lod.meshletCount && m_meshletVisible[end]; end++)
+		{
+		}
+
+		first = m_meshlets[lod.meshletStart + i].indexStart;
+		meshlet = &m_meshlets[lod.meshletStart + end - 1];
+		memcpy(indices, m_indices + first, sizeof(unsigned int) * (meshlet->indexStart + meshlet->triangleCount * 3 - first));
+		indices += meshlet->indexStart + meshlet->triangleCount * 3 - first;
+	}
+
+	// Unlock the visible index buffer.
+	deviceContext->Unmap(m_visibleIndexBuffer, 0);
+
+	return true;
 }
 
 ID3D11ShaderResourceView* ModelClass::GetTexture()
@@ -90,12 +396,38 @@ ID3D11ShaderResourceView* ModelClass::GetTexture()
 	return m_Texture->GetTexture();
 }
 
+ResourceRegistryClass::TextureType* ModelClass::GetSharedTexture()
+{
+	return m_SharedTexture;
+}
+
 D3DXMATRIX ModelClass::GetWorldMatrix()
 {
 	m_worldMatrix = m_scaling * m_rotation * m_translation;	
 	return m_worldMatrix;
 }
 
+D3DXMATRIX ModelClass::GetPlacementMatrix()
+{
+	return m_rotation * m_translation;
+}
+
+void ModelClass::UpdateWorldBounds()
+{
+	D3DXMATRIX world;
+
+	// Move the box and sphere of the mesh to where the world matrix puts it, once per frame after it was placed.
+	world = GetWorldMatrix();
+	BoundingVolumeClass::Transform(m_bounds, &world._11, m_worldBounds);
+
+	return;
+}
+
+const BoundingVolumeClass::BoundsType& ModelClass::GetWorldBounds()
+{
+	return m_worldBounds;
+}
+
 void ModelClass::SetScaling(float x, float y, float z)
 {
 	D3DXMatrixScaling(&m_scaling, x, y, z);
@@ -130,89 +462,204 @@ int ModelClass::GetPolygonCount()
 	return polygoneCount;
 }
 
-bool ModelClass::InitializeBuffers(ID3D11Device* device)
+const char* ModelClass::GetName()
 {
-	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
-	HRESULT result;
+	return m_name.c_str();
+}
+
+int ModelClass::GetVertexCount()
+{
+	return m_vertexCount;
+}
+
+int ModelClass::GetVertexFormat()
+{
+	return m_vertexFormat;
+}
+
+int ModelClass::GetVertexStride()
+{
+	return m_vertexStride;
+}
+
+const VertexQuantizerClass::DequantizeType* ModelClass::GetDequantize()
+{
+	return (m_vertexFormat == VERTEX_FORMAT_FLOAT) ? 0 : &m_dequantize;
+}
+
+const VertexQuantizerClass::ErrorType& ModelClass::GetQuantizationError()
+{
+	return m_quantizationError;
+}
+
+int ModelClass::GetLodCount()
+{
+	return m_lodCount;
+}
 
-	// Create the vertex array.
-	vertices = new VertexType[m_vertexCount];
-	if (!vertices)
+int ModelClass::GetLodPolygonCount(int lod)
+{
+	return m_lods[lod].indexCount / 3;
+}
+
+float ModelClass::GetLodError(int lod)
+{
+	return m_lods[lod].error;
+}
+
+int ModelClass::GetLodMeshletCount(int lod)
+{
+	return m_lods[lod].meshletCount;
+}
+
+size_t ModelClass::GetTransientPeakBytes()
+{
+	return m_Mesh ? m_Mesh->GetTransientPeakBytes() : 0;
+}
+
+bool ModelClass::IsFromCache()
+{
+	return m_Mesh ? m_Mesh->IsFromCache() : false;
+}
+
+bool ModelClass::IsCacheWritten()
+{
+	return m_Mesh ? m_Mesh->IsCacheWritten() : false;
+}
+
+int ModelClass::GetResidency()
+{
+	return m_Mesh ? m_Mesh->GetResidency() : MESH_RESIDENCY_NONE;
+}
+
+const float* ModelClass::GetPositions()
+{
+	return m_Mesh ? m_Mesh->GetPositions() : 0;
+}
+
+int ModelClass::GetPositionStride()
+{
+	return m_Mesh ? m_Mesh->GetPositionStride() : 0;
+}
+
+void ModelClass::GetMemoryStats(MemoryStatsType& stats)
+{
+	memset(&stats, 0, sizeof(stats));
+
+	// CPU side: what the mesh loader keeps after the upload, and the per meshlet visibility flags.
+	if (m_Mesh)
 	{
-		return false;
+		stats.cpuIndices = sizeof(unsigned int) * m_indexCount;
+		stats.cpuMeshlets = sizeof(MeshletBuilderClass::MeshletType) * m_meshletCount + m_meshletCount;
+		stats.cpuVertices = m_Mesh->GetRetainedBytes();
 	}
-	// Create the index array.
-	indices = new unsigned long[m_indexCount];
-	if (!indices)
+
+	// GPU side: the buffers as they were created, and the texture with its mip chain.
+	if (m_vertexBuffer)
 	{
-		return false;
+		stats.gpuVertices = (size_t)m_vertexStride * m_vertexCount;
+		stats.gpuIndices = sizeof(unsigned int) * m_indexCount;
 	}
 
-	int i;
-	// Load the vertex array and index array with data.
-	for (i = 0; i < m_vertexCount; i++)
-	{
-		vertices[i].position = D3DXVECTOR3(m_model[i].x, m_model[i].y, m_model[i].z);
-		vertices[i].texture = D3DXVECTOR2(m_model[i].tu, m_model[i].tv);
-		vertices[i].normal = D3DXVECTOR3(m_model[i].nx, m_model[i].ny, m_model[i].nz);
-		indices[i] = i;
-	}
-
-	// Set up the description of the static vertex buffer.
-	vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * m_vertexCount;
-	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	vertexBufferDesc.CPUAccessFlags = 0;
-	vertexBufferDesc.MiscFlags = 0;
-	vertexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Now create the vertex buffer.
-	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
-	if (FAILED(result))
+	if (m_visibleIndexBuffer)
 	{
-		return false;
+		stats.gpuVisibleIndices = sizeof(unsigned int) * m_lods[0].indexCount;
 	}
 
-	// Set up the description of the static index buffer.
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * m_indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
+	if (m_Texture)
+	{
+		stats.gpuTexture = m_Texture->GetMemorySize();
+	}
 
-	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
+	return;
+}
 
-	// Create the index buffer.
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
-	if (FAILED(result))
-	{
-		return false;
+const ModelClass::CullStatsType& ModelClass::GetCullStats()
+{
+	return m_cullStats;
+}
+
+bool ModelClass::InitializeBuffers(ID3D11Device* device, const void* vertices, const unsigned int* indices)
+{
+	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA vertexData, indexData;
+	HRESULT result;
+
+	// A shared mesh that another model already uploaded brings its vertex and index buffers, only the buffer
+	// of this model's own visible triangles is created.
+	if (!m_vertexBuffer)
+	{
+		// Set up the description of the static vertex buffer.
+		vertexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		vertexBufferDesc.ByteWidth = m_vertexStride * m_vertexCount;
+		vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		vertexBufferDesc.CPUAccessFlags = 0;
+		vertexBufferDesc.MiscFlags = 0;
+		vertexBufferDesc.StructureByteStride = 0;
+
+		// Give the subresource structure a pointer to the vertex data.
+		vertexData.pSysMem = vertices;
+		vertexData.SysMemPitch = 0;
+		vertexData.SysMemSlicePitch = 0;
+
+		// Now create the vertex buffer.
+		result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &m_vertexBuffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		// Set up the description of the static index buffer.
+		indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		indexBufferDesc.ByteWidth = sizeof(unsigned int) * m_indexCount;
+		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		indexBufferDesc.CPUAccessFlags = 0;
+		indexBufferDesc.MiscFlags = 0;
+		indexBufferDesc.StructureByteStride = 0;
+
+		// Give the subresource structure a pointer to the index data.
+		indexData.pSysMem = indices;
+		indexData.SysMemPitch = 0;
+		indexData.SysMemSlicePitch = 0;
+
+		// Create the index buffer.
+		result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_indexBuffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
 	}
 
-	// Release the arrays now that the vertex and index buffers have been created and loaded.
-	delete[] vertices;
-	vertices = 0;
+	// The triangles left after culling are written to a dynamic index buffer each frame. No level is larger
+	// than the full mesh.
+	if (m_meshletCount > 0)
+	{
+		indexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+		indexBufferDesc.ByteWidth = sizeof(unsigned int) * m_lods[0].indexCount;
+		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+		indexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		indexBufferDesc.MiscFlags = 0;
+		indexBufferDesc.StructureByteStride = 0;
 
-	delete[] indices;
-	indices = 0;
+		result = device->CreateBuffer(&indexBufferDesc, NULL, &m_visibleIndexBuffer);
+		if (FAILED(result))
+		{
+			return false;
+		}
+	}
 
 	return true;
 }
 
 void ModelClass::ShutdownBuffers()
 {
+	// Release the visible index buffer.
+	if (m_visibleIndexBuffer)
+	{
+		m_visibleIndexBuffer->Release();
+		m_visibleIndexBuffer = 0;
+	}
+
 	// Release the index buffer.
 	if (m_indexBuffer)
 	{
@@ -236,14 +683,22 @@ void ModelClass::RenderBuffers(ID3D11DeviceContext* deviceContext)
 	unsigned int offset;
 
 	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType);
+	stride = m_vertexStride;
 	offset = 0;
 
 	// Set the vertex buffer to active in the input assembler so it can be rendered.
 	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
 
-	// Set the index buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	// Set the index buffer to active in the input assembler so it can be rendered: the triangles that survived
+	// culling, or the whole selected detail level.
+	if (m_drawVisible)
+	{
+		deviceContext->IASetIndexBuffer(m_visibleIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
+	}
+	else
+	{
+		deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R32_UINT, m_lods[m_lod].indexStart * sizeof(unsigned int));
+	}
 
 	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
 	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
@@ -251,29 +706,33 @@ void ModelClass::RenderBuffers(ID3D11DeviceContext* deviceContext)
 	return;
 }
 
-bool ModelClass::LoadTexture(ID3D11Device* device, WCHAR* filename)
+bool ModelClass::LoadTexture(ID3D11Device* device)
 {
 	bool result;
 
-	// Create the texture object.
-	m_Texture = new TextureClass;
-	if (!m_Texture)
-	{
-		return false;
-	}
-
-	// Initialize the texture object.
-	result = m_Texture->Initialize(device, filename);
+	// Create the texture from the file read in by Load, unless another model already did. It is streamed in,
+	// the model can be drawn with the placeholder's texture until its smallest levels are there.
+	result = m_Registry->CreateTexture(device, m_SharedTexture, true);
 	if (!result)
 	{
 		return false;
 	}
 
+	m_Texture = m_SharedTexture->texture;
+
 	return true;
 }
 
 void ModelClass::ReleaseTexture()
 {
+	// Give the texture back to the registry.
+	if (m_SharedTexture)
+	{
+		m_Registry->ReleaseTexture(m_SharedTexture);
+		m_SharedTexture = 0;
+		m_Texture = 0;
+	}
+
 	// Release the texture object.
 	if (m_Texture)
 	{
@@ -285,362 +744,90 @@ void ModelClass::ReleaseTexture()
 	return;
 }
 
-bool ModelClass::ReadObjFileCount(char* filename)
+bool ModelClass::InitializeMesh()
 {
-	ifstream fin;
-	char input;
-
-	m_vertexCount = 0;
-	m_textureCount = 0;
-	m_normalCount = 0;
-	m_faceCount = 0;
-	m_faceNum = 0;
-	bool faceNumRead = false;
-
-	// Open the model file.
-	fin.open(filename);
-
-	// If it could not open the file then exit.
-	if (fin.fail())
+	m_vertexCount = m_Mesh->GetVertexCount();
+	m_indexCount = m_Mesh->GetIndexCount();
+	m_vertexFormat = m_Mesh->GetVertexFormat();
+	m_vertexStride = m_Mesh->GetVertexStride();
+	m_dequantize = m_Mesh->GetDequantize();
+	m_quantizationError = m_Mesh->GetQuantizationError();
+	polygoneCount = m_Mesh->GetPolygonCount();
+
+	// Copy the detail levels, level 0 is the full mesh. The indices and meshlets stay with the mesh loader, the
+	// culling pass copies the visible meshlets' triangles from them every frame.
+	m_lodCount = m_Mesh->GetLodCount();
+	memcpy(m_lods, m_Mesh->GetLods(), sizeof(MeshCacheClass::LodType) * m_lodCount);
+	m_indices = m_Mesh->GetIndices();
+	m_meshlets = m_Mesh->GetMeshlets();
+	m_meshletCount = m_Mesh->GetMeshletCount();
+
+	// Box and sphere of the mesh, used to cull it and to tell how large it is on screen. The world space ones
+	// follow once the model is placed.
+	m_Mesh->GetBounds(m_bounds);
+	m_worldBounds = m_bounds;
+
+	// Start out at full detail, with every meshlet drawn.
+	m_lod = 0;
+	m_drawVisible = false;
+
+	m_meshletVisible = new unsigned char[m_meshletCount];
+	if (!m_meshletVisible)
 	{
 		return false;
 	}
 
-	// Read up to the value of vertex count.
-	fin.get(input);
-	while (!fin.eof())
-	{
-		if (input == 'v')
-		{
-			fin.get(input);
-			switch (input)
-			{
-			case ' ':
-				m_vertexCount++;
-				break;
-			case 't':
-				m_textureCount++;
-				break;
-			case 'n':
-				m_normalCount++;
-				break;
-			}
-		}
-		if (input == 'f')
-		{
-			fin.get(input);
-			if (input == ' ')	m_faceCount++;
-
-			// '/'  簢 ׷ȴ ﰢ ׷ȴ Ǻ
-			if (!faceNumRead) {
-				while (input != '\n')
-				{
-					fin.get(input);
-					if (input == '/')m_faceNum++;
-				}
-				// '/'  6 ﰢ
-				if (m_faceNum == 6) m_faceNum = 3;
-				// '/'  8 簢
-				else if (m_faceNum == 8) m_faceNum = 4;
-				faceNumRead = true;
-			}
-		}
-
-		while (input != '\n')
-		{
-			fin.get(input);
-		}
-
-		fin.get(input);
-	}
-
-	fin.close();
-
 	return true;
 }
 
-bool ModelClass::LoadModel(char* filename)
+bool ModelClass::HasUnitTexcoords()
 {
-	ifstream fin;
-	FaceType* faces;
-	vertexType *vertices, *texcoords, *normals;
-	int vertexIndex, texcoordIndex, normalIndex, faceIndex, vIndex, tIndex, nIndex;
-	char input, input2;
-
-	vertices = new vertexType[m_vertexCount];
-	if (!vertices)
-	{
-		return false;
-	}
-
-	texcoords = new vertexType[m_textureCount];
-	if (!texcoords)
-	{
-		return false;
-	}
-
-	normals = new vertexType[m_normalCount];
-	if (!normals)
-	{
-		return false;
-	}
-
-	faces = new FaceType[m_faceCount];
-	if (!faces)
-	{
-		return false;
-	}
-
-	vertexIndex = 0;
-	texcoordIndex = 0;
-	normalIndex = 0;
-	faceIndex = 0;
-
-	// Open the model file.
-	fin.open(filename);
-
-	// If it could not open the file then exit.
-	if (fin.fail())
-	{
-		return false;
-	}
-
-	fin.get(input);
-
-	while (!fin.eof())
-	{
-		if (input == 'v')
-		{
-			fin.get(input);
-			if (input == ' ')
-			{
-				fin >> vertices[vertexIndex].x >> vertices[vertexIndex].y >> vertices[vertexIndex].z;
-				// ǥ迡 ޼ ǥ ȯ
-				vertices[vertexIndex].z = vertices[vertexIndex].z * -1.0f; vertexIndex++;
-			}
-			if (input == 't')
-			{
-				fin >> texcoords[texcoordIndex].x >> texcoords[texcoordIndex].y;
-				// ǥ迡 ޼ ǥ ȯ
-				texcoords[texcoordIndex].y = 1.0f - texcoords[texcoordIndex].y; texcoordIndex++;
-			}
-			if (input == 'n')
-			{
-				fin >> normals[normalIndex].x >> normals[normalIndex].y >> normals[normalIndex].z;
-				// ǥ迡 ޼ ǥ ȯ
-				normals[normalIndex].z = normals[normalIndex].z * -1.0f; normalIndex++;
-			}
-		}
-
-		if (input == 'f')
-		{
-			fin.get(input);
-			if (input == ' ')
-			{
-				if (m_faceNum == 4)
-				{
-					fin >> faces[faceIndex].vIndex4 >> input2 >> faces[faceIndex].tIndex4 >> input2 >> faces[faceIndex].nIndex4;
-				}
-				fin >> faces[faceIndex].vIndex3 >> input2 >> faces[faceIndex].tIndex3 >> input2 >> faces[faceIndex].nIndex3 >>
-					faces[faceIndex].vIndex2 >> input2 >> faces[faceIndex].tIndex2 >> input2 >> faces[faceIndex].nIndex2 >>
-					faces[faceIndex].vIndex1 >> input2 >> faces[faceIndex].tIndex1 >> input2 >> faces[faceIndex].nIndex1;
-				faceIndex++;
-			}
-		}
-
-		while (input != '\n')
-		{
-			fin.get(input);
-		}
-
-		fin.get(input);
-	}
-
-	fin.close();
-
-	// ﰢ ׸ 
-	if (m_faceNum == 3)
-	{
-		m_vertexCount = (m_faceCount * 3);
-	}
-	// 簢 ׸ 
-	if (m_faceNum == 4)
-	{
-		m_vertexCount = (m_faceCount * 6);
-		m_faceCount *= 2;
-	}
-
-	polygoneCount = m_faceCount;
-
-	// Set the number of indices to be the same as the vertex count.
-	m_indexCount = m_vertexCount;
-
-	// Create the model using the vertex count that was read in.
-	m_model = new ModelType[m_vertexCount];
-	if (!m_model)
+	// Float vertices go to the shader as they are, there are no dequantize values to fold a remap into.
+	if (m_vertexFormat == VERTEX_FORMAT_FLOAT)
 	{
 		return false;
 	}
 
-	for (int i = 0; i < faceIndex; i++)
-	{
-		if (m_faceNum == 3)
-		{
-			vIndex = faces[i].vIndex1 - 1;
-			tIndex = faces[i].tIndex1 - 1;
-			nIndex = faces[i].nIndex1 - 1;
-
-			m_model[i * 3].x = vertices[vIndex].x;
-			m_model[i * 3].y = vertices[vIndex].y;
-			m_model[i * 3].z = vertices[vIndex].z;
-			m_model[i * 3].tu = texcoords[tIndex].x;
-			m_model[i * 3].tv = texcoords[tIndex].y;
-			m_model[i * 3].nx = normals[nIndex].x;
-			m_model[i * 3].ny = normals[nIndex].y;
-			m_model[i * 3].nz = normals[nIndex].z;
-
-			vIndex = faces[i].vIndex2 - 1;
-			tIndex = faces[i].tIndex2 - 1;
-			nIndex = faces[i].nIndex2 - 1;
-
-			m_model[i * 3 + 1].x = vertices[vIndex].x;
-			m_model[i * 3 + 1].y = vertices[vIndex].y;
-			m_model[i * 3 + 1].z = vertices[vIndex].z;
-			m_model[i * 3 + 1].tu = texcoords[tIndex].x;
-			m_model[i * 3 + 1].tv = texcoords[tIndex].y;
-			m_model[i * 3 + 1].nx = normals[nIndex].x;
-			m_model[i * 3 + 1].ny = normals[nIndex].y;
-			m_model[i * 3 + 1].nz = normals[nIndex].z;
-
-			vIndex = faces[i].vIndex3 - 1;
-			tIndex = faces[i].tIndex3 - 1;
-			nIndex = faces[i].nIndex3 - 1;
-
-			m_model[i * 3 + 2].x = vertices[vIndex].x;
-			m_model[i * 3 + 2].y = vertices[vIndex].y;
-			m_model[i * 3 + 2].z = vertices[vIndex].z;
-			m_model[i * 3 + 2].tu = texcoords[tIndex].x;
-			m_model[i * 3 + 2].tv = texcoords[tIndex].y;
-			m_model[i * 3 + 2].nx = normals[nIndex].x;
-			m_model[i * 3 + 2].ny = normals[nIndex].y;
-			m_model[i * 3 + 2].nz = normals[nIndex].z;
-		}
-
-		if (m_faceNum == 4)
-		{
-			vIndex = faces[i].vIndex1 - 1;
-			tIndex = faces[i].tIndex1 - 1;
-			nIndex = faces[i].nIndex1 - 1;
-
-			m_model[i * 6].x = vertices[vIndex].x;
-			m_model[i * 6].y = vertices[vIndex].y;
-			m_model[i * 6].z = vertices[vIndex].z;
-			m_model[i * 6].tu = texcoords[tIndex].x;
-			m_model[i * 6].tv = texcoords[tIndex].y;
-			m_model[i * 6].nx = normals[nIndex].x;
-			m_model[i * 6].ny = normals[nIndex].y;
-			m_model[i * 6].nz = normals[nIndex].z;
-
-			vIndex = faces[i].vIndex2 - 1;
-			tIndex = faces[i].tIndex2 - 1;
-			nIndex = faces[i].nIndex2 - 1;
-
-			m_model[i * 6 + 1].x = vertices[vIndex].x;
-			m_model[i * 6 + 1].y = vertices[vIndex].y;
-			m_model[i * 6 + 1].z = vertices[vIndex].z;
-			m_model[i * 6 + 1].tu = texcoords[tIndex].x;
-			m_model[i * 6 + 1].tv = texcoords[tIndex].y;
-			m_model[i * 6 + 1].nx = normals[nIndex].x;
-			m_model[i * 6 + 1].ny = normals[nIndex].y;
-			m_model[i * 6 + 1].nz = normals[nIndex].z;
-
-			vIndex = faces[i].vIndex3 - 1;
-			tIndex = faces[i].tIndex3 - 1;
-			nIndex = faces[i].nIndex3 - 1;
-
-			m_model[i * 6 + 2].x = vertices[vIndex].x;
-			m_model[i * 6 + 2].y = vertices[vIndex].y;
-			m_model[i * 6 + 2].z = vertices[vIndex].z;
-			m_model[i * 6 + 2].tu = texcoords[tIndex].x;
-			m_model[i * 6 + 2].tv = texcoords[tIndex].y;
-			m_model[i * 6 + 2].nx = normals[nIndex].x;
-			m_model[i * 6 + 2].ny = normals[nIndex].y;
-			m_model[i * 6 + 2].nz = normals[nIndex].z;
-
-			vIndex = faces[i].vIndex3 - 1;
-			tIndex = faces[i].tIndex3 - 1;
-			nIndex = faces[i].nIndex3 - 1;
-
-			m_model[i * 6 + 3].x = vertices[vIndex].x;
-			m_model[i * 6 + 3].y = vertices[vIndex].y;
-			m_model[i * 6 + 3].z = vertices[vIndex].z;
-			m_model[i * 6 + 3].tu = texcoords[tIndex].x;
-			m_model[i * 6 + 3].tv = texcoords[tIndex].y;
-			m_model[i * 6 + 3].nx = normals[nIndex].x;
-			m_model[i * 6 + 3].ny = normals[nIndex].y;
-			m_model[i * 6 + 3].nz = normals[nIndex].z;
-
-			vIndex = faces[i].vIndex4 - 1;
-			tIndex = faces[i].tIndex4 - 1;
-			nIndex = faces[i].nIndex4 - 1;
-
-			m_model[i * 6 + 4].x = vertices[vIndex].x;
-			m_model[i * 6 + 4].y = vertices[vIndex].y;
-			m_model[i * 6 + 4].z = vertices[vIndex].z;
-			m_model[i * 6 + 4].tu = texcoords[tIndex].x;
-			m_model[i * 6 + 4].tv = texcoords[tIndex].y;
-			m_model[i * 6 + 4].nx = normals[nIndex].x;
-			m_model[i * 6 + 4].ny = normals[nIndex].y;
-			m_model[i * 6 + 4].nz = normals[nIndex].z;
-
-			vIndex = faces[i].vIndex1 - 1;
-			tIndex = faces[i].tIndex1 - 1;
-			nIndex = faces[i].nIndex1 - 1;
-
-			m_model[i * 6 + 5].x = vertices[vIndex].x;
-			m_model[i * 6 + 5].y = vertices[vIndex].y;
-			m_model[i * 6 + 5].z = vertices[vIndex].z;
-			m_model[i * 6 + 5].tu = texcoords[tIndex].x;
-			m_model[i * 6 + 5].tv = texcoords[tIndex].y;
-			m_model[i * 6 + 5].nx = normals[nIndex].x;
-			m_model[i * 6 + 5].ny = normals[nIndex].y;
-			m_model[i * 6 + 5].nz = normals[nIndex].z;
-		}
-	}
+	// Worked out when the shared mesh was packed, never from vertices the registry may already have released.
+	return m_Mesh->HasUnitTexcoords();
+}
 
-	if (vertices)
+void ModelClass::ReleaseUploadData()
+{
+	// Release the vertices, the mesh loader keeps what culling needs.
+	if (m_Mesh)
 	{
-		delete[] vertices;
-		vertices = 0;
+		m_Mesh->ReleaseUploadData();
 	}
 
-	if (texcoords)
-	{
-		delete[] texcoords;
-		texcoords = 0;
-	}
+	return;
+}
 
-	if (normals)
+void ModelClass::ReleaseModel()
+{
+	// Give the mesh back to the registry.
+	if (m_SharedMesh)
 	{
-		delete[] normals;
-		normals = 0;
+		m_Registry->ReleaseMesh(m_SharedMesh);
+		m_SharedMesh = 0;
+		m_Mesh = 0;
 	}
 
-	if (faces)
+	// Release the mesh loader object.
+	if (m_Mesh)
 	{
-		delete[] faces;
-		faces = 0;
+		m_Mesh->Shutdown();
+		delete m_Mesh;
+		m_Mesh = 0;
 	}
 
-	return true;
-}
+	m_indices = 0;
+	m_meshlets = 0;
 
-void ModelClass::ReleaseModel()
-{
-	if (m_model)
+	if (m_meshletVisible)
 	{
-		delete[] m_model;
-		m_model = 0;
+		delete[] m_meshletVisible;
+		m_meshletVisible = 0;
 	}
 
 	return;
@@ -5,9 +5,12 @@
 
 #include <d3d11.h>
 #include <d3dx10math.h>
-#include <fstream>
+#include <string>
 
 #include "textureclass.h"
+#include "meshloaderclass.h"
+#include "frustumclass.h"
+#include "resourceregistryclass.h"
 using namespace std;
 
 class ModelClass
@@ -20,23 +23,20 @@ private:
 		D3DXVECTOR3 normal;
 	};
 
-	struct ModelType
-	{
-		float x, y, z;
-		float tu, tv; //ؽ ǥ
-		float nx, ny, nz; // 
-	};
-
-	struct vertexType
+public:
+	// Running totals of the meshlet culling pass, for the culling report.
+	struct CullStatsType
 	{
-		float x, y, z;
+		int frames;
+		unsigned long long meshlets, frustumCulled, backfaceCulled;
+		unsigned long long triangles, drawnTriangles;
 	};
 
-	struct FaceType
+	// Bytes the model holds on each side, for the memory report.
+	struct MemoryStatsType
 	{
-		int vIndex1, vIndex2, vIndex3, vIndex4; //
-		int tIndex1, tIndex2, tIndex3, tIndex4; //ؽ
-		int nIndex1, nIndex2, nIndex3, nIndex4; //
+		size_t cpuIndices, cpuMeshlets, cpuVertices;
+		size_t gpuVertices, gpuIndices, gpuVisibleIndices, gpuTexture;
 	};
 
 public:
@@ -44,39 +44,91 @@ public:
 	ModelClass(const ModelClass&);
 	~ModelClass();
 
-	bool Initialize(ID3D11Device*, char*, WCHAR*);
+	bool Initialize(ID3D11Device*, ResourceRegistryClass*, char*, WCHAR*, bool, int, int, int);
+	bool Load(ResourceRegistryClass*, char*, WCHAR*, bool, int, int, int);
+	bool CreateResources(ID3D11Device*);
+	bool InitializePlaceholder(ID3D11Device*);
 	void Shutdown();
 	void Render(ID3D11DeviceContext*);
 
 	int GetIndexCount();
+	int SelectLod(D3DXVECTOR3, float, float);
+	float GetProjectedSize();
+	bool Cull(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX, D3DXVECTOR3);
 	ID3D11ShaderResourceView* GetTexture();
+	ResourceRegistryClass::TextureType* GetSharedTexture();
 
 	D3DXMATRIX GetWorldMatrix();
+	D3DXMATRIX GetPlacementMatrix();
+	void UpdateWorldBounds();
+	const BoundingVolumeClass::BoundsType& GetWorldBounds();
 	void SetScaling(float, float, float);
 	void SetRotation(char, float);
 	void SetTranslation(float, float, float);
 
 	int GetPolygonCount();
 
+	const char* GetName();
+	int GetVertexCount();
+	int GetVertexFormat();
+	int GetVertexStride();
+	const VertexQuantizerClass::DequantizeType* GetDequantize();
+	const VertexQuantizerClass::ErrorType& GetQuantizationError();
+	int GetLodCount();
+	int GetLodPolygonCount(int);
+	float GetLodError(int);
+	int GetLodMeshletCount(int);
+	size_t GetTransientPeakBytes();
+	bool IsFromCache();
+	bool IsCacheWritten();
+	int GetResidency();
+	const float* GetPositions();
+	int GetPositionStride();
+	void GetMemoryStats(MemoryStatsType&);
+	const CullStatsType& GetCullStats();
+
 private:
-	bool InitializeBuffers(ID3D11Device*);
+	bool InitializeBuffers(ID3D11Device*, const void*, const unsigned int*);
 	void ShutdownBuffers();
 	void RenderBuffers(ID3D11DeviceContext*);
 
-	bool LoadTexture(ID3D11Device*, WCHAR*);
+	bool LoadTexture(ID3D11Device*);
 	void ReleaseTexture();
 
-	bool ReadObjFileCount(char*);
-	bool LoadModel(char*);
+	bool InitializeMesh();
+	bool HasUnitTexcoords();
+	void ReleaseUploadData();
 	void ReleaseModel();
 
 private:
-	ID3D11Buffer *m_vertexBuffer, *m_indexBuffer;
-	int m_vertexCount, m_indexCount, m_textureCount, m_normalCount, m_faceCount;
-	int m_faceNum;
+	ID3D11Buffer *m_vertexBuffer, *m_indexBuffer, *m_visibleIndexBuffer;
+	int m_vertexCount, m_indexCount;
+	int m_vertexFormat, m_vertexStride;
+	VertexQuantizerClass::DequantizeType m_dequantize;
+	VertexQuantizerClass::ErrorType m_quantizationError;
+	string m_name;
+
+	MeshCacheClass::LodType m_lods[MESH_MAX_LODS];
+	int m_lodCount, m_lod;
+	float m_projectedSize;
+	BoundingVolumeClass::BoundsType m_bounds, m_worldBounds;
+
+	const MeshletBuilderClass::MeshletType* m_meshlets;
+	unsigned char* m_meshletVisible;
+	int m_meshletCount;
+	int m_drawIndexCount;
+	bool m_drawVisible;
+	CullStatsType m_cullStats;
 
 	TextureClass* m_Texture;
-	ModelType* m_model;
+	MeshLoaderClass* m_Mesh;
+	const unsigned int* m_indices;
+
+	// The mesh, its buffers and the texture belong to the registry and are shared with every model loaded
+	// from the same files. Only the placeholder owns its own.
+	ResourceRegistryClass* m_Registry;
+	ResourceRegistryClass::MeshType* m_SharedMesh;
+	ResourceRegistryClass::TextureType* m_SharedTexture;
 
 	D3DXMATRIX m_worldMatrix;
 	D3DXMATRIX m_scaling;
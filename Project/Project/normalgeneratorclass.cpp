@@ -0,0 +1,659 @@
+#include "normalgeneratorclass.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <thread>
+
+// Work is not split into ranges smaller than this, the thread start up would cost more than it saves.
+static const int MIN_RANGE_SIZE = 4096;
+
+NormalGeneratorClass::NormalGeneratorClass()
+{
+	m_vertices = 0;
+	m_indices = 0;
+	m_outputIndices = 0;
+	m_vertexCount = 0;
+	m_indexCount = 0;
+	m_positionCount = 0;
+	m_threadCount = 1;
+	m_creaseCosine = 0.0f;
+	m_outputVertices = 0;
+	m_outputTangents = 0;
+}
+
+NormalGeneratorClass::NormalGeneratorClass(const NormalGeneratorClass& other)
+{
+}
+
+NormalGeneratorClass::~NormalGeneratorClass()
+{
+}
+
+bool NormalGeneratorClass::GenerateNormals(const ObjLoaderClass::VertexType* vertices, int vertexCount, unsigned int* indices, int indexCount, float creaseAngle,
+										   int threadCount, vector<ObjLoaderClass::VertexType>& outputVertices)
+{
+	int i;
+	bool result;
+
+	m_creaseCosine = cosf(creaseAngle * 3.14159265f / 180.0f);
+
+	// Face normals and corner angles, and the corners of every vertex.
+	result = Prepare(vertices, vertexCount, indices, indexCount, threadCount);
+	if (!result)
+	{
+		Shutdown();
+		return false;
+	}
+
+	// Smooth across every corner at the same position, which also joins texture seams.
+	result = GroupPositions();
+	if (!result)
+	{
+		Shutdown();
+		return false;
+	}
+
+	m_cornerNormals.resize(m_indexCount);
+	RunRanges(NormalRange, m_positionCount);
+
+	// A vertex whose corners ended up with different normals becomes one vertex per normal. Count them per
+	// vertex first so every thread knows where its vertices go.
+	m_outputStart.assign(m_vertexCount + 1, 0);
+	RunRanges(CountRange, m_vertexCount);
+
+	for (i = 0; i < m_vertexCount; i++)
+	{
+		m_outputStart[i + 1] += m_outputStart[i];
+	}
+
+	outputVertices.resize(m_outputStart[m_vertexCount]);
+	m_outputVertices = &outputVertices;
+	m_outputIndices = indices;
+	RunRanges(SplitRange, m_vertexCount);
+
+	Shutdown();
+
+	return true;
+}
+
+bool NormalGeneratorClass::GenerateTangents(const ObjLoaderClass::VertexType* vertices, int vertexCount, const unsigned int* indices, int indexCount,
+											int threadCount, vector<TangentType>& outputTangents)
+{
+	bool result;
+
+	// Face tangents and corner angles, and the corners of every vertex.
+	result = Prepare(vertices, vertexCount, indices, indexCount, threadCount);
+	if (!result)
+	{
+		Shutdown();
+		return false;
+	}
+
+	outputTangents.resize(m_vertexCount);
+	m_outputTangents = &outputTangents;
+	RunRanges(TangentRange, m_vertexCount);
+
+	Shutdown();
+
+	return true;
+}
+
+void NormalGeneratorClass::Shutdown()
+{
+	// Release the scratch arrays.
+	vector<VectorType>().swap(m_faceNormals);
+	vector<VectorType>().swap(m_faceTangents);
+	vector<VectorType>().swap(m_faceBitangents);
+	vector<float>().swap(m_cornerAngles);
+	vector<VectorType>().swap(m_cornerNormals);
+	vector<int>().swap(m_positionIds);
+	vector<int>().swap(m_positionStart);
+	vector<int>().swap(m_positionCorners);
+	vector<int>().swap(m_vertexStart);
+	vector<int>().swap(m_vertexCorners);
+	vector<int>().swap(m_outputStart);
+
+	m_vertices = 0;
+	m_indices = 0;
+	m_outputIndices = 0;
+	m_outputVertices = 0;
+	m_outputTangents = 0;
+
+	return;
+}
+
+bool NormalGeneratorClass::HasNormals(const ObjLoaderClass::VertexType* vertices, int vertexCount)
+{
+	int i;
+
+	// A face corner without a normal was loaded with a zero one.
+	for (i = 0; i < vertexCount; i++)
+	{
+		if (vertices[i].nx == 0.0f && vertices[i].ny == 0.0f && vertices[i].nz == 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool NormalGeneratorClass::Prepare(const ObjLoaderClass::VertexType* vertices, int vertexCount, const unsigned int* indices, int indexCount, int threadCount)
+{
+	vector<int> keys;
+	int i;
+
+	// Whole triangles that only reference vertices that exist.
+	if (indexCount % 3 != 0)
+	{
+		return false;
+	}
+
+	for (i = 0; i < indexCount; i++)
+	{
+		if (indices[i] >= (unsigned int)vertexCount)
+		{
+			return false;
+		}
+	}
+
+	// Use every core unless told otherwise.
+	if (threadCount <= 0)
+	{
+		threadCount = (int)thread::hardware_concurrency();
+		if (threadCount <= 0)
+		{
+			threadCount = 1;
+		}
+	}
+
+	m_vertices = vertices;
+	m_vertexCount = vertexCount;
+	m_indices = indices;
+	m_indexCount = indexCount;
+	m_threadCount = threadCount;
+
+	// Everything about a face the later passes need, a triangle at a time.
+	m_faceNormals.resize(m_indexCount / 3);
+	m_faceTangents.resize(m_indexCount / 3);
+	m_faceBitangents.resize(m_indexCount / 3);
+	m_cornerAngles.resize(m_indexCount);
+	RunRanges(FaceRange, m_indexCount / 3);
+
+	// The corners of each vertex, in index order.
+	keys.assign(indices, indices + indexCount);
+	GroupCorners(keys, m_vertexCount, m_vertexStart, m_vertexCorners);
+
+	return true;
+}
+
+void NormalGeneratorClass::GroupCorners(const vector<int>& keys, int keyCount, vector<int>& start, vector<int>& corners)
+{
+	vector<int> cursor;
+	int i;
+
+	// Counting sort of the corners by key. Corners with the same key stay in index order.
+	start.assign(keyCount + 1, 0);
+	for (i = 0; i < (int)keys.size(); i++)
+	{
+		start[keys[i] + 1]++;
+	}
+
+	for (i = 0; i < keyCount; i++)
+	{
+		start[i + 1] += start[i];
+	}
+
+	cursor.assign(start.begin(), start.end() - 1);
+	corners.resize(keys.size());
+	for (i = 0; i < (int)keys.size(); i++)
+	{
+		corners[cursor[keys[i]]++] = i;
+	}
+
+	return;
+}
+
+bool NormalGeneratorClass::GroupPositions()
+{
+	vector<PositionKeyType> positions;
+	vector<int> keys;
+	int i;
+
+	// Vertices that only differ in texture coordinate or normal share a position id.
+	positions.resize(m_vertexCount);
+	for (i = 0; i < m_vertexCount; i++)
+	{
+		positions[i].x = m_vertices[i].x;
+		positions[i].y = m_vertices[i].y;
+		positions[i].z = m_vertices[i].z;
+		positions[i].vertex = i;
+	}
+
+	sort(positions.begin(), positions.end(), ComparePositions);
+
+	m_positionIds.resize(m_vertexCount);
+	m_positionCount = 0;
+	for (i = 0; i < m_vertexCount; i++)
+	{
+		if (i == 0 || positions[i].x != positions[i - 1].x || positions[i].y != positions[i - 1].y || positions[i].z != positions[i - 1].z)
+		{
+			m_positionCount++;
+		}
+		m_positionIds[positions[i].vertex] = m_positionCount - 1;
+	}
+
+	// The corners at each position, in index order.
+	keys.resize(m_indexCount);
+	for (i = 0; i < m_indexCount; i++)
+	{
+		keys[i] = m_positionIds[m_indices[i]];
+	}
+
+	GroupCorners(keys, m_positionCount, m_positionStart, m_positionCorners);
+
+	return true;
+}
+
+void NormalGeneratorClass::RunRanges(void (*function)(RangeType*), int count)
+{
+	RangeType* ranges;
+	thread* threads;
+	int rangeCount, i;
+
+	// Small jobs run on the calling thread only.
+	rangeCount = count / MIN_RANGE_SIZE + 1;
+	if (rangeCount > m_threadCount)
+	{
+		rangeCount = m_threadCount;
+	}
+
+	ranges = new RangeType[rangeCount];
+	if (!ranges)
+	{
+		return;
+	}
+
+	for (i = 0; i < rangeCount; i++)
+	{
+		ranges[i].generator = this;
+		ranges[i].begin = (int)((long long)count * i / rangeCount);
+		ranges[i].end = (int)((long long)count * (i + 1) / rangeCount);
+	}
+
+	// Run every range but the first on a worker thread, and the first one here.
+	threads = 0;
+	if (rangeCount > 1)
+	{
+		threads = new thread[rangeCount - 1];
+		for (i = 1; i < rangeCount; i++)
+		{
+			threads[i - 1] = thread(function, &ranges[i]);
+		}
+	}
+
+	function(&ranges[0]);
+
+	if (threads)
+	{
+		for (i = 0; i < rangeCount - 1; i++)
+		{
+			threads[i].join();
+		}
+		delete[] threads;
+		threads = 0;
+	}
+
+	delete[] ranges;
+	ranges = 0;
+
+	return;
+}
+
+bool NormalGeneratorClass::NeedsNormal(int vertex)
+{
+	return m_vertices[vertex].nx == 0.0f && m_vertices[vertex].ny == 0.0f && m_vertices[vertex].nz == 0.0f;
+}
+
+void NormalGeneratorClass::FaceRange(RangeType* range)
+{
+	NormalGeneratorClass* generator;
+	const ObjLoaderClass::VertexType* corner[3];
+	VectorType edge1, edge2, normal, tangent, bitangent;
+	float length, du1, dv1, du2, dv2, area, ux, uy, uz, wx, wy, wz, cx, cy, cz;
+	int i, j;
+
+	generator = range->generator;
+
+	for (i = range->begin; i < range->end; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			corner[j] = &generator->m_vertices[generator->m_indices[i * 3 + j]];
+		}
+
+		edge1.x = corner[1]->x - corner[0]->x;
+		edge1.y = corner[1]->y - corner[0]->y;
+		edge1.z = corner[1]->z - corner[0]->z;
+		edge2.x = corner[2]->x - corner[0]->x;
+		edge2.y = corner[2]->y - corner[0]->y;
+		edge2.z = corner[2]->z - corner[0]->z;
+
+		// Clockwise front faces in the left handed space, so the normal is edge1 x edge2. A degenerate
+		// triangle gets a zero normal and adds nothing to its neighbours.
+		normal.x = edge1.y * edge2.z - edge1.z * edge2.y;
+		normal.y = edge1.z * edge2.x - edge1.x * edge2.z;
+		normal.z = edge1.x * edge2.y - edge1.y * edge2.x;
+		length = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+		if (length > 0.0f)
+		{
+			normal.x /= length;
+			normal.y /= length;
+			normal.z /= length;
+		}
+		generator->m_faceNormals[i] = normal;
+
+		// The angle at each corner weights the face in that corner's average.
+		for (j = 0; j < 3; j++)
+		{
+			ux = corner[(j + 1) % 3]->x - corner[j]->x;
+			uy = corner[(j + 1) % 3]->y - corner[j]->y;
+			uz = corner[(j + 1) % 3]->z - corner[j]->z;
+			wx = corner[(j + 2) % 3]->x - corner[j]->x;
+			wy = corner[(j + 2) % 3]->y - corner[j]->y;
+			wz = corner[(j + 2) % 3]->z - corner[j]->z;
+			cx = uy * wz - uz * wy;
+			cy = uz * wx - ux * wz;
+			cz = ux * wy - uy * wx;
+			generator->m_cornerAngles[i * 3 + j] = atan2f(sqrtf(cx * cx + cy * cy + cz * cz), ux * wx + uy * wy + uz * wz);
+		}
+
+		// Directions of increasing u and v across the face. Without a usable mapping both are zero.
+		du1 = corner[1]->tu - corner[0]->tu;
+		dv1 = corner[1]->tv - corner[0]->tv;
+		du2 = corner[2]->tu - corner[0]->tu;
+		dv2 = corner[2]->tv - corner[0]->tv;
+		area = du1 * dv2 - du2 * dv1;
+
+		memset(&tangent, 0, sizeof(tangent));
+		memset(&bitangent, 0, sizeof(bitangent));
+		if (fabsf(area) > 1e-20f)
+		{
+			tangent.x = (edge1.x * dv2 - edge2.x * dv1) / area;
+			tangent.y = (edge1.y * dv2 - edge2.y * dv1) / area;
+			tangent.z = (edge1.z * dv2 - edge2.z * dv1) / area;
+			bitangent.x = (edge2.x * du1 - edge1.x * du2) / area;
+			bitangent.y = (edge2.y * du1 - edge1.y * du2) / area;
+			bitangent.z = (edge2.z * du1 - edge1.z * du2) / area;
+		}
+		generator->m_faceTangents[i] = tangent;
+		generator->m_faceBitangents[i] = bitangent;
+	}
+
+	return;
+}
+
+void NormalGeneratorClass::NormalRange(RangeType* range)
+{
+	NormalGeneratorClass* generator;
+	const ObjLoaderClass::VertexType* vertex;
+	const VectorType *faceNormal, *otherNormal;
+	VectorType normal;
+	float length, weight;
+	int i, j, k, corner, other;
+	bool flat;
+
+	generator = range->generator;
+
+	for (i = range->begin; i < range->end; i++)
+	{
+		for (j = generator->m_positionStart[i]; j < generator->m_positionStart[i + 1]; j++)
+		{
+			corner = generator->m_positionCorners[j];
+
+			// A normal from the file is kept as it is.
+			if (!generator->NeedsNormal(generator->m_indices[corner]))
+			{
+				vertex = &generator->m_vertices[generator->m_indices[corner]];
+				generator->m_cornerNormals[corner].x = vertex->nx;
+				generator->m_cornerNormals[corner].y = vertex->ny;
+				generator->m_cornerNormals[corner].z = vertex->nz;
+				continue;
+			}
+
+			// Sum the faces at this position within the crease angle of this corner's face, each weighted by its
+			// angle here. A degenerate face has no direction to compare against and takes all of them.
+			faceNormal = &generator->m_faceNormals[corner / 3];
+			flat = faceNormal->x == 0.0f && faceNormal->y == 0.0f && faceNormal->z == 0.0f;
+
+			memset(&normal, 0, sizeof(normal));
+			for (k = generator->m_positionStart[i]; k < generator->m_positionStart[i + 1]; k++)
+			{
+				other = generator->m_positionCorners[k];
+				otherNormal = &generator->m_faceNormals[other / 3];
+
+				if (flat || faceNormal->x * otherNormal->x + faceNormal->y * otherNormal->y + faceNormal->z * otherNormal->z >= generator->m_creaseCosine)
+				{
+					weight = generator->m_cornerAngles[other];
+					normal.x += otherNormal->x * weight;
+					normal.y += otherNormal->y * weight;
+					normal.z += otherNormal->z * weight;
+				}
+			}
+
+			// Faces that cancel out, or only degenerate ones, leave the normal pointing up.
+			length = sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+			if (length > 0.0f)
+			{
+				normal.x /= length;
+				normal.y /= length;
+				normal.z /= length;
+			}
+			else
+			{
+				normal.y = 1.0f;
+			}
+
+			generator->m_cornerNormals[corner] = normal;
+		}
+	}
+
+	return;
+}
+
+void NormalGeneratorClass::CountRange(RangeType* range)
+{
+	NormalGeneratorClass* generator;
+	const VectorType *normal, *earlier;
+	int i, j, k, count;
+	bool seen;
+
+	generator = range->generator;
+
+	// Distinct corner normals of each vertex. A vertex no face uses is dropped.
+	for (i = range->begin; i < range->end; i++)
+	{
+		count = 0;
+		for (j = generator->m_vertexStart[i]; j < generator->m_vertexStart[i + 1]; j++)
+		{
+			normal = &generator->m_cornerNormals[generator->m_vertexCorners[j]];
+
+			seen = false;
+			for (k = generator->m_vertexStart[i]; k < j && !seen; k++)
+			{
+				earlier = &generator->m_cornerNormals[generator->m_vertexCorners[k]];
+				seen = normal->x == earlier->x && normal->y == earlier->y && normal->z == earlier->z;
+			}
+
+			count += seen ? 0 : 1;
+		}
+
+		generator->m_outputStart[i + 1] = count;
+	}
+
+	return;
+}
+
+void NormalGeneratorClass::SplitRange(RangeType* range)
+{
+	NormalGeneratorClass* generator;
+	ObjLoaderClass::VertexType* vertex;
+	const VectorType *normal, *earlier;
+	int i, j, k, next, corner;
+	bool seen;
+
+	generator = range->generator;
+
+	for (i = range->begin; i < range->end; i++)
+	{
+		// The first corner with each normal adds a vertex, later ones with the same normal reuse it.
+		next = generator->m_outputStart[i];
+		for (j = generator->m_vertexStart[i]; j < generator->m_vertexStart[i + 1]; j++)
+		{
+			corner = generator->m_vertexCorners[j];
+			normal = &generator->m_cornerNormals[corner];
+
+			seen = false;
+			for (k = generator->m_vertexStart[i]; k < j && !seen; k++)
+			{
+				earlier = &generator->m_cornerNormals[generator->m_vertexCorners[k]];
+				if (normal->x == earlier->x && normal->y == earlier->y && normal->z == earlier->z)
+				{
+					generator->m_outputIndices[corner] = generator->m_outputIndices[generator->m_vertexCorners[k]];
+					seen = true;
+				}
+			}
+
+			if (!seen)
+			{
+				vertex = &(*generator->m_outputVertices)[next];
+				*vertex = generator->m_vertices[i];
+				vertex->nx = normal->x;
+				vertex->ny = normal->y;
+				vertex->nz = normal->z;
+
+				generator->m_outputIndices[corner] = (unsigned int)next;
+				next++;
+			}
+		}
+	}
+
+	return;
+}
+
+void NormalGeneratorClass::TangentRange(RangeType* range)
+{
+	NormalGeneratorClass* generator;
+	const ObjLoaderClass::VertexType* vertex;
+	const VectorType *faceTangent, *faceBitangent;
+	VectorType normal, tangent, sum;
+	TangentType* output;
+	float length, weight, side, handedness;
+	int i, j, corner;
+
+	generator = range->generator;
+
+	for (i = range->begin; i < range->end; i++)
+	{
+		vertex = &generator->m_vertices[i];
+		normal.x = vertex->nx;
+		normal.y = vertex->ny;
+		normal.z = vertex->nz;
+
+		// Each face's tangent is moved into the plane of the vertex normal and weighted by the corner angle. The
+		// faces vote on the bitangent sign the same way.
+		memset(&sum, 0, sizeof(sum));
+		handedness = 0.0f;
+		for (j = generator->m_vertexStart[i]; j < generator->m_vertexStart[i + 1]; j++)
+		{
+			corner = generator->m_vertexCorners[j];
+			faceTangent = &generator->m_faceTangents[corner / 3];
+			faceBitangent = &generator->m_faceBitangents[corner / 3];
+
+			weight = normal.x * faceTangent->x + normal.y * faceTangent->y + normal.z * faceTangent->z;
+			tangent.x = faceTangent->x - normal.x * weight;
+			tangent.y = faceTangent->y - normal.y * weight;
+			tangent.z = faceTangent->z - normal.z * weight;
+			length = sqrtf(tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z);
+			if (length <= 0.0f)
+			{
+				continue;
+			}
+
+			weight = generator->m_cornerAngles[corner] / length;
+			sum.x += tangent.x * weight;
+			sum.y += tangent.y * weight;
+			sum.z += tangent.z * weight;
+
+			// Sign of (normal x tangent) . bitangent.
+			side = (normal.y * tangent.z - normal.z * tangent.y) * faceBitangent->x + (normal.z * tangent.x - normal.x * tangent.z) * faceBitangent->y +
+				(normal.x * tangent.y - normal.y * tangent.x) * faceBitangent->z;
+			handedness += (side < 0.0f) ? -generator->m_cornerAngles[corner] : generator->m_cornerAngles[corner];
+		}
+
+		// Orthogonalize once more, the faces may have been averaged off the plane.
+		weight = normal.x * sum.x + normal.y * sum.y + normal.z * sum.z;
+		tangent.x = sum.x - normal.x * weight;
+		tangent.y = sum.y - normal.y * weight;
+		tangent.z = sum.z - normal.z * weight;
+		length = sqrtf(tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z);
+
+		// Without a texture mapping any direction in the plane will do: normal x the axis least along it.
+		if (length <= 1e-12f)
+		{
+			if (fabsf(normal.x) < fabsf(normal.y) && fabsf(normal.x) < fabsf(normal.z))
+			{
+				tangent.x = 0.0f;
+				tangent.y = normal.z;
+				tangent.z = -normal.y;
+			}
+			else if (fabsf(normal.y) < fabsf(normal.z))
+			{
+				tangent.x = -normal.z;
+				tangent.y = 0.0f;
+				tangent.z = normal.x;
+			}
+			else
+			{
+				tangent.x = normal.y;
+				tangent.y = -normal.x;
+				tangent.z = 0.0f;
+			}
+			length = sqrtf(tangent.x * tangent.x + tangent.y * tangent.y + tangent.z * tangent.z);
+		}
+
+		if (length > 0.0f)
+		{
+			tangent.x /= length;
+			tangent.y /= length;
+			tangent.z /= length;
+		}
+
+		output = &(*generator->m_outputTangents)[i];
+		output->x = tangent.x;
+		output->y = tangent.y;
+		output->z = tangent.z;
+		output->w = (handedness < 0.0f) ? -1.0f : 1.0f;
+	}
+
+	return;
+}
+
+bool NormalGeneratorClass::ComparePositions(const PositionKeyType& first, const PositionKeyType& second)
+{
+	if (first.x != second.x)
+	{
+		return first.x < second.x;
+	}
+	if (first.y != second.y)
+	{
+		return first.y < second.y;
+	}
+	if (first.z != second.z)
+	{
+		return first.z < second.z;
+	}
+
+	return first.vertex < second.vertex;
+}
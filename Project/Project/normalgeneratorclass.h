@@ -0,0 +1,91 @@
+#pragma once
+
+#ifndef _NORMALGENERATORCLASS_H_
+#define _NORMALGENERATORCLASS_H_
+
+#include <vector>
+
+#include "objloaderclass.h"
+using namespace std;
+
+// Faces meeting at a sharper angle than this, in degrees, keep separate normals along their shared edge.
+const float NORMAL_CREASE_ANGLE = 60.0f;
+
+// Fills in the normals and tangent frames a model file left out. A generated normal is the angle weighted
+// average of the face normals around its position, over the faces within the crease angle of the corner's
+// own face, so a vertex on a crease is split into one per side. Tangents follow MikkTSpace: a tangent per
+// face from the texture coordinate gradients, projected into the plane of the vertex normal and angle
+// weighted, with the bitangent sign in w (bitangent = w * normal x tangent).
+// The work is spread over threads by triangle and by vertex. Every sum runs over the corners in index
+// order, so the result is the same bit for bit whatever the thread count.
+class NormalGeneratorClass
+{
+public:
+	struct TangentType
+	{
+		float x, y, z, w;
+	};
+
+private:
+	struct VectorType
+	{
+		float x, y, z;
+	};
+
+	struct PositionKeyType
+	{
+		float x, y, z;
+		int vertex;
+	};
+
+	struct RangeType
+	{
+		NormalGeneratorClass* generator;
+		int begin, end;
+	};
+
+public:
+	NormalGeneratorClass();
+	NormalGeneratorClass(const NormalGeneratorClass&);
+	~NormalGeneratorClass();
+
+	bool GenerateNormals(const ObjLoaderClass::VertexType*, int, unsigned int*, int, float, int, vector<ObjLoaderClass::VertexType>&);
+	bool GenerateTangents(const ObjLoaderClass::VertexType*, int, const unsigned int*, int, int, vector<TangentType>&);
+	void Shutdown();
+
+	static bool HasNormals(const ObjLoaderClass::VertexType*, int);
+
+private:
+	bool Prepare(const ObjLoaderClass::VertexType*, int, const unsigned int*, int, int);
+	void GroupCorners(const vector<int>&, int, vector<int>&, vector<int>&);
+	bool GroupPositions();
+	void RunRanges(void (*)(RangeType*), int);
+	bool NeedsNormal(int);
+
+	static void FaceRange(RangeType*);
+	static void NormalRange(RangeType*);
+	static void CountRange(RangeType*);
+	static void SplitRange(RangeType*);
+	static void TangentRange(RangeType*);
+	static bool ComparePositions(const PositionKeyType&, const PositionKeyType&);
+
+private:
+	const ObjLoaderClass::VertexType* m_vertices;
+	const unsigned int* m_indices;
+	unsigned int* m_outputIndices;
+	int m_vertexCount, m_indexCount, m_positionCount, m_threadCount;
+	float m_creaseCosine;
+
+	vector<VectorType> m_faceNormals, m_faceTangents, m_faceBitangents;
+	vector<float> m_cornerAngles;
+	vector<VectorType> m_cornerNormals;
+
+	vector<int> m_positionIds;
+	vector<int> m_positionStart, m_positionCorners;
+	vector<int> m_vertexStart, m_vertexCorners;
+	vector<int> m_outputStart;
+
+	vector<ObjLoaderClass::VertexType>* m_outputVertices;
+	vector<TangentType>* m_outputTangents;
+};
+#endif
@@ -0,0 +1,769 @@
+#include "objloaderclass.h"
+
+#include <string.h>
+#include <thread>
+
+// Files are not split into chunks smaller than this, the thread start up would cost more than it saves.
+static const size_t MIN_CHUNK_SIZE = 256 * 1024;
+
+// Exact powers of ten representable in a double.
+static const double s_powersOfTen[23] =
+{
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static inline bool IsDigit(char c)
+{
+	return (unsigned)(c - '0') < 10u;
+}
+
+static inline const char* SkipSpaces(const char* p, const char* end)
+{
+	while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+	{
+		p++;
+	}
+
+	return p;
+}
+
+// Locale independent float parser. Returns the position after the number, or the input position when
+// there was no number to read.
+static const char* ParseFloat(const char* p, const char* end, float& value)
+{
+	const char* start;
+	unsigned long long mantissa;
+	int exponent, digits, exponentValue;
+	bool negative, negativeExponent;
+	double result;
+
+	mantissa = 0;
+	exponent = 0;
+	digits = 0;
+	negative = false;
+
+	p = SkipSpaces(p, end);
+	if (p < end && (*p == '-' || *p == '+'))
+	{
+		negative = (*p == '-');
+		p++;
+	}
+
+	// Accumulate up to 19 significant digits in an integer, the rest only moves the exponent.
+	start = p;
+	while (p < end && IsDigit(*p))
+	{
+		if (digits < 19)
+		{
+			mantissa = mantissa * 10 + (*p - '0');
+			if (mantissa != 0)
+			{
+				digits++;
+			}
+		}
+		else
+		{
+			exponent++;
+		}
+		p++;
+	}
+
+	if (p < end && *p == '.')
+	{
+		p++;
+		while (p < end && IsDigit(*p))
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				if (mantissa != 0)
+				{
+					digits++;
+				}
+				exponent--;
+			}
+			p++;
+		}
+	}
+
+	// No digits at all, so this was not a number.
+	if (p == start || (p == start + 1 && *start == '.'))
+	{
+		value = 0.0f;
+		return start;
+	}
+
+	if (p < end && (*p == 'e' || *p == 'E'))
+	{
+		p++;
+		negativeExponent = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			negativeExponent = (*p == '-');
+			p++;
+		}
+
+		exponentValue = 0;
+		while (p < end && IsDigit(*p))
+		{
+			if (exponentValue < 10000)
+			{
+				exponentValue = exponentValue * 10 + (*p - '0');
+			}
+			p++;
+		}
+		exponent += negativeExponent ? -exponentValue : exponentValue;
+	}
+
+	// Scale the mantissa. For the short decimals obj exporters write this is a single exact operation.
+	result = (double)mantissa;
+	if (exponent < 0)
+	{
+		while (exponent < -22)
+		{
+			result /= 1e22;
+			exponent += 22;
+		}
+		result /= s_powersOfTen[-exponent];
+	}
+	else
+	{
+		while (exponent > 22)
+		{
+			result *= 1e22;
+			exponent -= 22;
+		}
+		result *= s_powersOfTen[exponent];
+	}
+
+	value = (float)(negative ? -result : result);
+
+	return p;
+}
+
+static const char* ParseInt(const char* p, const char* end, int& value)
+{
+	bool negative;
+
+	negative = false;
+	value = 0;
+
+	if (p < end && *p == '-')
+	{
+		negative = true;
+		p++;
+	}
+
+	while (p < end && IsDigit(*p))
+	{
+		value = value * 10 + (*p - '0');
+		p++;
+	}
+
+	if (negative)
+	{
+		value = -value;
+	}
+
+	return p;
+}
+
+ObjLoaderClass::ObjLoaderClass()
+{
+}
+
+ObjLoaderClass::ObjLoaderClass(const ObjLoaderClass& other)
+{
+}
+
+ObjLoaderClass::~ObjLoaderClass()
+{
+}
+
+bool ObjLoaderClass::Initialize(const char* filename, int threadCount)
+{
+	MappedFileClass* file;
+	bool result;
+
+	// Use every core unless told otherwise.
+	if (threadCount <= 0)
+	{
+		threadCount = (int)thread::hardware_concurrency();
+		if (threadCount <= 0)
+		{
+			threadCount = 1;
+		}
+	}
+
+	// Map the whole model file into memory.
+	file = new MappedFileClass;
+	if (!file)
+	{
+		return false;
+	}
+
+	result = file->Initialize(filename);
+	if (result)
+	{
+		// Read the vertex, texture coordinate, normal and face records in a single pass.
+		result = ParseBuffer(file->GetData(), file->GetSize(), threadCount);
+	}
+
+	// The mapping is no longer needed once the records have been parsed.
+	file->Shutdown();
+	delete file;
+	file = 0;
+
+	if (!result)
+	{
+		return false;
+	}
+
+	// Share every corner that repeats the same position, texture coordinate and normal.
+	result = BuildIndices();
+	if (!result)
+	{
+		return false;
+	}
+
+	// Expand the unique corners into the final vertex array.
+	result = BuildVertices(threadCount);
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+void ObjLoaderClass::Shutdown()
+{
+	// Release the parsed data.
+	vector<PositionType>().swap(m_positions);
+	vector<TexcoordType>().swap(m_texcoords);
+	vector<PositionType>().swap(m_normals);
+	vector<CornerType>().swap(m_corners);
+	vector<CornerType>().swap(m_uniqueCorners);
+	vector<VertexType>().swap(m_vertices);
+	vector<unsigned int>().swap(m_indices);
+
+	return;
+}
+
+int ObjLoaderClass::GetVertexCount()
+{
+	return (int)m_vertices.size();
+}
+
+ObjLoaderClass::VertexType* ObjLoaderClass::GetVertices()
+{
+	return m_vertices.empty() ? 0 : &m_vertices[0];
+}
+
+int ObjLoaderClass::GetIndexCount()
+{
+	return (int)m_indices.size();
+}
+
+unsigned int* ObjLoaderClass::GetIndices()
+{
+	return m_indices.empty() ? 0 : &m_indices[0];
+}
+
+int ObjLoaderClass::GetPolygonCount()
+{
+	return (int)(m_indices.size() / 3);
+}
+
+bool ObjLoaderClass::ParseBuffer(const char* data, size_t size, int threadCount)
+{
+	ChunkType* chunks;
+	thread* threads;
+	const char *p, *end, *split;
+	int chunkCount, i;
+	bool result;
+
+	if (!data)
+	{
+		return size == 0;
+	}
+
+	// Small files are parsed on the calling thread only.
+	chunkCount = (int)(size / MIN_CHUNK_SIZE) + 1;
+	if (chunkCount > threadCount)
+	{
+		chunkCount = threadCount;
+	}
+
+	chunks = new ChunkType[chunkCount];
+	if (!chunks)
+	{
+		return false;
+	}
+
+	// Cut the buffer into roughly equal chunks, moving every cut forward to the next line start.
+	p = data;
+	end = data + size;
+	for (i = 0; i < chunkCount; i++)
+	{
+		chunks[i].begin = p;
+		if (i == chunkCount - 1)
+		{
+			split = end;
+		}
+		else
+		{
+			split = data + (size / chunkCount) * (i + 1);
+			if (split < p)
+			{
+				split = p;
+			}
+			split = (const char*)memchr(split, '\n', end - split);
+			split = split ? split + 1 : end;
+		}
+		chunks[i].end = split;
+		p = split;
+	}
+
+	// Parse every chunk but the first on a worker thread, and the first one here.
+	threads = 0;
+	if (chunkCount > 1)
+	{
+		threads = new thread[chunkCount - 1];
+		for (i = 1; i < chunkCount; i++)
+		{
+			threads[i - 1] = thread(ParseChunk, &chunks[i]);
+		}
+	}
+
+	ParseChunk(&chunks[0]);
+
+	if (threads)
+	{
+		for (i = 0; i < chunkCount - 1; i++)
+		{
+			threads[i].join();
+		}
+		delete[] threads;
+		threads = 0;
+	}
+
+	// Stitch the per chunk arrays together.
+	result = MergeChunks(chunks, chunkCount);
+
+	delete[] chunks;
+	chunks = 0;
+
+	return result;
+}
+
+bool ObjLoaderClass::MergeChunks(ChunkType* chunks, int chunkCount)
+{
+	size_t positionCount, texcoordCount, normalCount, cornerCount, j;
+	int i, slot;
+	CornerType* corner;
+
+	// Prefix sums of the record counts give each chunk its first global index.
+	positionCount = 0;
+	texcoordCount = 0;
+	normalCount = 0;
+	cornerCount = 0;
+	for (i = 0; i < chunkCount; i++)
+	{
+		if (!chunks[i].result)
+		{
+			return false;
+		}
+
+		chunks[i].positionBase = positionCount;
+		chunks[i].texcoordBase = texcoordCount;
+		chunks[i].normalBase = normalCount;
+		chunks[i].cornerBase = cornerCount;
+
+		positionCount += chunks[i].positions.size();
+		texcoordCount += chunks[i].texcoords.size();
+		normalCount += chunks[i].normals.size();
+		cornerCount += chunks[i].corners.size();
+	}
+
+	m_positions.resize(positionCount);
+	m_texcoords.resize(texcoordCount);
+	m_normals.resize(normalCount);
+	m_corners.resize(cornerCount);
+
+	for (i = 0; i < chunkCount; i++)
+	{
+		// Move relative indices from chunk local to global numbering.
+		for (j = 0; j < chunks[i].relativeIndices.size(); j++)
+		{
+			slot = chunks[i].relativeIndices[j];
+			corner = &chunks[i].corners[slot / 3];
+			switch (slot % 3)
+			{
+			case 0:
+				corner->vIndex += (int)chunks[i].positionBase;
+				break;
+			case 1:
+				corner->tIndex += (int)chunks[i].texcoordBase;
+				break;
+			case 2:
+				corner->nIndex += (int)chunks[i].normalBase;
+				break;
+			}
+		}
+
+		if (!chunks[i].positions.empty())
+		{
+			memcpy(&m_positions[chunks[i].positionBase], &chunks[i].positions[0], chunks[i].positions.size() * sizeof(PositionType));
+		}
+		if (!chunks[i].texcoords.empty())
+		{
+			memcpy(&m_texcoords[chunks[i].texcoordBase], &chunks[i].texcoords[0], chunks[i].texcoords.size() * sizeof(TexcoordType));
+		}
+		if (!chunks[i].normals.empty())
+		{
+			memcpy(&m_normals[chunks[i].normalBase], &chunks[i].normals[0], chunks[i].normals.size() * sizeof(PositionType));
+		}
+		if (!chunks[i].corners.empty())
+		{
+			memcpy(&m_corners[chunks[i].cornerBase], &chunks[i].corners[0], chunks[i].corners.size() * sizeof(CornerType));
+		}
+	}
+
+	return true;
+}
+
+bool ObjLoaderClass::BuildIndices()
+{
+	vector<int> table;
+	size_t tableSize, mask, slot, i;
+	unsigned int hash;
+	const CornerType* corner;
+	const CornerType* unique;
+	int vertex;
+
+	// Open addressing table of unique corner numbers, kept under half full.
+	tableSize = 16;
+	while (tableSize < m_corners.size() * 2)
+	{
+		tableSize *= 2;
+	}
+	mask = tableSize - 1;
+	table.assign(tableSize, -1);
+
+	m_uniqueCorners.clear();
+	m_uniqueCorners.reserve(m_corners.size() / 2);
+	m_indices.resize(m_corners.size());
+
+	for (i = 0; i < m_corners.size(); i++)
+	{
+		corner = &m_corners[i];
+
+		hash = (unsigned int)corner->vIndex * 73856093u ^ (unsigned int)corner->tIndex * 19349663u ^ (unsigned int)corner->nIndex * 83492791u;
+		slot = (hash ^ (hash >> 15)) & mask;
+
+		// Walk the probe sequence until the corner or an empty slot is found.
+		while (true)
+		{
+			vertex = table[slot];
+			if (vertex < 0)
+			{
+				// First time this corner is seen, so it becomes a new vertex.
+				vertex = (int)m_uniqueCorners.size();
+				table[slot] = vertex;
+				m_uniqueCorners.push_back(*corner);
+				break;
+			}
+
+			unique = &m_uniqueCorners[vertex];
+			if (unique->vIndex == corner->vIndex && unique->tIndex == corner->tIndex && unique->nIndex == corner->nIndex)
+			{
+				break;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+
+		m_indices[i] = (unsigned int)vertex;
+	}
+
+	return true;
+}
+
+bool ObjLoaderClass::BuildVertices(int threadCount)
+{
+	BuildRangeType* ranges;
+	thread* threads;
+	size_t cornerCount;
+	int rangeCount, i;
+	bool result;
+
+	cornerCount = m_uniqueCorners.size();
+	m_vertices.resize(cornerCount);
+
+	// Split the corners evenly, but keep small meshes on the calling thread.
+	rangeCount = (int)(cornerCount / 65536) + 1;
+	if (rangeCount > threadCount)
+	{
+		rangeCount = threadCount;
+	}
+
+	ranges = new BuildRangeType[rangeCount];
+	if (!ranges)
+	{
+		return false;
+	}
+
+	for (i = 0; i < rangeCount; i++)
+	{
+		ranges[i].loader = this;
+		ranges[i].begin = cornerCount * i / rangeCount;
+		ranges[i].end = cornerCount * (i + 1) / rangeCount;
+	}
+
+	threads = 0;
+	if (rangeCount > 1)
+	{
+		threads = new thread[rangeCount - 1];
+		for (i = 1; i < rangeCount; i++)
+		{
+			threads[i - 1] = thread(BuildRange, &ranges[i]);
+		}
+	}
+
+	BuildRange(&ranges[0]);
+
+	result = ranges[0].result;
+	if (threads)
+	{
+		for (i = 0; i < rangeCount - 1; i++)
+		{
+			threads[i].join();
+			result = result && ranges[i + 1].result;
+		}
+		delete[] threads;
+		threads = 0;
+	}
+
+	delete[] ranges;
+	ranges = 0;
+
+	return result;
+}
+
+void ObjLoaderClass::ParseChunk(ChunkType* chunk)
+{
+	const char *p, *end, *lineEnd;
+	PositionType position;
+	TexcoordType texcoord;
+	size_t size;
+
+	// Reserve using a rough bytes-per-record guess so the arrays rarely have to grow.
+	size = chunk->end - chunk->begin;
+	chunk->positions.reserve(size / 96);
+	chunk->texcoords.reserve(size / 96);
+	chunk->normals.reserve(size / 96);
+	chunk->corners.reserve(size / 32);
+	chunk->result = true;
+
+	p = chunk->begin;
+	end = chunk->end;
+	while (p < end)
+	{
+		// Find the end of this line.
+		lineEnd = (const char*)memchr(p, '\n', end - p);
+		if (!lineEnd)
+		{
+			lineEnd = end;
+		}
+
+		p = SkipSpaces(p, lineEnd);
+		if (lineEnd - p >= 2)
+		{
+			if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				p = ParseFloat(p + 2, lineEnd, position.x);
+				p = ParseFloat(p, lineEnd, position.y);
+				p = ParseFloat(p, lineEnd, position.z);
+
+				// Convert from the right handed obj space to the left handed space used by Direct3D.
+				position.z = position.z * -1.0f;
+				chunk->positions.push_back(position);
+			}
+			else if (p[0] == 'v' && p[1] == 't')
+			{
+				p = ParseFloat(p + 2, lineEnd, texcoord.u);
+				p = ParseFloat(p, lineEnd, texcoord.v);
+
+				// Flip the v coordinate for Direct3D.
+				texcoord.v = 1.0f - texcoord.v;
+				chunk->texcoords.push_back(texcoord);
+			}
+			else if (p[0] == 'v' && p[1] == 'n')
+			{
+				p = ParseFloat(p + 2, lineEnd, position.x);
+				p = ParseFloat(p, lineEnd, position.y);
+				p = ParseFloat(p, lineEnd, position.z);
+
+				// Convert from the right handed obj space to the left handed space used by Direct3D.
+				position.z = position.z * -1.0f;
+				chunk->normals.push_back(position);
+			}
+			else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				if (!ParseFace(chunk, p + 2, lineEnd))
+				{
+					chunk->result = false;
+					return;
+				}
+			}
+		}
+
+		p = lineEnd + 1;
+	}
+
+	return;
+}
+
+bool ObjLoaderClass::ParseFace(ChunkType* chunk, const char* p, const char* end)
+{
+	CornerType corner;
+	int i, count, slot;
+
+	chunk->polygon.clear();
+
+	// Read every v, v/t, v//n or v/t/n corner on the line.
+	while (true)
+	{
+		p = SkipSpaces(p, end);
+		if (p >= end || !(IsDigit(*p) || *p == '-'))
+		{
+			break;
+		}
+
+		corner.tIndex = 0;
+		corner.nIndex = 0;
+
+		p = ParseInt(p, end, corner.vIndex);
+		if (p < end && *p == '/')
+		{
+			p++;
+			if (p < end && *p != '/')
+			{
+				p = ParseInt(p, end, corner.tIndex);
+			}
+			if (p < end && *p == '/')
+			{
+				p = ParseInt(p + 1, end, corner.nIndex);
+			}
+		}
+
+		chunk->polygon.push_back(corner);
+	}
+
+	count = (int)chunk->polygon.size();
+	if (count < 3)
+	{
+		return false;
+	}
+
+	// Triangulate as a fan over the reversed corner order, which also flips the winding for the left handed space.
+	for (i = 1; i < count - 1; i++)
+	{
+		chunk->corners.push_back(chunk->polygon[count - 1]);
+		chunk->corners.push_back(chunk->polygon[count - 1 - i]);
+		chunk->corners.push_back(chunk->polygon[count - 2 - i]);
+	}
+
+	// Resolve relative indices against what this chunk has read so far, MergeChunks adds the chunk base later.
+	for (i = (int)chunk->corners.size() - (count - 2) * 3; i < (int)chunk->corners.size(); i++)
+	{
+		slot = i * 3;
+		if (chunk->corners[i].vIndex < 0)
+		{
+			chunk->corners[i].vIndex += (int)chunk->positions.size() + 1;
+			chunk->relativeIndices.push_back(slot);
+		}
+		if (chunk->corners[i].tIndex < 0)
+		{
+			chunk->corners[i].tIndex += (int)chunk->texcoords.size() + 1;
+			chunk->relativeIndices.push_back(slot + 1);
+		}
+		if (chunk->corners[i].nIndex < 0)
+		{
+			chunk->corners[i].nIndex += (int)chunk->normals.size() + 1;
+			chunk->relativeIndices.push_back(slot + 2);
+		}
+	}
+
+	return true;
+}
+
+void ObjLoaderClass::BuildRange(BuildRangeType* range)
+{
+	ObjLoaderClass* loader;
+	int positionCount, texcoordCount, normalCount;
+	size_t i;
+	const CornerType* corner;
+	VertexType* vertex;
+
+	loader = range->loader;
+	positionCount = (int)loader->m_positions.size();
+	texcoordCount = (int)loader->m_texcoords.size();
+	normalCount = (int)loader->m_normals.size();
+	range->result = false;
+
+	for (i = range->begin; i < range->end; i++)
+	{
+		corner = &loader->m_uniqueCorners[i];
+		vertex = &loader->m_vertices[i];
+
+		// Every face must reference a vertex that exists.
+		if (corner->vIndex < 1 || corner->vIndex > positionCount)
+		{
+			return;
+		}
+
+		vertex->x = loader->m_positions[corner->vIndex - 1].x;
+		vertex->y = loader->m_positions[corner->vIndex - 1].y;
+		vertex->z = loader->m_positions[corner->vIndex - 1].z;
+
+		// Texture coordinates and normals are optional.
+		if (corner->tIndex >= 1 && corner->tIndex <= texcoordCount)
+		{
+			vertex->tu = loader->m_texcoords[corner->tIndex - 1].u;
+			vertex->tv = loader->m_texcoords[corner->tIndex - 1].v;
+		}
+		else if (corner->tIndex == 0)
+		{
+			vertex->tu = 0.0f;
+			vertex->tv = 0.0f;
+		}
+		else
+		{
+			return;
+		}
+
+		if (corner->nIndex >= 1 && corner->nIndex <= normalCount)
+		{
+			vertex->nx = loader->m_normals[corner->nIndex - 1].x;
+			vertex->ny = loader->m_normals[corner->nIndex - 1].y;
+			vertex->nz = loader->m_normals[corner->nIndex - 1].z;
+		}
+		else if (corner->nIndex == 0)
+		{
+			vertex->nx = 0.0f;
+			vertex->ny = 0.0f;
+			vertex->nz = 0.0f;
+		}
+		else
+		{
+			return;
+		}
+	}
+
+	range->result = true;
+
+	return;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#ifndef _OBJLOADERCLASS_H_
+#define _OBJLOADERCLASS_H_
+
+#include <stddef.h>
+#include <vector>
+
+#include "mappedfileclass.h"
+using namespace std;
+
+class ObjLoaderClass
+{
+public:
+	struct VertexType
+	{
+		float x, y, z;
+		float tu, tv;
+		float nx, ny, nz;
+	};
+
+private:
+	struct PositionType
+	{
+		float x, y, z;
+	};
+
+	struct TexcoordType
+	{
+		float u, v;
+	};
+
+	// One triangle corner, as 1-based obj indices. Zero means the attribute was not given.
+	struct CornerType
+	{
+		int vIndex, tIndex, nIndex;
+	};
+
+	// A run of whole lines parsed by one thread. Relative (negative) indices are first resolved against the
+	// chunk's own counts and listed in relativeIndices so they can be rebased once every chunk is done.
+	struct ChunkType
+	{
+		const char *begin, *end;
+		vector<PositionType> positions;
+		vector<TexcoordType> texcoords;
+		vector<PositionType> normals;
+		vector<CornerType> corners;
+		vector<CornerType> polygon;
+		vector<int> relativeIndices;
+		size_t positionBase, texcoordBase, normalBase, cornerBase;
+		bool result;
+	};
+
+	// A range of unique corners expanded into vertices by one thread.
+	struct BuildRangeType
+	{
+		ObjLoaderClass* loader;
+		size_t begin, end;
+		bool result;
+	};
+
+public:
+	ObjLoaderClass();
+	ObjLoaderClass(const ObjLoaderClass&);
+	~ObjLoaderClass();
+
+	bool Initialize(const char*, int);
+	void Shutdown();
+
+	int GetVertexCount();
+	VertexType* GetVertices();
+	int GetIndexCount();
+	unsigned int* GetIndices();
+	int GetPolygonCount();
+
+private:
+	bool ParseBuffer(const char*, size_t, int);
+	bool MergeChunks(ChunkType*, int);
+	bool BuildIndices();
+	bool BuildVertices(int);
+
+	static void ParseChunk(ChunkType*);
+	static bool ParseFace(ChunkType*, const char*, const char*);
+	static void BuildRange(BuildRangeType*);
+
+private:
+	vector<PositionType> m_positions;
+	vector<TexcoordType> m_texcoords;
+	vector<PositionType> m_normals;
+	vector<CornerType> m_corners;
+	vector<CornerType> m_uniqueCorners;
+	vector<VertexType> m_vertices;
+	vector<unsigned int> m_indices;
+};
+#endif
@@ -0,0 +1,1156 @@
+#include "resourceregistryclass.h"
+
+#include <string.h>
+#include <chrono>
+
+#include "hashclass.h"
+
+ResourceRegistryClass::ResourceRegistryClass()
+{
+	m_TextureCache = 0;
+	m_TextureStreamer = 0;
+	m_TextureAtlas = 0;
+	m_quadIndexBuffer = 0;
+	m_device = 0;
+	m_meshHits = 0;
+	m_meshMisses = 0;
+	m_textureHits = 0;
+	m_textureMisses = 0;
+	m_atlasHits = 0;
+}
+
+ResourceRegistryClass::ResourceRegistryClass(const ResourceRegistryClass& other)
+{
+}
+
+ResourceRegistryClass::~ResourceRegistryClass()
+{
+}
+
+bool ResourceRegistryClass::Initialize(size_t textureBudget, bool streamTextures)
+{
+	bool result;
+
+	m_meshHits = 0;
+	m_meshMisses = 0;
+	m_textureHits = 0;
+	m_textureMisses = 0;
+	m_atlasHits = 0;
+
+	// Create the texture cache object.
+	m_TextureCache = new TextureCacheClass;
+	if (!m_TextureCache)
+	{
+		return false;
+	}
+
+	// Initialize the texture cache object, which changes a texture's levels through the registry.
+	result = m_TextureCache->Initialize(textureBudget, [this](int id, int firstMip) { return SetTextureFirstMip(id, firstMip); });
+	if (!result)
+	{
+		return false;
+	}
+
+	if (!streamTextures)
+	{
+		return true;
+	}
+
+	// Create the texture streamer object.
+	m_TextureStreamer = new TextureStreamerClass;
+	if (!m_TextureStreamer)
+	{
+		return false;
+	}
+
+	// Initialize the texture streamer object, which starts its I/O thread.
+	result = m_TextureStreamer->Initialize();
+	if (!result)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+bool ResourceRegistryClass::LoadAtlas(const char* tableFilename, const vector<string>& sources, unsigned int format)
+{
+	string directory, atlasFilename;
+	size_t slash, dot;
+	int threadCount;
+	bool result;
+
+	// Create the texture atlas object.
+	m_TextureAtlas = new TextureAtlasClass;
+	if (!m_TextureAtlas)
+	{
+		return false;
+	}
+
+	slash = string(tableFilename).find_last_of("/\\");
+	directory = (slash == string::npos) ? "" : string(tableFilename, slash + 1);
+
+	// Read the table, or cook the atlas next to where it goes, named after it.
+	result = m_TextureAtlas->Initialize(tableFilename);
+	if (!result)
+	{
+		atlasFilename = tableFilename;
+		dot = atlasFilename.find_last_of('.');
+		atlasFilename = ((dot == string::npos || (slash != string::npos && dot < slash)) ? atlasFilename : atlasFilename.substr(0, dot)) + ".dds";
+
+		threadCount = (int)thread::hardware_concurrency();
+		result = m_TextureAtlas->Cook(sources, atlasFilename.c_str(), tableFilename, format, (threadCount > 0) ? threadCount : 1);
+	}
+
+	// Without an atlas every texture is drawn on its own. A read only data folder is not an error.
+	if (!result)
+	{
+		m_TextureAtlas->Shutdown();
+		delete m_TextureAtlas;
+		m_TextureAtlas = 0;
+		return true;
+	}
+
+	directory += m_TextureAtlas->GetAtlasName();
+	m_atlasFilename.assign(directory.begin(), directory.end());
+
+	return true;
+}
+
+void ResourceRegistryClass::Shutdown()
+{
+	unsigned int i;
+
+	// Release whatever is still held, every handle to it is gone with the registry.
+	for (i = 0; i < m_meshes.size(); i++)
+	{
+		DestroyMesh(m_meshes[i]);
+	}
+	m_meshes.clear();
+	m_meshNames.clear();
+
+	for (i = 0; i < m_textures.size(); i++)
+	{
+		DestroyTexture(m_textures[i]);
+	}
+	m_textures.clear();
+	m_textureNames.clear();
+
+	// Release the quad index buffer.
+	if (m_quadIndexBuffer)
+	{
+		m_quadIndexBuffer->Release();
+		m_quadIndexBuffer = 0;
+	}
+
+	// Release the texture atlas object.
+	if (m_TextureAtlas)
+	{
+		m_TextureAtlas->Shutdown();
+		delete m_TextureAtlas;
+		m_TextureAtlas = 0;
+	}
+
+	// Release the texture streamer object, once nothing is left for it to read.
+	if (m_TextureStreamer)
+	{
+		m_TextureStreamer->Shutdown();
+		delete m_TextureStreamer;
+		m_TextureStreamer = 0;
+	}
+
+	// Release the texture cache object.
+	if (m_TextureCache)
+	{
+		m_TextureCache->Shutdown();
+		delete m_TextureCache;
+		m_TextureCache = 0;
+	}
+
+	return;
+}
+
+ResourceRegistryClass::MeshType* ResourceRegistryClass::AcquireMesh(const char* filename, bool optimize, int vertexFormat, int lodCount, int residency)
+{
+	MappedFileClass* source;
+	MeshType* mesh;
+	MeshNameType name;
+	vector<string> candidates, matches;
+	unsigned long long contentHash, contentSize;
+	unsigned int i, j;
+	bool result, named, same;
+
+	// The load settings are part of the name, the same file packed another way is another mesh.
+	name.key = GetMeshKey(filename, optimize, vertexFormat, lodCount, residency);
+
+	// Already asked for under this name.
+	{
+		unique_lock<mutex> lock(m_mutex);
+
+		for (i = 0; i < m_meshNames.size(); i++)
+		{
+			if (m_meshNames[i].key == name.key)
+			{
+				mesh = m_meshNames[i].mesh;
+				mesh->refCount++;
+				mesh->hits++;
+				m_meshHits++;
+
+				return WaitForMesh(lock, mesh);
+			}
+		}
+	}
+
+	// Hash the source without holding the lock, it is as large as the model.
+	source = new MappedFileClass;
+	if (!source)
+	{
+		return 0;
+	}
+
+	result = source->Initialize(filename);
+	if (!result)
+	{
+		source->Shutdown();
+		delete source;
+		return 0;
+	}
+
+	contentHash = HashClass::HashData(source->GetData(), source->GetSize());
+	contentSize = source->GetSize();
+
+	// Another file with the same hash is only shared once its contents turn out to be the same, compared
+	// without the lock as well.
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		for (i = 0; i < m_meshes.size(); i++)
+		{
+			if (m_meshes[i]->contentHash == contentHash && m_meshes[i]->contentSize == contentSize && m_meshes[i]->filename != filename)
+			{
+				candidates.push_back(m_meshes[i]->filename);
+			}
+		}
+	}
+
+	for (i = 0; i < candidates.size(); i++)
+	{
+		if (HasSameContents(source, candidates[i].c_str()))
+		{
+			matches.push_back(candidates[i]);
+		}
+	}
+
+	source->Shutdown();
+	delete source;
+	source = 0;
+
+	{
+		unique_lock<mutex> lock(m_mutex);
+
+		// The same contents under another name, or this name added by a thread that got here first.
+		for (i = 0; i < m_meshes.size(); i++)
+		{
+			mesh = m_meshes[i];
+			same = (mesh->filename == filename);
+			for (j = 0; j < matches.size(); j++)
+			{
+				same = same || (mesh->filename == matches[j]);
+			}
+
+			if (same && mesh->contentHash == contentHash && mesh->contentSize == contentSize && mesh->optimize == optimize &&
+				mesh->vertexFormat == vertexFormat && mesh->lodCount == lodCount && mesh->residency == residency)
+			{
+				named = false;
+				for (j = 0; j < m_meshNames.size(); j++)
+				{
+					named = named || (m_meshNames[j].key == name.key);
+				}
+
+				if (!named)
+				{
+					name.mesh = mesh;
+					m_meshNames.push_back(name);
+				}
+
+				mesh->refCount++;
+				mesh->hits++;
+				m_meshHits++;
+
+				return WaitForMesh(lock, mesh);
+			}
+		}
+
+		// A new mesh, this thread reads it.
+		mesh = new MeshType;
+		if (!mesh)
+		{
+			return 0;
+		}
+
+		mesh->loader = new MeshLoaderClass;
+		if (!mesh->loader)
+		{
+			delete mesh;
+			return 0;
+		}
+
+		mesh->vertexBuffer = 0;
+		mesh->indexBuffer = 0;
+		mesh->filename = filename;
+		mesh->contentHash = contentHash;
+		mesh->contentSize = contentSize;
+		mesh->optimize = optimize;
+		mesh->vertexFormat = vertexFormat;
+		mesh->lodCount = lodCount;
+		mesh->residency = residency;
+		mesh->refCount = 1;
+		mesh->hits = 0;
+		mesh->loaded = false;
+		mesh->failed = false;
+
+		m_meshes.push_back(mesh);
+		name.mesh = mesh;
+		m_meshNames.push_back(name);
+		m_meshMisses++;
+	}
+
+	// Read the mesh outside the lock, anyone else asking for it in the meantime waits for it.
+	result = mesh->loader->Initialize(filename, optimize, vertexFormat, lodCount, residency);
+
+	{
+		lock_guard<mutex> lock(m_mutex);
+		mesh->loaded = true;
+		mesh->failed = !result;
+	}
+	m_meshLoaded.notify_all();
+
+	if (!result)
+	{
+		ReleaseMesh(mesh);
+		return 0;
+	}
+
+	return mesh;
+}
+
+void ResourceRegistryClass::ReleaseMesh(MeshType* mesh)
+{
+	unsigned int i;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	mesh->refCount--;
+	if (mesh->refCount > 0)
+	{
+		return;
+	}
+
+	// The last handle is gone, forget the mesh under every name it had.
+	for (i = 0; i < m_meshNames.size(); )
+	{
+		if (m_meshNames[i].mesh == mesh)
+		{
+			m_meshNames.erase(m_meshNames.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	for (i = 0; i < m_meshes.size(); i++)
+	{
+		if (m_meshes[i] == mesh)
+		{
+			m_meshes.erase(m_meshes.begin() + i);
+			break;
+		}
+	}
+
+	DestroyMesh(mesh);
+
+	return;
+}
+
+ResourceRegistryClass::TextureType* ResourceRegistryClass::AcquireTexture(const WCHAR* filename)
+{
+	MappedFileClass* file;
+	TextureType* texture;
+	TextureNameType name;
+	vector<wstring> candidates, matches;
+	unsigned long long contentHash, contentSize;
+	unsigned int i, j;
+	bool result, named, same;
+
+	name.key = filename;
+
+	// Already asked for under this name.
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		for (i = 0; i < m_textureNames.size(); i++)
+		{
+			if (m_textureNames[i].key == name.key)
+			{
+				texture = m_textureNames[i].texture;
+				texture->refCount++;
+				texture->hits++;
+				m_textureHits++;
+
+				return texture;
+			}
+		}
+	}
+
+	// Read and hash the file without holding the lock. A new texture is created from this read.
+	file = new MappedFileClass;
+	if (!file)
+	{
+		return 0;
+	}
+
+	result = file->Initialize(filename);
+	if (!result)
+	{
+		file->Shutdown();
+		delete file;
+		return 0;
+	}
+
+	contentHash = HashClass::HashData(file->GetData(), file->GetSize());
+	contentSize = file->GetSize();
+
+	// Another file with the same hash is only shared once its contents turn out to be the same, compared
+	// without the lock as well.
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		for (i = 0; i < m_textures.size(); i++)
+		{
+			if (m_textures[i]->contentHash == contentHash && m_textures[i]->contentSize == contentSize && m_textures[i]->filename != name.key)
+			{
+				candidates.push_back(m_textures[i]->filename);
+			}
+		}
+	}
+
+	for (i = 0; i < candidates.size(); i++)
+	{
+		if (HasSameContents(file, candidates[i].c_str()))
+		{
+			matches.push_back(candidates[i]);
+		}
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+
+	// The same contents under another name, or this name added by a thread that got here first.
+	for (i = 0; i < m_textures.size(); i++)
+	{
+		texture = m_textures[i];
+		same = (texture->filename == name.key);
+		for (j = 0; j < matches.size(); j++)
+		{
+			same = same || (texture->filename == matches[j]);
+		}
+
+		if (same && texture->contentHash == contentHash && texture->contentSize == contentSize)
+		{
+			named = false;
+			for (j = 0; j < m_textureNames.size(); j++)
+			{
+				named = named || (m_textureNames[j].key == name.key);
+			}
+
+			if (!named)
+			{
+				name.texture = texture;
+				m_textureNames.push_back(name);
+			}
+
+			texture->refCount++;
+			texture->hits++;
+			m_textureHits++;
+
+			file->Shutdown();
+			delete file;
+
+			return texture;
+		}
+	}
+
+	// A new texture, held as the file until CreateTexture uploads it.
+	texture = new TextureType;
+	if (!texture)
+	{
+		file->Shutdown();
+		delete file;
+		return 0;
+	}
+
+	texture->texture = 0;
+	texture->file = file;
+	texture->filename = filename;
+	texture->contentHash = contentHash;
+	texture->contentSize = contentSize;
+	texture->refCount = 1;
+	texture->hits = 0;
+	texture->mipCount = 0;
+	texture->cacheId = -1;
+	texture->streamId = -1;
+	texture->residentMip = 0;
+	texture->priority = 0.0f;
+	texture->streamable = false;
+
+	m_textures.push_back(texture);
+	name.texture = texture;
+	m_textureNames.push_back(name);
+	m_textureMisses++;
+
+	return texture;
+}
+
+ResourceRegistryClass::TextureType* ResourceRegistryClass::AcquireAtlasTexture(const WCHAR* filename, TextureAtlasClass::RemapType& remap)
+{
+	TextureType* texture;
+	wstring wideName;
+	string name;
+	bool result;
+
+	if (!m_TextureAtlas)
+	{
+		return 0;
+	}
+
+	// The table holds plain file names.
+	wideName = filename;
+	name.assign(wideName.begin(), wideName.end());
+
+	result = m_TextureAtlas->GetRemap(name.c_str(), remap);
+	if (!result)
+	{
+		return 0;
+	}
+
+	// Shared with everything else drawn from the atlas.
+	texture = AcquireTexture(m_atlasFilename.c_str());
+	if (texture)
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_atlasHits++;
+	}
+
+	return texture;
+}
+
+bool ResourceRegistryClass::CreateTexture(ID3D11Device* device, TextureType* texture, bool stream)
+{
+	int streamId;
+	bool result;
+
+	// Only the first holder to get here uploads it.
+	if (texture->texture)
+	{
+		return true;
+	}
+
+	// Create the texture object.
+	texture->texture = new TextureClass;
+	if (!texture->texture)
+	{
+		return false;
+	}
+
+	// A streamed texture stays empty until UpdateTextures uploads its smallest levels, the file is read again
+	// on the I/O thread.
+	if (stream && m_TextureStreamer)
+	{
+		{
+			lock_guard<mutex> lock(m_mutex);
+			streamId = m_TextureStreamer->Add(texture->filename.c_str(), texture->priority);
+			texture->streamId = streamId;
+		}
+
+		texture->file->Shutdown();
+		delete texture->file;
+		texture->file = 0;
+
+		return streamId >= 0;
+	}
+
+	// Initialize the texture object from the file read in by AcquireTexture, with all its levels.
+	result = texture->texture->InitializeFromMemory(device, texture->file->GetData(), texture->file->GetSize(), 0);
+	if (!result)
+	{
+		texture->texture->Shutdown();
+		delete texture->texture;
+		texture->texture = 0;
+		return false;
+	}
+
+	// Count it against the budget from now on.
+	{
+		lock_guard<mutex> lock(m_mutex);
+		texture->mipCount = texture->texture->GetMipCount();
+		texture->cacheId = m_TextureCache->Add(texture->texture->GetFormat(), texture->texture->GetWidth(), texture->texture->GetHeight(),
+			texture->texture->GetMipCount(), texture->texture->GetArraySize(), 0);
+	}
+
+	// The file is not needed once the texture exists, the cache reads it again for levels it brings back.
+	texture->file->Shutdown();
+	delete texture->file;
+	texture->file = 0;
+
+	return true;
+}
+
+void ResourceRegistryClass::ReleaseTexture(TextureType* texture)
+{
+	unsigned int i;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	texture->refCount--;
+	if (texture->refCount > 0)
+	{
+		return;
+	}
+
+	// The last handle is gone, forget the texture under every name it had.
+	for (i = 0; i < m_textureNames.size(); )
+	{
+		if (m_textureNames[i].texture == texture)
+		{
+			m_textureNames.erase(m_textureNames.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	for (i = 0; i < m_textures.size(); i++)
+	{
+		if (m_textures[i] == texture)
+		{
+			m_textures.erase(m_textures.begin() + i);
+			break;
+		}
+	}
+
+	DestroyTexture(texture);
+
+	return;
+}
+
+void ResourceRegistryClass::SetTexturePriority(TextureType* texture, float priority)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	// The largest any holder drew it at this frame.
+	texture->priority = (priority > texture->priority) ? priority : texture->priority;
+
+	return;
+}
+
+void ResourceRegistryClass::UpdateTextures(ID3D11Device* device)
+{
+	TextureStreamerClass::ResultType result;
+	vector<ReloadType> reloads;
+	unsigned int i;
+
+	unique_lock<mutex> lock(m_mutex);
+
+	m_device = device;
+
+	// Upload the levels the I/O thread read since the last frame, and tell it what to read first next.
+	if (m_TextureStreamer)
+	{
+		while (m_TextureStreamer->GetResult(result))
+		{
+			UploadStreamedTexture(result);
+		}
+
+		for (i = 0; i < m_textures.size(); i++)
+		{
+			if (m_textures[i]->streamId >= 0)
+			{
+				m_TextureStreamer->SetPriority(m_textures[i]->streamId, m_textures[i]->priority);
+				m_textures[i]->priority = 0.0f;
+			}
+		}
+	}
+
+	// Whatever was drawn since the last frame stays, and comes back in full if it can.
+	for (i = 0; i < m_textures.size(); i++)
+	{
+		if (m_textures[i]->cacheId >= 0 && m_textures[i]->texture->WasUsed())
+		{
+			m_TextureCache->Touch(m_textures[i]->cacheId);
+		}
+	}
+
+	m_TextureCache->Frame();
+	m_device = 0;
+
+	// Take the reloads the cache asked for, each texture held so it is still there when its reload is done.
+	reloads.swap(m_reloads);
+	for (i = 0; i < reloads.size(); i++)
+	{
+		reloads[i].texture->refCount++;
+	}
+
+	lock.unlock();
+
+	// Map the files and create the textures while the loading threads go on acquiring meshes and textures.
+	for (i = 0; i < reloads.size(); i++)
+	{
+		ReloadTexture(device, reloads[i].texture, reloads[i].firstMip);
+		ReleaseTexture(reloads[i].texture);
+	}
+
+	return;
+}
+
+void ResourceRegistryClass::GetTextureCacheStats(TextureCacheClass::StatsType& stats)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	stats = m_TextureCache->GetStats();
+
+	return;
+}
+
+bool ResourceRegistryClass::GetAtlasStats(TextureAtlasClass::StatsType& stats)
+{
+	if (!m_TextureAtlas)
+	{
+		return false;
+	}
+
+	stats = m_TextureAtlas->GetStats();
+
+	return true;
+}
+
+ID3D11Buffer* ResourceRegistryClass::GetQuadIndexBuffer(ID3D11Device* device)
+{
+	unsigned short* indices;
+	D3D11_BUFFER_DESC indexBufferDesc;
+	D3D11_SUBRESOURCE_DATA indexData;
+	HRESULT result;
+	int i;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	// Created once and shared by everything drawing quads.
+	if (m_quadIndexBuffer)
+	{
+		return m_quadIndexBuffer;
+	}
+
+	// Create the index array.
+	indices = new unsigned short[TEXT_RING_QUAD_COUNT * TEXT_QUAD_INDEX_COUNT];
+	if (!indices)
+	{
+		return 0;
+	}
+
+	// Two clockwise triangles a quad, top left, top right, bottom right and top left, bottom right, bottom left.
+	// The largest text draw, a full ring, stays below 65536 vertices.
+	for (i = 0; i < TEXT_RING_QUAD_COUNT; i++)
+	{
+		indices[i * 6 + 0] = (unsigned short)(i * 4 + 0);
+		indices[i * 6 + 1] = (unsigned short)(i * 4 + 1);
+		indices[i * 6 + 2] = (unsigned short)(i * 4 + 2);
+		indices[i * 6 + 3] = (unsigned short)(i * 4 + 0);
+		indices[i * 6 + 4] = (unsigned short)(i * 4 + 2);
+		indices[i * 6 + 5] = (unsigned short)(i * 4 + 3);
+	}
+
+	// Set up the description of the static index buffer.
+	indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexBufferDesc.ByteWidth = sizeof(unsigned short) * TEXT_RING_QUAD_COUNT * TEXT_QUAD_INDEX_COUNT;
+	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	indexBufferDesc.CPUAccessFlags = 0;
+	indexBufferDesc.MiscFlags = 0;
+	indexBufferDesc.StructureByteStride = 0;
+
+	// Give the subresource structure a pointer to the index data.
+	indexData.pSysMem = indices;
+	indexData.SysMemPitch = 0;
+	indexData.SysMemSlicePitch = 0;
+
+	// Create the index buffer.
+	result = device->CreateBuffer(&indexBufferDesc, &indexData, &m_quadIndexBuffer);
+
+	// Release the array now that the index buffer has been created and loaded.
+	delete[] indices;
+	indices = 0;
+
+	if (FAILED(result))
+	{
+		m_quadIndexBuffer = 0;
+		return 0;
+	}
+
+	return m_quadIndexBuffer;
+}
+
+void ResourceRegistryClass::GetStats(StatsType& stats)
+{
+	MeshLoaderClass* loader;
+	size_t bytes;
+	unsigned int i;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	stats.meshCount = (int)m_meshes.size();
+	stats.meshHits = m_meshHits;
+	stats.meshMisses = m_meshMisses;
+	stats.textureCount = (int)m_textures.size();
+	stats.textureHits = m_textureHits;
+	stats.textureMisses = m_textureMisses;
+	stats.atlasHits = m_atlasHits;
+
+	// Every hit on a resource still held saved reading and uploading it once more: a mesh's CPU copy and its
+	// two buffers, a texture's size on the GPU, or its file while it is not uploaded yet.
+	stats.meshBytesSaved = 0;
+	for (i = 0; i < m_meshes.size(); i++)
+	{
+		if (!m_meshes[i]->loaded || m_meshes[i]->failed)
+		{
+			continue;
+		}
+
+		loader = m_meshes[i]->loader;
+		bytes = loader->GetCpuBytes() + (size_t)loader->GetVertexStride() * loader->GetVertexCount() + sizeof(unsigned int) * loader->GetIndexCount();
+		stats.meshBytesSaved += bytes * m_meshes[i]->hits;
+	}
+
+	stats.textureBytesSaved = 0;
+	for (i = 0; i < m_textures.size(); i++)
+	{
+		bytes = m_textures[i]->texture ? m_textures[i]->texture->GetMemorySize() : (size_t)m_textures[i]->contentSize;
+		stats.textureBytesSaved += bytes * m_textures[i]->hits;
+	}
+
+	return;
+}
+
+string ResourceRegistryClass::GetMeshKey(const char* filename, bool optimize, int vertexFormat, int lodCount, int residency)
+{
+	return string(filename) + "|" + to_string(optimize ? 1 : 0) + "|" + to_string(vertexFormat) + "|" + to_string(lodCount) + "|" + to_string(residency);
+}
+
+bool ResourceRegistryClass::HasSameContents(MappedFileClass* file, const char* filename)
+{
+	MappedFileClass other;
+	bool result;
+
+	result = other.Initialize(filename);
+	result = result && other.GetSize() == file->GetSize() && (file->GetSize() == 0 || memcmp(other.GetData(), file->GetData(), file->GetSize()) == 0);
+	other.Shutdown();
+
+	return result;
+}
+
+bool ResourceRegistryClass::HasSameContents(MappedFileClass* file, const WCHAR* filename)
+{
+	MappedFileClass other;
+	bool result;
+
+	result = other.Initialize(filename);
+	result = result && other.GetSize() == file->GetSize() && (file->GetSize() == 0 || memcmp(other.GetData(), file->GetData(), file->GetSize()) == 0);
+	other.Shutdown();
+
+	return result;
+}
+
+ResourceRegistryClass::MeshType* ResourceRegistryClass::WaitForMesh(unique_lock<mutex>& lock, MeshType* mesh)
+{
+	// Another thread is still reading it.
+	while (!mesh->loaded)
+	{
+		m_meshLoaded.wait(lock);
+	}
+
+	if (!mesh->failed)
+	{
+		return mesh;
+	}
+
+	// That read failed, give the handle back. The last one to do so removes the mesh.
+	lock.unlock();
+	ReleaseMesh(mesh);
+
+	return 0;
+}
+
+void ResourceRegistryClass::DestroyMesh(MeshType* mesh)
+{
+	// Release the buffers the first model to use the mesh created.
+	if (mesh->indexBuffer)
+	{
+		mesh->indexBuffer->Release();
+		mesh->indexBuffer = 0;
+	}
+
+	if (mesh->vertexBuffer)
+	{
+		mesh->vertexBuffer->Release();
+		mesh->vertexBuffer = 0;
+	}
+
+	// Release the mesh loader object.
+	if (mesh->loader)
+	{
+		mesh->loader->Shutdown();
+		delete mesh->loader;
+		mesh->loader = 0;
+	}
+
+	delete mesh;
+
+	return;
+}
+
+void ResourceRegistryClass::DestroyTexture(TextureType* texture)
+{
+	// Stop counting it against the budget, and reading it.
+	if (m_TextureCache && texture->cacheId >= 0)
+	{
+		m_TextureCache->Remove(texture->cacheId);
+		texture->cacheId = -1;
+	}
+
+	if (m_TextureStreamer && texture->streamId >= 0)
+	{
+		m_TextureStreamer->Remove(texture->streamId);
+		texture->streamId = -1;
+	}
+
+	// Release the texture object.
+	if (texture->texture)
+	{
+		texture->texture->Shutdown();
+		delete texture->texture;
+		texture->texture = 0;
+	}
+
+	// Release the file of a texture that was never uploaded.
+	if (texture->file)
+	{
+		texture->file->Shutdown();
+		delete texture->file;
+		texture->file = 0;
+	}
+
+	delete texture;
+
+	return;
+}
+
+bool ResourceRegistryClass::SetTextureFirstMip(int cacheId, int firstMip)
+{
+	TextureType* texture;
+	ReloadType reload;
+	unsigned int i;
+
+	// Called from UpdateTextures, with the lock held.
+	texture = 0;
+	for (i = 0; i < m_textures.size(); i++)
+	{
+		if (m_textures[i]->cacheId == cacheId)
+		{
+			texture = m_textures[i];
+			break;
+		}
+	}
+
+	if (!texture)
+	{
+		return false;
+	}
+
+	// A streamed texture is brought up by the I/O thread, the cache counts the levels as resident from now on.
+	// Reduced below what it has, it is created again from the file right away.
+	if (texture->streamable)
+	{
+		m_TextureStreamer->Request(texture->streamId, firstMip);
+
+		if (firstMip >= texture->mipCount)
+		{
+			texture->texture->Shutdown();
+			texture->residentMip = texture->mipCount;
+			m_TextureStreamer->SetResident(texture->streamId, texture->residentMip);
+			return true;
+		}
+
+		if (firstMip <= texture->residentMip)
+		{
+			return true;
+		}
+
+		texture->residentMip = firstMip;
+		m_TextureStreamer->SetResident(texture->streamId, texture->residentMip);
+	}
+
+	// Evicted entirely, whoever draws it gets no texture until it comes back.
+	if (firstMip >= texture->mipCount)
+	{
+		texture->texture->Shutdown();
+	}
+
+	// Anything else is created again from the file once UpdateTextures released the lock, the last word of
+	// the cache this frame is the one that counts. Until then it is drawn as it is.
+	for (i = 0; i < m_reloads.size(); i++)
+	{
+		if (m_reloads[i].texture == texture)
+		{
+			m_reloads.erase(m_reloads.begin() + i);
+			break;
+		}
+	}
+
+	if (firstMip < texture->mipCount)
+	{
+		reload.texture = texture;
+		reload.firstMip = firstMip;
+		m_reloads.push_back(reload);
+	}
+
+	return true;
+}
+
+void ResourceRegistryClass::UploadStreamedTexture(TextureStreamerClass::ResultType& result)
+{
+	TextureType* texture;
+	unsigned int i;
+	int cachedMip;
+	bool upload;
+
+	// Called from UpdateTextures, with the lock held.
+	texture = 0;
+	for (i = 0; i < m_textures.size(); i++)
+	{
+		if (m_textures[i]->streamId == result.id)
+		{
+			texture = m_textures[i];
+			break;
+		}
+	}
+
+	// A texture that could not be read stays empty, whoever draws it gets no texture.
+	if (!texture || result.failed)
+	{
+		return;
+	}
+
+	// Only levels finer than the texture has and within what the cache allows it are uploaded. A read the cache
+	// reduced the texture below in the meantime is dropped, the I/O thread goes on from what is resident.
+	if (texture->cacheId >= 0)
+	{
+		cachedMip = m_TextureCache->GetFirstMip(texture->cacheId);
+		upload = (result.firstMip < texture->residentMip && result.firstMip >= cachedMip);
+		if (!upload)
+		{
+			m_TextureStreamer->SetResident(texture->streamId, texture->residentMip);
+			return;
+		}
+	}
+
+	texture->texture->Shutdown();
+	upload = texture->texture->InitializeFromMemory(m_device, &result.file[0], result.file.size(), 0);
+	if (!upload)
+	{
+		texture->texture->Shutdown();
+		texture->residentMip = texture->mipCount;
+		m_TextureStreamer->SetResident(texture->streamId, texture->residentMip);
+		return;
+	}
+
+	// The first read of a texture counts it against the budget, at the levels it came with.
+	if (texture->cacheId < 0)
+	{
+		texture->streamable = result.streamable;
+		if (result.streamable)
+		{
+			texture->mipCount = result.mipCount;
+			texture->cacheId = m_TextureCache->Add(result.format, result.width, result.height, result.mipCount, result.arraySize, result.firstMip);
+		}
+		else
+		{
+			texture->mipCount = texture->texture->GetMipCount();
+			texture->cacheId = m_TextureCache->Add(texture->texture->GetFormat(), texture->texture->GetWidth(), texture->texture->GetHeight(),
+				texture->texture->GetMipCount(), texture->texture->GetArraySize(), 0);
+		}
+	}
+
+	texture->residentMip = result.firstMip;
+
+	return;
+}
+
+bool ResourceRegistryClass::ReloadTexture(ID3D11Device* device, TextureType* texture, int firstMip)
+{
+	chrono::high_resolution_clock::time_point start;
+	TextureClass* created;
+	MappedFileClass* file;
+	double milliseconds;
+	bool result;
+
+	// Called from UpdateTextures, without the lock, on a texture it holds.
+	start = chrono::high_resolution_clock::now();
+
+	// Created aside from the file, without the levels above the first one kept.
+	created = new TextureClass;
+	file = new MappedFileClass;
+	result = created && file;
+
+	if (result)
+	{
+		result = file->Initialize(texture->filename.c_str());
+	}
+
+	if (result)
+	{
+		result = created->InitializeFromMemory(device, file->GetData(), file->GetSize(), firstMip);
+	}
+
+	if (file)
+	{
+		file->Shutdown();
+		delete file;
+		file = 0;
+	}
+
+	milliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+	// Swapped in under the lock, the old texture goes with the object it is swapped into. A texture that could
+	// not be created is left with nothing, as the cache now has it.
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		if (result)
+		{
+			texture->texture->Swap(*created);
+		}
+		else
+		{
+			texture->texture->Shutdown();
+		}
+
+		m_TextureCache->ReportReload(texture->cacheId, result, milliseconds);
+	}
+
+	if (created)
+	{
+		created->Shutdown();
+		delete created;
+		created = 0;
+	}
+
+	return result;
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#ifndef _RESOURCEREGISTRYCLASS_H_
+#define _RESOURCEREGISTRYCLASS_H_
+
+#include <d3d11.h>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+
+#include "textureclass.h"
+#include "meshloaderclass.h"
+#include "mappedfileclass.h"
+#include "texturecacheclass.h"
+#include "texturestreamerclass.h"
+#include "textureatlasclass.h"
+#include "textbatchclass.h"
+using namespace std;
+
+// Meshes and textures shared by everything drawn from the same file. A resource is looked up by its path
+// first and then by a hash of the file contents, confirmed by comparing the two files byte for byte, so a file
+// loaded under a second name is still read and uploaded once. Acquire hands out a reference counted handle and Release gives it back, the resource goes
+// with the last one.
+//
+// Meshes and textures are acquired on the loading threads. The first to ask for a mesh reads it while the
+// others wait for it; the GPU side is created later on the render thread, by the first model to need it.
+//
+// Uploaded textures are kept within a byte budget by a TextureCacheClass. UpdateTextures, called on the
+// render thread once a frame, tells it which textures were drawn since the last call and reads the files
+// again for the levels it brings back. Those are read and created after the lock is released, so the loading
+// threads are not held up by the disk, and swapped in under it.
+//
+// A texture created to be streamed starts out empty. A TextureStreamerClass reads its smallest levels on its
+// I/O thread and UpdateTextures uploads them, from then on it can be drawn; the larger levels the cache brings
+// it up to follow a level at a time, for the textures that cover the most of the screen first.
+// SetTexturePriority tells the registry that size for every frame a texture is drawn in.
+//
+// Small textures can be drawn from one atlas instead. LoadAtlas reads the table of a TextureAtlasClass, or cooks
+// the atlas and its table from the given sources when there is none yet. AcquireAtlasTexture hands out the atlas
+// for a texture file packed in it, with the remap that moves the texture coordinates into it, and nothing for
+// any other file.
+//
+// Text and sprites draw quads of 4 vertices, top left, top right, bottom right and bottom left, all from the one
+// 16 bit index buffer GetQuadIndexBuffer creates the first time it is asked for: 0, 1, 2, 0, 2, 3 and so on for
+// the TEXT_RING_QUAD_COUNT quads of a full text ring, with the base vertex of a draw saying where its quads start.
+class ResourceRegistryClass
+{
+public:
+	struct MeshType
+	{
+		MeshLoaderClass* loader;
+		ID3D11Buffer* vertexBuffer;
+		ID3D11Buffer* indexBuffer;
+		string filename;
+
+		unsigned long long contentHash, contentSize;
+		bool optimize;
+		int vertexFormat, lodCount, residency;
+		int refCount, hits;
+		bool loaded, failed;
+	};
+
+	struct TextureType
+	{
+		TextureClass* texture;
+		MappedFileClass* file;
+		wstring filename;
+
+		unsigned long long contentHash, contentSize;
+		int mipCount, refCount, hits, cacheId;
+		int streamId, residentMip;
+		float priority;
+		bool streamable;
+	};
+
+	// Lookups since Initialize, and what the resources handed out more than once would have cost again.
+	struct StatsType
+	{
+		int meshCount, meshHits, meshMisses;
+		int textureCount, textureHits, textureMisses, atlasHits;
+		size_t meshBytesSaved, textureBytesSaved;
+	};
+
+private:
+	struct MeshNameType
+	{
+		string key;
+		MeshType* mesh;
+	};
+
+	struct TextureNameType
+	{
+		wstring key;
+		TextureType* texture;
+	};
+
+	// A texture the cache brought back or reduced, created again from its file once the lock is released.
+	struct ReloadType
+	{
+		TextureType* texture;
+		int firstMip;
+	};
+
+public:
+	ResourceRegistryClass();
+	ResourceRegistryClass(const ResourceRegistryClass&);
+	~ResourceRegistryClass();
+
+	bool Initialize(size_t, bool);
+	bool LoadAtlas(const char*, const vector<string>&, unsigned int);
+	void Shutdown();
+
+	MeshType* AcquireMesh(const char*, bool, int, int, int);
+	void ReleaseMesh(MeshType*);
+
+	TextureType* AcquireTexture(const WCHAR*);
+	TextureType* AcquireAtlasTexture(const WCHAR*, TextureAtlasClass::RemapType&);
+	bool CreateTexture(ID3D11Device*, TextureType*, bool);
+	void ReleaseTexture(TextureType*);
+	void SetTexturePriority(TextureType*, float);
+	void UpdateTextures(ID3D11Device*);
+
+	void GetStats(StatsType&);
+	void GetTextureCacheStats(TextureCacheClass::StatsType&);
+	bool GetAtlasStats(TextureAtlasClass::StatsType&);
+
+	ID3D11Buffer* GetQuadIndexBuffer(ID3D11Device*);
+
+private:
+	static string GetMeshKey(const char*, bool, int, int, int);
+	static bool HasSameContents(MappedFileClass*, const char*);
+	static bool HasSameContents(MappedFileClass*, const WCHAR*);
+	MeshType* WaitForMesh(unique_lock<mutex>&, MeshType*);
+	void DestroyMesh(MeshType*);
+	void DestroyTexture(TextureType*);
+	bool SetTextureFirstMip(int, int);
+	void UploadStreamedTexture(TextureStreamerClass::ResultType&);
+	bool ReloadTexture(ID3D11Device*, TextureType*, int);
+
+private:
+	vector<MeshType*> m_meshes;
+	vector<MeshNameType> m_meshNames;
+	vector<TextureType*> m_textures;
+	vector<TextureNameType> m_textureNames;
+	vector<ReloadType> m_reloads;
+	TextureCacheClass* m_TextureCache;
+	TextureStreamerClass* m_TextureStreamer;
+	TextureAtlasClass* m_TextureAtlas;
+	wstring m_atlasFilename;
+	ID3D11Buffer* m_quadIndexBuffer;
+	ID3D11Device* m_device;
+	int m_meshHits, m_meshMisses, m_textureHits, m_textureMisses, m_atlasHits;
+	mutex m_mutex;
+	condition_variable m_meshLoaded;
+};
+#endif
@@ -0,0 +1,275 @@
+#include "textbatchclass.h"
+
+#include <string.h>
+
+#include "hashclass.h"
+
+TextBatchClass::TextBatchClass()
+{
+	memset(m_glyphs, 0, sizeof(m_glyphs));
+	m_top = 0.0f;
+	m_bottom = 1.0f;
+	m_screenWidth = 0;
+	m_screenHeight = 0;
+	m_frameUpdates = 0;
+	m_frameLayouts = 0;
+	m_dirty = false;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+TextBatchClass::TextBatchClass(const TextBatchClass& other)
+{
+}
+
+TextBatchClass::~TextBatchClass()
+{
+}
+
+bool TextBatchClass::Initialize(const FontLoaderClass::GlyphType* glyphs, float top, float bottom, int screenWidth, int screenHeight)
+{
+	if (!glyphs || screenWidth <= 0 || screenHeight <= 0)
+	{
+		return false;
+	}
+
+	// The glyphs as the font samples them, moved into an atlas or not.
+	memcpy(m_glyphs, glyphs, sizeof(m_glyphs));
+	m_top = top;
+	m_bottom = bottom;
+	m_screenWidth = screenWidth;
+	m_screenHeight = screenHeight;
+
+	m_frameUpdates = 0;
+	m_frameLayouts = 0;
+	m_dirty = true;
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	return true;
+}
+
+void TextBatchClass::Shutdown()
+{
+	unsigned int i;
+
+	// Release the sentences.
+	for (i = 0; i < m_sentences.size(); i++)
+	{
+		delete m_sentences[i];
+	}
+	m_sentences.clear();
+
+	vector<VertexType>().swap(m_batch);
+
+	return;
+}
+
+int TextBatchClass::AddSentence(int maxLength)
+{
+	SentenceType* sentence;
+
+	if (maxLength <= 0)
+	{
+		return -1;
+	}
+
+	// Create the sentence, empty until it is first set.
+	sentence = new SentenceType;
+	if (!sentence)
+	{
+		return -1;
+	}
+
+	sentence->vertices.resize((size_t)maxLength * TEXT_QUAD_VERTEX_COUNT);
+	sentence->maxLength = maxLength;
+	sentence->vertexCount = 0;
+	sentence->hash = 0;
+	sentence->laidOut = false;
+
+	m_sentences.push_back(sentence);
+
+	return (int)m_sentences.size() - 1;
+}
+
+bool TextBatchClass::SetSentence(int id, const char* text, int positionX, int positionY, float red, float green, float blue)
+{
+	SentenceType* sentence;
+	StyleType style;
+	unsigned long long hash;
+	int numLetters;
+
+	if (id < 0 || id >= (int)m_sentences.size())
+	{
+		return false;
+	}
+
+	sentence = m_sentences[id];
+	m_frameUpdates++;
+
+	// Get the number of letters in the sentence, and check for possible buffer overflow.
+	numLetters = (int)strlen(text);
+	if (numLetters > sentence->maxLength)
+	{
+		return false;
+	}
+
+	// The text and everything else that decides its vertices.
+	memset(&style, 0, sizeof(style));
+	style.positionX = positionX;
+	style.positionY = positionY;
+	style.red = red;
+	style.green = green;
+	style.blue = blue;
+
+	hash = HashClass::Combine(HashClass::HashData(text, (size_t)numLetters), HashClass::HashData((const char*)&style, sizeof(style)));
+
+	// Drawn as it already is.
+	if (sentence->laidOut && sentence->hash == hash)
+	{
+		return true;
+	}
+
+	// Lay it out from the top left corner of the screen.
+	sentence->vertexCount = Layout(text, (float)(((m_screenWidth / 2) * -1) + positionX), (float)((m_screenHeight / 2) - positionY),
+		PackColor(red, green, blue), &sentence->vertices[0]);
+	sentence->hash = hash;
+	sentence->laidOut = true;
+
+	m_frameLayouts++;
+	m_dirty = true;
+
+	return true;
+}
+
+bool TextBatchClass::Build()
+{
+	size_t vertexCount;
+	unsigned int i;
+
+	// Nothing changed, the batch from last time is still the one to draw.
+	if (!m_dirty)
+	{
+		return false;
+	}
+
+	vertexCount = 0;
+	for (i = 0; i < m_sentences.size(); i++)
+	{
+		vertexCount += m_sentences[i]->vertexCount;
+	}
+
+	// The batch keeps its memory from frame to frame.
+	m_batch.resize(vertexCount);
+	vertexCount = 0;
+	for (i = 0; i < m_sentences.size(); i++)
+	{
+		if (m_sentences[i]->vertexCount > 0)
+		{
+			memcpy(&m_batch[vertexCount], &m_sentences[i]->vertices[0], sizeof(VertexType) * m_sentences[i]->vertexCount);
+			vertexCount += m_sentences[i]->vertexCount;
+		}
+	}
+
+	m_dirty = false;
+
+	return true;
+}
+
+void TextBatchClass::EndFrame(size_t uploadBytes, int draws)
+{
+	m_stats.frameCount++;
+	m_stats.sentenceCount = (int)m_sentences.size();
+	m_stats.updates = m_frameUpdates;
+	m_stats.layouts = m_frameLayouts;
+	m_stats.vertexCount = (int)m_batch.size();
+	m_stats.draws = draws;
+	m_stats.uploadBytes = uploadBytes;
+	m_stats.totalUpdates += m_frameUpdates;
+	m_stats.totalLayouts += m_frameLayouts;
+	m_stats.totalDraws += draws;
+	m_stats.totalUploadBytes += uploadBytes;
+
+	m_frameUpdates = 0;
+	m_frameLayouts = 0;
+
+	return;
+}
+
+const TextBatchClass::VertexType* TextBatchClass::GetVertices()
+{
+	return m_batch.empty() ? 0 : &m_batch[0];
+}
+
+int TextBatchClass::GetVertexCount()
+{
+	return (int)m_batch.size();
+}
+
+const TextBatchClass::StatsType& TextBatchClass::GetStats()
+{
+	return m_stats;
+}
+
+unsigned int TextBatchClass::PackColor(float red, float green, float blue)
+{
+	unsigned int r, g, b;
+
+	// R8G8B8A8_UNORM, red in the lowest byte, always opaque.
+	r = (unsigned int)((red < 0.0f ? 0.0f : (red > 1.0f ? 1.0f : red)) * 255.0f + 0.5f);
+	g = (unsigned int)((green < 0.0f ? 0.0f : (green > 1.0f ? 1.0f : green)) * 255.0f + 0.5f);
+	b = (unsigned int)((blue < 0.0f ? 0.0f : (blue > 1.0f ? 1.0f : blue)) * 255.0f + 0.5f);
+
+	return r | (g << 8) | (b << 16) | 0xff000000u;
+}
+
+int TextBatchClass::Layout(const char* text, float drawX, float drawY, unsigned int color, VertexType* vertices)
+{
+	const FontLoaderClass::GlyphType* glyph;
+	VertexType* corners;
+	int index, i, letter;
+
+	index = 0;
+	for (i = 0; text[i]; i++)
+	{
+		// A space, or anything the font has no glyph for, just moves over.
+		letter = (int)(unsigned char)text[i] - 32;
+		if (letter <= 0 || letter >= FONT_GLYPH_COUNT)
+		{
+			drawX += TEXT_SPACE_WIDTH;
+			continue;
+		}
+
+		glyph = &m_glyphs[letter];
+		corners = &vertices[index];
+
+		// Top left, top right, bottom right and bottom left, as the quad index buffer draws them.
+		corners[0].x = drawX;
+		corners[0].y = drawY;
+		corners[0].u = glyph->left;
+		corners[0].v = m_top;
+
+		corners[1].x = drawX + (float)glyph->size;
+		corners[1].y = drawY;
+		corners[1].u = glyph->right;
+		corners[1].v = m_top;
+
+		corners[2].x = drawX + (float)glyph->size;
+		corners[2].y = drawY - TEXT_GLYPH_HEIGHT;
+		corners[2].u = glyph->right;
+		corners[2].v = m_bottom;
+
+		corners[3].x = drawX;
+		corners[3].y = drawY - TEXT_GLYPH_HEIGHT;
+		corners[3].u = glyph->left;
+		corners[3].v = m_bottom;
+
+		corners[0].z = corners[1].z = corners[2].z = corners[3].z = 0.0f;
+		corners[0].color = corners[1].color = corners[2].color = corners[3].color = color;
+
+		index += TEXT_QUAD_VERTEX_COUNT;
+
+		// Move over by the size of the letter and one pixel.
+		drawX += (float)glyph->size + 1.0f;
+	}
+
+	return index;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#ifndef _TEXTBATCHCLASS_H_
+#define _TEXTBATCHCLASS_H_
+
+#include <vector>
+
+#include "fontloaderclass.h"
+using namespace std;
+
+// Height of a glyph quad in pixels, and how far a space moves the next glyph.
+const float TEXT_GLYPH_HEIGHT = 16.0f;
+const float TEXT_SPACE_WIDTH = 3.0f;
+
+// Vertices and indices of a glyph quad.
+const int TEXT_QUAD_VERTEX_COUNT = 4;
+const int TEXT_QUAD_INDEX_COUNT = 6;
+
+// Glyph quads the text ring buffer holds, a larger batch is drawn a ring at a time.
+const int TEXT_RING_QUAD_COUNT = 4096;
+
+// Every sentence drawn with one font, laid out into one stream of vertices drawn with a single call. No
+// Direct3D dependency. A sentence is retained: SetSentence hashes its text with its position and color and
+// lays it out again only when the hash changed, into vertices the sentence keeps. Build gathers the vertices of
+// all sentences, in the order they were added, into the batch, only when one of them changed since the last
+// Build. Each glyph is a quad of 4 vertices, top left, top right, bottom right and bottom left, carrying the
+// sentence color, so sentences of different colors still draw together; the triangles come from a shared quad
+// index buffer.
+//
+// EndFrame closes a frame of counters: the sentences set, those laid out again, the bytes the caller uploaded
+// and the draws it took.
+class TextBatchClass
+{
+public:
+	struct VertexType
+	{
+		float x, y, z;
+		float u, v;
+		unsigned int color;
+	};
+
+	struct StatsType
+	{
+		int frameCount, sentenceCount;
+		int updates, layouts, vertexCount, draws;
+		size_t uploadBytes;
+		long long totalUpdates, totalLayouts, totalDraws;
+		unsigned long long totalUploadBytes;
+	};
+
+private:
+	struct SentenceType
+	{
+		vector<VertexType> vertices;
+		int maxLength, vertexCount;
+		unsigned long long hash;
+		bool laidOut;
+	};
+
+	// What a sentence looks like besides its text.
+	struct StyleType
+	{
+		int positionX, positionY;
+		float red, green, blue;
+	};
+
+public:
+	TextBatchClass();
+	TextBatchClass(const TextBatchClass&);
+	~TextBatchClass();
+
+	bool Initialize(const FontLoaderClass::GlyphType*, float, float, int, int);
+	void Shutdown();
+
+	int AddSentence(int);
+	bool SetSentence(int, const char*, int, int, float, float, float);
+	bool Build();
+	void EndFrame(size_t, int);
+
+	const VertexType* GetVertices();
+	int GetVertexCount();
+	const StatsType& GetStats();
+
+	static unsigned int PackColor(float, float, float);
+
+private:
+	int Layout(const char*, float, float, unsigned int, VertexType*);
+
+private:
+	vector<SentenceType*> m_sentences;
+	vector<VertexType> m_batch;
+	FontLoaderClass::GlyphType m_glyphs[FONT_GLYPH_COUNT];
+	float m_top, m_bottom;
+	int m_screenWidth, m_screenHeight;
+	int m_frameUpdates, m_frameLayouts;
+	bool m_dirty;
+	StatsType m_stats;
+};
+#endif
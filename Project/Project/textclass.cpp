@@ -4,10 +4,16 @@ TextClass::TextClass()
 {
 	m_Font = 0;
 	m_FontShader = 0;
-
-	m_sentence1 = 0;
-	m_sentence2 = 0;
-	m_sentence3 = 0;
+	m_Batch = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_ringOffset = 0;
+	m_batchStart = 0;
+	m_batchInRing = false;
+
+	m_fpsSentence = -1;
+	m_cpuSentence = -1;
+	m_polygonSentence = -1;
 }
 
 TextClass::TextClass(const TextClass& other)
@@ -18,7 +24,7 @@ TextClass::~TextClass()
 {
 }
 
-bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, HWND hwnd, int screenWidth, int screenHeight, D3DXMATRIX baseViewMatrix)
+bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceContext, ResourceRegistryClass* registry, HWND hwnd, int screenWidth, int screenHeight, D3DXMATRIX baseViewMatrix)
 {
 	bool result;
 
@@ -37,7 +43,7 @@ bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceCont
 	}
 
 	// Initialize the font object.
-	result = m_Font->Initialize(device, "../Project/data/fontdata.txt", L"../Project/data/font.dds");
+	result = m_Font->Initialize(device, registry, "../Project/data/fontdata.txt", L"../Project/data/font.dds");
 	if (!result)
 	{
 		MessageBox(hwnd, L"Could not initialize the font object.", L"Error", MB_OK);
@@ -59,54 +65,56 @@ bool TextClass::Initialize(ID3D11Device* device, ID3D11DeviceContext* deviceCont
 		return false;
 	}
 
-	// Initialize the first sentence.
-	result = InitializeSentence(&m_sentence1, 16, device);
-	if (!result)
+	// Create the text batch object.
+	m_Batch = new TextBatchClass;
+	if (!m_Batch)
 	{
 		return false;
 	}
 
-	//// Now update the sentence vertex buffer with the new string information.
-	//result = UpdateSentence(m_sentence1, "Hello", 100, 100, 1.0f, 1.0f, 1.0f, deviceContext);
-	//if (!result)
-	//{
-	//	return false;
-	//}
-
-	// Initialize the second sentence.
-	result = InitializeSentence(&m_sentence2, 16, device);
+	// Initialize the text batch object with the glyphs as the font samples them.
+	result = m_Batch->Initialize(m_Font->GetGlyphs(), m_Font->GetTop(), m_Font->GetBottom(), screenWidth, screenHeight);
 	if (!result)
 	{
 		return false;
 	}
 
-	//// Now update the sentence vertex buffer with the new string information.
-	//result = UpdateSentence(m_sentence2, "Goodbye", 100, 200, 1.0f, 1.0f, 0.0f, deviceContext);
-	//if (!result)
-	//{
-	//	return false;
-	//}
-
-	// Initialize the third sentence.
-	result = InitializeSentence(&m_sentence3, 16, device);
+	// Initialize the ring vertex buffer every sentence is drawn from, and get the quad index buffer.
+	result = InitializeBuffers(device, registry);
 	if (!result)
 	{
 		return false;
 	}
 
+	// Add the sentences of the on screen counters.
+	m_fpsSentence = AddSentence(TEXT_MAX_LENGTH);
+	m_cpuSentence = AddSentence(TEXT_MAX_LENGTH);
+	m_polygonSentence = AddSentence(TEXT_MAX_LENGTH);
+	if (m_fpsSentence < 0 || m_cpuSentence < 0 || m_polygonSentence < 0)
+	{
+		return false;
+	}
+
 	return true;
 }
 
 void TextClass::Shutdown()
 {
-	// Release the first sentence.
-	ReleaseSentence(&m_sentence1);
-
-	// Release the second sentence.
-	ReleaseSentence(&m_sentence2);
+	// Release the ring vertex buffer, the quad index buffer belongs to the registry.
+	if (m_vertexBuffer)
+	{
+		m_vertexBuffer->Release();
+		m_vertexBuffer = 0;
+	}
+	m_indexBuffer = 0;
 
-	// Release the third sentence.
-	ReleaseSentence(&m_sentence3);
+	// Release the text batch object.
+	if (m_Batch)
+	{
+		m_Batch->Shutdown();
+		delete m_Batch;
+		m_Batch = 0;
+	}
 
 	// Release the font shader object.
 	if (m_FontShader)
@@ -127,35 +135,96 @@ void TextClass::Shutdown()
 	return;
 }
 
-bool TextClass::Render(ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX  orthoMatrix)
+bool TextClass::Render(ID3D11DeviceContext* deviceContext, D3DXMATRIX worldMatrix, D3DXMATRIX orthoMatrix)
 {
-	bool result;
+	const TextBatchClass::VertexType* vertices;
+	unsigned int stride, offset;
+	size_t uploadBytes;
+	int vertexCount, first, count, startVertex, draws;
+	bool changed, result;
 
-	// Draw the first sentence.
-	result = RenderSentence(deviceContext, m_sentence1, worldMatrix, orthoMatrix);
-	if (!result)
-	{
-		return false;
-	}
+	// Gather the sentences again only if one of them changed since the last frame.
+	changed = m_Batch->Build();
+	vertices = m_Batch->GetVertices();
+	vertexCount = m_Batch->GetVertexCount();
 
-	// Draw the second sentence.
-	result = RenderSentence(deviceContext, m_sentence2, worldMatrix, orthoMatrix);
-	if (!result)
+	// Set the ring vertex buffer to active in the input assembler so it can be rendered.
+	stride = sizeof(TextBatchClass::VertexType);
+	offset = 0;
+	deviceContext->IASetVertexBuffers(0, 1, &m_vertexBuffer, &stride, &offset);
+
+	// Set the quad index buffer to active in the input assembler so it can be rendered.
+	deviceContext->IASetIndexBuffer(m_indexBuffer, DXGI_FORMAT_R16_UINT, 0);
+
+	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
+	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	uploadBytes = 0;
+	draws = 0;
+
+	// Unchanged and in the ring whole, it is drawn from where it already is.
+	if (!changed && m_batchInRing)
 	{
-		return false;
+		if (vertexCount > 0)
+		{
+			result = m_FontShader->Render(deviceContext, vertexCount / TEXT_QUAD_VERTEX_COUNT * TEXT_QUAD_INDEX_COUNT, m_batchStart, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture());
+			if (!result)
+			{
+				return false;
+			}
+
+			draws++;
+		}
+
+		m_Batch->EndFrame(uploadBytes, draws);
+
+		return true;
 	}
 
-	// Draw the third sentence.
-	result = RenderSentence(deviceContext, m_sentence3, worldMatrix, orthoMatrix);
-	if (!result)
+	// Otherwise uploaded a ring at a time, each piece drawn before the next can start the ring over.
+	for (first = 0; first < vertexCount; first += count)
 	{
-		return false;
+		count = (vertexCount - first < TEXT_RING_VERTEX_COUNT) ? vertexCount - first : TEXT_RING_VERTEX_COUNT;
+
+		result = UploadVertices(deviceContext, vertices + first, count, startVertex);
+		if (!result)
+		{
+			return false;
+		}
+
+		result = m_FontShader->Render(deviceContext, count / TEXT_QUAD_VERTEX_COUNT * TEXT_QUAD_INDEX_COUNT, startVertex, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture());
+		if (!result)
+		{
+			return false;
+		}
+
+		uploadBytes += sizeof(TextBatchClass::VertexType) * count;
+		m_batchStart = startVertex;
+		draws++;
 	}
 
+	m_batchInRing = (draws <= 1);
+	m_Batch->EndFrame(uploadBytes, draws);
+
 	return true;
 }
 
-bool TextClass::SetCpu(int cpu, ID3D11DeviceContext* deviceContext)
+int TextClass::AddSentence(int maxLength)
+{
+	return m_Batch->AddSentence(maxLength);
+}
+
+bool TextClass::UpdateSentence(int sentence, const char* text, int positionX, int positionY, float red, float green, float blue)
+{
+	return m_Batch->SetSentence(sentence, text, positionX, positionY, red, green, blue);
+}
+
+const TextBatchClass::StatsType& TextClass::GetStats()
+{
+	return m_Batch->GetStats();
+}
+
+bool TextClass::SetCpu(int cpu)
 {
 	char tempString[16];
 	char cpuString[16];
@@ -169,8 +238,8 @@ bool TextClass::SetCpu(int cpu, ID3D11DeviceContext* deviceContext)
 	strcat_s(cpuString, tempString);
 	strcat_s(cpuString, "%");
 
-	// Update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence2, cpuString, 20, 40, 0.0f, 1.0f, 0.0f, deviceContext);
+	// Update the sentence with the new string information.
+	result = UpdateSentence(m_cpuSentence, cpuString, 20, 40, 0.0f, 1.0f, 0.0f);
 	if (!result)
 	{
 		return false;
@@ -179,7 +248,7 @@ bool TextClass::SetCpu(int cpu, ID3D11DeviceContext* deviceContext)
 	return true;
 }
 
-bool TextClass::SetFps(int fps, ID3D11DeviceContext* deviceContext)
+bool TextClass::SetFps(int fps)
 {
 	char tempString[16];
 	char fpsString[16];
@@ -223,8 +292,8 @@ bool TextClass::SetFps(int fps, ID3D11DeviceContext* deviceContext)
 		blue = 0.0f;
 	}
 
-	// Update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence1, fpsString, 20, 20, red, green, blue, deviceContext);
+	// Update the sentence with the new string information.
+	result = UpdateSentence(m_fpsSentence, fpsString, 20, 20, red, green, blue);
 	if (!result)
 	{
 		return false;
@@ -233,7 +302,7 @@ bool TextClass::SetFps(int fps, ID3D11DeviceContext* deviceContext)
 	return true;
 }
 
-bool TextClass::SetPolygonNum(int polygonNum, ID3D11DeviceContext* deviceContext)
+bool TextClass::SetPolygonNum(int polygonNum)
 {
 	char tempString[16];
 	char polygonString[16];
@@ -246,8 +315,8 @@ bool TextClass::SetPolygonNum(int polygonNum, ID3D11DeviceContext* deviceContext
 	strcpy_s(polygonString, "Polygon: ");
 	strcat_s(polygonString, tempString);	
 
-	// Update the sentence vertex buffer with the new string information.
-	result = UpdateSentence(m_sentence3, polygonString, 20, 60, 0.0f, 1.0f, 0.0f, deviceContext);
+	// Update the sentence with the new string information.
+	result = UpdateSentence(m_polygonSentence, polygonString, 20, 60, 0.0f, 1.0f, 0.0f);
 	if (!result)
 	{
 		return false;
@@ -256,226 +325,68 @@ bool TextClass::SetPolygonNum(int polygonNum, ID3D11DeviceContext* deviceContext
 	return true;
 }
 
-bool TextClass::InitializeSentence(SentenceType** sentence, int maxLength, ID3D11Device* device)
+bool TextClass::InitializeBuffers(ID3D11Device* device, ResourceRegistryClass* registry)
 {
-	VertexType* vertices;
-	unsigned long* indices;
-	D3D11_BUFFER_DESC vertexBufferDesc, indexBufferDesc;
-	D3D11_SUBRESOURCE_DATA vertexData, indexData;
+	D3D11_BUFFER_DESC vertexBufferDesc;
 	HRESULT result;
-	int i;
-
-	// Create a new sentence object.
-	*sentence = new SentenceType;
-	if (!*sentence)
-	{
-		return false;
-	}
-
-	// Initialize the sentence buffers to null.
-	(*sentence)->vertexBuffer = 0;
-	(*sentence)->indexBuffer = 0;
-
-	// Set the maximum length of the sentence.
-	(*sentence)->maxLength = maxLength;
-
-	// Set the number of vertices in the vertex array.
-	(*sentence)->vertexCount = 6 * maxLength;
-
-	// Set the number of indexes in the index array.
-	(*sentence)->indexCount = (*sentence)->vertexCount;
-
-	// Create the vertex array.
-	vertices = new VertexType[(*sentence)->vertexCount];
-	if (!vertices)
-	{
-		return false;
-	}
-
-	// Create the index array.
-	indices = new unsigned long[(*sentence)->indexCount];
-	if (!indices)
-	{
-		return false;
-	}
-
-	// Initialize vertex array to zeros at first.
-	memset(vertices, 0, (sizeof(VertexType) * (*sentence)->vertexCount));
-
-	// Initialize the index array.
-	for (i = 0; i < (*sentence)->indexCount; i++)
-	{
-		indices[i] = i;
-	}
 
 	// Set up the description of the dynamic vertex buffer.
 	vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-	vertexBufferDesc.ByteWidth = sizeof(VertexType) * (*sentence)->vertexCount;
+	vertexBufferDesc.ByteWidth = sizeof(TextBatchClass::VertexType) * TEXT_RING_VERTEX_COUNT;
 	vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
 	vertexBufferDesc.MiscFlags = 0;
 	vertexBufferDesc.StructureByteStride = 0;
 
-	// Give the subresource structure a pointer to the vertex data.
-	vertexData.pSysMem = vertices;
-	vertexData.SysMemPitch = 0;
-	vertexData.SysMemSlicePitch = 0;
-
-	// Create the vertex buffer.
-	result = device->CreateBuffer(&vertexBufferDesc, &vertexData, &(*sentence)->vertexBuffer);
+	// Create the vertex buffer, it is written before anything is drawn from it.
+	result = device->CreateBuffer(&vertexBufferDesc, NULL, &m_vertexBuffer);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
-	// Set up the description of the static index buffer.
-	indexBufferDesc.Usage = D3D11_USAGE_DEFAULT;
-	indexBufferDesc.ByteWidth = sizeof(unsigned long) * (*sentence)->indexCount;
-	indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	indexBufferDesc.CPUAccessFlags = 0;
-	indexBufferDesc.MiscFlags = 0;
-	indexBufferDesc.StructureByteStride = 0;
-
-	// Give the subresource structure a pointer to the index data.
-	indexData.pSysMem = indices;
-	indexData.SysMemPitch = 0;
-	indexData.SysMemSlicePitch = 0;
-
-	// Create the index buffer.
-	result = device->CreateBuffer(&indexBufferDesc, &indexData, &(*sentence)->indexBuffer);
-	if (FAILED(result))
+	// Every glyph quad is drawn with the shared quad index buffer.
+	m_indexBuffer = registry->GetQuadIndexBuffer(device);
+	if (!m_indexBuffer)
 	{
 		return false;
 	}
 
-	// Release the vertex array as it is no longer needed.
-	delete[] vertices;
-	vertices = 0;
-
-	// Release the index array as it is no longer needed.
-	delete[] indices;
-	indices = 0;
-
 	return true;
 }
 
-bool TextClass::UpdateSentence(SentenceType* sentence, char* text, int positionX, int positionY, float red, float green, float blue, ID3D11DeviceContext* deviceContext)
+bool TextClass::UploadVertices(ID3D11DeviceContext* deviceContext, const TextBatchClass::VertexType* vertices, int count, int& startVertex)
 {
-	int numLetters;
-	VertexType* vertices;
-	float drawX, drawY;
-	HRESULT result;
 	D3D11_MAPPED_SUBRESOURCE mappedResource;
-	VertexType* verticesPtr;
-
-	// Store the color of the sentence.
-	sentence->red = red;
-	sentence->green = green;
-	sentence->blue = blue;
-
-	// Get the number of letters in the sentence.
-	numLetters = (int)strlen(text);
+	D3D11_MAP mapType;
+	HRESULT result;
 
-	// Check for possible buffer overflow.
-	if (numLetters > sentence->maxLength)
+	// After what was written last, which the GPU may still be drawing from, or at the start of a new buffer.
+	if (m_ringOffset + count > TEXT_RING_VERTEX_COUNT)
 	{
-		return false;
+		m_ringOffset = 0;
+		mapType = D3D11_MAP_WRITE_DISCARD;
 	}
-
-	// Create the vertex array.
-	vertices = new VertexType[sentence->vertexCount];
-	if (!vertices)
+	else
 	{
-		return false;
+		mapType = D3D11_MAP_WRITE_NO_OVERWRITE;
 	}
 
-	// Initialize vertex array to zeros at first.
-	memset(vertices, 0, (sizeof(VertexType) * sentence->vertexCount));
-
-	// Calculate the X and Y pixel position on the screen to start drawing to.
-	drawX = (float)(((m_screenWidth / 2) * -1) + positionX);
-	drawY = (float)((m_screenHeight / 2) - positionY);
-
-	// Use the font class to build the vertex array from the sentence text and sentence draw location.
-	m_Font->BuildVertexArray((void*)vertices, text, drawX, drawY);
-
 	// Lock the vertex buffer so it can be written to.
-	result = deviceContext->Map(sentence->vertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
+	result = deviceContext->Map(m_vertexBuffer, 0, mapType, 0, &mappedResource);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
-	// Get a pointer to the data in the vertex buffer.
-	verticesPtr = (VertexType*)mappedResource.pData;
-
 	// Copy the data into the vertex buffer.
-	memcpy(verticesPtr, (void*)vertices, (sizeof(VertexType) * sentence->vertexCount));
-	
-	// Unlock the vertex buffer.
-	deviceContext->Unmap(sentence->vertexBuffer, 0);
-	
-	// Release the vertex array as it is no longer needed.
-	delete[] vertices;
-	vertices = 0;
+	memcpy((TextBatchClass::VertexType*)mappedResource.pData + m_ringOffset, vertices, sizeof(TextBatchClass::VertexType) * count);
 
-	return true;
-}
-
-void TextClass::ReleaseSentence(SentenceType** sentence)
-{
-	if (*sentence)
-	{
-		// Release the sentence vertex buffer.
-		if ((*sentence)->vertexBuffer)
-		{
-			(*sentence)->vertexBuffer->Release();
-			(*sentence)->vertexBuffer = 0;
-		}
-
-		// Release the sentence index buffer.
-		if ((*sentence)->indexBuffer)
-		{
-			(*sentence)->indexBuffer->Release();
-			(*sentence)->indexBuffer = 0;
-		}
-
-		// Release the sentence.
-		delete *sentence;
-		*sentence = 0;
-	}
-
-	return;
-}
-
-bool TextClass::RenderSentence(ID3D11DeviceContext* deviceContext, SentenceType* sentence, D3DXMATRIX worldMatrix, D3DXMATRIX orthoMatrix)
-{
-	unsigned int stride, offset;
-	D3DXVECTOR4 pixelColor;
-	bool result;
-
-	// Set vertex buffer stride and offset.
-	stride = sizeof(VertexType);
-	offset = 0;
-
-	// Set the vertex buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetVertexBuffers(0, 1, &sentence->vertexBuffer, &stride, &offset);
+	// Unlock the vertex buffer.
+	deviceContext->Unmap(m_vertexBuffer, 0);
 
-	// Set the index buffer to active in the input assembler so it can be rendered.
-	deviceContext->IASetIndexBuffer(sentence->indexBuffer, DXGI_FORMAT_R32_UINT, 0);
-	
-	// Set the type of primitive that should be rendered from this vertex buffer, in this case triangles.
-	deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	
-	// Create a pixel color vector with the input sentence color.
-	pixelColor = D3DXVECTOR4(sentence->red, sentence->green, sentence->blue, 1.0f);
-	
-	// Render the text using the font shader.
-	result = m_FontShader->Render(deviceContext, sentence->indexCount, worldMatrix, m_baseViewMatrix, orthoMatrix, m_Font->GetTexture(), pixelColor);
-	if (!result)
-	{
-		false;
-	}
+	startVertex = m_ringOffset;
+	m_ringOffset += count;
 
 	return true;
-}
\ No newline at end of file
+}
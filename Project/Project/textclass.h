@@ -4,50 +4,54 @@
 
 #include "fontclass.h"
 #include "fontshaderclass.h"
+#include "textbatchclass.h"
 
+// Longest sentence the on screen counters set.
+const int TEXT_MAX_LENGTH = 16;
+
+// Vertices the text ring buffer holds.
+const int TEXT_RING_VERTEX_COUNT = TEXT_RING_QUAD_COUNT * TEXT_QUAD_VERTEX_COUNT;
+
+// Any number of sentences, laid out by a TextBatchClass and drawn together in one call. A sentence is added once
+// and set as often as wanted; only the sentences whose text, position or color changed are laid out again. The
+// batch goes into a dynamic ring buffer after the last one written, or at the start when it does not fit, so the
+// GPU can still be drawing the previous frame's text. An unchanged batch is drawn from where it already is; one
+// larger than the ring is uploaded and drawn a ring at a time. The glyph quads are drawn with the registry's
+// quad index buffer, from the ring position they were written at.
 class TextClass
 {
-private:
-	struct SentenceType
-	{
-		ID3D11Buffer *vertexBuffer, *indexBuffer;
-		int vertexCount, indexCount, maxLength;
-		float red, green, blue;
-	};
-
-	struct VertexType
-	{
-		D3DXVECTOR3 position;
-		D3DXVECTOR2 texture;
-	};
-
 public:
 	TextClass();
 	TextClass(const TextClass&);
 	~TextClass();
 
-	bool Initialize(ID3D11Device*, ID3D11DeviceContext*, HWND, int, int, D3DXMATRIX);
+	bool Initialize(ID3D11Device*, ID3D11DeviceContext*, ResourceRegistryClass*, HWND, int, int, D3DXMATRIX);
 	void Shutdown();
 	bool Render(ID3D11DeviceContext*, D3DXMATRIX, D3DXMATRIX);
 
-	bool SetFps(int, ID3D11DeviceContext*);
-	bool SetCpu(int, ID3D11DeviceContext*);
-	bool SetPolygonNum(int, ID3D11DeviceContext*);
+	int AddSentence(int);
+	bool UpdateSentence(int, const char*, int, int, float, float, float);
+
+	bool SetFps(int);
+	bool SetCpu(int);
+	bool SetPolygonNum(int);
+
+	const TextBatchClass::StatsType& GetStats();
 
 private:
-	bool InitializeSentence(SentenceType**, int, ID3D11Device*);
-	bool UpdateSentence(SentenceType*, char*, int, int, float, float, float, ID3D11DeviceContext*);
-	void ReleaseSentence(SentenceType**);
-	bool RenderSentence(ID3D11DeviceContext*, SentenceType*, D3DXMATRIX, D3DXMATRIX);
+	bool InitializeBuffers(ID3D11Device*, ResourceRegistryClass*);
+	bool UploadVertices(ID3D11DeviceContext*, const TextBatchClass::VertexType*, int, int&);
 
 private:
 	FontClass* m_Font;
 	FontShaderClass* m_FontShader;
+	TextBatchClass* m_Batch;
+	ID3D11Buffer *m_vertexBuffer, *m_indexBuffer;
+	int m_ringOffset, m_batchStart;
+	bool m_batchInRing;
 	int m_screenWidth, m_screenHeight;
 	D3DXMATRIX m_baseViewMatrix;
 
-	SentenceType* m_sentence1;
-	SentenceType* m_sentence2;
-	SentenceType* m_sentence3;
+	int m_fpsSentence, m_cpuSentence, m_polygonSentence;
 };
 #endif
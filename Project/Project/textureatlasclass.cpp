@@ -0,0 +1,401 @@
+#include "textureatlasclass.h"
+
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+
+#include "atlaspackerclass.h"
+#include "mipgeneratorclass.h"
+#include "texturecookerclass.h"
+
+TextureAtlasClass::TextureAtlasClass()
+{
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+TextureAtlasClass::TextureAtlasClass(const TextureAtlasClass& other)
+{
+}
+
+TextureAtlasClass::~TextureAtlasClass()
+{
+}
+
+bool TextureAtlasClass::Cook(const vector<string>& sources, const char* atlasFilename, const char* tableFilename, unsigned int format, int threadCount)
+{
+	vector<SourceType> packed;
+	DdsFileClass dds;
+	DdsFileClass::SurfaceType surface;
+	MipGeneratorClass generator;
+	TextureCookerClass cooker;
+	vector<unsigned char> atlas, chain;
+	vector<char> levels, file;
+	ofstream fout;
+	size_t size;
+	unsigned int i;
+	int width, height, mipCount, mip, x, y, sourceX, sourceY;
+	float cellOccupancy;
+	long long sourceTexels;
+	bool result;
+
+	Shutdown();
+
+	if (sources.empty() || (format != DDS_FORMAT_R8G8B8A8_UNORM && !BlockEncoderClass::IsSupported(format)))
+	{
+		return false;
+	}
+
+	// The first level of every source in RGBA, with the cell it needs around it.
+	packed.resize(sources.size());
+	sourceTexels = 0;
+	for (i = 0; i < sources.size(); i++)
+	{
+		result = dds.Initialize(sources[i].c_str()) && dds.GetDimension() == 2 && dds.GetSurface(0, 0, surface) && TextureCookerClass::ConvertToRgba(dds.GetFormat(), surface, 0);
+		if (result)
+		{
+			packed[i].width = (int)surface.width;
+			packed[i].height = (int)surface.height;
+			packed[i].texels.resize((size_t)surface.width * surface.height * 4);
+			TextureCookerClass::ConvertToRgba(dds.GetFormat(), surface, &packed[i].texels[0]);
+		}
+		dds.Shutdown();
+
+		if (!result)
+		{
+			return false;
+		}
+
+		packed[i].cellWidth = (packed[i].width + 2 * ATLAS_GUTTER + ATLAS_ALIGNMENT - 1) / ATLAS_ALIGNMENT * ATLAS_ALIGNMENT;
+		packed[i].cellHeight = (packed[i].height + 2 * ATLAS_GUTTER + ATLAS_ALIGNMENT - 1) / ATLAS_ALIGNMENT * ATLAS_ALIGNMENT;
+		sourceTexels += (long long)packed[i].width * packed[i].height;
+	}
+
+	result = Pack(packed, width, height, cellOccupancy);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Each source fills its whole cell, clamped at its edges, so the levels filter only its own texels.
+	atlas.assign((size_t)width * height * 4, 0);
+	for (i = 0; i < packed.size(); i++)
+	{
+		for (y = 0; y < packed[i].cellHeight; y++)
+		{
+			sourceY = y - ATLAS_GUTTER;
+			sourceY = (sourceY < 0) ? 0 : ((sourceY >= packed[i].height) ? packed[i].height - 1 : sourceY);
+			for (x = 0; x < packed[i].cellWidth; x++)
+			{
+				sourceX = x - ATLAS_GUTTER;
+				sourceX = (sourceX < 0) ? 0 : ((sourceX >= packed[i].width) ? packed[i].width - 1 : sourceX);
+				memcpy(&atlas[((size_t)(packed[i].y + y) * width + packed[i].x + x) * 4], &packed[i].texels[((size_t)sourceY * packed[i].width + sourceX) * 4], 4);
+			}
+		}
+	}
+
+	// A box filter never crosses an aligned cell, any wider one would reach into the neighbours.
+	result = generator.Initialize(threadCount, MIP_FILTER_BOX, true);
+	if (result)
+	{
+		result = generator.Generate(&atlas[0], width, height, width * 4, true, chain);
+	}
+	generator.Shutdown();
+
+	if (!result)
+	{
+		return false;
+	}
+
+	mipCount = MipGeneratorClass::GetLevelCount(width, height);
+	mipCount = (mipCount < ATLAS_MIP_COUNT) ? mipCount : ATLAS_MIP_COUNT;
+
+	size = 0;
+	for (mip = 0; mip < mipCount; mip++)
+	{
+		size += (size_t)(width >> mip) * (height >> mip) * 4;
+	}
+
+	levels.resize(DDS_WRITTEN_HEADER_SIZE + size);
+	DdsFileClass::WriteHeader(DDS_FORMAT_R8G8B8A8_UNORM, width, height, mipCount, 1, false, &levels[0]);
+	memcpy(&levels[DDS_WRITTEN_HEADER_SIZE], &chain[0], size);
+
+	// Block compress the levels as they are, or keep them as RGBA.
+	if (format == DDS_FORMAT_R8G8B8A8_UNORM)
+	{
+		file.swap(levels);
+	}
+	else
+	{
+		result = dds.InitializeFromMemory(&levels[0], levels.size());
+		if (result)
+		{
+			result = cooker.Initialize(threadCount, BLOCK_QUALITY_NORMAL, MIP_FILTER_NONE, true);
+		}
+		if (result)
+		{
+			result = cooker.Cook(&dds, format, file);
+		}
+		cooker.Shutdown();
+		dds.Shutdown();
+
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	fout.open(atlasFilename, ios::out | ios::binary | ios::trunc);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout.write(&file[0], (streamsize)file.size());
+
+	fout.close();
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	// The table places each source inside its gutter.
+	m_atlasName = GetFileName(atlasFilename);
+	m_entries.resize(packed.size());
+	for (i = 0; i < packed.size(); i++)
+	{
+		m_entries[i].name = GetFileName(sources[i]);
+		m_entries[i].x = packed[i].x + ATLAS_GUTTER;
+		m_entries[i].y = packed[i].y + ATLAS_GUTTER;
+		m_entries[i].width = packed[i].width;
+		m_entries[i].height = packed[i].height;
+	}
+
+	m_stats.width = width;
+	m_stats.height = height;
+	m_stats.mipCount = mipCount;
+	m_stats.entryCount = (int)m_entries.size();
+	m_stats.occupancy = (float)((double)sourceTexels / ((double)width * height));
+	m_stats.cellOccupancy = cellOccupancy;
+
+	return WriteTable(tableFilename);
+}
+
+bool TextureAtlasClass::Initialize(const char* tableFilename)
+{
+	ifstream fin;
+	EntryType entry;
+	long long sourceTexels;
+
+	Shutdown();
+
+	fin.open(tableFilename);
+	if (fin.fail())
+	{
+		return false;
+	}
+
+	fin >> m_atlasName >> m_stats.width >> m_stats.height >> m_stats.mipCount;
+	if (fin.fail() || m_stats.width <= 0 || m_stats.height <= 0)
+	{
+		Shutdown();
+		return false;
+	}
+
+	// An entry per line until the end of the file.
+	sourceTexels = 0;
+	while (fin >> entry.name >> entry.x >> entry.y >> entry.width >> entry.height)
+	{
+		if (entry.x < 0 || entry.y < 0 || entry.width <= 0 || entry.height <= 0 || entry.x + entry.width > m_stats.width || entry.y + entry.height > m_stats.height)
+		{
+			Shutdown();
+			return false;
+		}
+
+		m_entries.push_back(entry);
+		sourceTexels += (long long)entry.width * entry.height;
+	}
+
+	if (!fin.eof())
+	{
+		Shutdown();
+		return false;
+	}
+
+	m_stats.entryCount = (int)m_entries.size();
+	m_stats.occupancy = (float)((double)sourceTexels / ((double)m_stats.width * m_stats.height));
+	m_stats.cellOccupancy = 0.0f;
+
+	return true;
+}
+
+void TextureAtlasClass::Shutdown()
+{
+	m_entries.clear();
+	m_atlasName.clear();
+	memset(&m_stats, 0, sizeof(m_stats));
+
+	return;
+}
+
+bool TextureAtlasClass::GetRemap(const char* filename, RemapType& remap)
+{
+	string name;
+	unsigned int i;
+
+	name = GetFileName(filename);
+	for (i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries[i].name == name)
+		{
+			remap.uScale = (float)m_entries[i].width / (float)m_stats.width;
+			remap.vScale = (float)m_entries[i].height / (float)m_stats.height;
+			remap.uOffset = (float)m_entries[i].x / (float)m_stats.width;
+			remap.vOffset = (float)m_entries[i].y / (float)m_stats.height;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+const string& TextureAtlasClass::GetAtlasName()
+{
+	return m_atlasName;
+}
+
+int TextureAtlasClass::GetEntryCount()
+{
+	return (int)m_entries.size();
+}
+
+const TextureAtlasClass::EntryType& TextureAtlasClass::GetEntry(int index)
+{
+	return m_entries[index];
+}
+
+const TextureAtlasClass::StatsType& TextureAtlasClass::GetStats()
+{
+	return m_stats;
+}
+
+string TextureAtlasClass::GetFileName(const string& path)
+{
+	size_t slash;
+
+	slash = path.find_last_of("/\\");
+
+	return (slash == string::npos) ? path : path.substr(slash + 1);
+}
+
+bool TextureAtlasClass::Pack(vector<SourceType>& packed, int& width, int& height, float& cellOccupancy)
+{
+	vector<int> order;
+	long long cellArea;
+	unsigned int i, j;
+	int index, maxWidth, maxHeight, area;
+
+	// Largest side first, then largest area, the order MaxRects packs tightest in.
+	cellArea = 0;
+	maxWidth = 0;
+	maxHeight = 0;
+	for (i = 0; i < packed.size(); i++)
+	{
+		index = (int)i;
+		for (j = (unsigned int)order.size(); j > 0; j--)
+		{
+			const SourceType& other = packed[order[j - 1]];
+			if (max(other.cellWidth, other.cellHeight) > max(packed[i].cellWidth, packed[i].cellHeight) ||
+				(max(other.cellWidth, other.cellHeight) == max(packed[i].cellWidth, packed[i].cellHeight) && other.cellWidth * other.cellHeight >= packed[i].cellWidth * packed[i].cellHeight))
+			{
+				break;
+			}
+		}
+		order.insert(order.begin() + j, index);
+
+		cellArea += (long long)packed[i].cellWidth * packed[i].cellHeight;
+		maxWidth = (packed[i].cellWidth > maxWidth) ? packed[i].cellWidth : maxWidth;
+		maxHeight = (packed[i].cellHeight > maxHeight) ? packed[i].cellHeight : maxHeight;
+	}
+
+	// The smallest power of two sizes first, of the same area the squarest.
+	for (area = ATLAS_ALIGNMENT * ATLAS_ALIGNMENT; area <= ATLAS_MAX_SIZE * ATLAS_MAX_SIZE; area *= 2)
+	{
+		if ((long long)area < cellArea)
+		{
+			continue;
+		}
+
+		for (width = 1; width * width < area; width *= 2)
+		{
+		}
+
+		for (; width <= ATLAS_MAX_SIZE && width <= area; width *= 2)
+		{
+			height = area / width;
+			if (height > ATLAS_MAX_SIZE)
+			{
+				continue;
+			}
+
+			if (width >= maxWidth && height >= maxHeight && TryPack(packed, order, width, height, cellOccupancy))
+			{
+				return true;
+			}
+
+			if (width != height && height >= maxWidth && width >= maxHeight && TryPack(packed, order, height, width, cellOccupancy))
+			{
+				swap(width, height);
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool TextureAtlasClass::TryPack(vector<SourceType>& packed, const vector<int>& order, int width, int height, float& cellOccupancy)
+{
+	AtlasPackerClass packer;
+	unsigned int i;
+	int x, y;
+	bool result;
+
+	// In units of the alignment, every cell lands on it.
+	result = packer.Initialize(width / ATLAS_ALIGNMENT, height / ATLAS_ALIGNMENT);
+	for (i = 0; result && i < order.size(); i++)
+	{
+		result = packer.Insert(packed[order[i]].cellWidth / ATLAS_ALIGNMENT, packed[order[i]].cellHeight / ATLAS_ALIGNMENT, x, y);
+		if (result)
+		{
+			packed[order[i]].x = x * ATLAS_ALIGNMENT;
+			packed[order[i]].y = y * ATLAS_ALIGNMENT;
+		}
+	}
+
+	cellOccupancy = packer.GetOccupancy();
+	packer.Shutdown();
+
+	return result;
+}
+
+bool TextureAtlasClass::WriteTable(const char* tableFilename)
+{
+	ofstream fout;
+	unsigned int i;
+
+	fout.open(tableFilename, ios::out | ios::trunc);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout << m_atlasName << " " << m_stats.width << " " << m_stats.height << " " << m_stats.mipCount << "\n";
+	for (i = 0; i < m_entries.size(); i++)
+	{
+		fout << m_entries[i].name << " " << m_entries[i].x << " " << m_entries[i].y << " " << m_entries[i].width << " " << m_entries[i].height << "\n";
+	}
+
+	fout.close();
+
+	return !fout.fail();
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#ifndef _TEXTUREATLASCLASS_H_
+#define _TEXTUREATLASCLASS_H_
+
+#include <string>
+#include <vector>
+
+#include "ddsfileclass.h"
+using namespace std;
+
+// Levels an atlas keeps. Every entry sits in a cell aligned to a BC block of the smallest of them, so no
+// block and no box filtered texel of any level mixes two entries, and the cell around an entry repeats its
+// edge texels at least one texel of the smallest level wide.
+const int ATLAS_MIP_COUNT = 4;
+const int ATLAS_ALIGNMENT = 4 << (ATLAS_MIP_COUNT - 1);
+const int ATLAS_GUTTER = 1 << (ATLAS_MIP_COUNT - 1);
+const int ATLAS_MAX_SIZE = 4096;
+
+// Many small textures in one, so what is drawn with them shares a texture bind. Cook reads the first level
+// of every source dds, packs their cells with AtlasPackerClass into the smallest power of two atlas they fit
+// in, fills each cell with its source clamped to the cell, box filters the levels in linear light and writes
+// the atlas in the given format (block compressed by TextureCookerClass, or RGBA) with a table next to it.
+// The table is text: the atlas file name, size and level count, then a line per source with its file name
+// and where its texels are in the atlas.
+//
+// Initialize reads a table back. GetRemap finds a source by its file name, whatever directory it is asked
+// for from, and gives the scale and offset that move its texture coordinates into the atlas.
+class TextureAtlasClass
+{
+public:
+	struct EntryType
+	{
+		string name;
+		int x, y, width, height;
+	};
+
+	// u' = u * uScale + uOffset and the same for v.
+	struct RemapType
+	{
+		float uScale, vScale, uOffset, vOffset;
+	};
+
+	// Texels of the sources against those of the atlas, and the same for the cells they were packed in.
+	struct StatsType
+	{
+		int width, height, mipCount, entryCount;
+		float occupancy, cellOccupancy;
+	};
+
+private:
+	struct SourceType
+	{
+		vector<unsigned char> texels;
+		int width, height, cellWidth, cellHeight, x, y;
+	};
+
+public:
+	TextureAtlasClass();
+	TextureAtlasClass(const TextureAtlasClass&);
+	~TextureAtlasClass();
+
+	bool Cook(const vector<string>&, const char*, const char*, unsigned int, int);
+	bool Initialize(const char*);
+	void Shutdown();
+
+	bool GetRemap(const char*, RemapType&);
+	const string& GetAtlasName();
+	int GetEntryCount();
+	const EntryType& GetEntry(int);
+	const StatsType& GetStats();
+
+	static string GetFileName(const string&);
+
+private:
+	bool Pack(vector<SourceType>&, int&, int&, float&);
+	bool TryPack(vector<SourceType>&, const vector<int>&, int, int, float&);
+	bool WriteTable(const char*);
+
+private:
+	vector<EntryType> m_entries;
+	string m_atlasName;
+	StatsType m_stats;
+};
+#endif
@@ -0,0 +1,400 @@
+#include "texturecacheclass.h"
+
+#include <string.h>
+#include <chrono>
+
+#include "ddsfileclass.h"
+
+TextureCacheClass::TextureCacheClass()
+{
+	m_budgetBytes = 0;
+	m_residentBytes = 0;
+	m_frame = 0;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+TextureCacheClass::TextureCacheClass(const TextureCacheClass& other)
+{
+}
+
+TextureCacheClass::~TextureCacheClass()
+{
+}
+
+bool TextureCacheClass::Initialize(size_t budgetBytes, const function<bool(int, int)>& setFirstMip)
+{
+	if (!setFirstMip)
+	{
+		return false;
+	}
+
+	m_budgetBytes = budgetBytes;
+	m_setFirstMip = setFirstMip;
+	m_residentBytes = 0;
+	m_frame = 0;
+
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_stats.budgetBytes = budgetBytes;
+
+	return true;
+}
+
+void TextureCacheClass::Shutdown()
+{
+	// The holders release their own textures, only forget about them.
+	m_entries.clear();
+	m_setFirstMip = nullptr;
+	m_residentBytes = 0;
+
+	return;
+}
+
+int TextureCacheClass::Add(unsigned int format, int width, int height, int mipCount, int arraySize, int firstMip)
+{
+	EntryType entry;
+	unsigned int i;
+
+	if (width <= 0 || height <= 0 || mipCount <= 0 || arraySize <= 0 || firstMip < 0 || firstMip > mipCount)
+	{
+		return -1;
+	}
+
+	// Added with the levels it has from firstMip down and as drawn the frame before, the last of the unused
+	// textures to be evicted.
+	entry.format = format;
+	entry.width = width;
+	entry.height = height;
+	entry.mipCount = mipCount;
+	entry.arraySize = arraySize;
+	entry.firstMip = firstMip;
+	entry.lastUsed = m_frame - 1;
+	entry.active = true;
+	entry.failed = false;
+
+	for (entry.tailMip = 0; entry.tailMip < mipCount - 1; entry.tailMip++)
+	{
+		if ((width >> entry.tailMip) <= TEXTURE_TAIL_SIZE && (height >> entry.tailMip) <= TEXTURE_TAIL_SIZE)
+		{
+			break;
+		}
+	}
+
+	m_residentBytes += GetResidentBytes(entry, firstMip);
+
+	for (i = 0; i < m_entries.size(); i++)
+	{
+		if (!m_entries[i].active)
+		{
+			m_entries[i] = entry;
+			return (int)i;
+		}
+	}
+
+	m_entries.push_back(entry);
+
+	return (int)m_entries.size() - 1;
+}
+
+void TextureCacheClass::Remove(int id)
+{
+	if (id < 0 || id >= (int)m_entries.size() || !m_entries[id].active)
+	{
+		return;
+	}
+
+	m_residentBytes -= GetResidentBytes(m_entries[id], m_entries[id].firstMip);
+	m_entries[id].active = false;
+
+	return;
+}
+
+void TextureCacheClass::ReportReload(int id, bool result, double milliseconds)
+{
+	if (id < 0 || id >= (int)m_entries.size() || !m_entries[id].active)
+	{
+		return;
+	}
+
+	EntryType& entry = m_entries[id];
+
+	// The frame already counted the reload, only its time is added, to the frame and to the totals.
+	m_stats.reloadMilliseconds += milliseconds;
+	m_stats.maxReloadMilliseconds = (milliseconds > m_stats.maxReloadMilliseconds) ? milliseconds : m_stats.maxReloadMilliseconds;
+	m_stats.totalReloadMilliseconds += milliseconds;
+	m_stats.worstReloadMilliseconds = (milliseconds > m_stats.worstReloadMilliseconds) ? milliseconds : m_stats.worstReloadMilliseconds;
+
+	// Whatever failed to load left nothing behind.
+	if (!result)
+	{
+		m_residentBytes -= GetResidentBytes(entry, entry.firstMip);
+		entry.firstMip = entry.mipCount;
+		entry.failed = true;
+		m_stats.failures++;
+	}
+
+	return;
+}
+
+void TextureCacheClass::Touch(int id)
+{
+	if (id < 0 || id >= (int)m_entries.size())
+	{
+		return;
+	}
+
+	m_entries[id].lastUsed = m_frame;
+
+	return;
+}
+
+void TextureCacheClass::Frame()
+{
+	vector<int> wanted;
+	size_t needed, bytes, largest;
+	unsigned int i, j;
+	int id, mip;
+
+	m_stats.evictions = 0;
+	m_stats.mipDrops = 0;
+	m_stats.reloads = 0;
+	m_stats.failures = 0;
+	m_stats.reloadMilliseconds = 0.0;
+	m_stats.maxReloadMilliseconds = 0.0;
+
+	// The textures drawn this frame without all their detail, those that are cheapest to complete first.
+	for (i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries[i].active && !m_entries[i].failed && m_entries[i].lastUsed == m_frame && m_entries[i].firstMip > 0)
+		{
+			wanted.push_back((int)i);
+		}
+	}
+
+	for (i = 1; i < wanted.size(); i++)
+	{
+		id = wanted[i];
+		needed = GetResidentBytes(m_entries[id], 0) - GetResidentBytes(m_entries[id], m_entries[id].firstMip);
+		for (j = i; j > 0 && GetResidentBytes(m_entries[wanted[j - 1]], 0) - GetResidentBytes(m_entries[wanted[j - 1]], m_entries[wanted[j - 1]].firstMip) > needed; j--)
+		{
+			wanted[j] = wanted[j - 1];
+		}
+		wanted[j] = id;
+	}
+
+	// Bring each one up as far as the budget allows once the unused textures made room. One that was evicted
+	// entirely gets at least its small levels back, whatever the budget.
+	for (i = 0; i < wanted.size(); i++)
+	{
+		id = wanted[i];
+		bytes = GetResidentBytes(m_entries[id], m_entries[id].firstMip);
+		MakeRoom(GetResidentBytes(m_entries[id], 0) - bytes);
+
+		for (mip = 0; mip < m_entries[id].firstMip; mip++)
+		{
+			if (m_residentBytes - bytes + GetResidentBytes(m_entries[id], mip) <= m_budgetBytes)
+			{
+				break;
+			}
+		}
+
+		if (mip == m_entries[id].firstMip && m_entries[id].firstMip == m_entries[id].mipCount)
+		{
+			mip = m_entries[id].tailMip;
+		}
+
+		if (mip < m_entries[id].firstMip)
+		{
+			SetFirstMip(id, mip);
+		}
+	}
+
+	// Keep to the budget with the textures nobody drew, then by dropping the top level of the largest one
+	// that was drawn until it fits.
+	MakeRoom(0);
+	while (m_residentBytes > m_budgetBytes)
+	{
+		id = -1;
+		largest = 0;
+		for (i = 0; i < m_entries.size(); i++)
+		{
+			if (!m_entries[i].active || m_entries[i].firstMip >= m_entries[i].mipCount - 1)
+			{
+				continue;
+			}
+
+			bytes = GetResidentBytes(m_entries[i], m_entries[i].firstMip);
+			if (bytes > largest)
+			{
+				id = (int)i;
+				largest = bytes;
+			}
+		}
+
+		if (id < 0)
+		{
+			break;
+		}
+
+		SetFirstMip(id, m_entries[id].firstMip + 1);
+		m_stats.mipDrops++;
+	}
+
+	// Residency as the next frame starts.
+	m_stats.budgetBytes = m_budgetBytes;
+	m_stats.residentBytes = m_residentBytes;
+	m_stats.peakResidentBytes = (m_residentBytes > m_stats.peakResidentBytes) ? m_residentBytes : m_stats.peakResidentBytes;
+	m_stats.fullBytes = 0;
+	m_stats.textureCount = 0;
+	m_stats.reducedCount = 0;
+	m_stats.evictedCount = 0;
+	for (i = 0; i < m_entries.size(); i++)
+	{
+		if (!m_entries[i].active)
+		{
+			continue;
+		}
+
+		m_stats.fullBytes += GetResidentBytes(m_entries[i], 0);
+		m_stats.textureCount++;
+		m_stats.reducedCount += (m_entries[i].firstMip > 0 && m_entries[i].firstMip < m_entries[i].mipCount) ? 1 : 0;
+		m_stats.evictedCount += (m_entries[i].firstMip == m_entries[i].mipCount) ? 1 : 0;
+	}
+
+	m_stats.frameCount++;
+	m_stats.totalEvictions += m_stats.evictions;
+	m_stats.totalMipDrops += m_stats.mipDrops;
+	m_stats.totalReloads += m_stats.reloads;
+	m_stats.totalReloadMilliseconds += m_stats.reloadMilliseconds;
+	m_stats.worstReloadMilliseconds = (m_stats.maxReloadMilliseconds > m_stats.worstReloadMilliseconds) ? m_stats.maxReloadMilliseconds : m_stats.worstReloadMilliseconds;
+
+	m_frame++;
+
+	return;
+}
+
+int TextureCacheClass::GetFirstMip(int id)
+{
+	if (id < 0 || id >= (int)m_entries.size() || !m_entries[id].active)
+	{
+		return 0;
+	}
+
+	return m_entries[id].firstMip;
+}
+
+const TextureCacheClass::StatsType& TextureCacheClass::GetStats()
+{
+	return m_stats;
+}
+
+size_t TextureCacheClass::GetBytes(unsigned int format, int width, int height, int mipCount, int arraySize, int firstMip)
+{
+	unsigned int blockBytes, bitsPerPixel;
+	size_t bytes;
+	int mip, levelWidth, levelHeight;
+
+	// Formats the dds reader does not know are taken as 4 bytes a texel, like TextureClass measures them.
+	DdsFileClass::GetFormatSize(format, blockBytes, bitsPerPixel);
+	bitsPerPixel = (blockBytes == 0 && bitsPerPixel == 0) ? 32 : bitsPerPixel;
+
+	bytes = 0;
+	for (mip = firstMip; mip < mipCount; mip++)
+	{
+		levelWidth = (width >> mip > 0) ? width >> mip : 1;
+		levelHeight = (height >> mip > 0) ? height >> mip : 1;
+		if (blockBytes)
+		{
+			bytes += (size_t)((levelWidth + 3) / 4) * ((levelHeight + 3) / 4) * blockBytes;
+		}
+		else
+		{
+			bytes += (size_t)levelWidth * levelHeight * bitsPerPixel / 8;
+		}
+	}
+
+	return bytes * arraySize;
+}
+
+size_t TextureCacheClass::GetResidentBytes(const EntryType& entry, int firstMip)
+{
+	return GetBytes(entry.format, entry.width, entry.height, entry.mipCount, entry.arraySize, firstMip);
+}
+
+void TextureCacheClass::MakeRoom(size_t extraBytes)
+{
+	unsigned int i;
+	int id, target;
+
+	// Evict the least recently drawn texture that was not drawn this frame, down to its small levels while
+	// any has more, then entirely. Of two drawn in the same frame the larger one goes first.
+	while (m_residentBytes + extraBytes > m_budgetBytes)
+	{
+		id = -1;
+		for (target = 0; target < 2 && id < 0; target++)
+		{
+			for (i = 0; i < m_entries.size(); i++)
+			{
+				if (!m_entries[i].active || m_entries[i].lastUsed == m_frame ||
+					m_entries[i].firstMip >= ((target == 0) ? m_entries[i].tailMip : m_entries[i].mipCount))
+				{
+					continue;
+				}
+
+				if (id < 0 || m_entries[i].lastUsed < m_entries[id].lastUsed ||
+					(m_entries[i].lastUsed == m_entries[id].lastUsed && GetResidentBytes(m_entries[i], m_entries[i].firstMip) > GetResidentBytes(m_entries[id], m_entries[id].firstMip)))
+				{
+					id = (int)i;
+				}
+			}
+
+			if (id >= 0)
+			{
+				SetFirstMip(id, (target == 0) ? m_entries[id].tailMip : m_entries[id].mipCount);
+				m_stats.evictions++;
+			}
+		}
+
+		if (id < 0)
+		{
+			return;
+		}
+	}
+
+	return;
+}
+
+void TextureCacheClass::SetFirstMip(int id, int firstMip)
+{
+	EntryType& entry = m_entries[id];
+	chrono::high_resolution_clock::time_point start;
+	double milliseconds;
+	bool result, reload;
+
+	reload = (firstMip < entry.firstMip);
+
+	start = chrono::high_resolution_clock::now();
+	result = m_setFirstMip(id, firstMip);
+	milliseconds = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+
+	m_residentBytes -= GetResidentBytes(entry, entry.firstMip);
+
+	// Whatever failed to load left nothing behind.
+	if (!result)
+	{
+		firstMip = entry.mipCount;
+		entry.failed = true;
+		m_stats.failures++;
+	}
+
+	entry.firstMip = firstMip;
+	m_residentBytes += GetResidentBytes(entry, entry.firstMip);
+
+	if (reload)
+	{
+		m_stats.reloads++;
+		m_stats.reloadMilliseconds += milliseconds;
+		m_stats.maxReloadMilliseconds = (milliseconds > m_stats.maxReloadMilliseconds) ? milliseconds : m_stats.maxReloadMilliseconds;
+	}
+
+	return;
+}
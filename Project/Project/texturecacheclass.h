@@ -0,0 +1,81 @@
+#pragma once
+
+#ifndef _TEXTURECACHECLASS_H_
+#define _TEXTURECACHECLASS_H_
+
+#include <vector>
+#include <functional>
+using namespace std;
+
+// Largest side of the levels a texture that is not drawn any more is first reduced to, before it is evicted
+// entirely. They cost a few kilobytes and leave something to draw when it comes back into view.
+const int TEXTURE_TAIL_SIZE = 64;
+
+// Keeps the textures on the GPU within a byte budget. Each texture is added with its format and size when it
+// is uploaded, together with the first level it has, which is 0 for all of them. Its holder calls Touch for every
+// frame it was drawn in. Once a frame, Frame brings the textures drawn at less than full detail back up as far
+// as the budget allows. Then it evicts the least recently used of the others: first down to their levels of
+// TEXTURE_TAIL_SIZE or less, then out entirely.
+// If the textures in use alone are over the budget their top levels are dropped, largest texture first.
+//
+// The cache only decides. Every change goes through the function given to Initialize, called with the
+// texture and the first level to keep, the texture's level count to release it, and returning whether it
+// could; a texture that failed to load has nothing resident and is not tried again. A holder may also say yes
+// and carry a reload out after Frame, then it reports with ReportReload how long it took and whether it worked.
+// Not thread safe, the holder serializes the calls.
+class TextureCacheClass
+{
+public:
+	// Residency after the last Frame, what that frame changed, and the totals since Initialize. Reload times
+	// are those of the calls that raised a texture's detail, in milliseconds.
+	struct StatsType
+	{
+		size_t budgetBytes, residentBytes, fullBytes, peakResidentBytes;
+		int textureCount, reducedCount, evictedCount;
+		int evictions, mipDrops, reloads, failures;
+		double reloadMilliseconds, maxReloadMilliseconds;
+		int frameCount, totalEvictions, totalMipDrops, totalReloads;
+		double totalReloadMilliseconds, worstReloadMilliseconds;
+	};
+
+private:
+	struct EntryType
+	{
+		unsigned int format;
+		int width, height, mipCount, arraySize;
+		int firstMip, tailMip, lastUsed;
+		bool active, failed;
+	};
+
+public:
+	TextureCacheClass();
+	TextureCacheClass(const TextureCacheClass&);
+	~TextureCacheClass();
+
+	bool Initialize(size_t, const function<bool(int, int)>&);
+	void Shutdown();
+
+	int Add(unsigned int, int, int, int, int, int);
+	void Remove(int);
+	void Touch(int);
+	void Frame();
+	void ReportReload(int, bool, double);
+
+	int GetFirstMip(int);
+	const StatsType& GetStats();
+
+	static size_t GetBytes(unsigned int, int, int, int, int, int);
+
+private:
+	size_t GetResidentBytes(const EntryType&, int);
+	void MakeRoom(size_t);
+	void SetFirstMip(int, int);
+
+private:
+	vector<EntryType> m_entries;
+	function<bool(int, int)> m_setFirstMip;
+	size_t m_budgetBytes, m_residentBytes;
+	int m_frame;
+	StatsType m_stats;
+};
+#endif
@@ -1,8 +1,23 @@
 #include "textureclass.h"
 
+#include <utility>
+using namespace std;
+
+// The texture bound to the first pixel shader slot, and the binds made and left out since the start.
+static ID3D11ShaderResourceView* s_boundTexture = 0;
+static unsigned long long s_bindCount = 0;
+static unsigned long long s_bindsSkipped = 0;
+
 TextureClass::TextureClass()
 {
 	m_texture = 0;
+	m_memorySize = 0;
+	m_format = 0;
+	m_width = 0;
+	m_height = 0;
+	m_mipCount = 0;
+	m_arraySize = 0;
+	m_used = false;
 }
 
 TextureClass::TextureClass(const TextureClass& other)
@@ -15,15 +30,233 @@ TextureClass::~TextureClass()
 
 bool TextureClass::Initialize(ID3D11Device* device, WCHAR* filename)
 {
+	DdsFileClass* dds;
 	HRESULT result;
+	bool direct;
+
+	// Create the dds file object.
+	dds = new DdsFileClass;
+	if (!dds)
+	{
+		return false;
+	}
 
-	// Load the texture in.
+	// A dds file that can be sampled as stored is created straight from the file mapping.
+	direct = dds->Initialize(filename) && IsDirectUpload(dds);
+	if (direct)
+	{
+		direct = InitializeFromDds(device, dds, 0);
+	}
+
+	dds->Shutdown();
+	delete dds;
+	dds = 0;
+
+	if (direct)
+	{
+		return true;
+	}
+
+	// Anything else is converted and given its mip chain by D3DX.
 	result = D3DX11CreateShaderResourceViewFromFile(device, filename, NULL, NULL, &m_texture, NULL);
 	if (FAILED(result))
 	{
 		return false;
 	}
 
+	MeasureMemory();
+
+	return true;
+}
+
+bool TextureClass::InitializeFromMemory(ID3D11Device* device, const void* data, size_t size, int firstMip)
+{
+	D3DX11_IMAGE_INFO imageInfo;
+	D3DX11_IMAGE_LOAD_INFO loadInfo;
+	DdsFileClass* dds;
+	HRESULT result;
+	bool direct;
+
+	// Create the dds file object.
+	dds = new DdsFileClass;
+	if (!dds)
+	{
+		return false;
+	}
+
+	// A dds file that can be sampled as stored is created straight from the memory it was read into.
+	direct = dds->InitializeFromMemory((const char*)data, size) && IsDirectUpload(dds);
+	if (direct)
+	{
+		direct = InitializeFromDds(device, dds, firstMip);
+	}
+
+	dds->Shutdown();
+	delete dds;
+	dds = 0;
+
+	if (direct)
+	{
+		return true;
+	}
+
+	// Leaving out levels of a file D3DX converts means loading it at the size of the first level kept.
+	if (firstMip > 0)
+	{
+		result = D3DX11GetImageInfoFromMemory(data, size, NULL, &imageInfo, NULL);
+		if (FAILED(result))
+		{
+			return false;
+		}
+
+		loadInfo.Width = (imageInfo.Width >> firstMip > 0) ? imageInfo.Width >> firstMip : 1;
+		loadInfo.Height = (imageInfo.Height >> firstMip > 0) ? imageInfo.Height >> firstMip : 1;
+	}
+
+	// Create the texture from a file that was already read in, so only the resource creation happens here.
+	result = D3DX11CreateShaderResourceViewFromMemory(device, data, size, (firstMip > 0) ? &loadInfo : NULL, NULL, &m_texture, NULL);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	MeasureMemory();
+
+	return true;
+}
+
+bool TextureClass::InitializeFromColor(ID3D11Device* device, unsigned int color)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SUBRESOURCE_DATA textureData;
+	ID3D11Texture2D* texture;
+	HRESULT result;
+
+	// Set up the description of a single texel texture.
+	textureDesc.Width = 1;
+	textureDesc.Height = 1;
+	textureDesc.MipLevels = 1;
+	textureDesc.ArraySize = 1;
+	textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = 0;
+
+	// The color is the texel, red in the lowest byte.
+	textureData.pSysMem = &color;
+	textureData.SysMemPitch = sizeof(color);
+	textureData.SysMemSlicePitch = 0;
+
+	result = device->CreateTexture2D(&textureDesc, &textureData, &texture);
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Create the shader resource view, which holds its own reference to the texture.
+	result = device->CreateShaderResourceView(texture, NULL, &m_texture);
+	texture->Release();
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	MeasureMemory();
+
+	return true;
+}
+
+bool TextureClass::InitializeFromDds(ID3D11Device* device, DdsFileClass* dds, int firstMip)
+{
+	D3D11_TEXTURE2D_DESC textureDesc;
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+	D3D11_SUBRESOURCE_DATA* textureData;
+	DdsFileClass::SurfaceType surface;
+	ID3D11Texture2D* texture;
+	HRESULT result;
+	int item, mip;
+
+	// Only 2D textures, arrays and cube maps in a format Direct3D samples as stored, keeping at least a level.
+	if (dds->GetDimension() != 2 || !DdsFileClass::IsDxgiFormat(dds->GetFormat()) || firstMip < 0 || firstMip >= dds->GetMipCount())
+	{
+		return false;
+	}
+
+	// Set up the description of the texture as the file describes it, from the first level kept.
+	textureDesc.Width = (UINT)((dds->GetWidth() >> firstMip > 0) ? dds->GetWidth() >> firstMip : 1);
+	textureDesc.Height = (UINT)((dds->GetHeight() >> firstMip > 0) ? dds->GetHeight() >> firstMip : 1);
+	textureDesc.MipLevels = (UINT)(dds->GetMipCount() - firstMip);
+	textureDesc.ArraySize = (UINT)dds->GetArraySize();
+	textureDesc.Format = (DXGI_FORMAT)dds->GetFormat();
+	textureDesc.SampleDesc.Count = 1;
+	textureDesc.SampleDesc.Quality = 0;
+	textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	textureDesc.CPUAccessFlags = 0;
+	textureDesc.MiscFlags = dds->IsCubemap() ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+	// One subresource per mip level of every slice, each pointing into the file, so nothing is copied here.
+	textureData = new D3D11_SUBRESOURCE_DATA[textureDesc.MipLevels * dds->GetArraySize()];
+	if (!textureData)
+	{
+		return false;
+	}
+
+	for (item = 0; item < dds->GetArraySize(); item++)
+	{
+		for (mip = 0; mip < (int)textureDesc.MipLevels; mip++)
+		{
+			dds->GetSurface(firstMip + mip, item, surface);
+			textureData[item * textureDesc.MipLevels + mip].pSysMem = surface.data;
+			textureData[item * textureDesc.MipLevels + mip].SysMemPitch = surface.rowPitch;
+			textureData[item * textureDesc.MipLevels + mip].SysMemSlicePitch = surface.slicePitch;
+		}
+	}
+
+	result = device->CreateTexture2D(&textureDesc, textureData, &texture);
+	delete[] textureData;
+	textureData = 0;
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	// Set up the view, a cube map is sampled as one.
+	viewDesc.Format = textureDesc.Format;
+	if (dds->IsCubemap())
+	{
+		viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+		viewDesc.TextureCube.MostDetailedMip = 0;
+		viewDesc.TextureCube.MipLevels = textureDesc.MipLevels;
+	}
+	else if (textureDesc.ArraySize > 1)
+	{
+		viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+		viewDesc.Texture2DArray.MostDetailedMip = 0;
+		viewDesc.Texture2DArray.MipLevels = textureDesc.MipLevels;
+		viewDesc.Texture2DArray.FirstArraySlice = 0;
+		viewDesc.Texture2DArray.ArraySize = textureDesc.ArraySize;
+	}
+	else
+	{
+		viewDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+		viewDesc.Texture2D.MostDetailedMip = 0;
+		viewDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+	}
+
+	// Create the shader resource view, which holds its own reference to the texture.
+	result = device->CreateShaderResourceView(texture, &viewDesc, &m_texture);
+	texture->Release();
+	if (FAILED(result))
+	{
+		return false;
+	}
+
+	MeasureMemory();
+
 	return true;
 }
 
@@ -36,10 +269,206 @@ void TextureClass::Shutdown()
 		m_texture = 0;
 	}
 
+	m_memorySize = 0;
+	m_format = 0;
+	m_width = 0;
+	m_height = 0;
+	m_mipCount = 0;
+	m_arraySize = 0;
+
+	return;
+}
+
+void TextureClass::Swap(TextureClass& other)
+{
+	// Everything but whether it was drawn, which belongs to whoever draws it.
+	swap(m_texture, other.m_texture);
+	swap(m_memorySize, other.m_memorySize);
+	swap(m_format, other.m_format);
+	swap(m_width, other.m_width);
+	swap(m_height, other.m_height);
+	swap(m_mipCount, other.m_mipCount);
+	swap(m_arraySize, other.m_arraySize);
+
 	return;
 }
 
 ID3D11ShaderResourceView* TextureClass::GetTexture()
 {
+	m_used = true;
+
 	return m_texture;
+}
+
+size_t TextureClass::GetMemorySize()
+{
+	return m_memorySize;
+}
+
+unsigned int TextureClass::GetFormat()
+{
+	return m_format;
+}
+
+int TextureClass::GetWidth()
+{
+	return m_width;
+}
+
+int TextureClass::GetHeight()
+{
+	return m_height;
+}
+
+int TextureClass::GetMipCount()
+{
+	return m_mipCount;
+}
+
+int TextureClass::GetArraySize()
+{
+	return m_arraySize;
+}
+
+bool TextureClass::WasUsed()
+{
+	bool used;
+
+	used = m_used;
+	m_used = false;
+
+	return used;
+}
+
+void TextureClass::Bind(ID3D11DeviceContext* deviceContext, ID3D11ShaderResourceView* texture)
+{
+	// The context holds a reference to what is bound, so no other view can take its address while it is.
+	if (texture == s_boundTexture)
+	{
+		s_bindsSkipped++;
+		return;
+	}
+
+	deviceContext->PSSetShaderResources(0, 1, &texture);
+	s_boundTexture = texture;
+	s_bindCount++;
+
+	return;
+}
+
+void TextureClass::GetBindCounts(unsigned long long& bindCount, unsigned long long& bindsSkipped)
+{
+	bindCount = s_bindCount;
+	bindsSkipped = s_bindsSkipped;
+
+	return;
+}
+
+bool TextureClass::IsDirectUpload(DdsFileClass* dds)
+{
+	int largest, mipCount;
+
+	// D3DX would give a texture without its mip levels a full chain, so only take over when the file has one.
+	largest = (dds->GetWidth() > dds->GetHeight()) ? dds->GetWidth() : dds->GetHeight();
+	for (mipCount = 1; (largest >> mipCount) > 0; mipCount++)
+	{
+	}
+
+	return dds->GetDimension() == 2 && DdsFileClass::IsDxgiFormat(dds->GetFormat()) && dds->GetMipCount() == mipCount;
+}
+
+void TextureClass::MeasureMemory()
+{
+	D3D11_SHADER_RESOURCE_VIEW_DESC viewDesc;
+	D3D11_TEXTURE2D_DESC textureDesc;
+	ID3D11Resource* resource;
+	unsigned int width, height, mip, blockBytes, texelBytes;
+
+	m_memorySize = 0;
+
+	// Only 2D textures, arrays and cube maps are created here.
+	m_texture->GetDesc(&viewDesc);
+	if (viewDesc.ViewDimension != D3D11_SRV_DIMENSION_TEXTURE2D && viewDesc.ViewDimension != D3D11_SRV_DIMENSION_TEXTURE2DARRAY &&
+		viewDesc.ViewDimension != D3D11_SRV_DIMENSION_TEXTURECUBE)
+	{
+		return;
+	}
+
+	m_texture->GetResource(&resource);
+	static_cast<ID3D11Texture2D*>(resource)->GetDesc(&textureDesc);
+	resource->Release();
+
+	m_format = (unsigned int)textureDesc.Format;
+	m_width = (int)textureDesc.Width;
+	m_height = (int)textureDesc.Height;
+	m_mipCount = (int)textureDesc.MipLevels;
+	m_arraySize = (int)textureDesc.ArraySize;
+
+	// Block compressed formats take a fixed size per 4x4 block, the rest a fixed size per texel.
+	blockBytes = 0;
+	texelBytes = 4;
+	switch (textureDesc.Format)
+	{
+	case DXGI_FORMAT_BC1_TYPELESS:
+	case DXGI_FORMAT_BC1_UNORM:
+	case DXGI_FORMAT_BC1_UNORM_SRGB:
+	case DXGI_FORMAT_BC4_TYPELESS:
+	case DXGI_FORMAT_BC4_UNORM:
+	case DXGI_FORMAT_BC4_SNORM:
+		blockBytes = 8;
+		break;
+	case DXGI_FORMAT_BC2_TYPELESS:
+	case DXGI_FORMAT_BC2_UNORM:
+	case DXGI_FORMAT_BC2_UNORM_SRGB:
+	case DXGI_FORMAT_BC3_TYPELESS:
+	case DXGI_FORMAT_BC3_UNORM:
+	case DXGI_FORMAT_BC3_UNORM_SRGB:
+	case DXGI_FORMAT_BC5_TYPELESS:
+	case DXGI_FORMAT_BC5_UNORM:
+	case DXGI_FORMAT_BC5_SNORM:
+	case DXGI_FORMAT_BC6H_TYPELESS:
+	case DXGI_FORMAT_BC6H_UF16:
+	case DXGI_FORMAT_BC6H_SF16:
+	case DXGI_FORMAT_BC7_TYPELESS:
+	case DXGI_FORMAT_BC7_UNORM:
+	case DXGI_FORMAT_BC7_UNORM_SRGB:
+		blockBytes = 16;
+		break;
+	case DXGI_FORMAT_R8_UNORM:
+	case DXGI_FORMAT_A8_UNORM:
+		texelBytes = 1;
+		break;
+	case DXGI_FORMAT_R8G8_UNORM:
+		texelBytes = 2;
+		break;
+	case DXGI_FORMAT_R16G16B16A16_UNORM:
+		texelBytes = 8;
+		break;
+	case DXGI_FORMAT_R32G32B32A32_FLOAT:
+		texelBytes = 16;
+		break;
+	default:
+		break;
+	}
+
+	// Add up the mip chain of every array slice.
+	width = textureDesc.Width;
+	height = textureDesc.Height;
+	for (mip = 0; mip < textureDesc.MipLevels; mip++)
+	{
+		if (blockBytes)
+		{
+			m_memorySize += (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+		}
+		else
+		{
+			m_memorySize += (size_t)width * height * texelBytes;
+		}
+
+		width = (width > 1) ? width / 2 : 1;
+		height = (height > 1) ? height / 2 : 1;
+	}
+	m_memorySize *= textureDesc.ArraySize;
+
+	return;
 }
\ No newline at end of file
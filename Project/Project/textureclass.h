@@ -6,6 +6,16 @@
 #include <d3d11.h>
 #include <d3dx11tex.h>
 
+#include "ddsfileclass.h"
+
+// A texture the shaders sample. The functions that create it from a file can leave out its largest levels,
+// starting at the given one, so a texture can be kept with less detail, and every GetTexture notes that it
+// was drawn until WasUsed is asked. The size and format describe the texture as created.
+//
+// Swap exchanges what two objects hold, so a texture created aside replaces the one drawn in one step.
+//
+// The shaders bind their texture with Bind, which leaves out a bind of the texture already bound, as happens
+// when what is drawn one after another shares an atlas, and counts the binds made and left out.
 class TextureClass
 {
 public:
@@ -14,11 +24,33 @@ public:
 	~TextureClass();
 
 	bool Initialize(ID3D11Device*, WCHAR*);
+	bool InitializeFromMemory(ID3D11Device*, const void*, size_t, int);
+	bool InitializeFromColor(ID3D11Device*, unsigned int);
+	bool InitializeFromDds(ID3D11Device*, DdsFileClass*, int);
 	void Shutdown();
+	void Swap(TextureClass&);
 
 	ID3D11ShaderResourceView* GetTexture();
+	size_t GetMemorySize();
+	unsigned int GetFormat();
+	int GetWidth();
+	int GetHeight();
+	int GetMipCount();
+	int GetArraySize();
+	bool WasUsed();
+
+	static void Bind(ID3D11DeviceContext*, ID3D11ShaderResourceView*);
+	static void GetBindCounts(unsigned long long&, unsigned long long&);
+
+private:
+	bool IsDirectUpload(DdsFileClass*);
+	void MeasureMemory();
 
 private:
 	ID3D11ShaderResourceView* m_texture;
+	size_t m_memorySize;
+	unsigned int m_format;
+	int m_width, m_height, m_mipCount, m_arraySize;
+	bool m_used;
 };
 #endif
\ No newline at end of file
@@ -0,0 +1,350 @@
+#include "texturecookerclass.h"
+
+#include <math.h>
+#include <string.h>
+#include <chrono>
+#include <fstream>
+
+// PSNR reported for a cook that reproduced the source exactly.
+static const double MAX_PSNR = 100.0;
+
+TextureCookerClass::TextureCookerClass()
+{
+	m_Encoder = 0;
+	m_Decoder = 0;
+	m_MipGenerator = 0;
+	memset(&m_stats, 0, sizeof(m_stats));
+	m_squaredError = 0.0;
+	m_samples = 0;
+	m_srgbTexels = false;
+}
+
+TextureCookerClass::TextureCookerClass(const TextureCookerClass& other)
+{
+}
+
+TextureCookerClass::~TextureCookerClass()
+{
+}
+
+bool TextureCookerClass::Initialize(int threadCount, int quality, int mipFilter, bool srgbTexels)
+{
+	bool result;
+
+	m_stats.threadCount = (threadCount > 0) ? threadCount : 1;
+	m_srgbTexels = srgbTexels;
+
+	// Create and initialize the block encoder.
+	m_Encoder = new BlockEncoderClass;
+	if (!m_Encoder)
+	{
+		return false;
+	}
+
+	result = m_Encoder->Initialize(m_stats.threadCount, quality);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Create and initialize the decoder that checks the blocks, on the best kernel the processor has.
+	m_Decoder = new BlockDecoderClass;
+	if (!m_Decoder)
+	{
+		return false;
+	}
+
+	result = m_Decoder->Initialize(m_stats.threadCount, BLOCK_KERNEL_AVX2);
+	if (!result)
+	{
+		return false;
+	}
+
+	// Create and initialize the mip generator, unless the sources keep the levels they have.
+	if (mipFilter != MIP_FILTER_NONE)
+	{
+		m_MipGenerator = new MipGeneratorClass;
+		if (!m_MipGenerator)
+		{
+			return false;
+		}
+
+		result = m_MipGenerator->Initialize(m_stats.threadCount, mipFilter, true);
+		if (!result)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void TextureCookerClass::Shutdown()
+{
+	// Release the mip generator.
+	if (m_MipGenerator)
+	{
+		m_MipGenerator->Shutdown();
+		delete m_MipGenerator;
+		m_MipGenerator = 0;
+	}
+
+	// Release the decoder.
+	if (m_Decoder)
+	{
+		m_Decoder->Shutdown();
+		delete m_Decoder;
+		m_Decoder = 0;
+	}
+
+	// Release the encoder.
+	if (m_Encoder)
+	{
+		m_Encoder->Shutdown();
+		delete m_Encoder;
+		m_Encoder = 0;
+	}
+
+	// Release the scratch texels.
+	vector<unsigned char>().swap(m_texels);
+	vector<unsigned char>().swap(m_decoded);
+	vector<unsigned char>().swap(m_chain);
+
+	return;
+}
+
+bool TextureCookerClass::Cook(DdsFileClass* source, unsigned int format, vector<char>& file)
+{
+	DdsFileClass::SurfaceType surface;
+	DdsFileClass cooked;
+	chrono::high_resolution_clock::time_point start;
+	const unsigned char* texels;
+	unsigned int sourceFormat, blockBytes, bitsPerPixel;
+	size_t size, offset, levelOffset;
+	int mipCount, item, mip, width, height;
+	bool srgb, generate, result;
+
+	// Only 2D textures of 8 bit texels, into the formats there is an encoder for.
+	sourceFormat = source->GetFormat();
+	if (source->GetDimension() != 2 || !BlockEncoderClass::IsSupported(format) || !source->GetSurface(0, 0, surface) || !ConvertToRgba(sourceFormat, surface, 0))
+	{
+		return false;
+	}
+
+	// Texels stored as srgb keep being read as srgb.
+	srgb = (sourceFormat == DDS_FORMAT_R8G8B8A8_UNORM_SRGB || sourceFormat == DDS_FORMAT_B8G8R8A8_UNORM_SRGB || sourceFormat == DDS_FORMAT_B8G8R8X8_UNORM_SRGB);
+	if (srgb)
+	{
+		format = (format == DDS_FORMAT_BC1_UNORM) ? DDS_FORMAT_BC1_UNORM_SRGB : format;
+		format = (format == DDS_FORMAT_BC3_UNORM) ? DDS_FORMAT_BC3_UNORM_SRGB : format;
+		format = (format == DDS_FORMAT_BC7_UNORM) ? DDS_FORMAT_BC7_UNORM_SRGB : format;
+	}
+
+	// The cooked file keeps every slice and level of the source, one after another in the same order, with
+	// the levels below the first generated when the source has only the one.
+	generate = (m_MipGenerator && source->GetMipCount() == 1);
+	mipCount = generate ? MipGeneratorClass::GetLevelCount(source->GetWidth(), source->GetHeight()) : source->GetMipCount();
+
+	DdsFileClass::GetFormatSize(format, blockBytes, bitsPerPixel);
+	size = DDS_WRITTEN_HEADER_SIZE;
+	for (mip = 0; mip < mipCount; mip++)
+	{
+		width = (source->GetWidth() >> mip > 0) ? source->GetWidth() >> mip : 1;
+		height = (source->GetHeight() >> mip > 0) ? source->GetHeight() >> mip : 1;
+		size += (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes * source->GetArraySize();
+	}
+
+	file.resize(size);
+	DdsFileClass::WriteHeader(format, source->GetWidth(), source->GetHeight(), mipCount, source->GetArraySize(), source->IsCubemap(), &file[0]);
+
+	// Read the cooked file the way the game will as it fills, to decode every surface once it is encoded.
+	result = cooked.InitializeFromMemory(&file[0], file.size());
+	if (!result)
+	{
+		return false;
+	}
+
+	m_stats.sourceBytes = source->GetDataSize();
+	m_stats.cookedBytes = size;
+	m_stats.texelCount = 0;
+	m_stats.mipSeconds = 0.0;
+	m_stats.encodeSeconds = 0.0;
+	m_squaredError = 0.0;
+	m_samples = 0;
+
+	offset = DDS_WRITTEN_HEADER_SIZE;
+	for (item = 0; item < source->GetArraySize(); item++)
+	{
+		if (generate)
+		{
+			source->GetSurface(0, item, surface);
+			m_texels.resize((size_t)surface.width * surface.height * 4);
+			ConvertToRgba(sourceFormat, surface, &m_texels[0]);
+
+			start = chrono::high_resolution_clock::now();
+			m_MipGenerator->Generate(&m_texels[0], (int)surface.width, (int)surface.height, (int)surface.width * 4, srgb || m_srgbTexels, m_chain);
+			m_stats.mipSeconds += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+		}
+
+		levelOffset = 0;
+		for (mip = 0; mip < mipCount; mip++)
+		{
+			width = (source->GetWidth() >> mip > 0) ? source->GetWidth() >> mip : 1;
+			height = (source->GetHeight() >> mip > 0) ? source->GetHeight() >> mip : 1;
+
+			if (generate)
+			{
+				texels = &m_chain[levelOffset];
+				levelOffset += (size_t)width * height * 4;
+			}
+			else
+			{
+				source->GetSurface(mip, item, surface);
+				m_texels.resize((size_t)width * height * 4);
+				ConvertToRgba(sourceFormat, surface, &m_texels[0]);
+				texels = &m_texels[0];
+			}
+
+			start = chrono::high_resolution_clock::now();
+			m_Encoder->Encode(format, texels, width, height, width * 4, (unsigned char*)&file[offset]);
+			m_stats.encodeSeconds += chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+			AddError(&cooked, mip, item, texels, width, height);
+
+			m_stats.texelCount += (unsigned long long)width * height;
+			offset += (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes;
+		}
+	}
+
+	cooked.Shutdown();
+
+	m_stats.psnr = MAX_PSNR;
+	if (m_squaredError > 0.0)
+	{
+		m_stats.psnr = 10.0 * log10(255.0 * 255.0 * (double)m_samples / m_squaredError);
+		m_stats.psnr = (m_stats.psnr < MAX_PSNR) ? m_stats.psnr : MAX_PSNR;
+	}
+
+	return true;
+}
+
+bool TextureCookerClass::Cook(const char* sourceFilename, const char* cookedFilename, unsigned int format)
+{
+	DdsFileClass source;
+	vector<char> file;
+	ofstream fout;
+	bool result;
+
+	result = source.Initialize(sourceFilename);
+	if (result)
+	{
+		result = Cook(&source, format, file);
+	}
+	source.Shutdown();
+
+	if (!result)
+	{
+		return false;
+	}
+
+	fout.open(cookedFilename, ios::out | ios::binary | ios::trunc);
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	fout.write(&file[0], (streamsize)file.size());
+
+	fout.close();
+	if (fout.fail())
+	{
+		return false;
+	}
+
+	return true;
+}
+
+const TextureCookerClass::StatsType& TextureCookerClass::GetStats()
+{
+	return m_stats;
+}
+
+bool TextureCookerClass::ConvertToRgba(unsigned int format, const DdsFileClass::SurfaceType& surface, unsigned char* texels)
+{
+	const unsigned char* row;
+	unsigned char* texel;
+	unsigned int x, y;
+	int red, blue, size;
+	bool alpha;
+
+	// Where red and blue sit in each texel, and whether the fourth byte is alpha or padding.
+	switch (format)
+	{
+	case DDS_FORMAT_R8G8B8A8_UNORM:
+	case DDS_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case DDS_FORMAT_R8G8B8X8:
+		red = 0;
+		blue = 2;
+		size = 4;
+		alpha = (format != DDS_FORMAT_R8G8B8X8);
+		break;
+	case DDS_FORMAT_B8G8R8A8_UNORM:
+	case DDS_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case DDS_FORMAT_B8G8R8X8_UNORM:
+	case DDS_FORMAT_B8G8R8X8_UNORM_SRGB:
+		red = 2;
+		blue = 0;
+		size = 4;
+		alpha = (format == DDS_FORMAT_B8G8R8A8_UNORM || format == DDS_FORMAT_B8G8R8A8_UNORM_SRGB);
+		break;
+	case DDS_FORMAT_B8G8R8:
+		red = 2;
+		blue = 0;
+		size = 3;
+		alpha = false;
+		break;
+	default:
+		return false;
+	}
+
+	// Without texels to fill only say whether the format converts.
+	if (!texels)
+	{
+		return true;
+	}
+
+	texel = texels;
+	for (y = 0; y < surface.height; y++)
+	{
+		row = (const unsigned char*)surface.data + (size_t)y * surface.rowPitch;
+		for (x = 0; x < surface.width; x++)
+		{
+			texel[0] = row[x * size + red];
+			texel[1] = row[x * size + 1];
+			texel[2] = row[x * size + blue];
+			texel[3] = alpha ? row[x * size + 3] : 255;
+			texel += 4;
+		}
+	}
+
+	return true;
+}
+
+void TextureCookerClass::AddError(DdsFileClass* cooked, int mip, int item, const unsigned char* texels, int width, int height)
+{
+	double difference;
+	size_t i, count;
+
+	count = (size_t)width * height * 4;
+	m_decoded.resize(count);
+	m_Decoder->Decode(cooked, mip, item, &m_decoded[0], width * 4);
+
+	for (i = 0; i < count; i++)
+	{
+		difference = (double)texels[i] - (double)m_decoded[i];
+		m_squaredError += difference * difference;
+	}
+	m_samples += count;
+
+	return;
+}
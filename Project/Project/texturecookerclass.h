@@ -0,0 +1,60 @@
+#pragma once
+
+#ifndef _TEXTURECOOKERCLASS_H_
+#define _TEXTURECOOKERCLASS_H_
+
+#include <vector>
+
+#include "ddsfileclass.h"
+#include "blockencoderclass.h"
+#include "blockdecoderclass.h"
+#include "mipgeneratorclass.h"
+using namespace std;
+
+// Cooks an uncompressed dds (8 bit RGB or RGBA, any mips, array slices or cube faces) into a DX10 dds of
+// BC1, BC3 or BC7 blocks that TextureClass uploads without a copy. An srgb source gets the srgb block
+// format. A source with a single level gets its full mip chain from MipGeneratorClass unless the filter is
+// MIP_FILTER_NONE, filtered in linear light when the source is srgb or its texels are known to be. Every
+// surface is encoded with BlockEncoderClass on the given threads, then decoded again to measure how far the
+// result is from the texels it was encoded from.
+class TextureCookerClass
+{
+public:
+	// Bytes in and out, time spent generating mips and encoding, and the PSNR over all four channels, the error the encoder
+	// minimizes. Sources without alpha count as opaque.
+	struct StatsType
+	{
+		size_t sourceBytes, cookedBytes;
+		unsigned long long texelCount;
+		double mipSeconds, encodeSeconds, psnr;
+		int threadCount;
+	};
+
+public:
+	TextureCookerClass();
+	TextureCookerClass(const TextureCookerClass&);
+	~TextureCookerClass();
+
+	bool Initialize(int, int, int, bool);
+	void Shutdown();
+
+	bool Cook(DdsFileClass*, unsigned int, vector<char>&);
+	bool Cook(const char*, const char*, unsigned int);
+	const StatsType& GetStats();
+
+	static bool ConvertToRgba(unsigned int, const DdsFileClass::SurfaceType&, unsigned char*);
+
+private:
+	void AddError(DdsFileClass*, int, int, const unsigned char*, int, int);
+
+private:
+	BlockEncoderClass* m_Encoder;
+	BlockDecoderClass* m_Decoder;
+	MipGeneratorClass* m_MipGenerator;
+	vector<unsigned char> m_texels, m_decoded, m_chain;
+	StatsType m_stats;
+	double m_squaredError;
+	unsigned long long m_samples;
+	bool m_srgbTexels;
+};
+#endif
@@ -1,5 +1,7 @@
 #include "textureshaderclass.h"
 
+#include "textureclass.h"
+
 TextureShaderClass::TextureShaderClass()
 {
 	m_vertexShader = 0;
@@ -307,8 +309,8 @@ bool TextureShaderClass::SetShaderParameters(ID3D11DeviceContext* deviceContext,
 	// Finanly set the constant buffer in the vertex shader with the updated values.
 	deviceContext->VSSetConstantBuffers(bufferNumber, 1, &m_matrixBuffer);
 
-	// Set shader texture resource in the pixel shader.
-	deviceContext->PSSetShaderResources(0, 1, &texture);
+	// Set shader texture resource in the pixel shader, unless it is already set.
+	TextureClass::Bind(deviceContext, texture);
 
 	return true;
 }
@@ -0,0 +1,490 @@
+#include "texturestreamerclass.h"
+
+#include <string.h>
+
+TextureStreamerClass::TextureStreamerClass()
+{
+	m_stopping = false;
+}
+
+TextureStreamerClass::TextureStreamerClass(const TextureStreamerClass& other)
+{
+}
+
+TextureStreamerClass::~TextureStreamerClass()
+{
+}
+
+bool TextureStreamerClass::Initialize()
+{
+	m_stopping = false;
+	m_thread = thread(&TextureStreamerClass::IoThread, this);
+
+	return true;
+}
+
+void TextureStreamerClass::Shutdown()
+{
+	unsigned int i;
+
+	// A read under way finishes, nothing else starts.
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_condition.notify_all();
+
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+
+	for (i = 0; i < m_streams.size(); i++)
+	{
+		Close(*m_streams[i]);
+		delete m_streams[i];
+	}
+	m_streams.clear();
+	m_results.clear();
+
+	return;
+}
+
+int TextureStreamerClass::Add(const wchar_t* filename, float priority)
+{
+	StreamType* stream;
+	int id;
+
+	// Nothing is known about the file until the I/O thread opens it to read the tail.
+	stream = new StreamType;
+	if (!stream)
+	{
+		return -1;
+	}
+
+	stream->filename = filename;
+	stream->file = 0;
+	stream->dds = 0;
+	stream->format = 0;
+	stream->width = 0;
+	stream->height = 0;
+	stream->mipCount = 0;
+	stream->arraySize = 0;
+	stream->tailMip = 0;
+	stream->residentMip = 0;
+	stream->targetMip = -1;
+	stream->priority = priority;
+	stream->cubemap = false;
+	stream->opened = false;
+	stream->streamable = false;
+	stream->failed = false;
+	stream->active = true;
+	stream->reading = false;
+
+	// Ids are never handed out again, a read still under way for a removed texture cannot land on another.
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_streams.push_back(stream);
+		id = (int)m_streams.size() - 1;
+	}
+	m_condition.notify_one();
+
+	return id;
+}
+
+void TextureStreamerClass::Remove(int id)
+{
+	unsigned int i;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	if (id < 0 || id >= (int)m_streams.size())
+	{
+		return;
+	}
+
+	// The I/O thread closes the file itself when it is reading from it.
+	m_streams[id]->active = false;
+	if (!m_streams[id]->reading)
+	{
+		Close(*m_streams[id]);
+	}
+
+	for (i = 0; i < m_results.size(); )
+	{
+		if (m_results[i].id == id)
+		{
+			m_results.erase(m_results.begin() + i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	return;
+}
+
+void TextureStreamerClass::Request(int id, int firstMip)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		if (id < 0 || id >= (int)m_streams.size())
+		{
+			return;
+		}
+
+		// Levels above the one asked for are read, those below it are no longer wanted.
+		m_streams[id]->targetMip = firstMip;
+	}
+	m_condition.notify_one();
+
+	return;
+}
+
+void TextureStreamerClass::SetResident(int id, int firstMip)
+{
+	{
+		lock_guard<mutex> lock(m_mutex);
+
+		if (id < 0 || id >= (int)m_streams.size())
+		{
+			return;
+		}
+
+		// The texture was reduced or released, later reads start again from what it has left.
+		m_streams[id]->residentMip = firstMip;
+	}
+	m_condition.notify_one();
+
+	return;
+}
+
+void TextureStreamerClass::SetPriority(int id, float priority)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	if (id < 0 || id >= (int)m_streams.size())
+	{
+		return;
+	}
+
+	m_streams[id]->priority = priority;
+
+	return;
+}
+
+bool TextureStreamerClass::GetResult(ResultType& result)
+{
+	lock_guard<mutex> lock(m_mutex);
+
+	if (m_results.empty())
+	{
+		return false;
+	}
+
+	result = move(m_results.front());
+	m_results.pop_front();
+
+	return true;
+}
+
+void TextureStreamerClass::IoThread()
+{
+	StreamType* stream;
+	ResultType result;
+	unsigned int i;
+	int id, mip, next;
+	bool opened;
+
+	while (true)
+	{
+		// Sleep until a texture needs a read. Tails go first, so everything asked for can be drawn soon,
+		// then the levels of the texture that covers the most of the screen.
+		{
+			unique_lock<mutex> lock(m_mutex);
+
+			id = -1;
+			m_condition.wait(lock, [&]
+			{
+				if (m_stopping)
+				{
+					return true;
+				}
+
+				for (i = 0; i < m_streams.size(); i++)
+				{
+					if (m_streams[i]->reading || GetNextMip(*m_streams[i]) < 0)
+					{
+						continue;
+					}
+
+					if (id < 0 || IsTailRead(*m_streams[i]) > IsTailRead(*m_streams[id]) ||
+						(IsTailRead(*m_streams[i]) == IsTailRead(*m_streams[id]) && m_streams[i]->priority > m_streams[id]->priority))
+					{
+						id = (int)i;
+					}
+				}
+
+				return id >= 0;
+			});
+
+			if (m_stopping)
+			{
+				return;
+			}
+
+			stream = m_streams[id];
+			stream->reading = true;
+		}
+
+		// Map the file outside the lock, the first time reading what it holds.
+		opened = Open(*stream);
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+
+			// Nothing of a texture opened for the first time is resident yet.
+			if (opened && !stream->opened)
+			{
+				stream->residentMip = stream->mipCount;
+				stream->opened = true;
+			}
+
+			mip = opened ? GetNextMip(*stream) : -1;
+			stream->failed = stream->failed || !opened;
+		}
+
+		// Read the levels outside the lock too, they are as large as the texture.
+		result.id = id;
+		result.failed = false;
+		if (mip >= 0 || !opened)
+		{
+			Read(*stream, opened ? mip : 0, result);
+		}
+
+		{
+			lock_guard<mutex> lock(m_mutex);
+
+			stream->reading = false;
+			stream->failed = stream->failed || result.failed;
+
+			if (stream->active && (mip >= 0 || stream->failed))
+			{
+				stream->residentMip = result.failed ? stream->mipCount : result.firstMip;
+				m_results.push_back(move(result));
+			}
+
+			// Keep the file mapped only while more of it is wanted.
+			next = GetNextMip(*stream);
+			if (!stream->active || next < 0)
+			{
+				Close(*stream);
+			}
+		}
+
+		result.file.clear();
+	}
+}
+
+bool TextureStreamerClass::IsTailRead(const StreamType& stream)
+{
+	return !stream.opened || stream.residentMip >= stream.mipCount;
+}
+
+int TextureStreamerClass::GetNextMip(const StreamType& stream)
+{
+	if (!stream.active || stream.failed)
+	{
+		return -1;
+	}
+
+	// Not opened yet, the first read is the tail, whatever it turns out to be.
+	if (!stream.opened)
+	{
+		return 0;
+	}
+
+	// Nothing resident: the tail, or the whole file when it cannot be read a level at a time.
+	if (stream.residentMip >= stream.mipCount)
+	{
+		if (stream.targetMip >= stream.mipCount)
+		{
+			return -1;
+		}
+
+		return stream.streamable ? stream.tailMip : 0;
+	}
+
+	// Then one level at a time down to the one asked for, if any was.
+	if (stream.targetMip >= 0 && stream.residentMip - 1 >= stream.targetMip)
+	{
+		return stream.residentMip - 1;
+	}
+
+	return -1;
+}
+
+bool TextureStreamerClass::Open(StreamType& stream)
+{
+	int fullMipCount;
+	bool result;
+
+	if (stream.file)
+	{
+		return true;
+	}
+
+	stream.file = new MappedFileClass;
+	if (!stream.file)
+	{
+		return false;
+	}
+
+	result = stream.file->Initialize(stream.filename.c_str());
+	if (!result)
+	{
+		Close(stream);
+		return false;
+	}
+
+	// Whatever is not a dds file is read whole and left to the texture loader to make sense of.
+	stream.dds = new DdsFileClass;
+	if (!stream.dds)
+	{
+		Close(stream);
+		return false;
+	}
+
+	result = stream.dds->InitializeFromMemory(stream.file->GetData(), stream.file->GetSize());
+	if (!result)
+	{
+		stream.dds->Shutdown();
+		delete stream.dds;
+		stream.dds = 0;
+	}
+
+	if (stream.opened)
+	{
+		return true;
+	}
+
+	// What the file holds is read once, it does not change while the texture streams.
+	if (stream.dds)
+	{
+		stream.format = stream.dds->GetFormat();
+		stream.width = stream.dds->GetWidth();
+		stream.height = stream.dds->GetHeight();
+		stream.mipCount = stream.dds->GetMipCount();
+		stream.arraySize = stream.dds->GetArraySize();
+		stream.cubemap = stream.dds->IsCubemap();
+
+		// Levels can only be read apart from a 2D texture that has all of them, in a format the GPU takes as stored.
+		for (fullMipCount = 1; (stream.width >> fullMipCount) > 0 || (stream.height >> fullMipCount) > 0; fullMipCount++)
+		{
+		}
+
+		stream.streamable = stream.dds->GetDimension() == 2 && DdsFileClass::IsDxgiFormat(stream.format) && stream.mipCount == fullMipCount;
+	}
+
+	if (!stream.streamable)
+	{
+		stream.mipCount = 1;
+	}
+
+	for (stream.tailMip = 0; stream.tailMip < stream.mipCount - 1; stream.tailMip++)
+	{
+		if ((stream.width >> stream.tailMip) <= TEXTURE_TAIL_SIZE && (stream.height >> stream.tailMip) <= TEXTURE_TAIL_SIZE)
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+void TextureStreamerClass::Read(StreamType& stream, int firstMip, ResultType& result)
+{
+	DdsFileClass::SurfaceType surface;
+	size_t size, offset;
+	int item, mip, width, height;
+	bool found;
+
+	result.firstMip = firstMip;
+	result.format = stream.format;
+	result.width = stream.width;
+	result.height = stream.height;
+	result.mipCount = stream.mipCount;
+	result.arraySize = stream.arraySize;
+	result.streamable = stream.streamable;
+	result.failed = !stream.file;
+	result.file.clear();
+
+	if (result.failed)
+	{
+		return;
+	}
+
+	// A file that cannot be read a level at a time is copied as it is.
+	if (!stream.streamable)
+	{
+		result.file.assign(stream.file->GetData(), stream.file->GetData() + stream.file->GetSize());
+		return;
+	}
+
+	// A dds file of its own, the texture as if its first level were the one read.
+	size = DDS_WRITTEN_HEADER_SIZE;
+	for (item = 0; item < stream.arraySize; item++)
+	{
+		for (mip = firstMip; mip < stream.mipCount; mip++)
+		{
+			found = stream.dds->GetSurface(mip, item, surface);
+			if (!found)
+			{
+				result.failed = true;
+				return;
+			}
+
+			size += surface.size;
+		}
+	}
+
+	width = (stream.width >> firstMip > 0) ? stream.width >> firstMip : 1;
+	height = (stream.height >> firstMip > 0) ? stream.height >> firstMip : 1;
+
+	result.file.resize(size);
+	DdsFileClass::WriteHeader(stream.format, width, height, stream.mipCount - firstMip, stream.arraySize, stream.cubemap, &result.file[0]);
+
+	offset = DDS_WRITTEN_HEADER_SIZE;
+	for (item = 0; item < stream.arraySize; item++)
+	{
+		for (mip = firstMip; mip < stream.mipCount; mip++)
+		{
+			stream.dds->GetSurface(mip, item, surface);
+			memcpy(&result.file[offset], surface.data, surface.size);
+			offset += surface.size;
+		}
+	}
+
+	return;
+}
+
+void TextureStreamerClass::Close(StreamType& stream)
+{
+	if (stream.dds)
+	{
+		stream.dds->Shutdown();
+		delete stream.dds;
+		stream.dds = 0;
+	}
+
+	if (stream.file)
+	{
+		stream.file->Shutdown();
+		delete stream.file;
+		stream.file = 0;
+	}
+
+	return;
+}
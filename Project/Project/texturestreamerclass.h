@@ -0,0 +1,83 @@
+#pragma once
+
+#ifndef _TEXTURESTREAMERCLASS_H_
+#define _TEXTURESTREAMERCLASS_H_
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "ddsfileclass.h"
+#include "texturecacheclass.h"
+using namespace std;
+
+// Reads textures from their dds files on a background I/O thread a few levels at a time, so they can be
+// drawn as soon as their smallest levels are in. The first read of a texture is its tail, every level of
+// TEXTURE_TAIL_SIZE or less; after that each read adds the next larger level, down to the level asked for
+// with Request. Every read comes back as a dds file of its own holding the levels from its first one down,
+// ready for TextureClass::InitializeFromMemory, and is picked up on the render thread with GetResult.
+//
+// The I/O thread reads every pending tail before any larger level, then the levels of the texture with the
+// highest priority, the size it covers on screen. A file that is not a 2D texture with its full mip chain in
+// a format the GPU samples as stored is read whole in one go, as level 0.
+class TextureStreamerClass
+{
+public:
+	// One read: the texture, the first level it holds, and the size of the whole texture.
+	struct ResultType
+	{
+		int id, firstMip;
+		unsigned int format;
+		int width, height, mipCount, arraySize;
+		bool streamable, failed;
+		vector<char> file;
+	};
+
+private:
+	struct StreamType
+	{
+		wstring filename;
+		MappedFileClass* file;
+		DdsFileClass* dds;
+		unsigned int format;
+		int width, height, mipCount, arraySize;
+		int tailMip, residentMip, targetMip;
+		float priority;
+		bool cubemap, opened, streamable, failed, active, reading;
+	};
+
+public:
+	TextureStreamerClass();
+	TextureStreamerClass(const TextureStreamerClass&);
+	~TextureStreamerClass();
+
+	bool Initialize();
+	void Shutdown();
+
+	int Add(const wchar_t*, float);
+	void Remove(int);
+	void Request(int, int);
+	void SetResident(int, int);
+	void SetPriority(int, float);
+	bool GetResult(ResultType&);
+
+private:
+	void IoThread();
+	bool IsTailRead(const StreamType&);
+	int GetNextMip(const StreamType&);
+	bool Open(StreamType&);
+	void Read(StreamType&, int, ResultType&);
+	void Close(StreamType&);
+
+private:
+	vector<StreamType*> m_streams;
+	deque<ResultType> m_results;
+	thread m_thread;
+	mutex m_mutex;
+	condition_variable m_condition;
+	bool m_stopping;
+};
+#endif
@@ -0,0 +1,413 @@
+#include "vertexquantizerclass.h"
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+static inline unsigned short QuantizeUnorm(float value, float offset, float extent)
+{
+	float scaled;
+
+	if (extent <= 0.0f)
+	{
+		return 0;
+	}
+
+	scaled = (value - offset) / extent * 65535.0f + 0.5f;
+	scaled = (scaled < 0.0f) ? 0.0f : ((scaled > 65535.0f) ? 65535.0f : scaled);
+
+	return (unsigned short)scaled;
+}
+
+static inline float SignNotZero(float value)
+{
+	return (value >= 0.0f) ? 1.0f : -1.0f;
+}
+
+VertexQuantizerClass::VertexQuantizerClass()
+{
+	memset(&m_dequantize, 0, sizeof(m_dequantize));
+	memset(&m_error, 0, sizeof(m_error));
+	m_format = VERTEX_FORMAT_FLOAT;
+	m_unitTexcoords = false;
+}
+
+VertexQuantizerClass::VertexQuantizerClass(const VertexQuantizerClass& other)
+{
+}
+
+VertexQuantizerClass::~VertexQuantizerClass()
+{
+}
+
+bool VertexQuantizerClass::Initialize(const FloatVertexType* vertices, int vertexCount, int format)
+{
+	float positionMin[3], positionMax[3], texcoordMin[2], texcoordMax[2], normal[3], length;
+	QuantizedVertexType* output;
+	int i, j;
+
+	if (format != VERTEX_FORMAT_HALF_UV && format != VERTEX_FORMAT_UNORM_UV)
+	{
+		return false;
+	}
+
+	m_format = format;
+
+	// Bounds of the positions and texture coordinates, which the unorm values are relative to.
+	for (j = 0; j < 3; j++)
+	{
+		positionMin[j] = FLT_MAX;
+		positionMax[j] = -FLT_MAX;
+	}
+	texcoordMin[0] = texcoordMin[1] = FLT_MAX;
+	texcoordMax[0] = texcoordMax[1] = -FLT_MAX;
+
+	for (i = 0; i < vertexCount; i++)
+	{
+		for (j = 0; j < 3; j++)
+		{
+			positionMin[j] = fminf(positionMin[j], (&vertices[i].x)[j]);
+			positionMax[j] = fmaxf(positionMax[j], (&vertices[i].x)[j]);
+		}
+		for (j = 0; j < 2; j++)
+		{
+			texcoordMin[j] = fminf(texcoordMin[j], (&vertices[i].tu)[j]);
+			texcoordMax[j] = fmaxf(texcoordMax[j], (&vertices[i].tu)[j]);
+		}
+	}
+
+	for (j = 0; j < 3; j++)
+	{
+		if (vertexCount == 0)
+		{
+			positionMin[j] = positionMax[j] = 0.0f;
+		}
+		m_dequantize.positionScale[j] = positionMax[j] - positionMin[j];
+		m_dequantize.positionOffset[j] = positionMin[j];
+	}
+
+	// Whether every texture coordinate stays inside the texture, in either layout.
+	m_unitTexcoords = texcoordMin[0] >= 0.0f && texcoordMin[1] >= 0.0f && texcoordMax[0] <= 1.0f && texcoordMax[1] <= 1.0f;
+
+	for (j = 0; j < 2; j++)
+	{
+		if (vertexCount == 0)
+		{
+			texcoordMin[j] = texcoordMax[j] = 0.0f;
+		}
+
+		// Half floats carry their own range, so only the unorm layout needs the bounds.
+		if (format == VERTEX_FORMAT_UNORM_UV)
+		{
+			m_dequantize.texcoordScale[j] = texcoordMax[j] - texcoordMin[j];
+			m_dequantize.texcoordOffset[j] = texcoordMin[j];
+		}
+		else
+		{
+			m_dequantize.texcoordScale[j] = 1.0f;
+			m_dequantize.texcoordOffset[j] = 0.0f;
+		}
+	}
+
+	// Pack every vertex.
+	m_vertices.resize(vertexCount);
+	for (i = 0; i < vertexCount; i++)
+	{
+		output = &m_vertices[i];
+
+		output->x = QuantizeUnorm(vertices[i].x, m_dequantize.positionOffset[0], m_dequantize.positionScale[0]);
+		output->y = QuantizeUnorm(vertices[i].y, m_dequantize.positionOffset[1], m_dequantize.positionScale[1]);
+		output->z = QuantizeUnorm(vertices[i].z, m_dequantize.positionOffset[2], m_dequantize.positionScale[2]);
+		output->w = 0;
+
+		if (format == VERTEX_FORMAT_UNORM_UV)
+		{
+			output->tu = QuantizeUnorm(vertices[i].tu, m_dequantize.texcoordOffset[0], m_dequantize.texcoordScale[0]);
+			output->tv = QuantizeUnorm(vertices[i].tv, m_dequantize.texcoordOffset[1], m_dequantize.texcoordScale[1]);
+		}
+		else
+		{
+			output->tu = FloatToHalf(vertices[i].tu);
+			output->tv = FloatToHalf(vertices[i].tv);
+		}
+
+		// Models without normals get straight up ones rather than a division by zero.
+		normal[0] = vertices[i].nx;
+		normal[1] = vertices[i].ny;
+		normal[2] = vertices[i].nz;
+		length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+		if (length > 0.0f)
+		{
+			normal[0] /= length;
+			normal[1] /= length;
+			normal[2] /= length;
+		}
+		else
+		{
+			normal[0] = 0.0f;
+			normal[1] = 0.0f;
+			normal[2] = 1.0f;
+		}
+
+		EncodeOctahedral(normal, output->nx, output->ny);
+	}
+
+	MeasureError(vertices);
+
+	return true;
+}
+
+void VertexQuantizerClass::Shutdown()
+{
+	vector<QuantizedVertexType>().swap(m_vertices);
+
+	return;
+}
+
+const VertexQuantizerClass::QuantizedVertexType* VertexQuantizerClass::GetVertices()
+{
+	return m_vertices.empty() ? 0 : &m_vertices[0];
+}
+
+int VertexQuantizerClass::GetVertexCount()
+{
+	return (int)m_vertices.size();
+}
+
+const VertexQuantizerClass::DequantizeType& VertexQuantizerClass::GetDequantize()
+{
+	return m_dequantize;
+}
+
+const VertexQuantizerClass::ErrorType& VertexQuantizerClass::GetError()
+{
+	return m_error;
+}
+
+bool VertexQuantizerClass::HasUnitTexcoords()
+{
+	return m_unitTexcoords;
+}
+
+int VertexQuantizerClass::GetStride(int format)
+{
+	return (format == VERTEX_FORMAT_FLOAT) ? (int)sizeof(FloatVertexType) : (int)sizeof(QuantizedVertexType);
+}
+
+const char* VertexQuantizerClass::GetFormatName(int format)
+{
+	switch (format)
+	{
+	case VERTEX_FORMAT_FLOAT:
+		return "float";
+	case VERTEX_FORMAT_HALF_UV:
+		return "unorm16 position, half uv, oct16 normal";
+	case VERTEX_FORMAT_UNORM_UV:
+		return "unorm16 position, unorm16 uv, oct16 normal";
+	}
+
+	return "unknown";
+}
+
+unsigned short VertexQuantizerClass::FloatToHalf(float value)
+{
+	unsigned int bits, sign, mantissa, remainder, halfway, half;
+	int exponent, shift;
+
+	memcpy(&bits, &value, sizeof(bits));
+	sign = (bits >> 16) & 0x8000;
+	exponent = (int)((bits >> 23) & 0xff);
+	mantissa = bits & 0x7fffff;
+
+	// Infinity and NaN.
+	if (exponent == 255)
+	{
+		return (unsigned short)(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+	}
+
+	exponent = exponent - 127 + 15;
+	if (exponent >= 31)
+	{
+		return (unsigned short)(sign | 0x7c00);
+	}
+
+	// Too small for a normal half, shift into a denormal rounding to nearest even.
+	if (exponent <= 0)
+	{
+		if (exponent < -10)
+		{
+			return (unsigned short)sign;
+		}
+
+		mantissa |= 0x800000;
+		shift = 14 - exponent;
+		half = mantissa >> shift;
+		remainder = mantissa & ((1u << shift) - 1);
+		halfway = 1u << (shift - 1);
+		if (remainder > halfway || (remainder == halfway && (half & 1)))
+		{
+			half++;
+		}
+
+		return (unsigned short)(sign | half);
+	}
+
+	// Round to nearest even, a carry out of the mantissa correctly bumps the exponent.
+	half = ((unsigned int)exponent << 10) | (mantissa >> 13);
+	remainder = mantissa & 0x1fff;
+	if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+	{
+		half++;
+	}
+
+	return (unsigned short)(sign | half);
+}
+
+float VertexQuantizerClass::HalfToFloat(unsigned short half)
+{
+	unsigned int sign, exponent, mantissa, bits;
+	float value;
+
+	sign = (unsigned int)(half & 0x8000) << 16;
+	exponent = (half >> 10) & 0x1f;
+	mantissa = half & 0x3ff;
+
+	if (exponent == 0)
+	{
+		value = ldexpf((float)mantissa, -24);
+		return sign ? -value : value;
+	}
+
+	if (exponent == 31)
+	{
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	}
+	else
+	{
+		bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+	}
+
+	memcpy(&value, &bits, sizeof(value));
+
+	return value;
+}
+
+void VertexQuantizerClass::EncodeOctahedral(const float normal[3], short& x, short& y)
+{
+	float sum, u, v, decoded[3], dot, bestDot;
+	int baseX, baseY, i, j, candidateX, candidateY;
+
+	// Project onto the octahedron, folding the lower half over the diagonals.
+	sum = fabsf(normal[0]) + fabsf(normal[1]) + fabsf(normal[2]);
+	u = normal[0] / sum;
+	v = normal[1] / sum;
+	if (normal[2] < 0.0f)
+	{
+		sum = u;
+		u = (1.0f - fabsf(v)) * SignNotZero(u);
+		v = (1.0f - fabsf(sum)) * SignNotZero(v);
+	}
+
+	// Plain rounding is not always the closest direction after decoding, so try the four neighbours.
+	baseX = (int)floorf(u * 32767.0f);
+	baseY = (int)floorf(v * 32767.0f);
+	bestDot = -2.0f;
+	for (i = 0; i < 2; i++)
+	{
+		for (j = 0; j < 2; j++)
+		{
+			candidateX = baseX + i;
+			candidateY = baseY + j;
+			candidateX = (candidateX < -32767) ? -32767 : ((candidateX > 32767) ? 32767 : candidateX);
+			candidateY = (candidateY < -32767) ? -32767 : ((candidateY > 32767) ? 32767 : candidateY);
+
+			DecodeOctahedral((short)candidateX, (short)candidateY, decoded);
+			dot = decoded[0] * normal[0] + decoded[1] * normal[1] + decoded[2] * normal[2];
+			if (dot > bestDot)
+			{
+				bestDot = dot;
+				x = (short)candidateX;
+				y = (short)candidateY;
+			}
+		}
+	}
+
+	return;
+}
+
+void VertexQuantizerClass::DecodeOctahedral(short x, short y, float normal[3])
+{
+	float u, v, length;
+
+	// The same steps as the vertex shader.
+	u = fmaxf((float)x / 32767.0f, -1.0f);
+	v = fmaxf((float)y / 32767.0f, -1.0f);
+
+	normal[2] = 1.0f - fabsf(u) - fabsf(v);
+	if (normal[2] < 0.0f)
+	{
+		normal[0] = (1.0f - fabsf(v)) * SignNotZero(u);
+		normal[1] = (1.0f - fabsf(u)) * SignNotZero(v);
+	}
+	else
+	{
+		normal[0] = u;
+		normal[1] = v;
+	}
+
+	length = sqrtf(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+	normal[0] /= length;
+	normal[1] /= length;
+	normal[2] /= length;
+
+	return;
+}
+
+void VertexQuantizerClass::MeasureError(const FloatVertexType* vertices)
+{
+	const QuantizedVertexType* packed;
+	float value, decoded[3], length, dot, diagonal;
+	int i, j;
+
+	memset(&m_error, 0, sizeof(m_error));
+
+	for (i = 0; i < (int)m_vertices.size(); i++)
+	{
+		packed = &m_vertices[i];
+
+		for (j = 0; j < 3; j++)
+		{
+			value = (float)(&packed->x)[j] / 65535.0f * m_dequantize.positionScale[j] + m_dequantize.positionOffset[j];
+			m_error.position = fmaxf(m_error.position, fabsf(value - (&vertices[i].x)[j]));
+		}
+
+		for (j = 0; j < 2; j++)
+		{
+			if (m_format == VERTEX_FORMAT_UNORM_UV)
+			{
+				value = (float)(&packed->tu)[j] / 65535.0f * m_dequantize.texcoordScale[j] + m_dequantize.texcoordOffset[j];
+			}
+			else
+			{
+				value = HalfToFloat((&packed->tu)[j]);
+			}
+			m_error.texcoord = fmaxf(m_error.texcoord, fabsf(value - (&vertices[i].tu)[j]));
+		}
+
+		length = sqrtf(vertices[i].nx * vertices[i].nx + vertices[i].ny * vertices[i].ny + vertices[i].nz * vertices[i].nz);
+		if (length > 0.0f)
+		{
+			DecodeOctahedral(packed->nx, packed->ny, decoded);
+			dot = (decoded[0] * vertices[i].nx + decoded[1] * vertices[i].ny + decoded[2] * vertices[i].nz) / length;
+			dot = (dot > 1.0f) ? 1.0f : ((dot < -1.0f) ? -1.0f : dot);
+			m_error.normalDegrees = fmaxf(m_error.normalDegrees, acosf(dot) * 57.2957795f);
+		}
+	}
+
+	// The position error as a fraction of the bounding box diagonal, comparable between meshes.
+	diagonal = sqrtf(m_dequantize.positionScale[0] * m_dequantize.positionScale[0] + m_dequantize.positionScale[1] * m_dequantize.positionScale[1] +
+		m_dequantize.positionScale[2] * m_dequantize.positionScale[2]);
+	m_error.positionRelative = (diagonal > 0.0f) ? m_error.position / diagonal : 0.0f;
+
+	return;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#ifndef _VERTEXQUANTIZERCLASS_H_
+#define _VERTEXQUANTIZERCLASS_H_
+
+#include <vector>
+using namespace std;
+
+// Vertex layouts a model can be uploaded in, chosen per asset when it is loaded.
+const int VERTEX_FORMAT_FLOAT = 0;
+const int VERTEX_FORMAT_HALF_UV = 1;
+const int VERTEX_FORMAT_UNORM_UV = 2;
+
+// Packs 32 byte float vertices (position, texture coordinate, normal) into 16 bytes: the position as unorm16
+// inside the mesh bounding box, the texture coordinate as half floats or as unorm16 inside its own bounds, and
+// the normal octahedral encoded as two snorm16. The shader undoes the bounds with the dequantize values.
+class VertexQuantizerClass
+{
+public:
+	struct FloatVertexType
+	{
+		float x, y, z;
+		float tu, tv;
+		float nx, ny, nz;
+	};
+
+	struct QuantizedVertexType
+	{
+		unsigned short x, y, z, w;
+		unsigned short tu, tv;
+		short nx, ny;
+	};
+
+	// Unpacked value = packed value * scale + offset, for the position and the texture coordinate.
+	struct DequantizeType
+	{
+		float positionScale[3];
+		float positionOffset[3];
+		float texcoordScale[2];
+		float texcoordOffset[2];
+	};
+
+	// Largest difference between a decoded vertex and the original one.
+	struct ErrorType
+	{
+		float position;
+		float positionRelative;
+		float texcoord;
+		float normalDegrees;
+	};
+
+public:
+	VertexQuantizerClass();
+	VertexQuantizerClass(const VertexQuantizerClass&);
+	~VertexQuantizerClass();
+
+	bool Initialize(const FloatVertexType*, int, int);
+	void Shutdown();
+
+	const QuantizedVertexType* GetVertices();
+	int GetVertexCount();
+	const DequantizeType& GetDequantize();
+	const ErrorType& GetError();
+	bool HasUnitTexcoords();
+
+	static int GetStride(int);
+	static const char* GetFormatName(int);
+
+	static unsigned short FloatToHalf(float);
+	static float HalfToFloat(unsigned short);
+
+private:
+	void EncodeOctahedral(const float[3], short&, short&);
+	void DecodeOctahedral(short, short, float[3]);
+	void MeasureError(const FloatVertexType*);
+
+private:
+	vector<QuantizedVertexType> m_vertices;
+	DequantizeType m_dequantize;
+	ErrorType m_error;
+	int m_format;
+	bool m_unitTexcoords;
+};
+#endif